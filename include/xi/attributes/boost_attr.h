@@ -29,6 +29,8 @@
 #include <map>
 #include <memory>   // shared_ptr
 #include <cstdint> // uintptr_t
+#include <cstring> // strlen
+#include <functional> // std::hash
 
 // boost library
 #include <boost/variant.hpp>            // boost::variant
@@ -38,6 +40,7 @@
 #include "xi/xilib_dll.h"               // все-таки в каком пакете он должен лежать?
 #include "xi/attributes/destructable_object.h"
 #include "xi/types/aliases.h"
+#include "xi/strutils/interned_str.h"
 
 
 namespace xi {
@@ -57,6 +60,9 @@ typedef std::shared_ptr<IDestructableObject> DestrObjSharedPtr;
 /** \brief Type definition for a shared pointer to std::string object */
 typedef std::shared_ptr<std::string> StringSharedPtr;  // тестируем
 
+/** \brief Type definition for a handle of a pooled (interned) string */
+typedef xi::strutils::InternedStr InternedStr;
+
 
 
 /** \brief Visitor for converting Variant object to a string representations. */
@@ -168,6 +174,11 @@ public:
         return s;
     }
 
+    std::string operator()(const InternedStr& is) const
+    {
+        return is.str();
+    }
+
 
 
     // "вне конкурса"
@@ -214,7 +225,8 @@ public:
         // shared_ptr<>                         // TODO: вынести в DestrObjSharedPtr операции сравнения или отдельным типом сравнимым сделать!
         DestrObjSharedPtr,                          // memory-managed object pointer    
         CStrSharedArr,                              // c-string // DONE: нельзя, вместо него  надо boost::shared_array
-        StringSharedPtr                             // std::string
+        StringSharedPtr,                            // std::string
+        InternedStr                                 // pooled std::string
     > BaseVariant;
 
 
@@ -236,6 +248,7 @@ public:
         tDestrObjSharedPtr,
         tCStrSharedArr,
         tStringSharedPtr,
+        tInternedStr,
         // atUnknown,   there are no such a state
     }; //
 public:
@@ -263,6 +276,7 @@ public:
     VarAttributeTVis1(const DestrObjSharedPtr& val) : _var(val) {  };
     VarAttributeTVis1(const CStrSharedArr& val) : _var(val) {  };
     VarAttributeTVis1(const StringSharedPtr& val) : _var(val) {  };
+    VarAttributeTVis1(const InternedStr& val) : _var(val) {  }
 
 
     // special for std::string
@@ -311,11 +325,19 @@ public:
                 return (*boost::get<StringSharedPtr>(getRef()) ==
                 *boost::get<StringSharedPtr>(rhv.getRef()));
 
+            if (lt == tInternedStr)                                      // из пула: по указателям
+                return boost::get<InternedStr>(getRef()) ==
+                boost::get<InternedStr>(rhv.getRef());
+
             if (lt == tCStrSharedArr)                                    // c-строка
                 return strcmp(boost::get<CStrSharedArr>(getRef()).get(),
                 boost::get<CStrSharedArr>(rhv.getRef()).get()) == 0;
         }
 
+        // std::string и строка из пула — по содержимому
+        if (isStdStrType(lt) && isStdStrType(rt))
+            return getStdStr() == rhv.getStdStr();
+
         // случай 2, жизненный (а если попробовать на откуп ей отдать?!)
         // для всего остального...
         return (getRef() == rhv.getRef()); 
@@ -344,6 +366,10 @@ public:
                 return (*boost::get<StringSharedPtr>(getRef()) <
                 *boost::get<StringSharedPtr>(rhv.getRef()));
 
+            if (lt == tInternedStr)                                      // из пула
+                return boost::get<InternedStr>(getRef()) <
+                boost::get<InternedStr>(rhv.getRef());
+
             if (lt == tCStrSharedArr)                                    // c-строка
                 return strcmp(boost::get<CStrSharedArr>(getRef()).get(),
                 boost::get<CStrSharedArr>(rhv.getRef()).get()) < 0;
@@ -352,6 +378,11 @@ public:
             //return (getRef() < rhv.getRef());
         }
 
+        // std::string и строка из пула — по содержимому; их типы соседние, так что
+        // с прочими типами порядок остается согласованным
+        if (isStdStrType(lt) && isStdStrType(rt))
+            return getStdStr() < rhv.getStdStr();
+
         // случай 2, жизненный (а если попробовать на откуп ей отдать?!)
         return (getRef() < rhv.getRef());
     }
@@ -371,6 +402,54 @@ public:
     /** \brief Makes an object empty. */
     void clear() { getRef() = boost::blank(); }
 
+    /** \brief Returns true for std::string and interned string types, whose values
+     *  are compared with each other by contents.
+     */
+    static bool isStdStrType(AType t) { return t == tStringSharedPtr || t == tInternedStr; }
+
+    /** \brief Returns a hash value consistent with operator==.
+     *
+     *  For interned strings the hash is precomputed, so it costs O(1);
+     *  other strings are hashed by contents.
+     */
+    std::size_t hash() const
+    {
+        AType t = getType();
+        if (t == tInternedStr)
+            return boost::get<InternedStr>(getRef()).hash();
+
+        if (t == tStringSharedPtr)
+            return std::hash<std::string>()(*boost::get<StringSharedPtr>(getRef()));
+
+        if (t == tBlank)
+            return 0;
+
+        // прочие типы — через строковое представление, с примесью типа
+        return std::hash<std::string>()(toString()) ^ (std::size_t)t;
+    }
+
+    /** \brief Returns a number of heap bytes owned by the attribute.
+     *
+     *  Only own strings are counted; interned strings belong to their pool,
+     *  objects by pointers are not known. A string shared by several attributes
+     *  is counted in each of them.
+     */
+    std::size_t getPayloadSize() const
+    {
+        AType t = getType();
+        if (t == tStringSharedPtr)
+        {
+            const std::string& s = *boost::get<StringSharedPtr>(getRef());
+            // буфер строки размещается в куче только вне SSO
+            return sizeof(std::string) + (s.capacity() > 15 ? s.capacity() + 1 : 0);
+        }
+
+        if (t == tCStrSharedArr)
+            return std::strlen(boost::get<CStrSharedArr>(getRef()).get()) + 1;
+
+        return 0;
+    }
+
 public:
     //-----------<Gets as a type>----------
     
@@ -451,6 +530,10 @@ public:
             return strPtr.get();
         }
 
+        // строка из пула не должна изменяться через возвращенный указатель!
+        if (t == tInternedStr)
+            return const_cast<std::string*>(boost::get<InternedStr>(getRef()).strP());
+
         return nullptr;
         //throw std::runtime_error("Not a string.");      // здесь не оч. удачно, что семантика страдает
     }
@@ -499,6 +582,17 @@ public:
     BaseVariant* getPtr() { return &_var; }
     const BaseVariant* getPtr() const { return &_var; }
 protected:
+    /** \brief Returns contents of a std::string or interned string attribute. */
+    const std::string& getStdStr() const
+    {
+        static const std::string EMPTY_STR;
+        if (getType() == tInternedStr)
+            return boost::get<InternedStr>(getRef()).str();
+
+        const StringSharedPtr& s = boost::get<StringSharedPtr>(getRef());
+        return s ? *s : EMPTY_STR;
+    }
+
     // instance of a base variant
     BaseVariant _var;
 
@@ -508,10 +602,26 @@ protected:
 typedef VarAttributeTVis1<VarAttributeToStrDefVisitor> VarAttribute1;
 
 
+/** \brief Hash functor for attributes, e.g. for unordered containers. */
+template<typename TAttr>
+struct VarAttributeHash {
+    std::size_t operator()(const TAttr& a) const { return a.hash(); }
+}; // struct VarAttributeHash
+
+
 
 }; //  namespace attributes
 }; // namespace xi
 
 
+/** \brief std::hash specialization, so attributes can be used as keys of std
+ *  unordered containers directly.
+ */
+template<typename TVis>
+struct std::hash<xi::attributes::VarAttributeTVis1<TVis>> {
+    std::size_t operator()(const xi::attributes::VarAttributeTVis1<TVis>& a) const { return a.hash(); }
+};
+
+
 
 #endif // XILIB_XI_ATTRIBUTES_BOOST_ATTR_H_
@@ -0,0 +1,230 @@
+////////////////////////////////////////////////////////////////////////////////
+/// \file
+/// \brief     Compact trivially copyable attribute.
+/// \author    Sergey Shershakov
+/// \version   0.1.0
+/// \date      18.10.2026
+/// \copyright (c) xidv.ru 2014–2017.
+///            This source is for internal use only — Restricted Distribution.
+///            All rights reserved.
+///
+/// CompactAttribute is a 16-byte tagged value keeping numerics and short strings
+/// inline and longer strings as pointers to pooled copies, so it owns nothing and
+/// is copied by memcpy without any refcounting. Its hash is computed once when a
+/// value is set.
+///
+/// If the library is configured with xi_COMPACT_ATTRIBUTES option, the
+/// XI_COMPACT_ATTRIBUTES directive is defined and the class is used as the
+/// attribute type of event logs instead of VarAttribute1.
+///
+////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef XILIB_XI_ATTRIBUTES_COMPACT_ATTR_H_
+#define XILIB_XI_ATTRIBUTES_COMPACT_ATTR_H_
+
+
+#include "xi/xilib_dll.h"
+#include "xi/attributes/boost_attr.h"
+#include "xi/strutils/interned_str.h"
+#include "xi/types/aliases.h"
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+namespace xi { namespace attributes {; //
+
+
+/** \brief Compact trivially copyable attribute.
+ *
+ *  Layout: 11 bytes of payload, a tag byte (type in the low nibble and a length of
+ *  an inline string in the high one) and a 32-bit hash.
+ *  Strings up to SSO_CAP characters are stored inline (tSmallStr); longer strings
+ *  and byte arrays are interned once in the process-wide InternStrPool::global()
+ *  and referred to by a pointer to their characters and a 24-bit length
+ *  (tPooledStr); interned strings keep a pointer to their pool entry (tInternedStr). All three are strings with the same
+ *  semantics: they are compared, ordered and hashed by contents. Values of other
+ *  types are equal only if their types are equal, as for VarAttribute1.
+ *
+ *  Types which own their data (shared pointers of VarAttribute1) have no compact
+ *  counterpart: strings are copied, byte arrays are stored as pooled byte strings,
+ *  other objects are rejected.
+ */
+class XILIB_API CompactAttribute {
+public:
+    //-----<Types>-----
+
+    /** \brief Types of values; the first ones coincide with ones of VarAttribute1. */
+    enum AType {
+        tBlank,                         ///< Empty, uninitialized value.
+        tChar,
+        tUChar,
+        tInt,
+        tUInt,
+        tInt64,
+        tUInt64,
+        tDouble,
+        tVoidP,
+        tVoidCP,
+        tSmallStr,                      ///< Inline string.
+        tPooledStr,                     ///< String in the process-wide pool.
+        tInternedStr,                   ///< String in an InternStrPool.
+    };
+
+    /** \brief Max length of a string stored inline. */
+    static const std::size_t SSO_CAP = 11;
+
+    /** \brief Max length of a pooled string. */
+    static const std::size_t MAX_POOLED_LEN = 0xFFFFFF;
+public:
+    //-----<Constructors>-----
+
+    /** \brief Default constructor: empty attribute. */
+    CompactAttribute() { std::memset(this, 0, sizeof(CompactAttribute)); }
+
+    CompactAttribute(char val) { setNum(tChar, (xi::types::TInt64)val); }
+    CompactAttribute(unsigned char val) { setNum(tUChar, (xi::types::TInt64)val); }
+    CompactAttribute(int val) { setNum(tInt, (xi::types::TInt64)val); }
+    CompactAttribute(unsigned int val) { setNum(tUInt, (xi::types::TInt64)val); }
+    CompactAttribute(xi::types::TInt64 val) { setNum(tInt64, val); }
+    CompactAttribute(xi::types::TQword val) { setNum(tUInt64, (xi::types::TInt64)val); }
+    CompactAttribute(double val);
+    CompactAttribute(void* val) { setPtr(tVoidP, val); }
+    CompactAttribute(const void* val) { setPtr(tVoidCP, val); }
+
+    /** \brief Strings are copied, unlike c-string pointers of VarAttribute1. */
+    CompactAttribute(const char* s) { setStr(s ? std::string_view(s) : std::string_view()); }
+    CompactAttribute(const std::string& s) { setStr(s); }
+    CompactAttribute(std::string_view s) { setStr(s); }
+    CompactAttribute(const InternedStr& s);
+
+    /** \brief Copies a string; a null pointer gives an empty attribute. */
+    CompactAttribute(const StringSharedPtr& s);
+
+    /** \brief Converts \a a; throws std::invalid_argument for owned objects other
+     *  than byte arrays.
+     */
+    explicit CompactAttribute(const VarAttribute1& a);
+public:
+    //----<Static Factory Constructors>----
+
+    /** \brief Creates a pooled byte string of \a size bytes. */
+    static CompactAttribute bytes(const void* data, std::size_t size);
+
+    /** \brief Process-wide pool for strings which do not fit inline; the same as
+     *  InternStrPool::global().
+     */
+    static xi::strutils::InternStrPool& strPool();
+public:
+    //--------<Operators>------------
+
+    bool operator==(const CompactAttribute& rhv) const
+    {
+        if (_hash != rhv._hash)
+            return false;
+
+        return compare(rhv) == 0;
+    }
+
+    bool operator!=(const CompactAttribute& rhv) const { return !operator==(rhv); }
+
+    bool operator<(const CompactAttribute& rhv) const { return compare(rhv) < 0; }
+
+    bool operator>(const CompactAttribute& rhv) const { return rhv < *this; }
+
+    /** \brief Three-way comparison: by types (strings form one type), then by values. */
+    int compare(const CompactAttribute& rhv) const;
+public:
+    //-----------<Info>----------
+
+    /** \brief Returns a type of attribute data. */
+    AType getType() const { return (AType)(_tag & 0x0F); }
+
+    /** \brief Returns true if the object is "empty" (uninitialized). */
+    bool isEmpty() const { return getType() == tBlank; }
+
+    /** \brief Returns true if the object is a string of any kind. */
+    bool isStr() const { AType t = getType(); return t >= tSmallStr; }
+
+    /** \brief Makes an object empty. */
+    void clear() { std::memset(this, 0, sizeof(CompactAttribute)); }
+
+    /** \brief Returns the precomputed hash value. */
+    std::size_t hash() const { return _hash; }
+
+    /** \brief Returns a number of heap bytes owned by the attribute: always 0, as
+     *  strings are either inline or belong to a pool.
+     */
+    std::size_t getPayloadSize() const { return 0; }
+public:
+    //-----------<Gets as a type>----------
+
+    int asInt() const { return (int)asInt64(); }
+
+    /** \brief Returns an integer value; 0 for non-integer types. */
+    xi::types::TInt64 asInt64() const
+    {
+        AType t = getType();
+        return (t >= tChar && t <= tUInt64) ? loadNum() : 0;
+    }
+
+    /** \brief Returns a double value or an integer one converted to double. */
+    double asDouble() const;
+
+    /** \brief Returns a pointer for pointer types and nullptr otherwise. */
+    const void* asPtr() const
+    {
+        AType t = getType();
+        return (t == tVoidP || t == tVoidCP) ? loadPtr() : nullptr;
+    }
+
+    /** \brief Returns a view of a string; an empty view for non-strings.
+     *
+     *  The view of an inline string refers to the object itself.
+     */
+    std::string_view asStrView() const;
+
+    /** \brief Returns a string representation in the same way as VarAttribute1. */
+    std::string toString() const;
+
+    /** \brief Converts the attribute to VarAttribute1. */
+    VarAttribute1 toVar() const;
+protected:
+    void setNum(AType t, xi::types::TInt64 val);
+    void setPtr(AType t, const void* p);
+    void setStr(std::string_view s);
+
+    xi::types::TInt64 loadNum() const
+    {
+        xi::types::TInt64 v;
+        std::memcpy(&v, _buf, sizeof(v));
+        return v;
+    }
+
+    const void* loadPtr() const
+    {
+        const void* p;
+        std::memcpy(&p, _buf, sizeof(p));
+        return p;
+    }
+protected:
+    char _buf[SSO_CAP];                 ///< Value, pointer or inline characters.
+    std::uint8_t _tag;                  ///< Type and length of an inline string.
+    std::uint32_t _hash;                ///< Precomputed hash.
+}; // class CompactAttribute
+
+
+//------------------------------------------------------------------------------
+}} // namespaces
+
+
+/** \brief std::hash specialization for compact attributes. */
+template<>
+struct std::hash<xi::attributes::CompactAttribute> {
+    std::size_t operator()(const xi::attributes::CompactAttribute& a) const { return a.hash(); }
+};
+
+
+#endif // XILIB_XI_ATTRIBUTES_COMPACT_ATTR_H_
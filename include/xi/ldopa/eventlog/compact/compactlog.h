@@ -0,0 +1,520 @@
+////////////////////////////////////////////////////////////////////////////////
+/// \file
+/// \brief     LDOPA EventLog Library
+/// \author    Sergey Shershakov
+/// \version   0.1.0
+/// \date      18.10.2026
+/// \copyright (c) xidv.ru 2014–2017.
+///            This source is for internal use only — Restricted Distribution.
+///            All rights reserved.
+///
+/// Compact in-memory event log storing traces as varint-encoded sequences of
+/// activity codes with an optional delta-encoded timestamp column.
+///
+////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef XI_LDOPA_EVENTLOG_COMPACT_COMPACTLOG_H_
+#define XI_LDOPA_EVENTLOG_COMPACT_COMPACTLOG_H_
+
+#pragma once
+
+// ldopa
+#include "xi/ldopa/eventlog/eventlog.h"
+
+// std
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+
+namespace xi { namespace ldopa { namespace eventlog {;   //
+
+
+class LDOPA_API CompactLog;
+class LDOPA_API CompactTrace;
+
+
+//==============================================================================
+// class CompactLog_traits
+//==============================================================================
+
+/** \brief Auxilliary class for compact event log classes. */
+class LDOPA_API CompactLog_traits {
+public:
+    /** \brief Unsigned int for numerating 0-based positions. */
+    typedef IEventLog_traits::UInt UInt;
+
+    /** \brief Byte of encoded data. */
+    typedef std::uint8_t Byte;
+
+    /** \brief Buffer of encoded data. */
+    typedef std::vector<Byte> ByteVec;
+
+    /** \brief Offsets in encoded data buffers. */
+    typedef std::vector<std::uint64_t> OffsetVec;
+
+    /** \brief Type of timestamps. */
+    typedef xi::types::TInt64 Timestamp;
+
+    /** \brief Vector of named attributes. */
+    typedef std::vector<IEventLog_traits::NamedAttribute> NmAttributesVector;
+}; // class CompactLog_traits
+
+
+//==============================================================================
+// class CompactEvent
+//==============================================================================
+
+/** \brief Decoded event of a compact event log: an activity code and a timestamp. */
+class LDOPA_API CompactEvent : public IEvent {
+    friend class CompactTrace;
+public:
+    /** \brief Unsigned int for numerating 0-based positions. */
+    typedef CompactLog_traits::UInt UInt;
+
+    /** \brief Type of timestamps. */
+    typedef CompactLog_traits::Timestamp Timestamp;
+public:
+    /** \brief Constructor initializes an event with an owner trace, an activity code
+     *  and a timestamp.
+     */
+    CompactEvent(CompactTrace* owner, UInt actCode, Timestamp timest)
+        : _owner(owner), _actCode(actCode), _timest(timest) {}
+public:
+    //-----<IEvent:: interface implementation>-----
+    virtual bool getAttr(const char* id, Attribute& a) override;
+    virtual int getAttrsNum() override;
+    virtual IAttributesEnumerator* getAttrs() override;
+    virtual IEventTrace* getTrace() override;
+public:
+    /** \brief Returns the activity code of the event. */
+    UInt getActCode() const { return _actCode; }
+
+    /** \brief Returns the timestamp of the event (0 if timestamps are not stored). */
+    Timestamp getTimestamp() const { return _timest; }
+protected:
+    CompactTrace* _owner;           ///< Owner trace.
+    UInt _actCode;                  ///< Activity code.
+    Timestamp _timest;              ///< Timestamp.
+}; // class CompactEvent
+
+
+//==============================================================================
+// class CompactTrace
+//==============================================================================
+
+/** \brief Implementation of a trace object for the compact event log.
+ *
+ *  Events are decoded on the first request to getEvent() and, as for other logs, 
+ *  by default only a bounded number of the least recently decoded traces is kept
+ *  (see CompactLog::setDecodedTracesLimit()): events of a trace that is not pinned
+ *  (see CompactLog::pinTrace()) can be freed when other traces are decoded. 
+ *  With the limit set to 0 returned event objects stay valid until the log is closed.
+ */
+class LDOPA_API CompactTrace : public IEventTrace {
+    friend class CompactLog;
+    friend class CompactEvent;
+public:
+    /** \brief Vector of decoded events. */
+    typedef std::vector<CompactEvent> VectorOfEvents;
+protected:
+    /** \brief Constructor initializes with an owner log and a number of
+     *  a corresponding trace.
+     */
+    CompactTrace(CompactLog* owner, UInt traceNum);
+protected:
+    CompactTrace(const CompactTrace&);                    // Prevent copy-construction
+    CompactTrace& operator=(const CompactTrace&);         // Prevent assignment
+public:
+    //-----<IEventTrace:: interface implementation>-----
+
+    virtual int getAttrsNum() override;
+    virtual bool getAttr(const char* id, Attribute& a) override;
+    virtual IAttributesEnumerator* getAttrs() override;
+
+    virtual IEvent* getEvent(UInt eventNum) override;
+    virtual int getSize() override;
+    virtual IEventLog* getLog() override;
+public:
+    /** \brief Returns the number of the trace. */
+    UInt getTraceNum() const { return _traceNum; }
+protected:
+    /** \brief Decodes the trace events. */
+    void decodeEvents();
+
+    /** \brief Frees decoded events. */
+    void freeEvents() { VectorOfEvents().swap(_events); }
+protected:
+    CompactLog* _owner;             ///< Owner log.
+    UInt _traceNum;                 ///< Number of the trace.
+    VectorOfEvents _events;         ///< Decoded events (empty if not decoded).
+    UInt _pins;                     ///< Number of pins keeping the events decoded.
+}; // class CompactTrace
+
+
+//==============================================================================
+// class CompactLog
+//==============================================================================
+
+/** \brief Compact in-memory event log.
+ *
+ *  Traces of a source log are loaded once and stored as concatenated LEB128 varint
+ *  sequences of activity codes in a single byte buffer, so that a typical event with
+ *  less than 128 activity classes costs a single byte. Activity names are stored once
+ *  in a dictionary, and an attribute object for each activity is shared by all its
+ *  events. Timestamps, if requested, are stored in a separate column as zigzag-varint
+ *  deltas from the previous event of the same trace.
+ *
+ *  Only the activity and (optionally) the timestamp attributes of events are kept.
+ *  Trace attributes are copied with their names stored once in a dictionary; log 
+ *  attributes are copied as is. Once loaded, the log does not depend on the source 
+ *  log anymore.
+ *
+ *  The procedural interface (getEventAttr(), getEventAttrs()) decodes a trace once
+ *  and keeps it until another trace is requested, so reading a trace event by event
+ *  takes linear time.
+ *
+ *  As trace objects and decoded events are cached, a log must not be read by several
+ *  threads at once. Instead, each thread can read its own view of a loaded log (see
+ *  CompactLog(const CompactLog&, ShareData)), which shares the encoded data read-only
+ *  and keeps only its own trace objects and decoded events.
+ */
+class LDOPA_API CompactLog : public IEventLog {
+    friend class CompactTrace;
+    friend class CompactEvent;
+public:
+    //----<Types>-----
+
+    /** \brief Byte of encoded data. */
+    typedef CompactLog_traits::Byte Byte;
+
+    /** \brief Buffer of encoded data. */
+    typedef CompactLog_traits::ByteVec ByteVec;
+
+    /** \brief Offsets in encoded data buffers. */
+    typedef CompactLog_traits::OffsetVec OffsetVec;
+
+    /** \brief Type of timestamps. */
+    typedef CompactLog_traits::Timestamp Timestamp;
+
+    /** \brief Vector of named attributes. */
+    typedef CompactLog_traits::NmAttributesVector NmAttributesVector;
+
+    /** \brief Vector of activity codes. */
+    typedef std::vector<UInt> CodesVector;
+
+    /** \brief Vector of timestamps. */
+    typedef std::vector<Timestamp> TimestampsVector;
+
+    /** \brief Vector of trace objects. */
+    typedef std::vector<CompactTrace*> VectorOfTraces;
+
+    /** \brief Trace attribute: a code of its name and a value. */
+    typedef std::pair<UInt, Attribute> CodedAttribute;
+
+    /** \brief Keeps a trace pinned (see pinTrace()) during its lifetime. */
+    class TracePin {
+    public:
+        TracePin(CompactLog& log, UInt traceNum) : _log(log), _traceNum(traceNum)
+        {
+            _log.pinTrace(_traceNum);
+        }
+        ~TracePin() { _log.unpinTrace(_traceNum); }
+    private:
+        TracePin(const TracePin&);                    // Prevent copy-construction
+        TracePin& operator=(const TracePin&);         // Prevent assignment
+    private:
+        CompactLog& _log;
+        UInt _traceNum;
+    }; // class TracePin
+
+public:
+    //----<Constants>-----
+
+    /** \brief Default limit of simultaneously decoded traces. */
+    static const UInt DEF_DECODED_TRACES_LIMIT = 1024;
+
+    /** \brief Marks no trace decoded by the procedural interface. */
+    static const UInt NO_TRACE = (UInt)-1;
+
+    /** \brief Tag of the constructor making a view of another log. */
+    struct ShareData { };
+
+public:
+    /** \brief Default constructor: creates an empty log. */
+    CompactLog();
+
+    /** \brief Constructor loads all traces of the log \a src (see load()). */
+    CompactLog(IEventLog* src, bool withTimestamps = false,
+        xi::strutils::InternStrPool* strPool = nullptr);
+
+    /** \brief Constructor makes a view of the log \a data: its encoded data are shared
+     *  without copying, while trace objects and decoded events are own.
+     *
+     *  \a data must stay alive and must not be loaded or cleared while the view is 
+     *  used; views themselves cannot be loaded or cleared.
+     */
+    CompactLog(const CompactLog& data, ShareData);
+
+    /** \brief Destructor. */
+    ~CompactLog();
+protected:
+    CompactLog(const CompactLog&);                    // Prevent copy-construction
+    CompactLog& operator=(const CompactLog&);         // Prevent assignment
+
+public:
+    //-----<Loading>-----
+
+    /** \brief Loads all traces of the log \a src into the compact representation.
+     *
+     *  The source log is opened if needed. If \a withTimestamps is set, the timestamp
+     *  attribute (see IEventLog::getEvTimestAttrId()) is stored as well.
+     *  If a string pool \a strPool is given, activity attributes are interned in it.
+     *  Previously loaded data are dropped.
+     */
+    void load(IEventLog* src, bool withTimestamps = false,
+        xi::strutils::InternStrPool* strPool = nullptr);
+
+    /** \brief Drops all loaded data. */
+    void clear();
+
+    /** \brief Returns true if the log is a view of another log. */
+    bool isView() const { return _data != this; }
+
+public:
+    //-----<IEventLog:: interface implementation>-----
+
+    virtual void open() override;
+    virtual void close() override;
+    virtual bool isOpen() override;
+
+    virtual int getEventsNum() override;
+    virtual int getTracesNum() override;
+    virtual int getActivitiesNum() override;
+    virtual int getLogAttrsNum() override;
+    virtual bool getLogAttr(const char* id, Attribute& a) override;
+    virtual IAttributesEnumerator* getLogAttrs() override;
+    virtual bool getEventAttr(int traceNum, int eventNum, const char* id, Attribute& a) override;
+    virtual bool getEventAttr(int eventId, const char* id, Attribute& a) override;
+    virtual IAttributesEnumerator* getEventAttrs(int traceNum, int eventNum) override;
+    virtual IAttributesEnumerator* getEventAttrs(int eventId) override;
+    virtual bool getTraceAttr(int traceNum, const char* id, Attribute& a) override;
+    virtual IAttributesEnumerator* getTraceAttrs(int traceNum) override;
+    virtual int getTraceSize(int traceNum) override;
+    virtual std::string getEvActAttrId() const override;
+    virtual std::string getEvTimestAttrId() const override;
+    virtual std::string getEvCaseAttrId() const override;
+    virtual std::string getInfoStr() const override;
+    virtual IEventTrace* getTrace(int traceNum) override;
+
+public:
+    //-----<Direct access to encoded data>-----
+
+    /** \brief Decodes activity codes of the trace \a traceNum into \a codes
+     *  (previous content is replaced).
+     */
+    void decodeTrace(UInt traceNum, CodesVector& codes) const;
+
+    /** \brief Decodes timestamps of the trace \a traceNum into \a timests
+     *  (previous content is replaced); empty if timestamps are not stored.
+     */
+    void decodeTimestamps(UInt traceNum, TimestampsVector& timests) const;
+
+    /** \brief Returns the activity attribute for the code \a code. */
+    const Attribute& getActivity(UInt code) const { return _data->_actAttrs[code]; }
+
+    /** \brief Returns the code of the activity \a act or -1 if there is no such an activity. */
+    int getActivityCode(const std::string& act) const;
+
+    /** \brief Returns true if timestamps are stored. */
+    bool hasTimestamps() const { return _data->_withTimests; }
+
+    /** \brief Returns the number of bytes occupied by encoded events (activity codes
+     *  and timestamps, without trace offsets).
+     */
+    size_t getEncodedSize() const { return _data->_actData.size() + _data->_tsData.size(); }
+
+    /** \brief Returns a limit of traces that are simultaneously kept decoded (0 if none). */
+    UInt getDecodedTracesLimit() const { return _decodedLimit; }
+
+    /** \brief Sets a limit of traces that are simultaneously kept decoded 
+     *  (DEF_DECODED_TRACES_LIMIT by default); 0 means no limit.
+     *
+     *  With a limit, events of the least recently decoded traces are freed, and their 
+     *  IEvent objects obtained earlier become invalid, unless the traces are pinned 
+     *  (see pinTrace()). A caller that keeps events of unpinned traces across
+     *  more than the limit of other traces must either pin them or set the limit to 0.
+     */
+    void setDecodedTracesLimit(UInt limit);
+
+    /** \brief Pins the trace \a traceNum: its events are not freed until it is unpinned
+     *  as many times as pinned (see also TracePin).
+     */
+    void pinTrace(UInt traceNum);
+
+    /** \brief Unpins the trace \a traceNum pinned by pinTrace(). */
+    void unpinTrace(UInt traceNum);
+
+    /** \brief Returns the name of a trace attribute by the code \a code. */
+    const std::string& getTraceAttrName(UInt code) const { return _data->_trAttrNames[code]; }
+
+public:
+    //-----<Encoding>-----
+
+    /** \brief Appends \a v to \a buf in the LEB128 varint encoding. */
+    static void encodeVarint(ByteVec& buf, std::uint64_t v)
+    {
+        while (v >= 0x80)
+        {
+            buf.push_back((Byte)(v | 0x80));
+            v >>= 7;
+        }
+        buf.push_back((Byte)v);
+    }
+
+    /** \brief Decodes a varint starting at \a p into \a v.
+     *
+     *  \returns a pointer to the byte following the decoded value.
+     *  Single-byte values, which are the majority for activity codes, take
+     *  the only predictable branch.
+     */
+    static const Byte* decodeVarint(const Byte* p, std::uint64_t& v)
+    {
+        std::uint64_t b = *p++;
+        v = b & 0x7F;
+        if (b < 0x80)
+            return p;
+
+        unsigned int shift = 7;
+        do {
+            b = *p++;
+            v |= (b & 0x7F) << shift;
+            shift += 7;
+        } while (b & 0x80);
+
+        return p;
+    }
+
+    /** \brief Maps a signed value to unsigned one keeping small absolute values small. */
+    static std::uint64_t zigzag(std::int64_t v)
+    {
+        return ((std::uint64_t)v << 1) ^ (std::uint64_t)(v >> 63);
+    }
+
+    /** \brief Inverse of zigzag(). */
+    static std::int64_t unzigzag(std::uint64_t v)
+    {
+        return (std::int64_t)(v >> 1) ^ -(std::int64_t)(v & 1);
+    }
+
+protected:
+    /** \brief Returns a code of the activity \a act adding it to the dictionary if needed. */
+    UInt getOrAddActivityCode(const std::string& act, xi::strutils::InternStrPool* strPool);
+
+    /** \brief Returns a code of the trace attribute name \a name adding it to the dictionary 
+     *  if needed. 
+     */
+    UInt getOrAddTraceAttrCode(const std::string& name);
+
+    /** \brief Extracts a trace attribute \a id of the trace \a traceNum. */
+    bool getTraceAttrInternal(UInt traceNum, const char* id, Attribute& a) const;
+
+    /** \brief Makes an enumerator over attributes of the trace \a traceNum. */
+    IAttributesEnumerator* makeTraceAttrsEnum(UInt traceNum) const;
+
+    /** \brief Decodes the trace \a traceNum for the procedural interface unless it is 
+     *  already decoded.
+     */
+    void seekTrace(UInt traceNum);
+
+    /** \brief Frees events of the least recently decoded unpinned traces exceeding the limit. */
+    void evictDecoded();
+
+    /** \brief Checks that the trace number is in range. */
+    bool checkTraceNum(int traceNum) const
+    {
+        return traceNum >= 0 && (size_t)traceNum + 1 < _data->_evOffs.size();
+    }
+
+    /** \brief Finds an event by its global ID (0-based position in the log). */
+    bool locateEvent(int eventId, UInt& traceNum, UInt& eventNum) const;
+
+    /** \brief Registers the trace \a tr as a decoded one and evicts the oldest
+     *  unpinned decoded traces if the limit is exceeded.
+     */
+    void registerDecoded(CompactTrace* tr);
+
+    /** \brief Extracts an event attribute \a id of an event with given code and timestamp. */
+    bool getEventAttrInternal(UInt actCode, Timestamp timest, const char* id, Attribute& a) const;
+
+    /** \brief Makes an enumerator over attributes of an event with given code and timestamp. */
+    IAttributesEnumerator* makeEventAttrsEnum(UInt actCode, Timestamp timest) const;
+
+    /** \brief Deletes all trace objects. */
+    void freeTraces();
+
+protected:
+    /** \brief Log owning the encoded data: this one or, for a view, another log.
+     *
+     *  The data members below up to _infoStr are filled by load() and read via _data.
+     */
+    const CompactLog* _data;
+
+    bool _loaded;                   ///< Determines whether data are loaded.
+    bool _withTimests;              ///< Determines whether timestamps are stored.
+
+    ByteVec _actData;               ///< Varint activity codes of all traces.
+    OffsetVec _actOffs;             ///< Offsets of traces in _actData (tracesNum + 1).
+    std::vector<UInt> _evOffs;      ///< Accumulated event numbers (tracesNum + 1).
+
+    ByteVec _tsData;                ///< Zigzag-varint timestamp deltas of all traces.
+    OffsetVec _tsOffs;              ///< Offsets of traces in _tsData (tracesNum + 1).
+
+    /** \brief Activity attributes indexed by codes. */
+    std::vector<Attribute> _actAttrs;
+
+    /** \brief Maps activity names to codes. */
+    std::unordered_map<std::string, UInt> _actCodes;
+
+    /** \brief Log attributes copied from the source log. */
+    NmAttributesVector _logAttrs;
+
+    /** \brief Names of trace attributes indexed by codes. */
+    std::vector<std::string> _trAttrNames;
+
+    /** \brief Maps names of trace attributes to codes. */
+    std::unordered_map<std::string, UInt> _trAttrCodes;
+
+    /** \brief Attributes of all traces. */
+    std::vector<CodedAttribute> _trAttrs;
+
+    /** \brief Offsets of traces in _trAttrs (tracesNum + 1). */
+    std::vector<UInt> _trAttrOffs;
+
+    std::string _actAttrID;         ///< ID of the activity attribute.
+    std::string _timestAttrID;      ///< ID of the timestamp attribute.
+    std::string _caseAttrID;        ///< ID of the case attribute.
+    std::string _infoStr;           ///< Info string of the source log.
+
+    /** \brief Lazily created trace objects. */
+    VectorOfTraces _traces;
+
+    /** \brief Traces having decoded events, from the oldest one. */
+    std::deque<CompactTrace*> _decoded;
+
+    /** \brief Limit of simultaneously decoded traces. */
+    UInt _decodedLimit;
+
+    UInt _curTrace;                 ///< Trace decoded for the procedural interface.
+    CodesVector _curCodes;          ///< Activity codes of _curTrace.
+    TimestampsVector _curTimests;   ///< Timestamps of _curTrace.
+}; // class CompactLog
+
+
+}}} // namespace xi { namespace ldopa { namespace eventlog {
+
+
+#endif // XI_LDOPA_EVENTLOG_COMPACT_COMPACTLOG_H_
@@ -25,6 +25,7 @@
 // xilib is a need
 #include "xi/collections/enumerators.hpp"
 #include "xi/attributes/boost_attr.h"
+#include "xi/attributes/compact_attr.h"
 
 #include "xi/strutils/set_str_pool.h"
 
@@ -43,8 +44,16 @@ public:
     /** \brief Unsigned int for numerating 0-based positions. */
     typedef unsigned int UInt;
 
-    /** \brief Log attribute type. */
+    /** \brief Log attribute type.
+     *
+     *  With XI_COMPACT_ATTRIBUTES (xi_COMPACT_ATTRIBUTES build option) it is the
+     *  trivially copyable CompactAttribute.
+     */
+#ifdef XI_COMPACT_ATTRIBUTES
+    typedef ::xi::attributes::CompactAttribute Attribute;
+#else
     typedef ::xi::attributes::VarAttribute1 Attribute;
+#endif
 
     /** \brief Tpe for Log attribute with name (id). */
     typedef std::pair<std::string, Attribute> NamedAttribute;
@@ -0,0 +1,300 @@
+////////////////////////////////////////////////////////////////////////////////
+/// \file
+/// \brief     LDOPA EventLog Library
+/// \author    Sergey Shershakov
+/// \version   0.1.0
+/// \date      18.10.2026
+/// \copyright (c) xidv.ru 2014–2017.
+///            This source is for internal use only — Restricted Distribution.
+///            All rights reserved.
+///
+/// Lazy decorators presenting a subset of traces (and events) of an existing
+/// log without copying events: only index arrays and an activity mask are stored.
+///
+////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef XI_LDOPA_EVENTLOG_FILTERED_LOG_H_
+#define XI_LDOPA_EVENTLOG_FILTERED_LOG_H_
+
+#pragma once
+
+// ldopa
+#include "xi/ldopa/eventlog/eventlog.h"
+
+// std
+#include <functional>
+#include <set>
+#include <string>
+#include <vector>
+
+
+namespace xi { namespace ldopa { namespace eventlog {;   //
+
+
+class LDOPA_API FilteredLog;
+
+
+//==============================================================================
+// class FilteredTrace
+//==============================================================================
+
+/** \brief A view over a source trace which exposes only events passing
+ *  the activity mask of the owner FilteredLog.
+ *
+ *  Events returned by getEvent() are the source log events, so their getTrace()
+ *  refers to the source trace, not to the view.
+ */
+class LDOPA_API FilteredTrace : public IEventTrace {
+    friend class FilteredLog;
+public:
+    /** \brief Array of 0-based indices of events in the source trace. */
+    typedef std::vector<UInt> IndexVec;
+protected:
+
+    /** \brief Constructor initializes with an owner log view, the source trace
+     *  and a number of the source trace in the source log.
+     */
+    FilteredTrace(FilteredLog* owner, IEventTrace* src, UInt srcTraceNum);
+protected:
+    FilteredTrace(const FilteredTrace&);                    // Prevent copy-construction
+    FilteredTrace& operator=(const FilteredTrace&);         // Prevent assignment
+public:
+    //-----<IEventTrace:: interface implementation>-----
+
+    virtual int getAttrsNum() override;
+    virtual bool getAttr(const char* id, Attribute& a) override;
+    virtual IAttributesEnumerator* getAttrs() override;
+
+    virtual IEvent* getEvent(UInt eventNum) override;
+    virtual int getSize() override;
+    virtual IEventLog* getLog() override;
+public:
+    /** \brief Returns the source trace. */
+    IEventTrace* getSrcTrace() { return _src; }
+
+    /** \brief Returns a number of the source trace in the source log. */
+    UInt getSrcTraceNum() const { return _srcTraceNum; }
+
+    /** \brief Maps a 0-based event number of the view to the one of the source trace. */
+    UInt mapEventNum(UInt eventNum) const
+    {
+        return _identity ? eventNum : _evInds[eventNum];
+    }
+protected:
+
+    /** \brief Applies the activity mask of the owner to the source trace and
+     *  builds an event index array.
+     */
+    void applyMask();
+protected:
+    FilteredLog* _owner;        ///< Owner log view.
+    IEventTrace* _src;          ///< Source trace.
+    UInt _srcTraceNum;          ///< Number of the source trace in the source log.
+
+    /** \brief true if all events of the source trace pass through, so that
+     *  no index array is needed.
+     */
+    bool _identity;
+
+    /** \brief Indices of the events passed through the activity mask. */
+    IndexVec _evInds;
+}; // class FilteredTrace
+
+
+//==============================================================================
+// class FilteredLog
+//==============================================================================
+
+/** \brief Lazy event log decorator presenting a filtered or sampled view
+ *  over an existing log.
+ *
+ *  The view keeps an array of selected source trace numbers and an activity mask
+ *  only; events are never copied. Filtering methods refine the view in place and
+ *  return a reference to it, so they can be chained:
+ *  `view.keepActivities({"a", "b"}).limitTraceLength(2, 10).sample(100)`.
+ *  As a view is an IEventLog itself, views can be stacked over each other as well.
+ *
+ *  Trace filters are applied in the order of calls to the traces remaining at the moment,
+ *  whereas the activity mask is global for the view: trace lengths are always reported
+ *  with the mask applied. Memory consumption is O(selected traces) plus event index
+ *  arrays for the traces accessed through a non-trivial mask.
+ *
+ *  The source log must outlive the view; the view does not own it.
+ *  Procedural methods addressing events by a unique event ID are redirected to
+ *  the source log as is.
+ */
+class LDOPA_API FilteredLog : public IEventLog {
+    friend class FilteredTrace;
+public:
+    //----<Types>-----
+
+    /** \brief Array of 0-based indices of traces in the source log. */
+    typedef std::vector<UInt> IndexVec;
+
+    /** \brief Set of activities. */
+    typedef std::set<std::string> ActivitiesSet;
+
+    /** \brief Predicate over (view) traces. */
+    typedef std::function<bool(IEventTrace*)> TracePredicate;
+
+    /** \brief Predicate over an attribute value. */
+    typedef std::function<bool(const Attribute&)> AttrPredicate;
+
+    /** \brief Vector of view trace objects. */
+    typedef std::vector<FilteredTrace*> VectorOfTraces;
+
+public:
+    /** \brief Constructor initializes a view passing all traces and events of the
+     *  source log \a src through.
+     */
+    FilteredLog(IEventLog* src);
+
+    /** \brief Destructor. */
+    ~FilteredLog();
+protected:
+    FilteredLog(const FilteredLog&);                    // Prevent copy-construction
+    FilteredLog& operator=(const FilteredLog&);         // Prevent assignment
+
+public:
+    //-----<Filters>-----
+
+    /** \brief Keeps in traces only events whose activities are in \a acts.
+     *
+     *  Repeated calls intersect the sets of kept activities.
+     */
+    FilteredLog& keepActivities(const ActivitiesSet& acts);
+
+    /** \brief Removes from traces all events whose activities are in \a acts. */
+    FilteredLog& removeActivities(const ActivitiesSet& acts);
+
+    /** \brief Keeps only traces whose size (after the activity mask) lies
+     *  in [\a minLen, \a maxLen]; a negative \a maxLen means no upper limit.
+     */
+    FilteredLog& limitTraceLength(int minLen, int maxLen = -1);
+
+    /** \brief Keeps only traces satisfying the predicate \a pred. */
+    FilteredLog& filterTraces(const TracePredicate& pred);
+
+    /** \brief Keeps only traces having a trace (case) attribute \a id
+     *  satisfying the predicate \a pred.
+     */
+    FilteredLog& filterByTraceAttr(const char* id, const AttrPredicate& pred);
+
+    /** \brief Keeps \a n randomly chosen traces (all if there are less) preserving
+     *  their relative order; \a seed makes the sample reproducible.
+     */
+    FilteredLog& sample(UInt n, unsigned int seed = 0);
+
+    /** \brief Keeps the given fraction \a frac ∈ [0, 1] of randomly chosen traces. */
+    FilteredLog& sampleFraction(double frac, unsigned int seed = 0);
+
+public:
+    //-----<IEventLog:: interface implementation>-----
+
+    virtual void open() override;
+    virtual void close() override;
+    virtual bool isOpen() override;
+
+    virtual int getEventsNum() override;
+    virtual int getTracesNum() override;
+    virtual int getActivitiesNum() override;
+    virtual int getLogAttrsNum() override;
+    virtual bool getLogAttr(const char* id, Attribute& a) override;
+    virtual IAttributesEnumerator* getLogAttrs() override;
+    virtual bool getEventAttr(int traceNum, int eventNum, const char* id, Attribute& a) override;
+    virtual bool getEventAttr(int eventId, const char* id, Attribute& a) override;
+    virtual IAttributesEnumerator* getEventAttrs(int traceNum, int eventNum) override;
+    virtual IAttributesEnumerator* getEventAttrs(int eventId) override;
+    virtual bool getTraceAttr(int traceNum, const char* id, Attribute& a) override;
+    virtual IAttributesEnumerator* getTraceAttrs(int traceNum) override;
+    virtual int getTraceSize(int traceNum) override;
+    virtual std::string getEvActAttrId() const override;
+    virtual std::string getEvTimestAttrId() const override;
+    virtual std::string getEvCaseAttrId() const override;
+    virtual std::string getInfoStr() const override;
+    virtual IEventTrace* getTrace(int traceNum) override;
+
+public:
+    //-----<Setters/Getters>-----
+
+    /** \brief Returns the source log. */
+    IEventLog* getSrcLog() { return _src; }
+
+    /** \brief Maps a 0-based trace number of the view to the one of the source log. */
+    UInt mapTraceNum(UInt traceNum) const
+    {
+        return _identity ? traceNum : _traceInds[traceNum];
+    }
+
+    /** \brief Returns true if the view has a non-trivial activity mask. */
+    bool hasActivityMask() const { return _hasKeepActs || !_removeActs.empty(); }
+
+    /** \brief Returns true if the activity \a act passes through the activity mask. */
+    bool isActivityPassed(const std::string& act) const;
+
+    /** \brief Returns the ID of the activity attribute; set from the source
+     *  log by default.
+     */
+    const std::string& getActAttrID() const { return _actAttrID; }
+
+    /** \brief Sets the ID of the activity attribute used for the activity mask. */
+    void setActAttrID(const std::string& id) { _actAttrID = id; }
+
+protected:
+
+    /** \brief Turns an identity view into an explicit trace index array. */
+    void materializeTraceInds();
+
+    /** \brief Keeps only traces whose view numbers satisfy \a keep and compacts
+     *  the trace index array along with already created trace objects.
+     */
+    void retainTraces(const std::function<bool(UInt)>& keep);
+
+    /** \brief Drops the activity dependent caches after the mask is changed. */
+    void invalidateMask();
+
+    /** \brief Deletes all created trace objects. */
+    void freeTraces();
+
+    /** \brief Checks that the trace number is in the view range. */
+    bool checkTraceNum(int traceNum);
+
+    /** \brief Returns an ID of the activity attribute or throws an exception. */
+    const std::string& obtainActAttrID();
+
+protected:
+    IEventLog* _src;                ///< Source log.
+
+    /** \brief true while all the source traces are selected, so that no
+     *  index array is kept.
+     */
+    bool _identity;
+
+    /** \brief Numbers of selected source traces. */
+    IndexVec _traceInds;
+
+    /** \brief Lazily created trace objects, indexed by view trace numbers. */
+    VectorOfTraces _traces;
+
+    /** \brief Activities to keep (valid if _hasKeepActs is set). */
+    ActivitiesSet _keepActs;
+
+    /** \brief Determines whether the keep-set of activities has been set. */
+    bool _hasKeepActs;
+
+    /** \brief Activities to remove. */
+    ActivitiesSet _removeActs;
+
+    /** \brief ID of the activity attribute. */
+    std::string _actAttrID;
+
+    int _eventsNum;                 ///< Cached number of events; -1 if unknown.
+    int _activitiesNum;             ///< Cached number of activities; -1 if unknown.
+}; // class FilteredLog
+
+
+}}} // namespace xi { namespace ldopa { namespace eventlog {
+
+
+#endif // XI_LDOPA_EVENTLOG_FILTERED_LOG_H_
@@ -30,6 +30,7 @@
 // ldopa.log
 #include "xi/ldopa/eventlog/eventlog.h"
 #include "xi/ldopa/eventlog/sqlite/sqlitehelpers.h"
+#include "xi/ldopa/utils/mem_usage.h"
 
 
 namespace xi { namespace ldopa { namespace eventlog {;   //
@@ -89,6 +90,7 @@ public:
  */
 class LDOPA_API SQLiteTrace : public IEventTrace {
     friend class SQLiteLog;
+    friend class SQLiteEvent;
 public:
     /** \brief Vector of traces. */
     typedef std::vector<IEvent*> VectorOfEvents;
@@ -132,6 +134,9 @@ public:
     virtual IEvent* getEvent(UInt eventNum) override;
     virtual int getSize() override;
     virtual IEventLog* getLog() override;
+public:
+    /** \brief Returns memory taken by the trace, its extracted events and attributes. */
+    MemUsage memoryUsage() const;
 protected:
     
     /** \brief Extracts the trace size from a log. */
@@ -236,6 +241,9 @@ public:
     //virtual AttributesMap getAttrsAsMap() override;
     virtual IAttributesEnumerator* getAttrs() override;
     virtual IEventTrace* getTrace() override;
+public:
+    /** \brief Returns memory taken by the event and its attributes. */
+    MemUsage memoryUsage() const;
 protected:
 
     /** \brief Extracts attributes from a prepared (and preliminarily fetched) statement. */
@@ -386,9 +394,10 @@ public:
      *  \returns true, if a valid attribute has been extracted; false otherwise.
      *  \a idNum, \a valNum, \a typeNum determine corresplondly
      *  position of the attribute id (name), attribute value and attribute type.
+     *  If a string pool \a strPool is given, string values are interned in it.
      */
     static bool extractAttributeVert(SQLiteStmt* stmt, std::string& aId, Attribute& a,
-        int idNum, int valNum, int typeNum);
+        int idNum, int valNum, int typeNum, xi::strutils::InternStrPool* strPool = nullptr);
 
     /** \brief Extract an attribute from the given statement "vertically" and checks
      *  whether its id is the as requested.
@@ -398,7 +407,8 @@ public:
      *  Method itself fetches the dataset from the given query.
      */
     static bool fetchAttributeVert(SQLiteStmt* stmt, const char* reqId,
-        Attribute& a, int idNum, int valNum, int typeNum);
+        Attribute& a, int idNum, int valNum, int typeNum, 
+        xi::strutils::InternStrPool* strPool = nullptr);
 
 
     /** \brief Extracts an attribute number \a iCol "horizontally" with from the 
@@ -413,9 +423,10 @@ public:
      *  \param[out] a — ...
      *  \param[out] aId — ...
      *  \returns true, if a valid attribute has been extracted; false otherwise.
+     *  If a string pool \a strPool is given, string values are interned in it.
      */
     static bool extractAttributeHor(SQLiteStmt* stmt, int iCol, Attribute& a, 
-        std::string* aId = nullptr);
+        std::string* aId = nullptr, xi::strutils::InternStrPool* strPool = nullptr);
 
     /** \brief Fetches the given statment \a stmt and looks among the result dataset
      *  for an event attribute with id \param aId.
@@ -538,6 +549,28 @@ public:
     /** \brief Returns a const ref to the vector with extracted trace IDs for trace-id-lookup mode. */
     const AttributesVector& getTraceIDs() const { return _traceIDs; }
 
+    /** \brief Returns a pool string attributes of events and traces are interned in;
+     *  nullptr if interning is off.
+     */
+    xi::strutils::InternStrPool* getStrPool() const { return _strPool; }
+
+    /** \brief Sets a pool for interning string attributes of events and traces
+     *  (e.g. InternStrPool::global()); nullptr turns interning off.
+     *
+     *  Interned attributes are compared by pointers and have precomputed hashes.
+     *  The pool is sharded, so it can be shared by logs loaded concurrently.
+     *  The pool must outlive all attributes extracted from the log.
+     */
+    void setStrPool(xi::strutils::InternStrPool* pool) { _strPool = pool; }
+
+    /** \brief Returns memory taken by the data extracted from the log: traces,
+     *  events and attributes.
+     *
+     *  The string pool is reported as "strPool" and can be shared by several logs.
+     *  Memory of SQLite itself (connection, statements) is not counted.
+     */
+    MemUsage memoryUsage() const;
+
 
 public:
     //-----<Specefifc for working with SQLite log>-----
@@ -618,12 +651,23 @@ public:
     /** \brief Returns a config param if exists, or empty mutable string. */
     std::string getConfigParamOrEmpty(const char* param) const;
 
-    /** \brief Returns a config param or default empty string if no param exists. */
+    /** \brief Returns a config param or default empty string if no param exists. 
+     *
+     *  A missing param is added as an empty one, so the result can be assigned.
+     */
     std::string& getConfigParamOrDef(const std::string& param)
     {
         return _workQueries[param];
     }
 
+    /** \brief Const overload of getConfigParamOrDef(): a missing param is not added. */
+    const std::string& getConfigParamOrDef(const std::string& param) const
+    {
+        static const std::string EMPTY;
+        SqlQueriesMap::const_iterator it = _workQueries.find(param);
+        return (it == _workQueries.end()) ? EMPTY : it->second;
+    }
+
     /** \brief Sets a parameter \a param to the value \a val. */
     void setConfigParam(const std::string& param, const std::string& val)
     {
@@ -835,6 +879,9 @@ protected:
     /** \brief Stores a collection of trace IDs indexed by 0-index. Used in trace-ids-lookup mode. */
     AttributesVector _traceIDs;
 
+    /** \brief Pool for interning string attributes; nullptr if interning is off. */
+    xi::strutils::InternStrPool* _strPool;
+
     /** \brief A collection of work quieries that are used to obtain individual 
      *  event log characteristic.
      *
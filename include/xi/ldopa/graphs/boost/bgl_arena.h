@@ -0,0 +1,57 @@
+////////////////////////////////////////////////////////////////////////////////
+/// \file
+/// \brief     BGL container selector allocating from a monotonic arena.
+/// \author    Sergey Shershakov
+/// \version   0.1.0
+/// \date      18.10.2026
+/// \copyright (c) xidv.ru 2014–2018.
+///            This source is for internal use only — Restricted Distribution.
+///            All rights reserved.
+///
+/// ArenaListS can be used by boost::adjacency_list in place of boost::listS;
+/// lists of vertices and edges then allocate their nodes by ArenaAllocator. BGL
+/// creates the lists by default, i.e. on the heap; an owner of the graph binds them
+/// to its arena (see LabeledTS with ArenaTsStorage).
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef XI_LDOPA_GRAPHS_BOOST_BGL_ARENA_H_
+#define XI_LDOPA_GRAPHS_BOOST_BGL_ARENA_H_
+
+#pragma once
+
+// ldopa
+#include "xi/ldopa/utils/arena.h"
+
+// boost
+#include <boost/graph/adjacency_list.hpp>
+
+// std
+#include <list>
+
+namespace xi { namespace ldopa { namespace gr {;   //
+
+/** \brief Selector of std::list with ArenaAllocator for boost::adjacency_list. */
+struct ArenaListS { };
+
+}}} // namespace xi { namespace ldopa { namespace gr {
+
+
+namespace boost {
+
+template<typename ValueType>
+struct container_gen<xi::ldopa::gr::ArenaListS, ValueType>
+{
+    typedef std::list<ValueType, xi::ldopa::ArenaAllocator<ValueType> > type;
+};
+
+template<>
+struct parallel_edge_traits<xi::ldopa::gr::ArenaListS>
+{
+    typedef allow_parallel_edge_tag type;
+};
+
+} // namespace boost
+
+
+#endif // XI_LDOPA_GRAPHS_BOOST_BGL_ARENA_H_
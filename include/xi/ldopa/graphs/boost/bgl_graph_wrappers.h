@@ -25,6 +25,13 @@
 
 #include <boost/iterator/filter_iterator.hpp>
 
+#include "xi/ldopa/utils/mem_usage.h"
+
+// std
+#include <algorithm>
+#include <unordered_set>
+#include <vector>
+
 
 namespace xi { namespace ldopa { namespace gr {;   //
 
@@ -148,6 +155,17 @@ protected:
         clone(other, *this);            // здесь выполняется актуальное клонирование
     }
 
+    /** \brief Tag of the constructor that does not create a graph. */
+    struct NoCreate { };
+
+    /** \brief Constructor leaves the graph not created, so a derived class creates
+     *  (or copies) it itself, e.g. in its own memory.
+     */
+    explicit BoostGraphP(NoCreate)
+        : _graph(nullptr)
+    {
+    }
+
 public:
 
     /** \brief Returns a ref to the underlying graph. */
@@ -156,6 +174,11 @@ public:
     /** \brief Const overloaded version of LabeledTS::getGraph(). */
     const Graph& getGraph() const { return *_graph; }
 
+    /** \brief Returns memory taken by vertices, edges and adjacency lists of the
+     *  underlying (bidirectional) graph.
+     */
+    MemUsage getGraphMemUsage() const { return mem::graphMemUsage(getGraph()); }
+
 public:
     //-----<BGL Shortcuts>----
 
@@ -356,6 +379,9 @@ public:
     /** \brief A pair of edge iterators, which represents a collection of input edges. */
     typedef std::pair<IedgeIter, IedgeIter> IedgeIterPair;
 
+    /** \brief Iterator of the graph list storing edges with their properties. */
+    typedef typename Graph::EdgeContainer::iterator StoredEdgeIter;
+
 public:
 
     /** \brief Virtual destructor. */
@@ -363,6 +389,16 @@ public:
     {
         BoostGraphP<Graph>::deleteGraph();
     }
+protected:
+    /** \brief Tag of the constructor that does not create a graph. */
+    typedef typename BoostGraphP<Graph>::NoCreate NoCreate;
+
+    /** \brief Default constructor creates an empty graph. */
+    BoostBidiGraphP() { }
+
+    /** \brief Constructor leaves the graph not created (see BoostGraphP). */
+    explicit BoostBidiGraphP(NoCreate nc) : BoostGraphP<Graph>(nc) { }
+public:
 
 public:
     //-----<BGL Shortcuts>----
@@ -387,6 +423,70 @@ public:
         boost::clear_in_edges(v, BoostGraphP<Graph>::getGraph()); 
     }
 
+    /** \brief Removes all edges of a range \a es at once.
+     *
+     *  Edges are marked first, then adjacency lists of their end vertices are swept
+     *  by a single pass each, so the cost is linear in the number of edges and
+     *  the degrees of the touched vertices rather than their product as for removeEdge()
+     *  called for each edge. Duplicates in \a es are allowed. 
+     *  \returns the number of removed edges.
+     */
+    template<typename EdgeRange>
+    size_t removeEdges(const EdgeRange& es)
+    {
+        Graph& g = BoostGraphP<Graph>::getGraph();
+
+        // дуга опознается по адресу свойства: он общий для списков выходных и входных дуг
+        std::unordered_set<const void*> marked;
+        std::unordered_set<Vertex> srcs, targs;
+        for (const Edge& e : es)
+        {
+            if (marked.insert(e.get_property()).second)
+            {
+                srcs.insert(boost::source(e, g));
+                targs.insert(boost::target(e, g));
+            }
+        }
+        if (marked.empty())
+            return 0;
+
+        // сперва входные списки: свойства в общем списке дуг еще живы
+        for (Vertex v : targs)
+            eraseStoredEdges(boost::in_edge_list(g, v), marked, nullptr);
+
+        // затем выходные, запоминая, что удалить из общего списка дуг
+        std::vector<StoredEdgeIter> garbage;
+        garbage.reserve(marked.size());
+        for (Vertex v : srcs)
+            eraseStoredEdges(g.out_edge_list(v), marked, &garbage);
+
+        for (const StoredEdgeIter& it : garbage)
+            g.m_edges.erase(it);
+
+        return garbage.size();
+    }
+
+protected:
+    /** \brief Erases stored edges marked by addresses of their properties from
+     *  an adjacency list \a lst; if \a garbage is not null, puts there iterators 
+     *  of erased edges in the graph edge list.
+     */
+    template<typename EdgeList>
+    static void eraseStoredEdges(EdgeList& lst, const std::unordered_set<const void*>& marked,
+        std::vector<StoredEdgeIter>* garbage)
+    {
+        typename EdgeList::iterator it = std::remove_if(lst.begin(), lst.end(),
+            [&](const typename EdgeList::value_type& se) 
+            {
+                if (!marked.count(&se.get_property()))
+                    return false;
+                if (garbage)
+                    garbage->push_back(se.get_iter());
+                return true;
+            });
+        lst.erase(it, lst.end());
+    }
+
 }; // class BoostBidiGraphP
 
 
@@ -24,6 +24,7 @@
 // ldopa
 #include "xi/ldopa/ts/models/evlog_ts_red.h"
 #include "xi/ldopa/utils/elapsed_time.h"
+#include "xi/ldopa/utils/mem_usage.h"
 
 // std
 //#include <unordered_set>
@@ -529,6 +530,16 @@ public:
             mapRegions();                   // отображаем регионы
         }
 
+        /** \brief Returns a number of heap bytes taken by the mappings. */
+        size_t getBytes() const
+        {
+            size_t bytes = mem::contBytes(_events2trans) + mem::contBytes(_processedRegions);
+            for (const typename Region2PnPosMap::value_type& rp : _processedRegions)
+                bytes += mem::contBytes(rp.first);
+
+            return bytes;
+        }
+
 
         /** \brief Reestablishes self-loops on the top of the synthesized PN.
          *
@@ -1424,6 +1435,36 @@ public:
     /// Provides direct access to the synthesizer options.
     Options& options() { return _options;  }
 
+    /** \brief Returns memory taken by the synthesized PN and the synthesis
+     *  structures (regions, label mappings); the TS is not counted.
+     */
+    MemUsage memoryUsage() const
+    {
+        MemUsage mu;
+        if (_pn)
+            mu.add("pn", _pn->memoryUsage());
+
+        size_t lbl2Trans = mem::contBytes(_lbl2Trans);
+        for (const typename Lbl2TransSetMap::value_type& lt : _lbl2Trans)
+            lbl2Trans += mem::contBytes(lt.second);
+        mu.add("lbl2Trans", lbl2Trans);
+
+        size_t regs = mem::contBytes(_minPreRegions);
+        for (const typename Lbl2SetOfStateSetsMap::value_type& lr : _minPreRegions)
+        {
+            regs += mem::contBytes(lr.second);
+            for (const StateSet& r : lr.second)
+                regs += mem::contBytes(r);
+        }
+        mu.add("minPreRegions", regs);
+
+        mu.add("splitLabels", mem::contBytes(_transsSplitLabels) + mem::contBytes(_lblCurrentSplitInd));
+        mu.add("initMarking", mem::contBytes(_initMarking.getMap()));
+        mu.add("mapper", _mapper.getBytes());
+
+        return mu;
+    }
+
 
 #pragma endregion  Setters/getters
 
@@ -1046,6 +1046,15 @@ public:
 
     /** \brief Const overloaded version of GenPetriNet::getGraph(). */
     const Graph& getGraph() const { return BaseGraph::getGraph(); }
+
+    /** \brief Returns memory taken by the net: the object and its graph. */
+    MemUsage memoryUsage() const
+    {
+        MemUsage mu;
+        mu.add("object", sizeof(GenPetriNet));
+        mu.add("graph", BaseGraph::getGraphMemUsage());
+        return mu;
+    }
 public:
     //----<PN Interface through Graph interface>----
 
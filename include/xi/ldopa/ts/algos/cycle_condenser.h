@@ -31,6 +31,8 @@
 // std
 #include <set>
 #include <queue>
+#include <map>
+#include <unordered_map>
 
 namespace xi { namespace ldopa { namespace ts {   //
 
@@ -300,6 +302,9 @@ public:
     typedef std::set<TS::Transition> SetOfTrans;
     typedef SetOfTrans::iterator SetOfTransIter;                ///< Iterator for a set.
 
+    /** \brief Maps states of the source TS to their copies in the condensed TS. */
+    typedef std::unordered_map<TS::State, TS::State> StateMap;
+
 public:
 
     /** \brief Constructor initializes with all necessary data.
@@ -357,12 +362,20 @@ public:
 
 protected:
     /** \brief Copies all states and transition from _srcTs to _ts 
-     * using state function _sf.
+     * using state function _sf; every source state is visited once.
     */
     void copyTS();
 
+    /** \brief Copies frequencies of transitions and accepting flags of states
+     * from _srcTs to _ts: frequencies of merged transitions are summed up, a merged
+     * state is accepting if any of its source states is.
+    */
+    void copyFreqs();
+
     /** \brief Copies state \a stOrig from _srcTs to _ts 
      * using state function _sf. \returns copied state.
+     *
+     * The state function is applied only once for a state: the copy is stored in _stateMap.
     */
     TS::State copyState(TS::State stOrig);
 
@@ -383,6 +396,9 @@ protected:
     /** \brief Stores a boundedness for cycles. */
     unsigned int _k;
 
+    /** \brief Copies of source states made during the current building. */
+    StateMap _stateMap;
+
 }; // class CycleCondensedTsBuilder
 
 
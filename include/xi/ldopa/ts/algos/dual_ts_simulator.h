@@ -23,6 +23,10 @@
 
 // ldopa
 #include "xi/ldopa/ts/models/evlog_ts_red.h"
+#include "xi/ldopa/ts/models/frozen_ts.h"
+
+// std
+#include <vector>
 
 
 namespace xi { namespace ldopa { namespace ts {;   //
@@ -33,11 +37,22 @@ namespace xi { namespace ldopa { namespace ts {;   //
 //==============================================================================
 
 
-/** \brief Implements an algorithm for building a condensed TS.
+/** \brief Implements an algorithm for calculating precision of a TS by simulating it
+*  on another one (normally, a prefix tree).
+*
+*  Pairs of states of TS1 and TS2 are traversed with an explicit stack, so long traces
+*  do not overflow the call stack; partial precisions are accumulated in a vector indexed
+*  by dense indices of states of TS1.
 *
-*  TS that is created during builder work is stored by the builder until next
-*  building or the TS is detached by using an appropriate method (detach).
-*  Normally, the builder manages the lifetime of a builded TS.
+*  With several threads (see setThreadsNum()), the pairs tree is split into subtrees 
+*  (always the same ones, regardless of the number of threads) that are simulated in 
+*  parallel; their partial sums are reduced in a fixed order, so the result does not 
+*  depend on scheduling. With pairs memoization (see setPairsMemo()) every pair of states
+*  is expanded only once and its partial precision is taken with the multiplicity of 
+*  the pair; it is useful when TS2 is not a tree. Memoization is made by one thread.
+*
+*  Simulated TSs are accessed only through their const interfaces, so several
+*  simulators (one per thread) can share the same TSs without locks.
 */
 class LDOPA_API DualTsSimulator {
 public:
@@ -49,11 +64,15 @@ public:
     typedef TS::TransRes TransRes;
     typedef TS::Attribute Attribute;
     
-    /** \brief Defines a dbl-int pair. */
-    typedef std::pair<double, int> DblInt;
+    /** \brief Defines a pair of a sum of partial precisions and the number of its terms.
+     *
+     *  The number is kept as double: with pairs memoization it counts paths to pairs, 
+     *  which can be exponentially many.
+     */
+    typedef std::pair<double, double> DblInt;
 
-    /** \brief Defines a datatype that maps states to <dbl, int> pair. */
-    typedef std::map<TS::State, DblInt> StateDblIntMap;
+    /** \brief Defines a vector of partial state precisions indexed by states. */
+    typedef std::vector<DblInt> VecOfDblInts;
 public:
     /** \brief Default constructor. */
     DualTsSimulator();
@@ -64,48 +83,60 @@ protected:
 public:
 
     /** \brief Calculates precision of ts2 by simulating ts1 on ts2. */
-    double calcPrecision(TS* ts1, TS* ts2);
+    double calcPrecision(const TS* ts1, const TS* ts2);
 
-protected:
-
-    /** \brief Calculates partial states precision. 
-     * 
-     *  \param s1 is a state of TS1 to calc precision of.
-     *  \param s2 is a corresponding (to \a s1) state of TS2 to calc precision of.
+    /** \brief Calculates precision of frozen \a ts2 by simulating frozen \a ts1 on it.
+     *
+     *  Gives the same result as the method for regular TSs; labels are matched by
+     *  codes.
      */
-    void calcStatePrecision(TS::State s1, TS::State s2);
+    double calcPrecision(const FrozenEvLogTS& ts1, const FrozenEvLogTS& ts2);
 
-    /** \brief Returns corresponding for \a tr transition that is output from the state \a s2. */
-    inline TS::TransRes getMatchingTransOfTs2(TS::Transition tr, TS::State s2)
-    {
-        const Attribute& a = _ts1->getTransLbl(tr);
-        return _ts2->getFirstOutTrans(s2, a);
-    }
+public:
+    //----<Setters/Getters>----
 
-    /** \brief For a given state \a s1 and its semipart precision \a semiPartStatePrec,
-     *  increments the value of part "precision".
+    /** \brief Sets the number of threads \a num: 1 (by default) means sequential 
+     *  simulation, 0 means the number of hardware threads.
      */
-    void incStatePrecision(State s1, double semiPartStatePrec);
+    void setThreadsNum(unsigned int num) { _threadsNum = num; }
+
+    /** \brief Returns the number of threads. */
+    unsigned int getThreadsNum() const { return _threadsNum; }
 
-    /** \brief For a given state \a s, returns its partial precision/num of calculations.
-     *  If no partial precision for the state has been previously set, returns (0, 0) by
-     *  reference (with adding a corresponding pair to a map), so it can be directly assigned.
+    /** \brief Turns on/off expanding every pair of states only once. */
+    void setPairsMemo(bool on) { _pairsMemo = on; }
+
+    /** \brief Returns true if every pair of states is expanded only once. */
+    bool isPairsMemo() const { return _pairsMemo; }
+
+    /** \brief Returns partial precisions of states of TS1 (by their dense indices, 
+     *  in the order of TS1 states) calculated by the last simulation.
      */
-    DblInt& getStatePrecision(State s);
+    const VecOfDblInts& getPartStatePrecs() const { return _partStatePrecs; }
 
-    /** \brief Calculates and returns a sum of partial precision of the _ts1 after simulating. */
-    double sumPartialPrecisions();
+protected:
+    /** \brief Runs simulation through an accessor \a acc of a pair of TSs. */
+    template <typename TAccess>
+    double simulate(const TAccess& acc);
 
+    /** \brief Calculates and returns a sum of partial precision of the _ts1 after simulating. */
+    double sumPartialPrecisions() const;
 
 protected:
     /** \brief TS1 simulates TS2. */
-    TS* _ts1;
+    const TS* _ts1;
 
     /** \brief TS2 is simulated by TS1. */
-    TS* _ts2;
+    const TS* _ts2;
+
+    /** \brief Partial state precisions of TS1 states by their dense indices. */
+    VecOfDblInts _partStatePrecs;
+
+    /** \brief Number of threads. */
+    unsigned int _threadsNum;
 
-    /** \brief Represents a map of states to associated partial state precisions. */
-    StateDblIntMap _partStatePrecs;
+    /** \brief Expanding every pair of states only once. */
+    bool _pairsMemo;
 
 }; // class DualTsSimulator
 
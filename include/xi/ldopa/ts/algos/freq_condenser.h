@@ -23,11 +23,14 @@
 
 // ldopa
 #include "xi/ldopa/ts/models/evlog_ts_red.h"
+#include "xi/ldopa/ts/models/overlay_ts.h"
 #include "xi/ldopa/utils/elapsed_time.h"
 
 
 // std
 #include <set>
+#include <unordered_map>
+#include <vector>
 
 namespace xi { namespace ldopa { namespace ts {;   //
 
@@ -42,6 +45,16 @@ namespace xi { namespace ldopa { namespace ts {;   //
 *  TS that is created during builder work is stored by the builder until next
 *  building or the TS is detached by using an appropriate method (detach).
 *  Normally, the builder manages the lifetime of a builded TS.
+*
+*  Thin transitions and widow states are removed in an overlay over the source TS
+*  (see EvLogTSOverlay), so buildOverlay() costs no copy of the source TS, whereas
+*  build() additionally materializes the overlay copying only elements that are left.
+*
+*  For trying many thresholds there is a sweep mode (sweepOverlay(), sweep(), sweepCounts()):
+*  transitions are sorted by frequency once, and each next (not smaller) threshold only
+*  removes transitions that newly fall below the minimum preserved frequency and states
+*  that become widow because of them. The result for a threshold is the same as the one
+*  of buildOverlay().
 */
 class LDOPA_API CondensedTsBuilder 
         : public ElapsedTimeStore       // вспомогательный класс для учета времени алгоритма
@@ -55,6 +68,26 @@ public:
     typedef std::set<TS::Transition> SetOfTrans;
     typedef SetOfTrans::iterator SetOfTransIter;                ///< Iterator for a set.
 
+    /** \brief Transition along with its frequency. */
+    typedef std::pair<int, TS::Transition> FreqTrans;
+
+    /** \brief Vector of transitions with frequencies. */
+    typedef std::vector<FreqTrans> VecOfFreqTrans;
+
+    /** \brief Map of states to their positions in the source TS. */
+    typedef std::unordered_map<TS::State, size_t> StateOrderMap;
+
+    /** \brief Sizes of a condensed TS obtained for one threshold of a sweep. */
+    struct SweepPoint {
+        double threshold;               ///< Threshold.
+        int minPresFreq;                ///< Minimum preserved frequency for the threshold.
+        size_t statesNum;               ///< Number of states left.
+        size_t transNum;                ///< Number of transitions left.
+    };
+
+    /** \brief Vector of sweep points. */
+    typedef std::vector<SweepPoint> VecOfSweepPoints;
+
 public:
 
     /** \brief Constructor initializes with all necessary data.
@@ -81,6 +114,41 @@ public:
      */
     TS* build(double threshold);
 
+    /** \brief Condenses the source TS in the overlay without making a new TS.
+     *
+     *  \returns the overlay, which is owned by the builder and is valid until next 
+     *  building. Useful for trying many thresholds: the overlay can be analyzed
+     *  (e.g. frozen) or materialized.
+     */
+    const EvLogTSOverlay* buildOverlay(double threshold);
+
+    /** \brief Starts a new sweep over thresholds: sorts transitions of the source TS
+     *  by their frequencies and drops changes of the overlay.
+     *
+     *  Is called implicitly by the first sweepOverlay() after build()/buildOverlay().
+     */
+    void startSweep();
+
+    /** \brief Makes the next step of a sweep: condenses the overlay for a \a threshold,
+     *  which must not be less than the one of the previous step.
+     *
+     *  Only transitions with frequencies between the previous and the new minimum preserved
+     *  frequency are visited. \returns the overlay as buildOverlay() does, so it can be
+     *  analyzed (e.g. frozen for calculating metrics) before the next step.
+     */
+    const EvLogTSOverlay* sweepOverlay(double threshold);
+
+    /** \brief Makes the next step of a sweep like sweepOverlay() and materializes the overlay.
+     *
+     *  The TS is managed by the builder as the one made by build().
+     */
+    TS* sweep(double threshold);
+
+    /** \brief Makes a whole sweep over ascending \a thresholds and returns sizes of 
+     *  condensed TSs for all of them. No TS is materialized.
+     */
+    VecOfSweepPoints sweepCounts(const std::vector<double>& thresholds);
+
     /** \brief Detaches and returns the TS built at the previous call of build() method. */
     TS* detach();
 
@@ -90,6 +158,9 @@ public:
 public:
     //----<Setters/Getters>----
 
+    /** \brief Returns the overlay made at the previous building. */
+    const EvLogTSOverlay* getOverlay() const { return &_ovl; }
+
     /** \brief Returns a ptr to the the TS built at the previous call of build() method. */
     TS* getTS() { return _ts; }
 
@@ -113,18 +184,36 @@ protected:
     /** \brief Marks all the edges with frequecies less than minFreq. */
     void markGauntTransitions();
 
-    /** \brief Removes all transitions that marked as "to be removed" as those 
-     *  having their frequencies less than a theshold. 
+    /** \brief Removes (in the overlay) all transitions that marked as "to be removed" 
+     *  as those having their frequencies less than a theshold. 
      */
     void removeMarkedTransitions();
 
-    /** \brief Removes all "widow" states from the condensed TS.
+    /** \brief Removes (in the overlay) all "widow" states from the condensed TS.
      *
      *  A state is considere as a "widow" one if 1) it does not have any input transition,
      *  and 2) it is not the Initial state.
      */
     void removeWidowStates();
 
+    /** \brief Checks a \a threshold and calculates the minimum preserved frequency for it. */
+    void setThreshold(double threshold);
+
+    /** \brief Returns true if a transition \a t has its frequency less than the minimum
+     *  preserved one.
+     */
+    bool isTransGaunt(const TS::Transition& t) const;
+
+    /** \brief Returns true if a state \a s would be removed as a widow one by 
+     *  removeWidowStates(), given that states preceding \a s have been already checked.
+     */
+    bool isStateWidow(TS::State s) const;
+
+    /** \brief Removes (in the overlay) widow states among \a cands and states that
+     *  become widow after removing them.
+     */
+    void removeWidowStates(std::vector<TS::State>& cands);
+
 protected:
 
     /** \brief Src TS to be condensed. */
@@ -133,6 +222,9 @@ protected:
     /** \brief Resulting condensed TS. */
     TS* _ts;
 
+    /** \brief Overlay over the source TS with removed elements. */
+    EvLogTSOverlay _ovl;
+
     /** \brief Stores a threshold for cutting branches. */
     double _threshold;
 
@@ -141,6 +233,18 @@ protected:
 
     /** \brief Stores transitions with smaller frequencies, to be excluded. */
     SetOfTrans _trans2excl;
+
+    /** \brief Transitions with frequencies sorted by frequencies for a sweep. */
+    VecOfFreqTrans _sweepTrans;
+
+    /** \brief Position of the first transition in _sweepTrans that is not removed yet. */
+    size_t _sweepPos;
+
+    /** \brief Positions of states in the source TS, in which widow states are checked. */
+    StateOrderMap _stOrder;
+
+    /** \brief True if a sweep has been started and not broken by build()/buildOverlay(). */
+    bool _sweeping;
 }; // class CondensedTsBuilder
 
 
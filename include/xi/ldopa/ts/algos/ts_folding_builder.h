@@ -138,6 +138,10 @@ protected:
  *  TS that is created during builder work is stored by the builder until next
  *  building or the TS is detached by using an appropriate method (detach).
  *  Normally, the builder manages the lifetime of a builded TS.
+ *
+ *  Along with Parikh vectors of states, frequencies of transitions and accepting
+ *  states are recorded in the same pass as TsBuilder does, so the resulting TS
+ *  can be condensed and measured without reading the log again.
  */
 class LDOPA_API TsFoldBuilder 
         : public ElapsedTimeStore       // вспомогательный класс для учета времени алгоритма
@@ -0,0 +1,214 @@
+////////////////////////////////////////////////////////////////////////////////
+/// \file
+/// \brief     LDOPA Transision Systems Library
+/// \author    Sergey Shershakov
+/// \version   0.1.0
+/// \date      18.10.2026
+/// \copyright (c) xidv.ru 2014–2017.
+///            This source is for internal use only — Restricted Distribution.
+///            All rights reserved.
+///
+/// Batch evaluation of TSs built for a grid of parameters.
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef XI_LDOPA_TRSS_ALGOS_TS_GRID_EVALUATOR_H_
+#define XI_LDOPA_TRSS_ALGOS_TS_GRID_EVALUATOR_H_
+
+//#pragma once
+
+
+// ldopa dll
+#include "xi/ldopa/ldopa_dll.h"
+
+// ldopa
+#include "xi/ldopa/eventlog/compact/compactlog.h"
+#include "xi/ldopa/ts/algos/varws_ts_rebuilder.h"
+#include "xi/ldopa/ts/models/eventlog_ts_stateids.h"
+#include "xi/ldopa/ts/models/evlog_ts_red.h"
+#include "xi/ldopa/utils/elapsed_time.h"
+
+// std
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace xi { namespace ldopa { namespace ts {;   //
+
+
+//==============================================================================
+//  class TsGridEvaluator
+//==============================================================================
+
+
+/** \brief Builds TSs for a grid of parameters and calculates their metrics.
+ *
+ *  A candidate is a triple of a window size, a threshold and a vwsc value. Its TS
+ *  is built in three steps: a TS for the window size (TsBuilder with PrefixStateFunc),
+ *  condensed by the threshold (CondensedTsBuilder) and rebuilt with the vwsc value
+ *  (VarWsTsBuilder). Then all its metrics are calculated by TsMetricsCalc::calcAll()
+ *  with the prefix tree of the log as the full TS.
+ *
+ *  Candidates having the same window size and threshold form a task: the condensed
+ *  TS is built once for it, and all its vwsc values are tried by
+ *  VarWsTsBuilder::sweepVwsc(). Tasks are run by a pool of threads, each idle thread
+ *  takes the next task, so long tasks do not hold up the others. A task is evaluated
+ *  entirely by its thread: the sweep rebuilds one TS at a time with a single replay
+ *  thread, so no more than getThreadsNum() threads are used.
+ *
+ *  The log is loaded once into a compact snapshot (CompactLog), from which the prefix
+ *  tree is built; both are shared by all threads read-only. As trace objects of a log
+ *  are cached and are not thread-safe, each thread reads its own view of the snapshot
+ *  (see CompactLog::ShareData), which shares its encoded data.
+ *
+ *  Memory of a candidate is the one taken by its TSs and state IDs. If a memory limit
+ *  is set, it is checked while the TS for the window size, the largest one, is built
+ *  (on every percent of traces), and building is stopped as soon as it is exceeded;
+ *  the condensed TS and each rebuilt TS are checked once built, and a rebuilt TS
+ *  exceeding the limit is deleted right away. So a thread exceeds the limit by no
+ *  more than the growth between two checks, but the limit is not a hard cap.
+ */
+class LDOPA_API TsGridEvaluator
+        : public ElapsedTimeStore       // вспомогательный класс для учета времени алгоритма
+{
+public:
+    //-----<Types>-----
+
+    /** \brief Alias for the datatype of TSs. */
+    typedef EvLogTSWithFreqs TS;
+
+    /** \brief Alias for IEventLog2.*/
+    typedef eventlog::IEventLog IEventLog;
+
+    /** \brief Parameters of a candidate TS. */
+    struct Candidate {
+        int ws;                         ///< Window size (PrefixStateFunc::UNLIM_WND_SIZE for unlimited).
+        double threshold;               ///< Threshold of condensation.
+        double vwsc;                    ///< Value of vwsc for rebuilding.
+    };
+
+    /** \brief Vector of candidates. */
+    typedef std::vector<Candidate> VecOfCandidates;
+
+    /** \brief Status of a candidate evaluation. */
+    enum Status {
+            stOk                        ///< Evaluated.
+        ,   stMemLimit                  ///< Exceeded the memory limit.
+        ,   stError                     ///< Failed with an error.
+    };
+
+    /** \brief Result of a candidate evaluation. */
+    struct Result {
+        Candidate cand;                 ///< Parameters.
+        Status status;                  ///< Status.
+        std::string error;              ///< Error message if failed.
+
+        size_t statesNum;               ///< Number of states of the TS.
+        size_t transNum;                ///< Number of transitions of the TS.
+
+        double simplicity;
+        double precision;
+        double generalization;
+
+        /** \brief Wall time (ms) of building the TS; for the first candidate of a task
+         *  it includes building the condensed TS.
+         */
+        double buildTime;
+        double metricsTime;             ///< Wall time (ms) of calculating metrics.
+        size_t memBytes;                ///< Memory taken by the TS and its predecessors.
+    };
+
+    /** \brief Table of results. */
+    typedef std::vector<Result> VecOfResults;
+
+public:
+    /** \brief Constructor takes a log \a log, which is read only by the constructor. */
+    TsGridEvaluator(IEventLog* log);
+
+protected:
+    TsGridEvaluator(const TsGridEvaluator&);                 // Prevent copy-construction
+    TsGridEvaluator& operator=(const TsGridEvaluator&);      // Prevent assignment
+
+public:
+    /** \brief Makes candidates for all combinations of window sizes \a wss, thresholds
+     *  \a thresholds and vwsc values \a vwscs (vwsc changes first).
+     */
+    static VecOfCandidates makeGrid(const std::vector<int>& wss,
+        const std::vector<double>& thresholds, const std::vector<double>& vwscs);
+
+    /** \brief Evaluates all candidates \a cands.
+     *
+     *  \returns results in the order of \a cands. A candidate which cannot be built (e.g.
+     *  because of a bad threshold) gets the stError status, the other ones are not
+     *  affected.
+     */
+    VecOfResults evaluate(const VecOfCandidates& cands);
+
+public:
+    /** \brief Sets the number of threads \a num: 1 (by default) means evaluating in
+     *  the calling thread, 0 means the number of hardware threads.
+     */
+    void setThreadsNum(unsigned int num) { _threadsNum = num; }
+
+    /** \brief Returns the number of threads. */
+    unsigned int getThreadsNum() const { return _threadsNum; }
+
+    /** \brief Sets a memory limit (bytes) \a bytes for a candidate; 0 (by default)
+     *  means no limit.
+     */
+    void setMemLimit(size_t bytes) { _memLimit = bytes; }
+
+    /** \brief Returns the memory limit for a candidate. */
+    size_t getMemLimit() const { return _memLimit; }
+
+    /** \brief Sets a policy \a zsa for 0-WS states of rebuilt TSs. */
+    void setZeroSizeWndAction(VarWsTsBuilder::ZeroSizeWndAction zsa) { _zsa = zsa; }
+
+    /** \brief Returns a policy for 0-WS states. */
+    VarWsTsBuilder::ZeroSizeWndAction getZeroSizeWndAction() const { return _zsa; }
+
+    /** \brief Returns the log snapshot. */
+    const eventlog::CompactLog& getLog() const { return _log; }
+
+    /** \brief Returns the prefix tree of the log. */
+    const TS* getFullTs() const { return _fullTs.get(); }
+
+protected:
+    /** \brief Candidates with the same window size and threshold. */
+    struct Task {
+        int ws;
+        double threshold;
+        std::vector<size_t> cands;      ///< Numbers of candidates.
+    };
+
+    /** \brief Evaluates all candidates of a task \a task reading a log \a log (a view
+     *  of the snapshot in a pool thread).
+     */
+    void runTask(const Task& task, IEventLog* log, const VecOfCandidates& cands,
+        VecOfResults& res) const;
+
+protected:
+    /** \brief Log snapshot. */
+    eventlog::CompactLog _log;
+
+    /** \brief State IDs of the prefix tree. */
+    AttrListStateIDsPool _fullPool;
+
+    /** \brief Prefix tree of the log. */
+    std::unique_ptr<TS> _fullTs;
+
+    /** \brief Number of threads. */
+    unsigned int _threadsNum;
+
+    /** \brief Memory limit for a candidate. */
+    size_t _memLimit;
+
+    /** \brief Policy for 0-WS states. */
+    VarWsTsBuilder::ZeroSizeWndAction _zsa;
+}; // class TsGridEvaluator
+
+
+}}} // namespace xi { namespace ldopa { namespace ts {
+
+
+#endif // XI_LDOPA_TRSS_ALGOS_TS_GRID_EVALUATOR_H_
@@ -20,9 +20,12 @@
 
 // ldopa dll
 #include "xi/ldopa/ldopa_dll.h"
+#include "xi/types/aliases.h"
 
 // ldopa
 #include "xi/ldopa/ts/models/evlog_ts_red.h"
+#include "xi/ldopa/ts/models/frozen_ts.h"
+#include "xi/ldopa/utils/progress_callback.h"
 
 namespace xi { namespace ldopa { namespace ts {;   //
 
@@ -49,9 +52,39 @@ public:
     /** \brief Declares a set of log attributes. */
     typedef std::set<IEventLog::Attribute> AttributesSet;
 
+    /** \brief All metrics of a TS calculated by calcAll() together with times (ms)
+     *  taken by each of them.
+     */
+    struct Metrics {
+        double simplicity;
+        double precision;
+        double generalization;
+
+        double gatherTime;              ///< Traversal of the TS.
+        double simplicityTime;
+        double precisionTime;
+        double generalizationTime;
+    };
+
+    /** \brief Counter of events, which can exceed int for large logs. */
+    typedef xi::types::TInt64 EventsCount;
+
+    /** \brief Result of replaying a log on a TS (see calcFitness()). */
+    struct Fitness {
+        int tracesNum;                  ///< Number of traces.
+        int variantsNum;                ///< Number of distinct traces.
+        int fittingTracesNum;           ///< Number of traces replayed completely.
+        EventsCount eventsNum;          ///< Number of events.
+        EventsCount prefixEventsNum;    ///< Number of events replayed before the first deviation.
+        EventsCount unmatchedEventsNum; ///< Number of events having no transition to replay.
+
+        /** \brief Share of matched events: 1 - unmatchedEventsNum / eventsNum. */
+        double fitness;
+    };
+
 public:
     /** \brief Constructor. */
-    TsMetricsCalc(IEventLog* log, TS* _fullTs = nullptr);
+    TsMetricsCalc(IEventLog* log, const TS* _fullTs = nullptr);
 
 protected:
     TsMetricsCalc(const TsMetricsCalc&);                 // Prevent copy-construction
@@ -63,35 +96,116 @@ public:
      *  \param ts is a TS, from which simplicity metric is calculated. If it is not given,
      *  the method uses the last passed ts. If no ts has been passed previously, raises an exception.
      */
-    double calcSimplicity(TS* ts = nullptr);
+    double calcSimplicity(const TS* ts = nullptr);
 
     /** \brief Calculates precision of the given TS. 
      * 
      *  \param ts is a TS, from which simplicity metric is calculated. If it is not given,
      *  the method uses the last passed ts. If no ts has been passed previously, raises an exception.
      */
-    double calcPrecision(TS* ts = nullptr);
+    double calcPrecision(const TS* ts = nullptr);
 
     /** \brief Calculates generalization of the given TS.
      *
      *  \param ts is a TS, from which simplicity metric is calculated. If it is not given,
      *  the method uses the last passed ts. If no ts has been passed previously, raises an exception.
      */
-    double calcGeneralization(TS* ts = nullptr);
+    double calcGeneralization(const TS* ts = nullptr);
+public:
+    //----<Metrics by the log>----
+
+    /** \brief Calculates precision of the given TS by replaying the log on it, with no
+     *  full TS (prefix tree) needed.
+     *
+     *  Traces are streamed through a prefix automaton, which is built on the fly only 
+     *  for prefixes that the TS can replay, so it takes O(events) time and memory for
+     *  distinct replayable prefixes only. For a deterministic TS gives the same value
+     *  as calcPrecision() with the prefix tree of the log.
+     *  \param ts is as for calcPrecision().
+     */
+    double calcPrecisionByLog(const TS* ts = nullptr);
+
+    /** \brief Calculates generalization of the given TS by replaying the log on it.
+     *
+     *  In-flows of states are counted by replayed events instead of frequencies of
+     *  transitions, so the TS does not need to have frequencies.
+     *  \param ts is as for calcGeneralization().
+     */
+    double calcGeneralizationByLog(const TS* ts = nullptr);
+public:
+    //----<All metrics at once>----
+
+    /** \brief Calculates simplicity, precision and generalization of the given TS at once.
+     *
+     *  In-flows, out-degrees and accepting flags of states are gathered into flat arrays
+     *  by a single traversal of the TS, and all the metrics are calculated from the arrays
+     *  then. Precision is calculated using the full TS if it is set (as calcPrecision()
+     *  does), otherwise by replaying the log (as calcPrecisionByLog() does).
+     *  \param ts is as for calcSimplicity().
+     */
+    Metrics calcAll(const TS* ts = nullptr);
+public:
+    //----<Fitness>----
+
+    /** \brief Calculates fitness of the log to the given TS by replaying the log on it.
+     *
+     *  The TS is frozen (see FrozenEvLogTS) first, so an output transition of a state
+     *  for an event is found by a binary search over label codes.
+     *  \param ts is as for calcSimplicity().
+     */
+    Fitness calcFitness(const TS* ts = nullptr);
+
+    /** \brief Calculates fitness of the log to the given frozen TS \a ts.
+     *
+     *  Every distinct trace (variant) is replayed once, in getThreadsNum() threads.
+     *  An event having no output transition of the current state is unmatched: it is
+     *  skipped, and the replay goes on from the same state. A trace fits if it has no
+     *  unmatched events and ends in an accepting state; so an empty trace fits only if
+     *  the initial state is accepting.
+     *  Progress is reported to the progress callback: reading the log takes the first
+     *  half, replaying variants the second one. If the callback cancels, an exception 
+     *  is thrown.
+     */
+    Fitness calcFitness(const FrozenEvLogTS& ts);
+public:
+    //----<Metrics of frozen TSs>----
+
+    /** \brief Calculates simplicity of the given frozen TS. */
+    double calcSimplicity(const FrozenEvLogTS& ts);
+
+    /** \brief Calculates precision of the given frozen TS \a ts using a frozen
+     *  full TS \a fullTs (a prefix tree) as the reference one.
+     */
+    double calcPrecision(const FrozenEvLogTS& ts, const FrozenEvLogTS& fullTs);
+
+    /** \brief Calculates generalization of the given frozen TS. */
+    double calcGeneralization(const FrozenEvLogTS& ts);
 public:
     /** \brief Return a TS, for which last metric has been calculated. */
     const TS* getTs() const { return _ts; }
 
+    /** \brief Sets a progress callback \a pcb for calcFitness(). */
+    void setProgressCB(IProgressCallback* pcb) { _progrCB = pcb; }
+
+    /** \brief Returns a progress callback. */
+    IProgressCallback* getProgressCB() const { return _progrCB; }
+
+    /** \brief Sets the number of threads \a num for replaying variants by calcFitness():
+     *  1 (by default) means replaying in the calling thread, 0 means the number 
+     *  of hardware threads.
+     */
+    void setThreadsNum(unsigned int num) { _threadsNum = num; }
+
+    /** \brief Returns the number of threads. */
+    unsigned int getThreadsNum() const { return _threadsNum; }
+
 protected:
     /** \brief Sets the given \a ts as one, fro which a metric is calculated. 
      * 
      *  If \a ts is null, doesn't change the previously set value. If the value is null
      *  itself, raises an exception.
      */
-    void setAndCheckTs(TS* ts);
-
-    /** \brief For a given state of _ts, calculates its in-flow. */
-    int getStateInFlow(TS::State st) const;
+    void setAndCheckTs(const TS* ts);
 protected:
     /** \brief Stores a ptr to an event log.  */
     IEventLog* _log;
@@ -100,10 +214,10 @@ protected:
     // const AttributesSet* _logActivities;
 
     /** \brief Stores a ptr to a TS, metrics of which are calculated. */
-    TS* _ts;
+    const TS* _ts;
 
     /** \brief Stores a ptr to a full TS for calculation of precision, which is needed it as a ref TS. */
-    TS* _fullTs;
+    const TS* _fullTs;
 
     /** \brief Stores the last calculated simplicity. */
     double _calculatedSimplicity;
@@ -114,6 +228,15 @@ protected:
     /** \brief Stores the last calculated generalization. */
     double _calculatedGeneralization;
 
+    /** \brief Stores the last calculated fitness. */
+    double _calculatedFitness;
+
+    /** \brief Progress callback. */
+    IProgressCallback* _progrCB;
+
+    /** \brief Number of threads for replaying variants. */
+    unsigned int _threadsNum;
+
 }; // class TsMetricsCalc
 
 
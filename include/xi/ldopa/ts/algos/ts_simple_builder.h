@@ -254,7 +254,7 @@ public:
     enum
     {
         SET_AUTO_CLEAR_ST_POOL = 0,     ///< Determines whether the stateIDs pool is cleared before mining.
-        //SET_SINGLE_ACPT_STATE = 1,      ///< Determines whether the single accepting state must be added.
+        SET_INDEX_TRANS_LBLS = 1,       ///< Determines whether output transitions of a built TS are indexed by labels.
         //
         //
         SET__LAST                       ///< Technical internal value used to determine size for underlying bitset
@@ -284,7 +284,7 @@ public:
     // default settings
     static const unsigned int DEF_SETTINGS =
         (0x0 << SET_AUTO_CLEAR_ST_POOL          // Do not clear stateIDs map by default.
-        //| 0x0 << SET_SINGLE_ACPT_STATE          // With no single accepting state so far.
+        | 0x1 << SET_INDEX_TRANS_LBLS           // Index transitions by default.
         //| 0x1 <<                              //
         );
 public:
@@ -342,6 +342,12 @@ public:
     /** \brief Setter for SET_AUTO_CLEAR_ST_POOL option. */
     void setAutoClearStateIDsPool(bool f) { _settings[SET_AUTO_CLEAR_ST_POOL] = f; }
 
+    /** \brief Getter for SET_INDEX_TRANS_LBLS option. */
+    bool isIndexTransLbls() const { return _settings[SET_INDEX_TRANS_LBLS]; }
+
+    /** \brief Setter for SET_INDEX_TRANS_LBLS option. */
+    void setIndexTransLbls(bool f) { _settings[SET_INDEX_TRANS_LBLS] = f; }
+
 protected:
     //----<Algorith decomposition>----
     
@@ -20,6 +20,10 @@
 // std
 #include <vector>
 #include <set>
+#include <map>
+#include <functional>
+#include <memory>
+#include <mutex>
 
 // ldopa dll
 #include "xi/ldopa/ldopa_dll.h"
@@ -41,6 +45,19 @@ namespace xi { namespace ldopa { namespace ts {;   //
  *  TS that is created during work of the builder is stored by the builder until next
  *  building or the TS is detached by using an appropriate method (detach).
  *  Normally, the builder manages the lifetime of a builded TS.
+ *
+ *  Traces are replayed in rounds. Only traces that are still incomplete are replayed
+ *  in the next round: they are kept in a worklist and indexed by the temporary
+ *  transition they are blocked on, so each temporary transition is restated once.
+ *
+ *  In the parallel mode (see setThreadsNum()) activities of all traces are read from
+ *  the log once, and traces of a round are replayed concurrently against the TS, which
+ *  is not changed while replaying. Replays stop at the first missing regular transition;
+ *  temporary transitions and their frequencies are then made in the order of trace
+ *  numbers, so rounds give the same TS as the sequential replay.
+ *
+ *  Several vwsc values are tried by sweepVwsc(): the log is decoded and the first round
+ *  (which does not depend on vwsc) is replayed once for all of them.
  */
 class LDOPA_API VarWsTsBuilder 
     : public ElapsedTimeStore       // вспомогательный класс для учета времени алгоритма
@@ -60,6 +77,47 @@ public:
     typedef std::set<TS::Transition> SetOfTrans;    ///< Set of transitions.
     typedef SetOfTrans::iterator SetOfTransIter;    ///< Iterator for a set.
 
+    /** \brief Vector of trace numbers. */
+    typedef std::vector<int> IntVector;
+
+    /** \brief Map of temporary transitions to numbers of traces blocked on them. */
+    typedef std::map<TS::Transition, IntVector> TransTracesMap;
+
+    /** \brief Vector of transitions. */
+    typedef std::vector<TS::Transition> VecOfTrans;
+
+    /** \brief Vector of states. */
+    typedef std::vector<TS::State> VecOfStates;
+
+    /** \brief Callback called after each replay round with the number of the round
+     *  (starting from 1) and the number of traces still incomplete after it.
+     */
+    typedef std::function<void(int, int)> RoundCallback;
+
+    /** \brief Vector of activities of a trace. */
+    typedef std::vector<TS::Attribute> VecOfActs;
+
+    /** \brief Result of a read-only replay of a trace: the number of the first 
+     *  unreplayed event and the last regular state reached.
+     */
+    typedef IntStatePair ReplayRes;
+
+    /** \brief Sizes of a TS rebuilt for one vwsc value of a sweep. */
+    struct VwscPoint {
+        double vwsc;                    ///< Value of vwsc.
+        size_t statesNum;               ///< Number of states.
+        size_t transNum;                ///< Number of transitions.
+        int roundsNum;                  ///< Number of replay rounds.
+    };
+
+    /** \brief Vector of sweep points. */
+    typedef std::vector<VwscPoint> VecOfVwscPoints;
+
+    /** \brief Callback called for a TS rebuilt for a vwsc value. Returns true if it
+     *  takes the TS over, otherwise the TS is deleted after the call.
+     */
+    typedef std::function<bool(double, TS*)> VwscCallback;
+
     typedef eventlog::IEventLog IEventLog;        ///< Alias for IEventLog2.
     typedef eventlog::IEventTrace IEventTrace;    ///< Alias for IEventTrace2.
     typedef eventlog::IEvent IEvent;              ///< Alias for IEvent2.
@@ -100,12 +158,54 @@ public:
      */
     TS* build(double vwsc, ZeroSizeWndAction zsa);
 
+    /** \brief Rebuilds TSs for all values of \a vwscs sharing decoding of the log and
+     *  the first replay round.
+     *
+     *  Every TS is passed to \a cb (in the order of \a vwscs) for analysis, then it 
+     *  is deleted unless \a cb takes it over; no TS is kept by the builder. Up to 
+     *  getMaxVariantsNum() TSs are rebuilt (and stored) at once, each in its own thread.
+     *  \returns sizes of all the TSs.
+     */
+    VecOfVwscPoints sweepVwsc(const std::vector<double>& vwscs, ZeroSizeWndAction zsa,
+        const VwscCallback& cb = VwscCallback());
+
     /** \brief Detaches and returns the TS built at the previous call of build() method. */
     TS* detach();
 
     /** \brief Cleans a previously built TS if exists. If no, does nothing. */
     void cleanTS();
 
+public:
+    //----<Setters/Getters>----
+
+    /** \brief Sets a callback \a cb for reporting progress of replay rounds. */
+    void setRoundCallback(const RoundCallback& cb) { _roundCb = cb; }
+
+    /** \brief Returns the number of replay rounds made at the last building. */
+    int getRoundsNum() const { return _roundsNum; }
+
+    /** \brief Returns the number of trace replays made at the last building. */
+    int getReplaysNum() const { return _replaysNum; }
+
+    /** \brief Returns the number of traces still incomplete. */
+    int getPendingTracesNum() const { return (int)_pending.size(); }
+
+    /** \brief Sets the number of threads \a num for replaying traces: 1 (by default) 
+     *  means the sequential replay, 0 means the number of hardware threads.
+     */
+    void setThreadsNum(unsigned int num) { _threadsNum = num; }
+
+    /** \brief Returns the number of threads for replaying traces. */
+    unsigned int getThreadsNum() const { return _threadsNum; }
+
+    /** \brief Sets the max number \a num of TSs rebuilt at once by sweepVwsc(): 
+     *  1 (by default) means one by one, 0 means the number of hardware threads.
+     */
+    void setMaxVariantsNum(unsigned int num) { _maxVariantsNum = num; }
+
+    /** \brief Returns the max number of TSs rebuilt at once by sweepVwsc(). */
+    unsigned int getMaxVariantsNum() const { return _maxVariantsNum; }
+
 protected:
     /** \brief Performs log replaying loop reconstructing TS.  */
     void replayLoop();    
@@ -124,6 +224,57 @@ protected:
      */
     void restateTrace(int traceNum);
 
+    /** \brief Restates all temporary transitions, each through the first trace 
+     *  blocked on it, and clears the index of blocked traces.
+     *
+     *  Temporary states are removed at once after all the transitions are restated
+     *  (see LabeledTS::removeStates()): they often share a source state, whose 
+     *  transitions are thus swept once per round rather than once per temporary state.
+     */
+    void restateBlocked();
+
+    /** \brief Registers that a trace \a traceNum is blocked on a temporary transition \a t. */
+    void blockTrace(TS::Transition t, int traceNum);
+
+    /** \brief Replays pending traces of a round by \a thrNum threads without changing
+     *  the TS and puts results into \a res.
+     */
+    void replayPendingRO(unsigned int thrNum, std::vector<ReplayRes>& res) const;
+
+    /** \brief Makes temporary elements for incomplete traces by results \a res of
+     *  replayPendingRO() and puts them into \a stillPending.
+     */
+    void applyReplayRes(const std::vector<ReplayRes>& res, IntVector& stillPending);
+
+    /** \brief Finishes a round: \a stillPending become pending ones, temporary
+     *  elements are restated.
+     */
+    void finishRound(IntVector& stillPending);
+
+    /** \brief Locks the mutex for restating shared with other variants of a sweep, if any. */
+    std::unique_lock<std::mutex> lockRestate();
+
+    /** \brief Prepares the builder to be a variant with \a vwsc of a sweep made
+     *  by \a base.
+     */
+    void initVariant(const VarWsTsBuilder& base, double vwsc, unsigned int thrNum,
+        std::mutex* restateMtx);
+
+    /** \brief Rebuilds a variant's TS from \a ts0 starting with results \a res0 of 
+     *  the first round replayed on it.
+     */
+    void replayVariant(const TS& ts0, const std::vector<ReplayRes>& res0);
+
+    /** \brief Replays a trace \a traceNum using cached activities without changing the TS.
+     *
+     *  \returns the number of the first event with no regular transition (or the trace
+     *  size if the trace is complete) and the state it is replayed from.
+     */
+    ReplayRes replayTraceRO(int traceNum) const;
+
+    /** \brief Reads activities of all traces of the log into _traceActs. */
+    void cacheTraceActs();
+
     /** \brief Resets and prepares a vector of traces' last event nums. */
     void reset();
 
@@ -221,6 +372,39 @@ protected:
     /** \brief Stores temporary transitions. */
     SetOfTrans _tempTrans;
 
+    /** \brief Numbers of traces incomplete after the previous round in ascending order. */
+    IntVector _pending;
+
+    /** \brief For temporary transitions, stores numbers of traces blocked on them. */
+    TransTracesMap _blocked;
+
+    /** \brief Temporary transitions in the order they are made within a round. */
+    VecOfTrans _blockedOrder;
+
+    /** \brief Temporary states restated within a round, to be removed at its end. */
+    VecOfStates _restatedStates;
+
+    /** \brief Progress callback. */
+    RoundCallback _roundCb;
+
+    /** \brief Number of replay rounds made. */
+    int _roundsNum;
+
+    /** \brief Number of trace replays made. */
+    int _replaysNum;
+
+    /** \brief Number of threads for replaying traces. */
+    unsigned int _threadsNum;
+
+    /** \brief Max number of TSs rebuilt at once by sweepVwsc(). */
+    unsigned int _maxVariantsNum;
+
+    /** \brief Mutex for restating shared by variants of a sweep, or nullptr. */
+    std::mutex* _restateMtx;
+
+    /** \brief Activities of traces cached for the parallel mode (shared by variants of a sweep). */
+    std::shared_ptr<const std::vector<VecOfActs>> _traceActs;
+
     /** \brief Stores a dedicated state for 0WS. */
     TS::State _0wsState;
 
@@ -22,6 +22,10 @@
 // ldopa
 #include "xi/ldopa/ts/models/labeledts.h"
 #include "xi/ldopa/eventlog/eventlog.h"
+#include "xi/ldopa/utils/mem_usage.h"
+
+// std
+#include <bitset>
 
 
 // ldopa dll
@@ -83,6 +87,9 @@ public:
     /** \brief Returns a size of the pool. */
     virtual size_t getSize() const = 0;
 
+    /** \brief Returns memory taken by the pool: the IDs and their attribute payloads. */
+    virtual MemUsage memoryUsage() const = 0;
+
 
 }; // class IStateIDsPool
 
@@ -98,10 +105,36 @@ public:
 };
 
 
+/** \brief Custom data embedded into states of event log TSs.
+ *
+ *  Stored in vertex bundles of the underlying graph, so the data are accessed in O(1)
+ *  and are copied together with the graph.
+ */
+struct EvLogTSStateData {
+    EvLogTSStateData() : flags(0), flagsSet(false) {}
+
+    unsigned char flags;        ///< Bits of state flags; their meaning is defined by derived TSs.
+    bool flagsSet;              ///< True, if flags have been set.
+};
+
+
+/** \brief Custom data embedded into transitions of event log TSs. */
+struct EvLogTSTransData {
+    EvLogTSTransData() : freq(0), freqSet(false) {}
+
+    int freq;                   ///< Frequency of a transition.
+    bool freqSet;               ///< True, if the frequency has been set.
+};
+
+
 /** \brief Base implementation of a TS built for an event log. 
  *
  *  Manages the lifetime of all state identifiers.
  *
+ *  As for LabeledTS, all queries and traversals are available through the const
+ *  interface and do not modify the TS, so analysis threads can share a const TS
+ *  (e.g. through a const reference) without locks while nobody modifies it.
+ *
  *  #todo: возможно, сделать копирование пула состояний с указанием в конструкторе (как
  *  это сделано в EventLogTs. Для этого в интерфейсе IStateIDsPool реализовать метод clone().
  */
@@ -115,11 +148,26 @@ public:
     typedef Activity TrLabel;           // обобщенный тип — пометка переходов
 
 
+    typedef EvLogTSStateData StateData;     ///< Data embedded into states.
+    typedef EvLogTSTransData TransData;     ///< Data embedded into transitions.
+
+    /** \brief Storage of log TS graphs.
+     *
+     *  With XI_ARENA_TS (xi_ARENA_TS build option) every TS is allocated from
+     *  its own arena and released at once (see ArenaTsStorage).
+     */
+#ifdef XI_ARENA_TS
+    typedef ArenaTsStorage LogTSStorage;
+#else
+    typedef ListTsStorage LogTSStorage;
+#endif
+
     /** \brief Defines a specific type of an event log TS. 
      *
-     *  No states and transitions property.
+     *  States and transitions carry StateData and TransData properties respectively.
      */
-    typedef LabeledTS<const IStateId*, Attribute> LogTS;
+    typedef LabeledTS<const IStateId*, Attribute, StateData, TransData,
+        LogTSStorage> LogTS;
     typedef LogTS::State State;             ///< State type alias.
     typedef LogTS::StateRes StateRes;       ///< StateRes type alias.
     typedef LogTS::Transition Transition;   ///< Transition type alias.
@@ -139,6 +187,51 @@ public:
 
     typedef unsigned int Uint;              ///< Alias for unsigned int.
 
+    /** \brief A wrapper class for a bitset for flags-for-a-state type */
+    class StateFlags : public std::bitset<2> {
+    public:
+        //-----<Const>-----
+        /** \brief List of pseudo-constants for numbering bits in bitset */
+        enum {
+            FL_ACCEPTING = 0,           ///< Accepting state.
+            FL_ACCEPTING_SET,           ///< True, if accepting flag is set, false otherwise.
+        };
+
+        /** \brief Enumeration for tri-state flags. */
+        enum TriState {
+            triNotSet,                   ///< Flag is not set.
+            triTrue,                     ///< Flag set to true (is `set').
+            triFalse                     ///< Flag set to false (is `reset').
+        };
+    public:
+        StateFlags() {}
+
+        /** \brief Makes flags from bits stored in StateData. */
+        explicit StateFlags(unsigned long bits) : std::bitset<2>(bits) {}
+    public:
+        //-----<Flags operations>-----        
+        TriState getAccepting() const
+        {
+            if (test(FL_ACCEPTING_SET))
+                return test(FL_ACCEPTING) ? triTrue : triFalse;
+            return triNotSet;
+        }
+
+        void setAccepting(bool fl)
+        {
+            set(FL_ACCEPTING, fl);
+            set(FL_ACCEPTING_SET, true);
+        }
+
+        void clearAccepting() { set(FL_ACCEPTING_SET, false); }
+    }; // class StateFlags
+
+    /** \brief Datatype for an integer resulting value that can be undefined. */
+    typedef std::pair<int, bool> IntRes;
+
+    /** \brief Datatype for an state resulting value that can be undefined. */
+    typedef std::pair<StateFlags, bool> StateFlagsRes;
+
 #pragma endregion // Type Definitions
 public:
 
@@ -172,6 +265,12 @@ public:
     /** \brief Return a number of edges in the TS. */
     size_t getTransitionsNum() const  { return _ts->getTransitionsNum(); }
 
+    /** \brief Turns on/off indexing of output transitions by labels (see LabeledTS). */
+    void setTransIndexing(bool on) { _ts->setTransIndexing(on); }
+
+    /** \brief Returns true if output transitions are indexed by labels. */
+    bool isTransIndexing() const { return _ts->isTransIndexing(); }
+
     //----<Manipulation with TS (mainly shortcuts)>----
 
     /** \brief Returns the initial state. */
@@ -189,10 +288,10 @@ public:
      *
      *  If a state exists, sets a second field of StateRes to true, otherwise sets it to false.
      */
-    StateRes getState(const IStateId* stId) { return _ts->getState(stId); }
+    StateRes getState(const IStateId* stId) const { return _ts->getState(stId); }
 
     /** \brief Returns the ID of the given state \a s. */
-    const IStateId* getStateID(State s) { return _ts->getStateID(s); }
+    const IStateId* getStateID(State s) const { return _ts->getStateID(s); }
 
     /** \brief Adds a new anonymous state to the TS. */
     State addAnonState() { return _ts->addAnonState();  }
@@ -232,21 +331,21 @@ public:
      *  for one labeled with the given label \a lbl. If such a transition exists,
      *  returns true as a second part of a returning value, otherwise returns false there.
      */
-    TransRes getTrans(State s, State t, const Attribute& lbl) { return _ts->getTrans(s, t, lbl); }
+    TransRes getTrans(State s, State t, const Attribute& lbl) const { return _ts->getTrans(s, t, lbl); }
 
     /** \brief Looks over all output transitions of a given state \a s for the first
      *  one, which is labeled by the label \a lbl.
      *
      *  \returns If at least one such a transition if found, returns its (arbitrary first).
      */
-    TransRes getFirstOutTrans(State s, const Attribute& lbl) { return _ts->getFirstOutTrans(s, lbl); }
+    TransRes getFirstOutTrans(State s, const Attribute& lbl) const { return _ts->getFirstOutTrans(s, lbl); }
 
     /** \brief Acts like getFirstOutTrans(), but returns the state, to which a found transition lead.
      *
      *  It is just a shortcut for a chain of methods getFirstOutTrans() and getTargState().
      *  \returns if a corresponding transition found, returns a corresponding state and true as a second parameter.
      */
-    StateRes getFirstOutState(State s, const Attribute& lbl) { return _ts->getFirstOutState(s, lbl); }
+    StateRes getFirstOutState(State s, const Attribute& lbl) const { return _ts->getFirstOutState(s, lbl); }
 
     /** \brief Returns the source State (vertex) of the given transitions \param t. */
     State getSrcState(const Transition& t) const { return _ts->getSrcState(t); }
@@ -255,7 +354,7 @@ public:
     State getTargState(const Transition& t) const { return _ts->getTargState(t); }
 
     /** \brief Returns a const ref to the label of the given transition \param t. */
-    const Attribute& getTransLbl(const Transition& t) const { return _ts->getBundle(t); }
+    const Attribute& getTransLbl(const Transition& t) const { return LogTS::extractTransLbl(_ts->getBundle(t)); }
         
     /** \brief Returns a collection of States (by a pair of state iterators). */
     /*LogTS::*/StateIterPair getStates() { return _ts->getStates(); }
@@ -289,6 +388,14 @@ public:
     /** \brief Shortcut for removing the given transition \a t. */
     void removeTrans(const Transition& t) { _ts->removeTrans(t); }
 
+    /** \brief Shortcut for removing all states of a range \a states at once. */
+    template<typename StateRange>
+    size_t removeStates(const StateRange& states) { return _ts->removeStates(states); }
+
+    /** \brief Shortcut for removing all transitions of a range \a trans at once. */
+    template<typename TransRange>
+    size_t removeTransitions(const TransRange& trans) { return _ts->removeTransitions(trans); }
+
     /** \brief Returns the numbers of input transitions of a state \a s. */
     size_t getInTransNum(State s) const { return _ts->getInTransNum(s); }
 
@@ -301,6 +408,38 @@ public:
     /** \brief Returns true if the given state \a s has output transitions, otherwise false. */
     bool hasOutTransitions(State s) const { return _ts->hasOutTransitions(s); }
 
+public:
+    //----<Frequencies and flags embedded into bundles>----
+
+    /** \brief Returns a frequency for the given transition \a t. 
+     *
+     *  If a frequecy has been set, the second parameter of the resulting object
+     *  is true, otherwise false.
+     */
+    IntRes getTransFreq(Transition t) const;
+
+    /** \brief Sets a new value \a freq of frequency for the given transition \a t. */
+    void setTransFreq(Transition t, int freq);
+
+
+    /** \brief Returns a state fags for the given state \a s.
+     *
+     *  If a state flags is set, the second parameter of the resulting object
+     *  is true, otherwise false.
+     */
+    StateFlagsRes getStateFlags(State s) const;
+
+    /** \brief Sets a new value \a freq of state flags for the given state \a s. */
+    void setStateFlags(State s, StateFlags sf);
+
+    /** \brief Returns true if the given state \a s is accepting one, otherwise false. */
+    bool isStateAccepting(State s) const;
+
+    /** \brief Sets the given state \a s to be accepting one (\a accepting is true)
+        or not (\a accepting is false). */
+    void setAcceptingState(State s, bool accepting);
+
+
 public:
     //----<Helpers>----
     
@@ -319,9 +458,26 @@ public:
 public:
     //----<Special setters and getters>----
         
+    /** \brief Returns data embedded into the given state \a s. */
+    StateData& getStateData(State s) { return _ts->getData(s); }
+
+    /** \brief Returns data embedded into the given state \a s / const. */
+    const StateData& getStateData(State s) const { return _ts->getData(s); }
+
+    /** \brief Returns data embedded into the given transition \a t. */
+    TransData& getTransData(const Transition& t) { return _ts->getData(t); }
+
+    /** \brief Returns data embedded into the given transition \a t / const. */
+    const TransData& getTransData(const Transition& t) const { return _ts->getData(t); }
+
     LogTS& getLts() { return *_ts; }                    ///< Returns the underlying labeled TS.
     const LogTS& getLts() const { return *_ts; }        ///< Returns the underlying const labeled TS.
 
+    /** \brief Returns memory taken by the TS (without the stateIDs pool, which
+     *  can be shared by several TSs).
+     */
+    virtual MemUsage memoryUsage() const;
+
     /** \brief Returns the associated (when constructed) stateIDs pool. */
     IStateIDsPool* getStateIDsPool() const { return _stIDsPool; }
 
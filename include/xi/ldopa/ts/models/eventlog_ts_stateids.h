@@ -135,6 +135,7 @@ public:
     //----<IStateIDsPool Implementation>----
     virtual const IStateId* getInitStateId() override;
     virtual size_t getSize() const override;
+    virtual MemUsage memoryUsage() const override;
     //virtual const IStateId* operator[](const IStateId* stId);
 public:
     //----<Main interface>----
@@ -255,6 +256,7 @@ public:
     //----<IStateIDsPool Implementation>----
     virtual const IStateId* getInitStateId() override;
     virtual size_t getSize() const override;
+    virtual MemUsage memoryUsage() const override;
     //virtual const IStateId* operator[](const IStateId* stId);
 public:
     //----<Main interface>----
@@ -22,13 +22,21 @@
 
 // ldopa
 #include "xi/ldopa/ts/models/eventlog_ts.h"
+#include "xi/ldopa/ts/models/evlog_ts_red.h"
 #include "xi/ldopa/ts/models/parikh_vector.h"
 
 
 namespace xi { namespace ldopa { namespace ts {
+
+// forward declaration
+class FrozenEvLogTS;
+
 /** \brief Definition for Event Log TS containing additional attributes.
  *
- *  Additional attributes: Parikh vectors for each state.
+ *  Additional attributes: Parikh vectors for each state. Frequencies of transitions
+ *  and accepting flags of states are stored in the bundles of the underlying graph and
+ *  accessed through BaseEventLogTS as for EvLogTSWithFreqs, so frequency-based algorithms 
+ *  and metrics need no separate TS built from the log.
  */
 class LDOPA_API EvLogTSWithParVecs : public BaseEventLogTS
 {
@@ -123,6 +131,22 @@ public:
      */
     Transition getOrAddTransPV(State s, State t, const Attribute& lbl, Value lblCnt);
 
+    /** \brief Does the same as getOrAddTransPV() and also increases the frequency of
+     *  the transition by \a addFreq (see EvLogTSWithFreqs::getOrAddTransF()).
+     */
+    Transition getOrAddTransPVF(State s, State t, const Attribute& lbl, Value lblCnt, 
+        int addFreq);
+
+    /** \brief Makes an immutable CSR snapshot of the TS including Parikh vectors,
+     *  e.g. for saving it in the binary form.
+     *
+     *  Requires xi/ldopa/ts/models/frozen_ts.h to be included at the point of call.
+     */
+    FrozenEvLogTS freeze() const;
+
+    /** \brief Returns memory taken by the TS including Parikh vectors of states. */
+    virtual MemUsage memoryUsage() const override;
+
 public:
     //----<Working with attributes>----
 
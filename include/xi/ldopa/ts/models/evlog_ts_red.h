@@ -26,68 +26,21 @@
 
 namespace xi { namespace ldopa { namespace ts {;   //
 
+// forward declaration
+class FrozenEvLogTS;
 
 
 /** \brief Definition for Event Log TS containing additional attributes.
  *
  *  Additional attributes: frequency for transitions and accepting flags for states.
+ *  Both are stored in the bundles of the underlying graph and are accessed through
+ *  BaseEventLogTS (see BaseEventLogTS::getTransFreq() and BaseEventLogTS::isStateAccepting()).
  */
 class LDOPA_API EvLogTSWithFreqs : public BaseEventLogTS
 {
 public:
 #pragma region Type Definitions
     typedef BaseEventLogTS Base;
-
-
-    /** \brief Type for mapping transitions to integers. 
-     *
-     *  Mind using \a unordered_map instead (see EdgePstrMap).
-     */
-    typedef std::map<Transition, int> TransIntMap;
-
-    /** \brief A wrapper class for a bitset for flags-for-a-state type */
-    class StateFlags : public std::bitset<2> {
-    public:
-        //-----<Const>-----
-        /** \brief List of pseudo-constants for numbering bits in bitset */
-        enum {
-            FL_ACCEPTING = 0,           ///< Accepting state.
-            FL_ACCEPTING_SET,           ///< True, if accepting flag is set, false otherwise.
-        };
-
-        /** \brief Enumeration for tri-state flags. */
-        enum TriState {
-            triNotSet,                   ///< Flag is not set.
-            triTrue,                     ///< Flag set to true (is `set').
-            triFalse                     ///< Flag set to false (is `reset').
-        };
-    public:
-        //-----<Flags operations>-----        
-        TriState getAccepting() const
-        {
-            if (test(FL_ACCEPTING_SET))
-                return test(FL_ACCEPTING) ? triTrue : triFalse;
-            return triNotSet;
-        }
-
-        void setAccepting(bool fl)
-        {
-            set(FL_ACCEPTING, fl);
-            set(FL_ACCEPTING_SET, true);
-        }
-
-        void clearAccepting() { set(FL_ACCEPTING_SET, false); }
-    }; // class StateFlags
-
-    /** \brief Mapping of states to state flags. */
-    typedef std::map<State, StateFlags> StateFlagsMap;
-
-    /** \brief Datatype for an integer resulting value that can be undefined. */
-    typedef std::pair<int, bool> IntRes;
-
-    /** \brief Datatype for an state resulting value that can be undefined. */
-    typedef std::pair<StateFlags, bool> StateFlagsRes;
-
 #pragma endregion // Type Definitions
 
 public:
@@ -102,7 +55,7 @@ public:
 
     /** \brief Copy constructor. 
      *
-     *  It is crucial to make a right copy for _transFreqsMap and _stateFlags.
+     *  Frequencies and flags are copied together with the underlying graph.
      */     
     EvLogTSWithFreqs(const EvLogTSWithFreqs& that);
 
@@ -113,7 +66,8 @@ public:
     //----<Extended interface>----
 
     /** \brief Gets a transition between given pair of states \a s and \a t,
-     *  marked by a label \a lbl, taking into account its frequency. 
+     *  marked by a label \a lbl, taking into account its frequency (see 
+     *  BaseEventLogTS::getTransFreq()). 
      *
      *  If the same transition appears again and again, its frequecy is increased
      *  by adding \a addFreq value.
@@ -123,62 +77,19 @@ public:
      */
     Transition getOrAddTransF(State s, State t, const Attribute& lbl, int addFreq);
 
-public:
-    //----<Working with attributes>----
-
-    /** \brief Returns a frequency for the given transition \a t. 
-     *
-     *  If a frequecy has been set, the second parameter of the resulting object
-     *  is true, otherwise false.
-     */
-    IntRes getTransFreq(Transition t) const;
-
-    /** \brief Sets a new value \a freq of frequency for the given transition \a t. */
-    void setTransFreq(Transition t, int freq);
-
-
-    /** \brief Returns a state fags for the given state \a s.
+    /** \brief Makes an immutable CSR snapshot of the TS for read-only analysis.
      *
-     *  If a state flags is set, the second parameter of the resulting object
-     *  is true, otherwise false.
+     *  Requires xi/ldopa/ts/models/frozen_ts.h to be included at the point of call.
      */
-    StateFlagsRes getStateFlags(State s) const;
+    FrozenEvLogTS freeze() const;
 
-    /** \brief Sets a new value \a freq of state flags for the given state \a s. */
-    void setStateFlags(State s, StateFlags sf);
-
-    /** \brief Returns true if the given state \a s is accepting one, otherwise false. */
-    bool isStateAccepting(State s) const;
-
-    /** \brief Sets the given state \a s to be accepting one (\a accepting is true)
-        or not (\a accepting is false). */
-    void setAcceptingState(State s, bool accepting);
+public:
+    //----<Working with attributes>----
 
     int getMaxWS() const { return _maxWS; }     ///< Gets MaxWS attribute.
     void setMaxWS(int ws) { _maxWS = ws; }      ///< Sets MaxWS attribute.    
 
 protected:
-    //----<Construction helpers>----
-    
-    /** \brief Makes all state-corresponding structures valid after copying the underlying graph. 
-     *
-     *  \param that is a TS, from which a copy (into this TS) has been done.
-     */
-    void validateStates(const EvLogTSWithFreqs& that);
-
-    /** \brief Makes all trans-corresponding structures valid after copying the underlying graph.
-     *
-     *  \param that is a TS, from which a copy (into this TS) has been done.
-     */
-    void validateTransitions(const EvLogTSWithFreqs& that);
-protected:
-    
-
-    /** \brief Stores a map of edges to assigned frequencies. */
-    TransIntMap _transFreqsMap;
-
-    /** \brief Stores a map of states to flags. */
-    StateFlagsMap _stateFlags;
 
     /** \brief Max Window Size attribute, for which the TS is built. */
     int _maxWS;
@@ -0,0 +1,362 @@
+////////////////////////////////////////////////////////////////////////////////
+/// \file
+/// \brief     Immutable CSR snapshot of an event log TS.
+/// \author    Sergey Shershakov
+/// \version   0.1.0
+/// \date      18.10.2026
+/// \copyright (c) xidv.ru 2014–2017.
+///            This source is for internal use only — Restricted Distribution.
+///            All rights reserved.
+///
+/// FrozenEvLogTS is a read-only compressed-sparse-row representation of
+/// EvLogTSWithFreqs and EvLogTSWithParVecs for analysis passes that do not
+/// modify a TS. Snapshots can be saved to a versioned binary file and loaded
+/// back by mapping the file into memory.
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef XI_LDOPA_TRSS_MODELS_FROZEN_TS_H_
+#define XI_LDOPA_TRSS_MODELS_FROZEN_TS_H_
+
+#pragma once
+
+// ldopa dll
+#include "xi/ldopa/ldopa_dll.h"
+
+// ldopa
+#include "xi/ldopa/ts/models/evlog_ts_red.h"
+#include "xi/ldopa/ts/models/parikh_vector.h"
+
+// boost
+#include <boost/iterator/counting_iterator.hpp>
+
+// std
+#include <climits>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace xi { namespace ldopa { namespace ts {;   //
+
+// forward declarations
+class EvLogTSOverlay;
+class EvLogTSWithParVecs;
+
+
+/** \brief Immutable snapshot of EvLogTSWithFreqs in the CSR form.
+ *
+ *  States are numbered densely in BFS order starting from the initial state (states
+ *  unreachable from it follow in the order of the source TS). Transitions are numbered
+ *  so that output transitions of every state form a contiguous range sorted by
+ *  labels; input transitions are given by a separate array of transition numbers.
+ *  Labels are replaced by dense codes ordered as the labels themselves, so an output
+ *  transition with a given label is found by a binary search. Frequencies of
+ *  transitions and accepting flags of states are stored as parallel columns.
+ *  A snapshot of EvLogTSWithParVecs also stores Parikh vectors of states as
+ *  a row-major matrix.
+ *
+ *  The snapshot follows the same traversal interface as EvLogTSWithFreqs (getStates(),
+ *  getInitState(), getOutTransitions(), getInTransitions(), getTargState(),
+ *  getTransLbl(), getFirstOutTrans(), getTransFreq(), isStateAccepting()), so
+ *  algorithms written against these methods run on both representations. States and
+ *  transitions are plain indices, hence algorithms can keep their data in vectors
+ *  instead of maps.
+ *
+ *  The snapshot doesn't depend on the source TS, except for state IDs (owned by a
+ *  state IDs pool) and original states returned by getOrigState(), which are valid
+ *  while the source TS is alive and unchanged.
+ *
+ *  Columns are immutable and shared between copies of a snapshot, so copying is
+ *  cheap. A snapshot saved by save() is restored by load(), which maps the file into
+ *  memory and refers to the columns in place; only labels (and state IDs, if a pool
+ *  is given) are decoded.
+ */
+class LDOPA_API FrozenEvLogTS {
+public:
+    //-----<Types>-----
+
+    /** \brief Type of a label. */
+    typedef BaseEventLogTS::Attribute Attribute;
+
+    /** \brief Index type used for states, transitions and labels. */
+    typedef unsigned int Index;
+
+    typedef Index State;                    ///< State is its index.
+    typedef Index Transition;               ///< Transition is its index.
+    typedef Index LabelCode;                ///< Dense code of a label.
+
+    typedef std::pair<State, bool> StateRes;
+    typedef std::pair<Transition, bool> TransRes;
+    typedef EvLogTSWithFreqs::IntRes IntRes;
+
+    /** \brief Type of Parikh vector elements. */
+    typedef ParikhVector::Value Value;
+
+    // iterators
+    typedef boost::counting_iterator<Index> StateIter;
+    typedef boost::counting_iterator<Index> OtransIter;
+    typedef boost::counting_iterator<Index> TransIter;
+    typedef const Index* ItransIter;
+
+    typedef std::pair<StateIter, StateIter> StateIterPair;
+    typedef std::pair<OtransIter, OtransIter> OtransIterPair;
+    typedef std::pair<TransIter, TransIter> TransIterPair;
+    typedef std::pair<ItransIter, ItransIter> ItransIterPair;
+
+    typedef BaseEventLogTS::Uint Uint;
+
+    /** \brief Index denoting no state/transition/label. */
+    static const Index NO_INDEX = UINT_MAX;
+
+    /** \brief Frequency value denoting a not set frequency. */
+    static const int NO_FREQ = INT_MIN;
+
+    /** \brief Version of the binary format written by save(). */
+    static const std::uint32_t FILE_VERSION = 1;
+
+    /** \brief Read-only view of a column, which is stored either in the snapshot
+     *  or in a mapped file.
+     */
+    template<typename T>
+    struct Column {
+        Column() : data(nullptr), size(0) {}
+
+        const T& operator[](size_t i) const { return data[i]; }
+        const T* begin() const { return data; }
+        const T* end() const { return data + size; }
+
+        const T* data;
+        size_t size;
+    };
+
+    /** \brief Bits of the state flags column. */
+    enum {
+        SF_ACCEPTING = 0x1,                 ///< Accepting state.
+        SF_ANON = 0x2,                      ///< Anonymous state.
+        SF_PARVEC = 0x4,                    ///< Parikh vector is set.
+    };
+public:
+    /** \brief Default constructor: an empty TS. */
+    FrozenEvLogTS();
+
+    /** \brief Makes a snapshot of \a ts. */
+    explicit FrozenEvLogTS(const EvLogTSWithFreqs& ts);
+
+    /** \brief Makes a snapshot of states and transitions left in an overlay \a ts. */
+    explicit FrozenEvLogTS(const EvLogTSOverlay& ts);
+
+    /** \brief Makes a snapshot of \a ts including Parikh vectors of states. */
+    explicit FrozenEvLogTS(const EvLogTSWithParVecs& ts);
+
+public:
+    //----<Binary format>----
+
+    /** \brief Writes the snapshot to a stream \a os opened in the binary mode.
+     *
+     *  Columns are written one by one without making an image of the whole file.
+     *  Labels and attributes of state IDs must be numbers or strings; state IDs must
+     *  be AttrListStateId or FixedIntListStateId. Throws LdopaException otherwise.
+     */
+    void save(std::ostream& os) const;
+
+    /** \brief Writes the snapshot to a file \a fileName. */
+    void save(const std::string& fileName) const;
+
+    /** \brief Loads a snapshot from a file \a fileName made by save().
+     *
+     *  The file is mapped into memory and stays mapped while the snapshot (or any of
+     *  its copies) is alive. If a pool \a pool is given, state IDs are restored in it:
+     *  the pool must be AttrListStateIDsPool or FixedIntListStateIdsPool according
+     *  to the type of saved IDs; otherwise getStateID() returns nullptr.
+     *  Original states (see getOrigState()) are not available for a loaded snapshot.
+     *
+     *  Throws LdopaException if the file cannot be read or is malformed.
+     */
+    static FrozenEvLogTS load(const std::string& fileName, IStateIDsPool* pool = nullptr);
+
+public:
+    //----<Basic TS interface>----
+
+    /** \brief Returns the number of states. */
+    size_t getStatesNum() const { return _stFlags.size; }
+
+    /** \brief Returns the number of transitions. */
+    size_t getTransitionsNum() const { return _targs.size; }
+
+    /** \brief Returns the number of different labels. */
+    size_t getLabelsNum() const { return _labels.size(); }
+
+    /** \brief Returns the initial state; NO_INDEX if the source TS has no one. */
+    State getInitState() const { return _hasInitState ? 0 : NO_INDEX; }
+
+    /** \brief Returns all states. */
+    StateIterPair getStates() const
+    {
+        return StateIterPair(StateIter(0), StateIter((Index)getStatesNum()));
+    }
+
+    /** \brief Returns all transitions. */
+    TransIterPair getTransitions() const
+    {
+        return TransIterPair(TransIter(0), TransIter((Index)getTransitionsNum()));
+    }
+
+    /** \brief Returns output transitions of a state \a s sorted by labels. */
+    OtransIterPair getOutTransitions(State s) const
+    {
+        return OtransIterPair(OtransIter(_outOffs[s]), OtransIter(_outOffs[s + 1]));
+    }
+
+    /** \brief Returns input transitions of a state \a s. */
+    ItransIterPair getInTransitions(State s) const
+    {
+        return ItransIterPair(_inTrans.begin() + _inOffs[s], _inTrans.begin() + _inOffs[s + 1]);
+    }
+
+    /** \brief Returns the number of output transitions of a state \a s. */
+    size_t getOutTransNum(State s) const { return _outOffs[s + 1] - _outOffs[s]; }
+
+    /** \brief Returns the number of input transitions of a state \a s. */
+    size_t getInTransNum(State s) const { return _inOffs[s + 1] - _inOffs[s]; }
+
+    /** \brief Returns the source state of a transition \a t. */
+    State getSrcState(Transition t) const { return _srcs[t]; }
+
+    /** \brief Returns the target state of a transition \a t. */
+    State getTargState(Transition t) const { return _targs[t]; }
+
+    /** \brief Returns the label of a transition \a t. */
+    const Attribute& getTransLbl(Transition t) const { return _labels[_lblCodes[t]]; }
+
+    /** \brief Returns the label code of a transition \a t. */
+    LabelCode getTransLblCode(Transition t) const { return _lblCodes[t]; }
+
+    /** \brief Returns a label by its \a code. */
+    const Attribute& getLabel(LabelCode code) const { return _labels[code]; }
+
+    /** \brief Returns the code of a label \a lbl or NO_INDEX if no transition is
+     *  labeled by it.
+     */
+    LabelCode getLabelCode(const Attribute& lbl) const;
+
+    /** \brief Returns an output transition of a state \a s labeled by a label with
+     *  a code \a code (the first one if there are several).
+     */
+    TransRes getFirstOutTrans(State s, LabelCode code) const;
+
+    /** \brief Returns an output transition of a state \a s labeled by \a lbl. */
+    TransRes getFirstOutTrans(State s, const Attribute& lbl) const
+    {
+        LabelCode code = getLabelCode(lbl);
+        if (code == NO_INDEX)
+            return TransRes(NO_INDEX, false);
+
+        return getFirstOutTrans(s, code);
+    }
+
+    /** \brief Returns a transition between states \a s and \a t labeled by \a lbl. */
+    TransRes getTrans(State s, State t, const Attribute& lbl) const;
+public:
+    //----<Properties>----
+
+    /** \brief Returns the frequency of a transition \a t (see EvLogTSWithFreqs). */
+    IntRes getTransFreq(Transition t) const
+    {
+        int f = _freqs[t];
+        return f == NO_FREQ ? IntRes(0, false) : IntRes(f, true);
+    }
+
+    /** \brief Returns true if a state \a s is accepting. */
+    bool isStateAccepting(State s) const { return (_stFlags[s] & SF_ACCEPTING) != 0; }
+
+    /** \brief Returns true if a state \a s is anonymous. */
+    bool isStateAnon(State s) const { return (_stFlags[s] & SF_ANON) != 0; }
+
+    /** \brief Returns the ID of a state \a s; nullptr for anonymous states and for
+     *  loaded snapshots with no state IDs restored.
+     */
+    const IStateId* getStateID(State s) const { return _stateIds.empty() ? nullptr : _stateIds[s]; }
+
+    /** \brief Returns the size of Parikh vectors; 0 if the snapshot has no ones. */
+    Uint getParikhDim() const { return _pvDim; }
+
+    /** \brief Returns getParikhDim() elements of the Parikh vector of a state \a s or
+     *  nullptr if no vector is set.
+     */
+    const Value* getParikhVector(State s) const
+    {
+        return (_stFlags[s] & SF_PARVEC) ? _parVecs.data + (size_t)s * _pvDim : nullptr;
+    }
+
+    /** \brief Returns the attribute counted by the element \a i of Parikh vectors. */
+    const Attribute& getParikhAttr(Uint i) const { return _pvAttrs[i]; }
+
+    /** \brief Returns a state of the source TS, for which a state \a s has been made.
+     *
+     *  Throws an exception for a loaded snapshot, which has no source TS.
+     */
+    EvLogTSWithFreqs::State getOrigState(State s) const
+    {
+        if ((size_t)s >= _origStates.size())
+            throw LdopaException("Original states are not available for the frozen TS.");
+        return _origStates[s];
+    }
+
+    /** \brief Returns the number of traces of the source TS. */
+    Uint getTracesNum() const { return _tracesNum; }
+
+    /** \brief Returns MaxWS attribute of the source TS. */
+    int getMaxWS() const { return _maxWS; }
+
+    /** \brief Returns memory taken by the snapshot; "columns" are either owned
+     *  or mapped from a file.
+     */
+    MemUsage memoryUsage() const;
+protected:
+    /** \brief Fills the snapshot by a source TS \a ts of type EvLogTSWithFreqs,
+     *  EvLogTSOverlay or EvLogTSWithParVecs.
+     */
+    template<typename TSrcTs>
+    void init(const TSrcTs& ts);
+
+    /** \brief Builds _lblSorted. */
+    void sortLabels();
+protected:
+    /** \brief Owner of the columns: the snapshot's own arrays or a mapped file. */
+    std::shared_ptr<const void> _storage;
+
+    //----<Output transitions: CSR>----
+    Column<Index> _outOffs;                 ///< Offsets of output transitions of states, size is n + 1.
+    Column<State> _srcs;                    ///< Source states of transitions.
+    Column<State> _targs;                   ///< Target states of transitions.
+    Column<LabelCode> _lblCodes;            ///< Label codes of transitions.
+    Column<int> _freqs;                     ///< Frequencies of transitions; NO_FREQ if not set.
+
+    //----<Input transitions: CSR>----
+    Column<Index> _inOffs;                  ///< Offsets of input transitions of states, size is n + 1.
+    Column<Transition> _inTrans;            ///< Input transitions grouped by target states.
+
+    //----<States>----
+    Column<unsigned char> _stFlags;         ///< State flags (SF_* bits).
+    Column<Value> _parVecs;                 ///< Parikh vectors of states, n x _pvDim.
+    Uint _pvDim;                            ///< Size of Parikh vectors.
+    std::vector<Attribute> _pvAttrs;        ///< Attributes counted by elements of Parikh vectors.
+    std::vector<const IStateId*> _stateIds;         ///< State IDs; empty if not available.
+    std::vector<EvLogTSWithFreqs::State> _origStates; ///< States of the source TS.
+    bool _hasInitState;                             ///< True if state 0 is the initial one.
+
+    //----<Labels>----
+    std::vector<Attribute> _labels;         ///< Labels ordered by their codes.
+    std::vector<LabelCode> _lblSorted;      ///< Label codes ordered by labels.
+
+    Uint _tracesNum;                        ///< Number of traces of the source TS.
+    int _maxWS;                             ///< MaxWS of the source TS.
+}; // class FrozenEvLogTS
+
+
+}}} // namespace xi { namespace ldopa { namespace ts {
+
+
+#endif // XI_LDOPA_TRSS_MODELS_FROZEN_TS_H_
@@ -25,10 +25,17 @@
 
 // ldopa
 #include "xi/ldopa/graphs/boost/bgl_graph_wrappers.h"
+#include "xi/ldopa/graphs/boost/bgl_arena.h"
+#include "xi/ldopa/ts/models/trans_lbl_index.h"
 
 // std
+#include <iterator>
 #include <set>
 #include <map>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 namespace xi { namespace ldopa { namespace ts {;   //
 
@@ -316,6 +323,97 @@ struct BGL_traits<TGraph, boost::multisetS> :
 #pragma endregion // BGL Traits Classes
 
 
+#pragma region Storage Policies
+
+/** \brief Storage policy: states and transitions are list nodes of the underlying graph.
+ *
+ *  Descriptors are pointers, which are stable under any removals. Default policy.
+ */
+struct ListTsStorage
+{
+    typedef boost::listS OutEdgeListS;          ///< Out edge storage selector.
+    typedef boost::listS VertexListS;           ///< Vertices storage selector.
+    typedef boost::listS EdgeListS;             ///< Edge list storage selector.
+
+    /** \brief Edge property type for a given bundle. */
+    template<typename TBundle>
+    struct EdgeProperty { typedef TBundle type; };
+
+    /** \brief Allocator of side maps and sets. */
+    template<typename T>
+    struct Allocator { typedef std::allocator<T> type; };
+
+    /** \brief True if states and transitions have dense integer indices. */
+    static const bool DENSE_INDICES = false;
+
+    /** \brief True if a TS allocates its graph and side maps from its own arena. */
+    static const bool ARENA = false;
+}; // struct ListTsStorage
+
+
+/** \brief Storage policy: states and output transitions are stored in vectors.
+ *
+ *  States are dense indices [0, n). Removed states become tombstones, which are skipped
+ *  by state iterators, so indices of other states do not change until compaction
+ *  (LabeledTS::compact()). Transitions get dense indices when added; indices of removed
+ *  transitions become holes until compaction as well. Attributes of states and
+ *  transitions can therefore be kept in vectors.
+ */
+struct VecTsStorage
+{
+    typedef boost::vecS OutEdgeListS;           ///< Out edge storage selector.
+    typedef boost::vecS VertexListS;            ///< Vertices storage selector.
+    typedef boost::listS EdgeListS;             ///< Edge list storage selector.
+
+    /** \brief Edge property type for a given bundle: the bundle with an edge index. */
+    template<typename TBundle>
+    struct EdgeProperty { typedef boost::property<boost::edge_index_t, std::size_t, TBundle> type; };
+
+    /** \brief Allocator of side maps and sets. */
+    template<typename T>
+    struct Allocator { typedef std::allocator<T> type; };
+
+    /** \brief True if states and transitions have dense integer indices. */
+    static const bool DENSE_INDICES = true;
+
+    /** \brief True if a TS allocates its graph and side maps from its own arena. */
+    static const bool ARENA = false;
+}; // struct VecTsStorage
+
+
+/** \brief Storage policy: as ListTsStorage, but the graph (its object, vertex records
+ *  and all lists) and the side maps are allocated from a MonotonicArena owned by a TS.
+ *
+ *  Building a TS takes memory from large chunks instead of separate heap allocations
+ *  per node. Destroying it frees the chunks at once: elements are not destroyed one by
+ *  one, except for state and transition bundles that are not trivially destructible.
+ *  Memory of removed states and transitions is not reused until the TS is destroyed.
+ *  The optional index of transitions (see LabeledTS::setTransIndexing()) stays on the heap.
+ */
+struct ArenaTsStorage
+{
+    typedef gr::ArenaListS OutEdgeListS;        ///< Out edge storage selector.
+    typedef gr::ArenaListS VertexListS;         ///< Vertices storage selector.
+    typedef gr::ArenaListS EdgeListS;           ///< Edge list storage selector.
+
+    /** \brief Edge property type for a given bundle. */
+    template<typename TBundle>
+    struct EdgeProperty { typedef TBundle type; };
+
+    /** \brief Allocator of side maps and sets. */
+    template<typename T>
+    struct Allocator { typedef ArenaAllocator<T> type; };
+
+    /** \brief True if states and transitions have dense integer indices. */
+    static const bool DENSE_INDICES = false;
+
+    /** \brief True if a TS allocates its graph and side maps from its own arena. */
+    static const bool ARENA = true;
+}; // struct ArenaTsStorage
+
+#pragma endregion // Storage Policies
+
+
 /** \brief Template base class for labeled transition systems. Primarily defines types.
  *
  *  \tparam TStateID is a type for representing (IDs of) states.
@@ -346,7 +444,8 @@ template<
 
     // additional properties
     typename TStateProperty = boost::no_property,
-    typename TTransProperty = boost::no_property
+    typename TTransProperty = boost::no_property,
+    typename TStorage = ListTsStorage
 >
 class BaseLabeledTS
 {
@@ -364,13 +463,15 @@ public:
      *  The most newest approach is to use BGD directly for making a most appropriate type.
      */
     typedef boost::adjacency_list<
-        boost::listS,               // out edge storage
-        boost::listS,               // vertices storage
+        typename TStorage::OutEdgeListS,    // out edge storage
+        typename TStorage::VertexListS,     // vertices storage
         boost::bidirectionalS,      // bi-directional      
         // properties
         StPropBundle,               // vertex properties
-        TrPropBundle
+        typename TStorage::template EdgeProperty<TrPropBundle>::type,
         //TLabel                    // edge properties
+        boost::no_property,         // graph properties
+        typename TStorage::EdgeListS
     > Graph;
 };
 
@@ -398,6 +499,20 @@ public:
  *  transitions are represented by regular graph vertices, but doesn't have IDs.
  *  So, they are managed by special methods and tracked respectively (by a special set).
  *
+ *  \tparam TStorage is a storage policy of the underlying graph: ListTsStorage (default),
+ *  VecTsStorage, which gives states and transitions dense indices, or ArenaTsStorage,
+ *  which allocates the graph and the side maps from an arena owned by the TS.
+ *
+ *  Optionally (see setTransIndexing()), output transitions of every state are indexed
+ *  by labels, so getTrans() and getFirstOutTrans() do not scan all output transitions.
+ *  The index is maintained by the methods adding and removing transitions (anonymous
+ *  transitions are indexed by their default labels, so lookups give the same results
+ *  as scanning). Labels must not be changed through the graph directly while the
+ *  index is on.
+ *
+ *  Const methods do not modify the TS in any way (there are no lazily built caches),
+ *  so a const TS is a read-only view that several threads may traverse and query
+ *  at the same time without locks, as long as no thread modifies it.
  */
 template<
     typename TStateID, 
@@ -405,11 +520,12 @@ template<
 
     // additional properties
     typename TStateProperty = boost::no_property,
-    typename TTransProperty = boost::no_property//,
+    typename TTransProperty = boost::no_property,
+    typename TStorage = ListTsStorage
 >
 class LabeledTS : 
-    public BaseLabeledTS<TStateID, TLabel, TStateProperty, TTransProperty>, 
-    protected gr::BoostBidiGraphP<typename BaseLabeledTS<TStateID, TLabel, TStateProperty, TTransProperty>::Graph>
+    public BaseLabeledTS<TStateID, TLabel, TStateProperty, TTransProperty, TStorage>, 
+    protected gr::BoostBidiGraphP<typename BaseLabeledTS<TStateID, TLabel, TStateProperty, TTransProperty, TStorage>::Graph>
 {
 public:
     //-----<Traits types>-----
@@ -469,17 +585,35 @@ public:
     //----<Custom data properties>----
 
     /** \brief Alias for a base graph wrapper type. */
-    typedef typename BaseLabeledTS<TStateID, TLabel, TStateProperty, TTransProperty>::Graph Graph;
+    typedef typename BaseLabeledTS<TStateID, TLabel, TStateProperty, TTransProperty, TStorage>::Graph Graph;
     typedef gr::BoostBidiGraphP<Graph> BaseGraph;
 
+    /** \brief True if states and transitions have dense indices (see VecTsStorage). */
+    static const bool DENSE_INDICES = TStorage::DENSE_INDICES;
+
+    /** \brief True if the graph and the side maps are allocated from an arena. */
+    static const bool ARENA = TStorage::ARENA;
+
     /** \brief State type alias for graph Vertex. */
     typedef typename BaseGraph::Vertex State;          // BoostGraphP
 
     /** \brief Transition type alias for graph Edge. */
     typedef typename BaseGraph::Edge Transition;
 
-    /** \brief Iterator for states modeled by vertices of a graph. */
-    typedef typename BaseGraph::VertexIter StateIter;
+    /** \brief Predicate skipping removed states (tombstones) of a dense storage. */
+    struct LiveStateFilter
+    {
+        LiveStateFilter(const std::vector<char>* tombstones = nullptr) : tombs(tombstones) { }
+        bool operator()(State s) const { return !tombs || !isTomb(*tombs, s); }
+        const std::vector<char>* tombs;                                         ///< Tombstones.
+    };
+
+    /** \brief Iterator for states modeled by vertices of a graph; for a dense storage
+     *  it skips removed states.
+     */
+    typedef typename std::conditional<DENSE_INDICES,
+        boost::filter_iterator<LiveStateFilter, typename BaseGraph::VertexIter>,
+        typename BaseGraph::VertexIter>::type StateIter;
 
     /** \brief Iterator for transitions modeled by output edges of a graph. */
     typedef typename BaseGraph::OedgeIter OtransIter;
@@ -491,7 +625,7 @@ public:
     typedef typename BaseGraph::EdgeIter TransIter;
 
     /** \brief A pair of state iterators, which represents a collection of states. */
-    typedef typename BaseGraph::VertexIterPair StateIterPair;
+    typedef std::pair<StateIter, StateIter> StateIterPair;
 
     /** \brief A pair of transition iterators, which represents a collection of output edges. */
     typedef typename BaseGraph::OedgeIterPair OtransIterPair;
@@ -527,13 +661,15 @@ public:
     typedef std::pair<Transition, bool> TransRes;
 
     /** \brief Declares a set of states, mostly for defining anon states. */
-    typedef std::set<State> StateSet;
+    typedef std::set<State, std::less<State>,
+        typename TStorage::template Allocator<State>::type> StateSet;
 
     // т.к. теперь вкладываем состояние непосредственно в вершины, необходимости
     // в двойной мапе нет
 
     /** \brief A more simple map for looking for a state by an id. */
-    typedef std::map<TStateID, State> StateIDStateMap;
+    typedef std::map<TStateID, State, std::less<TStateID>,
+        typename TStorage::template Allocator<std::pair<const TStateID, State> >::type> StateIDStateMap;
 
     /** \brief Pair of element for inserting in a StateIDStateMap object. */
     typedef typename StateIDStateMap::value_type  SISPair;          //SVBPair;
@@ -544,26 +680,58 @@ public:
     /** \brief Using for mapping transitions onto labels. */
     typedef std::map<Transition, TLabel> TransLabelsMap;
 
+    /** \brief Index of output transitions by labels. */
+    typedef TransLblIndex<State, TLabel, Transition> TransIndex;
+
 public:
     /** \brief Constructor. */
     LabeledTS()
+        : BaseGraph(typename BaseGraph::NoCreate())
+        , _tombsNum(0)
+        , _transIdxBound(0)
+        , _arena(nullptr)
     {
         createObjects();
     }
 
     /** \brief Copy constructor */
-    LabeledTS(const LabeledTS& other) : BaseGraph(other)//BaseGraph(other.getGraph())
+    LabeledTS(const LabeledTS& other) : BaseGraph(typename BaseGraph::NoCreate())
+        , _tombs(other._tombs)              // копия графа сохраняет порядок вершин и индексы дуг
+        , _tombsNum(other._tombsNum)
+        , _transIdxBound(other._transIdxBound)
+        , _arena(nullptr)
     {
-        // копированием графа теперь занимается родительский КК, а здесь только доиндексируем мапу идентификаторов
+        // граф копируется сразу туда, где он хранится (у копии своя арена), затем 
+        // доиндексируем мапу идентификаторов
+        createObjects();
+        if constexpr (ARENA)
+            cloneToArena(other);
+        else
+            BaseGraph::clone(other, *this);
         initStID2VertMap();
+
+        // дескрипторы у копии свои, индекс перестраиваем
+        if (other._trIdx)
+            setTransIndexing(true);
     }
 
     /** \brief Virtual destructor. */
     virtual ~LabeledTS() 
     {
-        delete _stid2verts;
-        delete _anonStates;         // ADDED: 11/01/2018
-        BaseGraph::deleteGraph();
+        delete _trIdx;
+        if constexpr (ARENA)
+        {
+            // граф и мапы не разрушаются поэлементно: память освобождается с ареной
+            destroyArenaBundles();
+            BaseGraph::_graph = nullptr;
+            delete _arena;
+        }
+        else
+        {
+            delete _stid2verts;
+            delete _anonStates;         // ADDED: 11/01/2018
+            BaseGraph::deleteGraph();
+        }
         //delete _gr;
     }
 
@@ -627,7 +795,7 @@ public:
     //----<TS Interface through Graph interface>----
 
     /** \brief Return a number of states in the TS. */
-    size_t getStatesNum() const { return BaseGraph::getVerticesNum(); } //{ return _gr.getVerticesNum(); }
+    size_t getStatesNum() const { return BaseGraph::getVerticesNum() - _tombsNum; } //{ return _gr.getVerticesNum(); }
 
     /** \brief Return a number of regular states in the TS. */
     size_t getRegStatesNum() const { return _stid2verts->size(); }
@@ -641,11 +809,21 @@ public:
     /** \brief Returns a collection of States (by a pair of state iterators). */
     inline StateIterPair getStates()
     {
-        return BaseGraph::getVertices();
+        return static_cast<const LabeledTS*>(this)->getStates();
     }
 
     /** \brief Returns a collection of States (by a pair of state iterators)/Const overload. */
-    inline StateIterPair getStates() const { return BaseGraph::getVertices(); }
+    inline StateIterPair getStates() const
+    {
+        if constexpr (DENSE_INDICES)            // пропускаем удаленные
+        {
+            typename BaseGraph::VertexIterPair vs = BaseGraph::getVertices();
+            LiveStateFilter f(&_tombs);
+            return StateIterPair(StateIter(f, vs.first, vs.second), StateIter(f, vs.second, vs.second));
+        }
+        else
+            return BaseGraph::getVertices();
+    }
 
 
     /** \brief Returns a collection of Transitions (by a pair of state iterators). */
@@ -696,7 +874,7 @@ public:
      *
      *  If a state exists, sets a second field of StateRes to true, otherwise sets it to false.
      */
-    StateRes getState(StateIDCArg id)
+    StateRes getState(StateIDCArg id) const
     {
         SISCIter it = _stid2verts->find(id);
         if (it != _stid2verts->end())               // found one
@@ -711,7 +889,7 @@ public:
      */
     State addAnonState()
     {
-        State v = BaseGraph::addVertex();             // новую вершину в граф
+        State v = addVertexInternal();                // новую вершину в граф
         _anonStates->insert(v);
 
         return v;
@@ -732,7 +910,7 @@ public:
     /** \brief Extracts a transition label from a complex transition property
      *  through the given transition.
      */
-    LabelCRes extractTransLbl(const Transition& t)
+    LabelCRes extractTransLbl(const Transition& t) const
     {
         TrPropBundleCRes trBundle = getBundle(t);
         return  TransProperty_traits<TLabel, TTransProperty>::getLbl(trBundle);
@@ -742,8 +920,17 @@ public:
      *  for one labeled with the given label \a lbl. If such a transition exists,
      *  returns true as a second part of a returning value, otherwise returns false there.
      */
-    TransRes getTrans(State s, State t, LabelCArg lbl)
+    TransRes getTrans(State s, State t, LabelCArg lbl) const
     {
+        if (_trIdx)                         // по индексу
+        {
+            const typename TransIndex::StateIndex* si = _trIdx->getStateIndex(s);
+            if (!si)
+                return std::make_pair(Transition(), false);
+
+            return si->find(lbl, [this, t](const Transition& tr) { return getTargState(tr) == t; });
+        }
+
         // новый подход от 16.02.2018
         // перебираем все выходные транзиции данного состояния s
         OtransIter tCur, tEnd;
@@ -769,8 +956,14 @@ public:
      *
      *  \returns If at least one such a transition if found, returns its (arbitrary first).
      */
-    TransRes getFirstOutTrans(State s, LabelCArg lbl)
+    TransRes getFirstOutTrans(State s, LabelCArg lbl) const
     {
+        if (_trIdx)                         // по индексу
+        {
+            const typename TransIndex::StateIndex* si = _trIdx->getStateIndex(s);
+            return si ? si->findFirst(lbl) : TransRes(Transition(), false);
+        }
+
         // перебираем все выходные транзиции данного состояния s
         OtransIter tCur, tEnd;
         for (boost::tie(tCur, tEnd) = getOutTransitions(s); tCur != tEnd; ++tCur)
@@ -792,7 +985,7 @@ public:
      *  It is just a shortcut for a chain of methods getFirstOutTrans() and getTargState().
      *  \returns if a corresponding transition found, returns a corresponding state and true as a second parameter.
      */
-    StateRes getFirstOutState(State s, LabelCArg lbl)
+    StateRes getFirstOutState(State s, LabelCArg lbl) const
     {
         TransRes trRes = getFirstOutTrans(s, lbl);
         if (!trRes.second)
@@ -830,21 +1023,23 @@ public:
      */
     Transition addAnonTrans(State s, State t)
     {
-        Transition trans = BaseGraph::addEdge(s, t);
+        Transition trans = addEdgeInternal(s, t);
         //emplaceTransLbl(getGraph()[trans], lbl);      // вот тут что будет, то будет
+        if (_trIdx)
+            _trIdx->add(s, extractTransLbl(trans), trans);
         return trans;
     }
 
 
     /** \brief Returns the source State (vertex) of the given transitions \param t. */
-    State getSrcState(const Transition& t)
+    State getSrcState(const Transition& t) const
     {
         return BaseGraph::getSrcVertex(t);
         //return boost::source(t, getGraph());
     }
 
     /** \brief Returns the target State (vertex) of the given transitions \param t. */
-    State getTargState(const Transition& t)
+    State getTargState(const Transition& t) const
     {
         return BaseGraph::getTargVertex(t);
         //return boost::target(t, getGraph());
@@ -856,6 +1051,8 @@ public:
      */
     inline void removeTrans(const Transition& t)
     {
+        if (_trIdx)
+            _trIdx->remove(getSrcState(t), extractTransLbl(t), t);
         BaseGraph::removeEdge(t);
         //removeGraphEdge(t);
     }
@@ -885,6 +1082,8 @@ public:
     /** \brief Clears all output transitions of the given state \a s. */
     inline void clearOutTransitions(State s)
     {
+        if (_trIdx)
+            _trIdx->removeState(s);
         BaseGraph::clearOutEdges(s);
         //clearGraphOutEdges(s);
     }
@@ -892,6 +1091,7 @@ public:
     /** \brief Clears all input transitions of the given state \a s. */
     inline void clearInTransitions(State s)
     {
+        unindexInTransitions(s);
         BaseGraph::clearInEdges(s);
         //clearGraphInEdges(s);
     }
@@ -899,6 +1099,9 @@ public:
     /** \brief Clears all (input and output) transitions of the given state \a s. */
     inline void clearTransitions(State s)
     {
+        if (_trIdx)
+            _trIdx->removeState(s);
+        unindexInTransitions(s);
         BaseGraph::clearEdges(s);
         //clearGraphEdges(s);
     }
@@ -921,7 +1124,72 @@ public:
         }
 
         clearTransitions(s);                    // очищаем все дуги (требование!)
-        BaseGraph::removeVertex(s);             // и саму вершину напоследок
+        if constexpr (DENSE_INDICES)            // индексы прочих вершин не трогаем
+            addTomb(s);
+        else
+            removeVertexInternal(s);            // и саму вершину напоследок
+    }
+
+    /** \brief Removes all transitions of a range \a trans at once.
+     *
+     *  Transitions are marked and then the adjacency lists are swept once, so filtering
+     *  a large TS costs O(V + E) instead of O(removed × degree) for removeTrans() called
+     *  for each transition. Duplicates in \a trans are allowed.
+     *  \returns the number of removed transitions.
+     */
+    template<typename TransRange>
+    size_t removeTransitions(const TransRange& trans)
+    {
+        if (_trIdx)
+            for (const Transition& t : trans)
+                _trIdx->remove(getSrcState(t), extractTransLbl(t), t);
+
+        return BaseGraph::removeEdges(trans);
+    }
+
+    /** \brief Removes all states of a range \a states together with their transitions
+     *  at once.
+     *
+     *  Transitions of all the states are removed by a single sweep (see removeTransitions()).
+     *  For a dense storage the states are marked as removed as by removeState(), 
+     *  compact() packs the storage afterwards. Duplicates in \a states are allowed.
+     *  \returns the number of removed states.
+     */
+    template<typename StateRange>
+    size_t removeStates(const StateRange& states)
+    {
+        std::unordered_set<State> marked;
+        std::vector<Transition> trans;
+        for (State s : states)
+        {
+            if (!marked.insert(s).second)
+                continue;
+
+            // петли попадут дважды, это допустимо
+            for (OtransIterPair ots = getOutTransitions(s); ots.first != ots.second; ++ots.first)
+                trans.push_back(*ots.first);
+            for (ItransIterPair its = getInTransitions(s); its.first != its.second; ++its.first)
+                trans.push_back(*its.first);
+        }
+
+        removeTransitions(trans);
+
+        for (State s : marked)
+        {
+            if (isStateAnon(s))
+                _anonStates->erase(s);
+            else
+                _stid2verts->erase(getStateID(s));
+
+            if (_trIdx)
+                _trIdx->removeState(s);
+            if constexpr (DENSE_INDICES)
+                addTomb(s);
+            else
+                removeVertexInternal(s);
+        }
+
+        return marked.size();
     }
 
     /** \brief Returns the numbers of input transitions of a state \a s. */
@@ -935,20 +1203,171 @@ public:
 
     /** \brief Returns true if the given state \a s has output transitions, otherwise false. */
     inline bool hasOutTransitions(State s) const { return getOutTransNum(s) != 0; }
+public:
+    //----<Transitions Index>----
+
+    /** \brief Turns on (\a on is true) or off the index of output transitions by labels.
+     *
+     *  Turning on builds the index over all labeled transitions, so it is preferrable
+     *  to do it before the TS is populated.
+     */
+    void setTransIndexing(bool on)
+    {
+        if (!on)
+        {
+            delete _trIdx;
+            _trIdx = nullptr;
+            return;
+        }
+
+        if (_trIdx)
+            return;
+
+        _trIdx = new TransIndex();
+        TransIterPair ts = getTransitions();
+        for (; ts.first != ts.second; ++ts.first)
+        {
+            const Transition& t = *ts.first;
+            _trIdx->add(getSrcState(t), extractTransLbl(t), t);
+        }
+    }
+
+    /** \brief Returns true if the index of output transitions is on. */
+    bool isTransIndexing() const { return _trIdx != nullptr; }
+
+    /** \brief Returns the index of output transitions or nullptr if it is off. */
+    const TransIndex* getTransIndex() const { return _trIdx; }
+public:
+    //----<Memory>----
+
+    /** \brief Returns memory taken by the TS: graph nodes with embedded state IDs,
+     *  labels and bundles, the map of state IDs, the set of anonymous states and
+     *  the index of transitions.
+     *
+     *  Heap objects referred by state IDs and labels are not counted: they are
+     *  owned by pools and logs.
+     */
+    MemUsage memoryUsage() const
+    {
+        MemUsage mu;
+        mu.add("graph.object", sizeof(Graph));
+        mu.add("graph", BaseGraph::getGraphMemUsage());
+        mu.add("stateIdMap", _stid2verts ? sizeof(StateIDStateMap) + mem::contBytes(*_stid2verts) : 0);
+        mu.add("anonStates", _anonStates ? sizeof(StateSet) + mem::contBytes(*_anonStates) : 0);
+        mu.add("transIndex", _trIdx ? sizeof(TransIndex) + _trIdx->getBytes() : 0);
+        mu.add("tombs", mem::contBytes(_tombs));
+        if (_arena)                                     // занятое арена учтено выше
+            mu.add("arena.unused", _arena->getReservedBytes() - _arena->getUsedBytes());
+        return mu;
+    }
+public:
+    //----<Dense Indices (VecTsStorage)>----
+
+    /** \brief Returns the dense index of a state \a s. */
+    size_t getStateIndex(State s) const
+    {
+        static_assert(DENSE_INDICES, "State indices require a dense storage policy");
+        return s;
+    }
+
+    /** \brief Returns an upper bound of state indices (including removed states). */
+    size_t getStateIndexBound() const { return BaseGraph::getVerticesNum(); }
+
+    /** \brief Returns the dense index of a transition \a t. */
+    size_t getTransIndex(const Transition& t) const
+    {
+        static_assert(DENSE_INDICES, "Transition indices require a dense storage policy");
+        return boost::get(boost::edge_index, getGraph(), t);
+    }
+
+    /** \brief Returns an upper bound of transition indices (including removed transitions). */
+    size_t getTransIndexBound() const { return _transIdxBound; }
+public:
+    /** \brief Returns the arena of the TS; nullptr if the storage policy has no one. */
+    const MonotonicArena* getArena() const { return _arena; }
+
+    /** \brief Returns the number of removed states, which are not compacted yet. */
+    size_t getRemovedStatesNum() const { return _tombsNum; }
+
+    /** \brief Returns true if a state with index \a s has been removed and not compacted yet. */
+    bool isStateRemoved(State s) const { return isTomb(_tombs, s); }
+
+    /** \brief Drops removed states and renumbers states and transitions densely.
+     *
+     *  States keep their relative order; transitions are numbered in the order of
+     *  getTransitions(). All state and transition descriptors become invalid.
+     *  \returns new indices of states by their old indices; removed states are mapped
+     *  onto NO_INDEX.
+     */
+    std::vector<size_t> compact()
+    {
+        static_assert(DENSE_INDICES, "Compaction requires a dense storage policy");
+
+        const Graph& g = getGraph();
+        size_t n = BaseGraph::getVerticesNum();
+        std::vector<size_t> newIdx(n, NO_INDEX);
+
+        Graph* g2 = new Graph();
+        for (State v = 0; v < n; ++v)
+        {
+            if (isTomb(_tombs, v))
+                continue;
+            State v2 = boost::add_vertex(*g2);
+            (*g2)[v2] = g[v];
+            newIdx[v] = v2;
+        }
+
+        // дуги в порядке общего списка, так что порядок выходных дуг сохраняется
+        size_t ti = 0;
+        TransIterPair ts = getTransitions();
+        for (; ts.first != ts.second; ++ts.first)
+        {
+            const Transition& e = *ts.first;
+            Transition e2 = boost::add_edge(newIdx[getSrcState(e)], newIdx[getTargState(e)], *g2).first;
+            (*g2)[e2] = g[e];
+            boost::put(boost::edge_index, *g2, e2, ti++);
+        }
+
+        // перенумеровываем вспомогательные структуры
+        for (typename StateIDStateMap::iterator it = _stid2verts->begin(); it != _stid2verts->end(); ++it)
+            it->second = newIdx[it->second];
+        StateSet* anons = new StateSet();
+        for (State s : *_anonStates)
+            anons->insert(newIdx[s]);
+        delete _anonStates;
+        _anonStates = anons;
+
+        std::swap(BaseGraph::_graph, g2);
+        delete g2;
+        _tombs.clear();
+        _tombsNum = 0;
+        _transIdxBound = ti;
+
+        if (_trIdx)                             // дескрипторы новые
+        {
+            setTransIndexing(false);
+            setTransIndexing(true);
+        }
+
+        return newIdx;
+    }
+
+    /** \brief Index value for removed states. */
+    static constexpr size_t NO_INDEX = (size_t)-1;
 public:
     //----<Associated Properties>----
 
     /** \brief Gets an ID of a state \a st. */
-    inline StateIDCRes getStateID(State st)
+    inline StateIDCRes getStateID(State st) const
     {
         return extractStateID(getGraph()[st]);
     }
 
     /** \brief Return bundled property for the given state \a st. */
-    inline StPropBundleCRes getBundle(State st) { return getGraph()[st]; }
+    inline StPropBundleCRes getBundle(State st) const { return getGraph()[st]; }
 
     /** \brief Return bundled property for the given transition \a tr. */
-    inline TrPropBundleCRes getBundle(const Transition& tr) { return getGraph()[tr]; }
+    inline TrPropBundleCRes getBundle(const Transition& tr) const { return getGraph()[tr]; }
 
 
     /** \brief Returns data, which is associated with the state \a st. 
@@ -979,23 +1398,22 @@ protected:
         BaseGraph::swap(lhv, rhv);
         std::swap(lhv._stid2verts, rhv._stid2verts);
         std::swap(lhv._anonStates, rhv._anonStates);        // ADDED: 11/01/2018
+        std::swap(lhv._trIdx, rhv._trIdx);
+        std::swap(lhv._tombs, rhv._tombs);
+        std::swap(lhv._tombsNum, rhv._tombsNum);
+        std::swap(lhv._transIdxBound, rhv._transIdxBound);
+        std::swap(lhv._arena, rhv._arena);
     }
 
 
-    /** \brief Dedicated method for creating and populating of a stid2Vertices Map. 
+    /** \brief Dedicated method for populating of a stid2Vertices Map and the set of 
+     *  anonymous states by the graph.
      *
-     *  Method should be invocked in a constructor only, where no previously created
-     *  map exists.
+     *  Method should be invocked in a copy constructor only, where the map and the set
+     *  have been just created (see createObjects()).
      */
     void initStID2VertMap()
     {
-        // TODO: анонимные состояния
-
-        // НЕ проверяем, что пред. существует, т.к. по договоренности этот метод
-        // можно вызвать ТОЛЬКО из конструктора, когда этой мапы быть не должно
-        _stid2verts = new StateIDStateMap();
-        _anonStates = new StateSet();           // ADDED: 11/01/2018
-
         // отдельно мапу состояний заполняем по графу: это возможно (индексирование)
         StateIterPair ss = getStates();
         for (; ss.first != ss.second; ++ss.first)
@@ -1016,13 +1434,166 @@ protected:
     }
 
 
-    /** \brief Create all object that this graph composes. */
+    /** \brief Create all object that this graph composes: the (empty) graph, the map
+     *  of state IDs and the set of anonymous states.
+     */
     void createObjects()
     {
+        _trIdx = nullptr;
+        if constexpr (ARENA)
+        {
+            // все объекты — на арене, с аллокаторами, явно привязанными к ней
+            _arena = new MonotonicArena();
+            Graph* g = _arena->create<Graph>();
+            bindToArena(g->m_vertices);
+            bindToArena(g->m_edges);
+            BaseGraph::_graph = g;
+            _stid2verts = _arena->create<StateIDStateMap>(typename StateIDStateMap::allocator_type(_arena));
+            _anonStates = _arena->create<StateSet>(typename StateSet::allocator_type(_arena));
+            return;
+        }
+
+        BaseGraph::createGraph();
         _stid2verts = new StateIDStateMap();
         _anonStates = new StateSet();           // ADDED: 11/01/2018
     }
 
+    /** \brief Binds an empty container \a c, created by default, to the arena. */
+    template<typename TCont>
+    void bindToArena(TCont& c)
+    {
+        c = TCont(typename TCont::allocator_type(_arena));
+    }
+
+    /** \brief Adds a graph vertex; with an arena storage the vertex record and its
+     *  lists of edges are allocated from the arena rather than by BGL on the heap.
+     */
+    State addVertexInternal()
+    {
+        if constexpr (ARENA)
+        {
+            typedef typename Graph::stored_vertex StoredVertex;
+
+            Graph& g = getGraph();
+            StoredVertex* sv = _arena->create<StoredVertex>();
+            bindToArena(sv->m_out_edges);
+            bindToArena(sv->m_in_edges);
+            g.m_vertices.push_back(sv);                 // как boost::add_vertex() для listS
+            sv->m_position = std::prev(g.m_vertices.end());
+
+            return sv;
+        }
+        else
+            return BaseGraph::addVertex();
+    }
+
+    /** \brief Removes a graph vertex \a v having no edges; the record of a vertex 
+     *  allocated from the arena is only destroyed.
+     */
+    void removeVertexInternal(State v)
+    {
+        if constexpr (ARENA)
+        {
+            typedef typename Graph::stored_vertex StoredVertex;
+
+            StoredVertex* sv = static_cast<StoredVertex*>(v);
+            getGraph().m_vertices.erase(sv->m_position);
+            sv->~StoredVertex();
+        }
+        else
+            BaseGraph::removeVertex(v);
+    }
+
+    /** \brief Copies the graph of \a other into the (empty) graph on the arena
+     *  preserving the order of vertices and edges.
+     */
+    void cloneToArena(const LabeledTS& other)
+    {
+        const Graph& src = other.getGraph();
+        Graph& g = getGraph();
+
+        std::unordered_map<State, State> verts(src.m_vertices.size());
+        typename BaseGraph::VertexIterPair vs = boost::vertices(src);
+        for (; vs.first != vs.second; ++vs.first)
+        {
+            State v = addVertexInternal();
+            g[v] = src[*vs.first];
+            verts[*vs.first] = v;
+        }
+
+        typename BaseGraph::EdgeIterPair es = boost::edges(src);
+        for (; es.first != es.second; ++es.first)
+            boost::add_edge(verts[boost::source(*es.first, src)], verts[boost::target(*es.first, src)],
+                src[*es.first], g);
+    }
+
+    /** \brief Before the arena is freed, destroys bundles of states and transitions
+     *  that are not trivially destructible (e.g. labels owning strings); everything 
+     *  else is freed with the arena without being destroyed.
+     */
+    void destroyArenaBundles()
+    {
+        typedef typename StateProperty_traits<TStateID, TStateProperty>::StPropBundle StPropBundle;
+        typedef typename TransProperty_traits<TLabel, TTransProperty>::TrPropBundle TrPropBundle;
+
+        Graph& g = getGraph();
+        if constexpr (!std::is_trivially_destructible<StPropBundle>::value)
+        {
+            typename BaseGraph::VertexIterPair vs = boost::vertices(g);
+            for (; vs.first != vs.second; ++vs.first)
+                g[*vs.first].~StPropBundle();
+        }
+        if constexpr (!std::is_trivially_destructible<TrPropBundle>::value)
+        {
+            for (typename Graph::EdgeContainer::iterator it = g.m_edges.begin(); it != g.m_edges.end(); ++it)
+                it->get_property().~TrPropBundle();
+        }
+        if constexpr (!std::is_trivially_destructible<TStateID>::value)
+            _stid2verts->~StateIDStateMap();
+
+        // свойство графа BGL всегда создает в куче
+        g.m_property.reset();
+    }
+
+    /** \brief Adds a graph edge; for a dense storage numbers it. */
+    Transition addEdgeInternal(State s, State t)
+    {
+        Transition trans = BaseGraph::addEdge(s, t);
+        if constexpr (DENSE_INDICES)
+            boost::put(boost::edge_index, getGraph(), trans, _transIdxBound++);
+
+        return trans;
+    }
+
+    /** \brief Returns true if a state \a s is marked as removed in \a tombs. */
+    static bool isTomb(const std::vector<char>& tombs, State s)
+    {
+        if constexpr (DENSE_INDICES)
+            return s < tombs.size() && tombs[s];
+        else
+            return false;
+    }
+
+    /** \brief Marks a state \a s, which has no transitions, as removed. */
+    void addTomb(State s)
+    {
+        if (_tombs.size() <= s)
+            _tombs.resize(BaseGraph::getVerticesNum(), 0);
+        _tombs[s] = 1;
+        ++_tombsNum;
+    }
+
+    /** \brief Removes input transitions of a state \a s from the index. */
+    void unindexInTransitions(State s)
+    {
+        if (!_trIdx)
+            return;
+
+        ItransIterPair ts = getInTransitions(s);
+        for (; ts.first != ts.second; ++ts.first)
+            _trIdx->remove(getSrcState(*ts.first), extractTransLbl(*ts.first), *ts.first);
+    }
+
 
     //----<Internal method for manipulation of the TS>----
 
@@ -1033,7 +1604,7 @@ protected:
      */
     State addStateInternal(StateIDCArg id)
     {
-        State v = BaseGraph::addVertex();             // вершину в граф
+        State v = addVertexInternal();                // вершину в граф
         emplaceStateID(getGraph()[v], id);
         _stid2verts->insert(SISPair(id, v));    // связываем вершину с ид. = state
 
@@ -1050,8 +1621,10 @@ protected:
     Transition addTransitionInternal(State s, State t, LabelCArg lbl)
     {
         //Transition trans = addGraphEdge(s, t);
-        Transition trans = BaseGraph::addEdge(s, t);
+        Transition trans = addEdgeInternal(s, t);
         emplaceTransLbl(getGraph()[trans], lbl);
+        if (_trIdx)
+            _trIdx->add(s, lbl, trans);
 
         return trans;
     }
@@ -1064,6 +1637,21 @@ protected:
     /** \brief Set of anonymous states. */
     StateSet* _anonStates;
 
+    /** \brief Index of output transitions by labels; nullptr if it is off. */
+    TransIndex* _trIdx;
+
+    /** \brief Removed states of a dense storage, which are not compacted yet. */
+    std::vector<char> _tombs;
+
+    /** \brief Number of removed states in _tombs. */
+    size_t _tombsNum;
+
+    /** \brief Upper bound of transition indices of a dense storage. */
+    size_t _transIdxBound;
+
+    /** \brief Arena of the graph and the side maps; nullptr if the storage has no one. */
+    MonotonicArena* _arena;
+
 }; // class LabeledTS
 
 
@@ -0,0 +1,262 @@
+////////////////////////////////////////////////////////////////////////////////
+/// \file
+/// \brief     Removal-only overlay over an event log TS.
+/// \author    Sergey Shershakov
+/// \version   0.1.0
+/// \date      18.10.2026
+/// \copyright (c) xidv.ru 2014–2017.
+///            This source is for internal use only — Restricted Distribution.
+///            All rights reserved.
+///
+/// EvLogTSOverlay is a view of a source TS for passes that only remove elements
+/// (condensation): removals are recorded in the overlay and the source stays intact.
+/// The overlay supports no added elements.
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef XI_LDOPA_TRSS_MODELS_OVERLAY_TS_H_
+#define XI_LDOPA_TRSS_MODELS_OVERLAY_TS_H_
+
+#pragma once
+
+// ldopa dll
+#include "xi/ldopa/ldopa_dll.h"
+
+// ldopa
+#include "xi/ldopa/ts/models/evlog_ts_red.h"
+
+// boost
+#include <boost/functional/hash.hpp>
+#include <boost/iterator/filter_iterator.hpp>
+
+// std
+#include <unordered_map>
+#include <unordered_set>
+
+namespace xi { namespace ldopa { namespace ts {;   //
+
+
+/** \brief Removal-only view of EvLogTSWithFreqs.
+ *
+ *  The overlay refers to a source TS read-only and records only what differs from
+ *  it: removed states and transitions, and changed frequencies and state flags.
+ *  Removing a state removes all its transitions, as in the source TS. Traversal
+ *  methods follow the interface of EvLogTSWithFreqs and skip removed elements, so
+ *  the overlay can be analyzed (e.g. frozen, see FrozenEvLogTS) without copying the
+ *  source. A standalone TS is made by materialize(), which copies only the elements
+ *  that are left.
+ *
+ *  States and transitions of the overlay are the ones of the source TS, thus they
+ *  remain valid while the source TS is alive and unchanged; the source must not be
+ *  modified while the overlay is used.
+ *
+ *  The overlay is removal-only: adding new elements is not supported, for states of 
+ *  the overlay are vertices of the source graph and a new state could not be linked
+ *  with them. Algorithms that grow a TS (e.g. VarWsTsBuilder) take a standalone TS,
+ *  such as one made by materialize() or CondensedTsBuilder::build().
+ */
+class LDOPA_API EvLogTSOverlay {
+public:
+    //-----<Types>-----
+
+    /** \brief Type of the source TS. */
+    typedef EvLogTSWithFreqs TS;
+
+    typedef TS::Attribute Attribute;
+    typedef TS::State State;
+    typedef TS::StateRes StateRes;
+    typedef TS::Transition Transition;
+    typedef TS::TransRes TransRes;
+    typedef TS::IntRes IntRes;
+    typedef TS::StateFlags StateFlags;
+    typedef TS::StateFlagsRes StateFlagsRes;
+    typedef TS::Uint Uint;
+
+    /** \brief Predicate for skipping removed states. */
+    struct LiveStateFilter {
+        LiveStateFilter() : ovl(nullptr) {}
+        LiveStateFilter(const EvLogTSOverlay* o) : ovl(o) {}
+        bool operator()(State s) const { return !ovl->isStateRemoved(s); }
+
+        const EvLogTSOverlay* ovl;
+    };
+
+    /** \brief Predicate for skipping removed transitions. */
+    struct LiveTransFilter {
+        LiveTransFilter() : ovl(nullptr) {}
+        LiveTransFilter(const EvLogTSOverlay* o) : ovl(o) {}
+        bool operator()(const Transition& t) const { return !ovl->isTransRemoved(t); }
+
+        const EvLogTSOverlay* ovl;
+    };
+
+    // iterators
+    typedef boost::filter_iterator<LiveStateFilter, TS::StateIter> StateIter;
+    typedef boost::filter_iterator<LiveTransFilter, TS::TransIter> TransIter;
+    typedef boost::filter_iterator<LiveTransFilter, TS::OtransIter> OtransIter;
+    typedef boost::filter_iterator<LiveTransFilter, TS::ItransIter> ItransIter;
+
+    typedef std::pair<StateIter, StateIter> StateIterPair;
+    typedef std::pair<TransIter, TransIter> TransIterPair;
+    typedef std::pair<OtransIter, OtransIter> OtransIterPair;
+    typedef std::pair<ItransIter, ItransIter> ItransIterPair;
+
+    /** \brief Set of states. */
+    typedef std::unordered_set<State> SetOfStates;
+
+    /** \brief Set of transitions. */
+    typedef std::unordered_set<Transition, boost::hash<Transition>> SetOfTrans;
+public:
+    /** \brief Constructor makes an overlay with no changes over a source TS \a src. 
+     *
+     *  \a src may be null only if the overlay is not used.
+     */
+    explicit EvLogTSOverlay(const TS* src);
+
+public:
+    //----<Changes>----
+
+    /** \brief Removes a state \a s together with all its transitions. */
+    void removeState(State s);
+
+    /** \brief Removes a transition \a t. */
+    void removeTrans(const Transition& t);
+
+    /** \brief Sets a new value \a freq of frequency for a transition \a t. */
+    void setTransFreq(Transition t, int freq) { _freqs[t] = freq; }
+
+    /** \brief Sets new state flags \a sf for a state \a s. */
+    void setStateFlags(State s, StateFlags sf) { _flags[s] = sf; }
+
+    /** \brief Sets a state \a s to be accepting one or not. */
+    void setAcceptingState(State s, bool accepting);
+
+    /** \brief Drops all changes, so the overlay coincides with the source TS again. */
+    void reset();
+
+    /** \brief Makes a standalone TS consisting of states and transitions left
+     *  in the overlay.
+     *
+     *  States and transitions are added in the order of the source TS.
+     *  The resulting TS is managed by the caller.
+     */
+    TS* materialize() const;
+
+public:
+    //----<Basic TS interface>----
+
+    /** \brief Returns the number of states left. */
+    size_t getStatesNum() const { return _src->getStatesNum() - _remStates.size(); }
+
+    /** \brief Returns the number of transitions left. */
+    size_t getTransitionsNum() const { return _src->getTransitionsNum() - _remTrans.size(); }
+
+    /** \brief Returns the initial state of the source TS. */
+    State getInitState() const { return _src->getInitState(); }
+
+    /** \brief Returns the ID of the initial state. */
+    const IStateId* getInitStateID() const { return _src->getInitStateID(); }
+
+    /** \brief Returns true if a state \a s is removed. */
+    bool isStateRemoved(State s) const { return _remStates.find(s) != _remStates.end(); }
+
+    /** \brief Returns true if a transition \a t is removed. */
+    bool isTransRemoved(const Transition& t) const { return _remTrans.find(t) != _remTrans.end(); }
+
+    /** \brief Returns states left. */
+    StateIterPair getStates() const;
+
+    /** \brief Returns transitions left. */
+    TransIterPair getTransitions() const;
+
+    /** \brief Returns output transitions of a state \a s left. */
+    OtransIterPair getOutTransitions(State s) const;
+
+    /** \brief Returns input transitions of a state \a s left. */
+    ItransIterPair getInTransitions(State s) const;
+
+    /** \brief Returns true if a state \a s has input transitions left. */
+    bool hasInTransitions(State s) const
+    {
+        ItransIterPair its = getInTransitions(s);
+        return its.first != its.second;
+    }
+
+    /** \brief Returns true if a state \a s has output transitions left. */
+    bool hasOutTransitions(State s) const
+    {
+        OtransIterPair ots = getOutTransitions(s);
+        return ots.first != ots.second;
+    }
+
+    /** \brief Returns the source state of a transition \a t. */
+    State getSrcState(const Transition& t) const { return _src->getSrcState(t); }
+
+    /** \brief Returns the target state of a transition \a t. */
+    State getTargState(const Transition& t) const { return _src->getTargState(t); }
+
+    /** \brief Returns the label of a transition \a t. */
+    const Attribute& getTransLbl(const Transition& t) const { return _src->getTransLbl(t); }
+
+    /** \brief Returns an output transition of a state \a s labeled by \a lbl, which
+     *  is not removed.
+     */
+    TransRes getFirstOutTrans(State s, const Attribute& lbl) const;
+
+    /** \brief Returns true if a state \a s is anonymous. */
+    bool isStateAnon(State s) const { return _src->isStateAnon(s); }
+
+    /** \brief Returns the ID of a state \a s. */
+    const IStateId* getStateID(State s) const { return _src->getStateID(s); }
+
+public:
+    //----<Attributes>----
+
+    /** \brief Returns the frequency of a transition \a t. */
+    IntRes getTransFreq(Transition t) const;
+
+    /** \brief Returns flags of a state \a s. */
+    StateFlagsRes getStateFlags(State s) const;
+
+    /** \brief Returns true if a state \a s is accepting. */
+    bool isStateAccepting(State s) const;
+
+    /** \brief Returns the number of traces of the source TS. */
+    Uint getTracesNum() const { return _src->getTracesNum(); }
+
+    /** \brief Returns MaxWS attribute of the source TS. */
+    int getMaxWS() const { return _src->getMaxWS(); }
+
+    /** \brief Returns the source TS. */
+    const TS* getSrcTS() const { return _src; }
+
+    /** \brief Returns the number of removed states. */
+    size_t getRemovedStatesNum() const { return _remStates.size(); }
+
+    /** \brief Returns the number of removed transitions. */
+    size_t getRemovedTransNum() const { return _remTrans.size(); }
+
+    /** \brief Returns memory taken by the overlay itself, without the source TS. */
+    MemUsage memoryUsage() const;
+protected:
+    /** \brief Source TS. */
+    const TS* _src;
+
+    /** \brief Removed states. */
+    SetOfStates _remStates;
+
+    /** \brief Removed transitions, including ones of removed states. */
+    SetOfTrans _remTrans;
+
+    /** \brief Changed frequencies of transitions. */
+    std::unordered_map<Transition, int, boost::hash<Transition>> _freqs;
+
+    /** \brief Changed flags of states. */
+    std::unordered_map<State, StateFlags> _flags;
+}; // class EvLogTSOverlay
+
+
+}}} // namespace xi { namespace ldopa { namespace ts {
+
+
+#endif // XI_LDOPA_TRSS_MODELS_OVERLAY_TS_H_
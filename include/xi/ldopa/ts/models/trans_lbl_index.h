@@ -0,0 +1,263 @@
+////////////////////////////////////////////////////////////////////////////////
+/// \file
+/// \brief     Per-state index of output transitions by their labels.
+/// \author    Sergey Shershakov
+/// \version   0.1.0
+/// \date      18.10.2026
+/// \copyright (c) xidv.ru 2014–2017.
+///            This source is for internal use only — Restricted Distribution.
+///            All rights reserved.
+///
+/// Used by LabeledTS to look up output transitions of a state by a label without
+/// scanning all of them.
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef XI_LDOPA_TRSS_MODELS_TRANS_LBL_INDEX_H_
+#define XI_LDOPA_TRSS_MODELS_TRANS_LBL_INDEX_H_
+
+#pragma once
+
+// ldopa
+#include "xi/ldopa/utils/mem_usage.h"
+
+// std
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace xi { namespace ldopa { namespace ts {;   //
+
+
+/** \brief Index of output transitions of a single state by their labels.
+ *
+ *  While a state has a few output transitions, they are kept in a small vector
+ *  sorted by labels (O(log d) lookup, no extra allocations); when the number of
+ *  them exceeds HASH_THRESHOLD, the index switches to a hash multimap (O(1) lookup)
+ *  and switches back when the number drops below a half of the threshold.
+ *  Several transitions may share a label (nondeterministic TS), so lookups
+ *  take a predicate to choose among them.
+ *
+ *  \tparam TLabel is a label type; requires operator<, operator== and std::hash.
+ *  \tparam TTrans is a transition (edge descriptor) type.
+ */
+template<typename TLabel, typename TTrans>
+class StateTransLblIndex {
+public:
+    //-----<Types>-----
+
+    /** \brief Entry of the index: a label and a transition marked by it. */
+    typedef std::pair<TLabel, TTrans> Entry;
+
+    /** \brief Small sorted storage. */
+    typedef std::vector<Entry> EntriesVector;
+
+    /** \brief Hashed storage. */
+    typedef std::unordered_multimap<TLabel, TTrans, std::hash<TLabel>> EntriesHash;
+
+    /** \brief Number of transitions after which the index becomes hashed. */
+    static const size_t HASH_THRESHOLD = 16;
+public:
+    StateTransLblIndex() {}
+
+    StateTransLblIndex(const StateTransLblIndex& that)
+        : _vec(that._vec)
+        , _hash(that._hash ? new EntriesHash(*that._hash) : nullptr)
+    {
+    }
+
+    StateTransLblIndex& operator=(StateTransLblIndex that)
+    {
+        _vec.swap(that._vec);
+        _hash.swap(that._hash);
+        return *this;
+    }
+public:
+
+    /** \brief Adds a transition \a t labeled by \a lbl. */
+    void add(const TLabel& lbl, const TTrans& t)
+    {
+        if (_hash)
+        {
+            _hash->emplace(lbl, t);
+            return;
+        }
+
+        _vec.insert(upperBound(lbl), Entry(lbl, t));
+        if (_vec.size() > HASH_THRESHOLD)
+            toHash();
+    }
+
+    /** \brief Removes a transition \a t labeled by \a lbl.
+     *  \returns false if there is no such an entry.
+     */
+    bool remove(const TLabel& lbl, const TTrans& t)
+    {
+        if (_hash)
+        {
+            auto rng = _hash->equal_range(lbl);
+            for (auto it = rng.first; it != rng.second; ++it)
+                if (it->second == t)
+                {
+                    _hash->erase(it);
+                    if (_hash->size() < HASH_THRESHOLD / 2)
+                        toVector();
+                    return true;
+                }
+            return false;
+        }
+
+        for (auto it = lowerBound(lbl); it != _vec.end() && !(lbl < it->first); ++it)
+            if (it->second == t)
+            {
+                _vec.erase(it);
+                return true;
+            }
+        return false;
+    }
+
+    /** \brief Looks for a transition labeled by \a lbl satisfying a predicate \a pred.
+     *
+     *  \returns a transition and true if found, otherwise false as the second part.
+     */
+    template<typename TPred>
+    std::pair<TTrans, bool> find(const TLabel& lbl, TPred pred) const
+    {
+        if (_hash)
+        {
+            auto rng = _hash->equal_range(lbl);
+            for (auto it = rng.first; it != rng.second; ++it)
+                if (pred(it->second))
+                    return std::make_pair(it->second, true);
+            return std::make_pair(TTrans(), false);
+        }
+
+        for (auto it = lowerBound(lbl); it != _vec.end() && !(lbl < it->first); ++it)
+            if (it->first == lbl && pred(it->second))
+                return std::make_pair(it->second, true);
+        return std::make_pair(TTrans(), false);
+    }
+
+    /** \brief Looks for an arbitrary transition labeled by \a lbl. */
+    std::pair<TTrans, bool> findFirst(const TLabel& lbl) const
+    {
+        return find(lbl, [](const TTrans&) { return true; });
+    }
+
+    /** \brief Returns the number of indexed transitions. */
+    size_t getSize() const { return _hash ? _hash->size() : _vec.size(); }
+
+    /** \brief Returns true if the index is hashed. */
+    bool isHashed() const { return (bool)_hash; }
+
+    /** \brief Returns heap memory taken by the index. */
+    size_t getBytes() const
+    {
+        return mem::contBytes(_vec) + (_hash ? sizeof(EntriesHash) + mem::contBytes(*_hash) : 0);
+    }
+protected:
+    typename EntriesVector::iterator upperBound(const TLabel& lbl)
+    {
+        return std::upper_bound(_vec.begin(), _vec.end(), lbl,
+            [](const TLabel& l, const Entry& e) { return l < e.first; });
+    }
+
+    typename EntriesVector::iterator lowerBound(const TLabel& lbl)
+    {
+        return std::lower_bound(_vec.begin(), _vec.end(), lbl,
+            [](const Entry& e, const TLabel& l) { return e.first < l; });
+    }
+
+    typename EntriesVector::const_iterator lowerBound(const TLabel& lbl) const
+    {
+        return std::lower_bound(_vec.begin(), _vec.end(), lbl,
+            [](const Entry& e, const TLabel& l) { return e.first < l; });
+    }
+
+    /** \brief Moves entries from the vector to the hash. */
+    void toHash()
+    {
+        _hash.reset(new EntriesHash(_vec.begin(), _vec.end()));
+        EntriesVector().swap(_vec);
+    }
+
+    /** \brief Moves entries from the hash to the sorted vector. */
+    void toVector()
+    {
+        _vec.assign(_hash->begin(), _hash->end());
+        std::stable_sort(_vec.begin(), _vec.end(),
+            [](const Entry& a, const Entry& b) { return a.first < b.first; });
+        _hash.reset();
+    }
+protected:
+    EntriesVector _vec;                     ///< Sorted entries while the state has a few transitions.
+    std::unique_ptr<EntriesHash> _hash;     ///< Hashed entries, if not null.
+}; // class StateTransLblIndex
+
+
+/** \brief Index of output transitions of all states of a TS. */
+template<typename TState, typename TLabel, typename TTrans>
+class TransLblIndex {
+public:
+    /** \brief Index of a single state. */
+    typedef StateTransLblIndex<TLabel, TTrans> StateIndex;
+
+    /** \brief Maps states onto their indices. */
+    typedef std::unordered_map<TState, StateIndex> StatesMap;
+public:
+
+    /** \brief Adds a transition \a t from a state \a s labeled by \a lbl. */
+    void add(TState s, const TLabel& lbl, const TTrans& t) { _states[s].add(lbl, t); }
+
+    /** \brief Removes a transition \a t from a state \a s labeled by \a lbl. */
+    bool remove(TState s, const TLabel& lbl, const TTrans& t)
+    {
+        typename StatesMap::iterator it = _states.find(s);
+        if (it == _states.end())
+            return false;
+
+        bool res = it->second.remove(lbl, t);
+        if (it->second.getSize() == 0)
+            _states.erase(it);
+        return res;
+    }
+
+    /** \brief Drops the index of a state \a s. */
+    void removeState(TState s) { _states.erase(s); }
+
+    /** \brief Returns the index of a state \a s or nullptr if there are no
+     *  indexed transitions.
+     */
+    const StateIndex* getStateIndex(TState s) const
+    {
+        typename StatesMap::const_iterator it = _states.find(s);
+        return it == _states.end() ? nullptr : &it->second;
+    }
+
+    /** \brief Returns the number of states having indexed transitions. */
+    size_t getStatesNum() const { return _states.size(); }
+
+    /** \brief Clears the index. */
+    void clear() { _states.clear(); }
+
+    /** \brief Returns heap memory taken by the index. */
+    size_t getBytes() const
+    {
+        size_t bytes = mem::contBytes(_states);
+        for (const auto& si : _states)
+            bytes += si.second.getBytes();
+
+        return bytes;
+    }
+protected:
+    StatesMap _states;                      ///< Per-state indices.
+}; // class TransLblIndex
+
+
+}}} // namespace xi { namespace ldopa { namespace ts {
+
+
+#endif // XI_LDOPA_TRSS_MODELS_TRANS_LBL_INDEX_H_
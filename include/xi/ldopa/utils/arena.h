@@ -0,0 +1,183 @@
+////////////////////////////////////////////////////////////////////////////////
+/// \file
+/// \brief     Monotonic arena and an allocator working on it.
+/// \author    Sergey Shershakov
+/// \version   0.1.0
+/// \date      18.10.2026
+/// \copyright (c) xidv.ru 2014–2018.
+///            This source is for internal use only — Restricted Distribution.
+///            All rights reserved.
+///
+/// MonotonicArena hands out memory from large chunks and frees it only all at
+/// once. ArenaAllocator is a standard allocator over an arena given to it explicitly.
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef XI_LDOPA_UTILS_ARENA_H_
+#define XI_LDOPA_UTILS_ARENA_H_
+
+#pragma once
+
+// ldopa dll
+#include "xi/ldopa/ldopa_dll.h"
+
+// std
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace xi { namespace ldopa { ;   //
+
+
+/** \brief Monotonic arena: memory is taken from chunks by bumping a pointer and is
+ *  given back only by release() or destruction.
+ *
+ *  Chunks grow twice up to MAX_CHUNK_SIZE; larger requests get chunks of their own.
+ *  The arena is not thread-safe.
+ */
+class LDOPA_API MonotonicArena {
+public:
+    /** \brief Default size of the first chunk. */
+    static const size_t DEF_CHUNK_SIZE = 64 * 1024;
+
+    /** \brief Maximum size of a regular chunk. */
+    static const size_t MAX_CHUNK_SIZE = 4 * 1024 * 1024;
+public:
+    /** \brief Constructor sets a size of the first chunk \a chunkSize; no memory is
+     *  reserved until the first allocation.
+     */
+    explicit MonotonicArena(size_t chunkSize = DEF_CHUNK_SIZE);
+
+    /** \brief Destructor frees all chunks. */
+    ~MonotonicArena();
+protected:
+    MonotonicArena(const MonotonicArena&);                  // Prevent copy-construction
+    MonotonicArena& operator=(const MonotonicArena&);       // Prevent assignment
+public:
+    /** \brief Allocates \a bytes aligned by \a align (a power of 2). */
+    void* allocate(size_t bytes, size_t align)
+    {
+        if (_cur)
+        {
+            char* p = alignUp(_cur, align);
+            if (p + bytes <= _end)
+            {
+                _cur = p + bytes;
+                _used += bytes;
+                return p;
+            }
+        }
+
+        return allocateSlow(bytes, align);
+    }
+
+    /** \brief Frees all chunks at once; memory allocated before becomes invalid. */
+    void release();
+
+    /** \brief Returns a number of bytes in chunks. */
+    size_t getReservedBytes() const { return _reserved; }
+
+    /** \brief Returns a number of bytes handed out since the last release. */
+    size_t getUsedBytes() const { return _used; }
+
+    /** \brief Returns a number of chunks. */
+    size_t getChunksNum() const { return _chunks.size(); }
+
+    /** \brief Allocates memory for an object of type \a T and constructs it by \a args.
+     *
+     *  The object is never destroyed by the arena.
+     */
+    template<typename T, typename... Args>
+    T* create(Args&&... args)
+    {
+        return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+protected:
+    /** \brief Aligns a pointer \a p up by \a align. */
+    static char* alignUp(char* p, size_t align)
+    {
+        return (char*)(((size_t)p + align - 1) & ~(align - 1));
+    }
+
+    /** \brief Takes a new chunk and allocates from it. */
+    void* allocateSlow(size_t bytes, size_t align);
+protected:
+    std::vector<char*> _chunks;             ///< Chunks.
+    char* _cur;                             ///< Free space of the last chunk.
+    char* _end;                             ///< End of the last chunk.
+    size_t _chunkSize;                      ///< Size of the next regular chunk.
+    size_t _reserved;                       ///< Bytes in chunks.
+    size_t _used;                           ///< Bytes handed out.
+}; // class MonotonicArena
+
+
+/** \brief Standard allocator over a MonotonicArena.
+ *
+ *  The arena is given explicitly; a default constructed allocator uses the heap.
+ *  Deallocation of arena memory does nothing. A container moved into another one
+ *  takes its arena along, so a container created by default (e.g. inside a BGL 
+ *  graph) is bound to an arena by assigning an empty container with an arena
+ *  allocator to it. Copies of containers use the heap, so a copy does not depend 
+ *  on the lifetime of the source arena.
+ */
+template<typename T>
+class ArenaAllocator {
+public:
+    typedef T value_type;
+    typedef std::true_type propagate_on_container_move_assignment;
+    typedef std::true_type propagate_on_container_swap;
+public:
+    /** \brief Default constructor makes an allocator using the heap. */
+    ArenaAllocator() : _arena(nullptr) {}
+
+    /** \brief Constructor with an explicit \a arena; nullptr means the heap. */
+    explicit ArenaAllocator(MonotonicArena* arena) : _arena(arena) {}
+
+    /** \brief Rebinding constructor. */
+    template<typename U>
+    ArenaAllocator(const ArenaAllocator<U>& that) : _arena(that.getArena()) {}
+public:
+    T* allocate(size_t n)
+    {
+        if (_arena)
+            return static_cast<T*>(_arena->allocate(n * sizeof(T), alignof(T)));
+
+        return static_cast<T*>(::operator new(n * sizeof(T)));
+    }
+
+    void deallocate(T* p, size_t)
+    {
+        if (!_arena)
+            ::operator delete(p);
+    }
+
+    /** \brief Copies of containers use the heap. */
+    ArenaAllocator select_on_container_copy_construction() const { return ArenaAllocator(); }
+
+    /** \brief Returns the arena; nullptr for the heap. */
+    MonotonicArena* getArena() const { return _arena; }
+protected:
+    /** \brief Arena; nullptr for the heap. */
+    MonotonicArena* _arena;
+}; // class ArenaAllocator
+
+
+template<typename T, typename U>
+bool operator==(const ArenaAllocator<T>& lhv, const ArenaAllocator<U>& rhv)
+{
+    return lhv.getArena() == rhv.getArena();
+}
+
+template<typename T, typename U>
+bool operator!=(const ArenaAllocator<T>& lhv, const ArenaAllocator<U>& rhv)
+{
+    return !(lhv == rhv);
+}
+
+
+}} // namespace xi { namespace ldopa {
+
+
+#endif // XI_LDOPA_UTILS_ARENA_H_
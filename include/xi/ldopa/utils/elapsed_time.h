@@ -15,12 +15,17 @@
 //#pragma once
 
 
+#include <chrono>
 #include <ctime>
 
 
-// utility macros
-#define XI_LDOPA_ELAPSEDTIME_START(timer) clock_t timer = clock();
-#define XI_LDOPA_ELAPSEDTIME_STOP(timer) _elapsed = (double)(clock() - timer) * 1000.0 / CLOCKS_PER_SEC;
+// utility macros; time is measured by a wall clock, for clock() sums up CPU time 
+// of all threads of the process
+#define XI_LDOPA_ELAPSEDTIME_START(timer) \
+    std::chrono::steady_clock::time_point timer = std::chrono::steady_clock::now();
+#define XI_LDOPA_ELAPSEDTIME_STOP_TO(timer, dst) \
+    dst = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - timer).count();
+#define XI_LDOPA_ELAPSEDTIME_STOP(timer) XI_LDOPA_ELAPSEDTIME_STOP_TO(timer, _elapsed)
 
 
 namespace xi { namespace ldopa { ;   //
@@ -0,0 +1,232 @@
+////////////////////////////////////////////////////////////////////////////////
+/// \file
+/// \brief     Accounting of memory taken by models, pools and logs.
+/// \author    Sergey Shershakov
+/// \version   0.1.0
+/// \date      18.10.2026
+/// \copyright (c) xidv.ru 2014–2018.
+///            This source is for internal use only — Restricted Distribution.
+///            All rights reserved.
+///
+/// MemUsage is a report of bytes per named component; helpers in xi::ldopa::mem
+/// count bytes of standard containers and BGL adjacency lists from their sizes,
+/// capacities and node layouts.
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef XI_LDOPA_UTILS_MEM_USAGE_H_
+#define XI_LDOPA_UTILS_MEM_USAGE_H_
+
+#pragma once
+
+// ldopa dll
+#include "xi/ldopa/ldopa_dll.h"
+
+// boost
+#include <boost/graph/adjacency_list.hpp>
+
+// std
+#include <list>
+#include <map>
+#include <ostream>
+#include <set>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace xi { namespace ldopa { ;   //
+
+
+/** \brief Report of memory taken by an object, in bytes per component.
+ *
+ *  Components are named by dotted paths (e.g. "graph.edges"); reports of nested
+ *  objects are merged with a prefix, so reports of several objects can be
+ *  aggregated into one. Components keep the order of their first addition.
+ */
+class LDOPA_API MemUsage {
+public:
+    /** \brief A component: its name and size in bytes. */
+    typedef std::pair<std::string, size_t> Component;
+
+    /** \brief Components in the order of addition. */
+    typedef std::vector<Component> Components;
+public:
+    /** \brief Adds \a bytes to a component \a name; creates it if needed. */
+    void add(const std::string& name, size_t bytes);
+
+    /** \brief Adds all components of \a other, prepending \a prefix and a dot to
+     *  their names (if \a prefix is not empty).
+     */
+    void add(const std::string& prefix, const MemUsage& other);
+
+    /** \brief Returns the size of a component \a name; 0 if there is no one. */
+    size_t getBytes(const std::string& name) const;
+
+    /** \brief Returns the total size of all components. */
+    size_t getTotal() const;
+
+    /** \brief Returns all components. */
+    const Components& getComponents() const { return _comps; }
+
+    /** \brief Prints components one per line and the total. */
+    void print(std::ostream& os) const;
+protected:
+    /** \brief Components. */
+    Components _comps;
+}; // class MemUsage
+
+
+/** \brief Helpers for counting bytes of standard containers and BGL graphs.
+ *
+ *  Sizes of nodes follow the layout of the standard library in use (see the 
+ *  constants below). Only heap memory is counted, not the container objects themselves.
+ */
+namespace mem {
+
+// раскладка узлов зависит от реализации стандартной библиотеки
+#if defined(_MSC_VER) && !defined(_LIBCPP_VERSION)
+
+// MSVC STL: у списков и деревьев есть выделяемый в куче узел-заголовок; 
+// unordered-контейнеры — список значений и вектор пар итераторов на корзину
+const size_t LIST_NODE_OVERHEAD = 2 * sizeof(void*);
+const size_t TREE_NODE_OVERHEAD = 4 * sizeof(void*);
+const size_t HASH_NODE_OVERHEAD = 2 * sizeof(void*);
+const size_t HASH_BUCKET_BYTES = 2 * sizeof(void*);
+const size_t HEAD_NODES = 1;
+const bool EMBEDDED_BUCKET = false;
+const size_t STRING_SSO_CAP = 15;
+
+#elif defined(_LIBCPP_VERSION)
+
+// libc++: хеш в узле хранится всегда, единственная корзина не встроена
+const size_t LIST_NODE_OVERHEAD = 2 * sizeof(void*);
+const size_t TREE_NODE_OVERHEAD = 4 * sizeof(void*);
+const size_t HASH_NODE_OVERHEAD = 2 * sizeof(void*);
+const size_t HASH_BUCKET_BYTES = sizeof(void*);
+const size_t HEAD_NODES = 0;
+const bool EMBEDDED_BUCKET = false;
+const size_t STRING_SSO_CAP = 3 * sizeof(void*) - 2;
+
+#else
+
+// libstdc++: узел хеш-контейнера — ссылка и закешированный хеш
+const size_t LIST_NODE_OVERHEAD = 2 * sizeof(void*);
+const size_t TREE_NODE_OVERHEAD = 4 * sizeof(void*);
+const size_t HASH_NODE_OVERHEAD = 2 * sizeof(void*);
+const size_t HASH_BUCKET_BYTES = sizeof(void*);
+const size_t HEAD_NODES = 0;
+const bool EMBEDDED_BUCKET = true;
+const size_t STRING_SSO_CAP = 15;
+
+#endif
+
+// LIST_NODE_OVERHEAD — служебные байты узла std::list;
+// TREE_NODE_OVERHEAD — узла std::set/std::map;
+// HASH_NODE_OVERHEAD — узла unordered-контейнеров, HASH_BUCKET_BYTES — их корзины;
+// HEAD_NODES — число узлов-заголовков списка или дерева в куче;
+// EMBEDDED_BUCKET — единственная корзина встроена в сам контейнер;
+// STRING_SSO_CAP — емкость строки без выделения памяти
+
+/** \brief Heap bytes of \a n buckets of an unordered container. */
+inline size_t bucketsBytes(size_t n)
+{
+    return (EMBEDDED_BUCKET && n <= 1) ? 0 : n * HASH_BUCKET_BYTES;
+}
+
+/** \brief Heap bytes of \a n nodes with elements of \a elSize bytes and
+ *  \a overhead service bytes each, including head nodes.
+ */
+inline size_t nodesBytes(size_t n, size_t elSize, size_t overhead)
+{
+    return (n + HEAD_NODES) * (elSize + overhead);
+}
+
+/** \brief Heap bytes of a string. */
+inline size_t contBytes(const std::string& s)
+{
+    return s.capacity() > STRING_SSO_CAP ? s.capacity() + 1 : 0;
+}
+
+template<typename T, typename A>
+size_t contBytes(const std::vector<T, A>& c) { return c.capacity() * sizeof(T); }
+
+template<typename T, typename A>
+size_t contBytes(const std::list<T, A>& c) { return nodesBytes(c.size(), sizeof(T), LIST_NODE_OVERHEAD); }
+
+template<typename K, typename C, typename A>
+size_t contBytes(const std::set<K, C, A>& c) { return nodesBytes(c.size(), sizeof(K), TREE_NODE_OVERHEAD); }
+
+template<typename K, typename C, typename A>
+size_t contBytes(const std::multiset<K, C, A>& c) { return nodesBytes(c.size(), sizeof(K), TREE_NODE_OVERHEAD); }
+
+template<typename K, typename V, typename C, typename A>
+size_t contBytes(const std::map<K, V, C, A>& c)
+{
+    return nodesBytes(c.size(), sizeof(typename std::map<K, V, C, A>::value_type), TREE_NODE_OVERHEAD);
+}
+
+template<typename K, typename V, typename H, typename E, typename A>
+size_t contBytes(const std::unordered_map<K, V, H, E, A>& c)
+{
+    return bucketsBytes(c.bucket_count()) + nodesBytes(c.size(),
+        sizeof(typename std::unordered_map<K, V, H, E, A>::value_type), HASH_NODE_OVERHEAD);
+}
+
+template<typename K, typename V, typename H, typename E, typename A>
+size_t contBytes(const std::unordered_multimap<K, V, H, E, A>& c)
+{
+    return bucketsBytes(c.bucket_count()) + nodesBytes(c.size(),
+        sizeof(typename std::unordered_multimap<K, V, H, E, A>::value_type), HASH_NODE_OVERHEAD);
+}
+
+template<typename K, typename H, typename E, typename A>
+size_t contBytes(const std::unordered_set<K, H, E, A>& c)
+{
+    return bucketsBytes(c.bucket_count()) + nodesBytes(c.size(), sizeof(K), HASH_NODE_OVERHEAD);
+}
+
+
+/** \brief Bytes of stored vertices besides the vertex container: with list
+ *  storages (vertex descriptors are pointers) every vertex is allocated separately.
+ */
+template<typename G>
+size_t storedVertexBytes(const G& g)
+{
+    if (!std::is_pointer<typename boost::graph_traits<G>::vertex_descriptor>::value)
+        return 0;
+
+    return boost::num_vertices(g) * sizeof(typename G::stored_vertex);
+}
+
+
+/** \brief Counts heap memory of a bidirectional BGL adjacency list \a g.
+ *
+ *  Components: "vertices" (vertex nodes with their bundles), "edges" (edge nodes
+ *  with their bundles) and "adjacency" (output and input edge lists of vertices).
+ */
+template<typename G>
+MemUsage graphMemUsage(const G& g)
+{
+    MemUsage mu;
+    mu.add("vertices", contBytes(g.m_vertices) + storedVertexBytes(g));
+    mu.add("edges", contBytes(g.m_edges));
+
+    size_t adj = 0;
+    typename boost::graph_traits<G>::vertex_iterator vCur, vEnd;
+    for (boost::tie(vCur, vEnd) = boost::vertices(g); vCur != vEnd; ++vCur)
+        adj += contBytes(g.out_edge_list(*vCur)) + contBytes(in_edge_list(g, *vCur));
+    mu.add("adjacency", adj);
+
+    return mu;
+}
+
+} // namespace mem
+
+
+}} // namespace xi { namespace ldopa {
+
+
+#endif // XI_LDOPA_UTILS_MEM_USAGE_H_
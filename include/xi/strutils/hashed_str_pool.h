@@ -0,0 +1,233 @@
+////////////////////////////////////////////////////////////////////////////////
+/// \file
+/// \brief     Hashed string pools storing characters in a bump arena.
+/// \author    Sergey Shershakov
+/// \version   0.1.0
+/// \date      18.10.2026
+/// \copyright (c) xidv.ru 2014–2017.
+///            This source is for internal use only — Restricted Distribution.
+///            All rights reserved.
+///
+/// Unlike SetStrPool, the pools below look strings up by std::string_view in a hash
+/// table and keep characters of unique strings in large chunks, so neither lookups
+/// nor insertions construct std::string objects.
+///
+////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef XILIB_XI_STRUTILS_HASHED_STR_POOL_H_
+#define XILIB_XI_STRUTILS_HASHED_STR_POOL_H_
+
+
+#include "xi/xilib_dll.h"
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+namespace xi {namespace strutils {; //
+
+
+//==============================================================================
+// class StrArena
+//==============================================================================
+
+/** \brief Bump allocator for characters of pooled strings.
+ *
+ *  Strings are copied one after another into chunks of a fixed size; a string that
+ *  does not fit into the rest of the current chunk opens a new one. Chunks are never
+ *  reallocated, so stored strings do not move until the arena is cleared.
+ *  Every stored string is followed by a zero character.
+ */
+class XILIB_API StrArena {
+public:
+    /** \brief Default size of a chunk in bytes. */
+    static const std::size_t DEF_CHUNK_SIZE = 64 * 1024;
+public:
+    /** \brief Constructs an arena with chunks of \a chunkSize bytes. */
+    explicit StrArena(std::size_t chunkSize = DEF_CHUNK_SIZE);
+protected:
+    StrArena(const StrArena&);                  // Prevent copy-construction
+    StrArena& operator=(const StrArena&);       // Prevent assignment
+public:
+
+    /** \brief Copies \a str into the arena and returns a view of the copy. */
+    std::string_view store(std::string_view str);
+
+    /** \brief Frees all chunks. Invalidates all views given before. */
+    void clear();
+
+    /** \brief Returns the number of bytes taken by chunks. */
+    std::size_t getAllocatedSize() const { return _allocated; }
+
+    /** \brief Returns the number of bytes taken by stored strings. */
+    std::size_t getUsedSize() const { return _used; }
+
+    /** \brief Returns the chunk size. */
+    std::size_t getChunkSize() const { return _chunkSize; }
+protected:
+    /** \brief Chunks of the arena. */
+    typedef std::vector<std::unique_ptr<char[]>> Chunks;
+protected:
+    Chunks _chunks;                 ///< Allocated chunks.
+    char* _cur;                     ///< Free space of the current chunk.
+    std::size_t _left;              ///< Number of free bytes in the current chunk.
+    std::size_t _chunkSize;         ///< Size of a regular chunk.
+    std::size_t _allocated;         ///< Total size of chunks.
+    std::size_t _used;              ///< Total size of stored strings.
+}; // class StrArena
+
+
+//==============================================================================
+// class HashedStrPool
+//==============================================================================
+
+/** \brief Pool of unique strings based on a hash table and an arena.
+ *
+ *  insert() returns a view of the permanent copy of a string; two views obtained
+ *  for equal strings have the same data() pointer, so they can be compared and
+ *  hashed by the pointer. Views stay valid until the pool is cleared or destroyed.
+ *  The pool is not thread-safe; see ConcurrentStrPool.
+ */
+class XILIB_API HashedStrPool {
+public:
+    //-----<Types>-----
+
+    /** \brief View of a pooled string along with its hash. */
+    struct HashedView {
+        std::string_view str;
+        std::size_t hash;
+
+        bool operator==(const HashedView& rhv) const { return str == rhv.str; }
+    };
+
+    /** \brief Hasher returning a precomputed hash. */
+    struct HashedViewHash {
+        std::size_t operator()(const HashedView& v) const { return v.hash; }
+    };
+
+    /** \brief Set of pooled strings. */
+    typedef std::unordered_set<HashedView, HashedViewHash> StrsSet;
+public:
+    /** \brief Constructs a pool whose arena has chunks of \a chunkSize bytes. */
+    explicit HashedStrPool(std::size_t chunkSize = StrArena::DEF_CHUNK_SIZE);
+protected:
+    HashedStrPool(const HashedStrPool&);                    // Prevent copy-construction
+    HashedStrPool& operator=(const HashedStrPool&);         // Prevent assignment
+public:
+
+    /** \brief Inserts a given string \a str and returns a view of its pooled copy. */
+    std::string_view insert(std::string_view str) { return insert(str, hashOf(str)); }
+
+    /** \brief Inserts a given string \a str whose hash \a h is already calculated. */
+    std::string_view insert(std::string_view str, std::size_t h);
+
+    /** \brief Operator acts in the same way as insert() method. */
+    std::string_view operator[](std::string_view str) { return insert(str); }
+
+    /** \brief Returns a view of the pooled copy of \a str or an empty view with
+     *  nullptr data if there is no such a string in the pool.
+     */
+    std::string_view find(std::string_view str) const { return find(str, hashOf(str)); }
+
+    /** \brief Looks up a given string \a str whose hash \a h is already calculated. */
+    std::string_view find(std::string_view str, std::size_t h) const;
+
+    /** \brief Returns true if \a str is a view given by this pool. */
+    bool contains(std::string_view str) const;
+
+    /** \brief Returns a number of strings in the pool. */
+    std::size_t getSize() const { return _set.size(); }
+
+    /** \brief Clears the pool. Invalidates all views given before. */
+    void clear();
+
+    /** \brief Returns an underlying set. */
+    const StrsSet& getPool() const { return _set; }
+
+    /** \brief Returns the arena storing characters. */
+    const StrArena& getArena() const { return _arena; }
+
+    /** \brief Hash function used by the pool. */
+    static std::size_t hashOf(std::string_view str) { return std::hash<std::string_view>()(str); }
+protected:
+    StrsSet _set;                   ///< Views of pooled strings.
+    StrArena _arena;                ///< Characters of pooled strings.
+}; // class HashedStrPool
+
+
+//==============================================================================
+// class ConcurrentStrPool
+//==============================================================================
+
+/** \brief Thread-safe pool of unique strings split into independent shards.
+ *
+ *  A string goes to a shard determined by its hash; every shard is a HashedStrPool
+ *  guarded by its own mutex. So concurrent loaders interning different strings
+ *  rarely wait for each other, and the hash is calculated only once per call.
+ *  Returned views have the same guarantees as ones of HashedStrPool.
+ */
+class XILIB_API ConcurrentStrPool {
+public:
+    /** \brief Default number of shards. */
+    static const std::size_t DEF_SHARDS_NUM = 16;
+public:
+    /** \brief Constructs a pool with \a shardsNum shards (rounded up to a power
+     *  of two).
+     */
+    explicit ConcurrentStrPool(std::size_t shardsNum = DEF_SHARDS_NUM,
+        std::size_t chunkSize = StrArena::DEF_CHUNK_SIZE);
+protected:
+    ConcurrentStrPool(const ConcurrentStrPool&);                // Prevent copy-construction
+    ConcurrentStrPool& operator=(const ConcurrentStrPool&);     // Prevent assignment
+public:
+
+    /** \brief Inserts a given string \a str and returns a view of its pooled copy. */
+    std::string_view insert(std::string_view str);
+
+    /** \brief Operator acts in the same way as insert() method. */
+    std::string_view operator[](std::string_view str) { return insert(str); }
+
+    /** \brief Returns a view of the pooled copy of \a str or an empty view with
+     *  nullptr data if there is no such a string in the pool.
+     */
+    std::string_view find(std::string_view str) const;
+
+    /** \brief Returns a number of strings in the pool. */
+    std::size_t getSize() const;
+
+    /** \brief Returns the number of shards. */
+    std::size_t getShardsNum() const { return _shards.size(); }
+
+    /** \brief Clears the pool. Invalidates all views given before. */
+    void clear();
+protected:
+    /** \brief Shard of the pool. */
+    struct Shard {
+        explicit Shard(std::size_t chunkSize) : pool(chunkSize) {}
+
+        HashedStrPool pool;
+        mutable std::mutex mtx;
+    };
+
+    /** \brief Returns a shard for a hash \a h. */
+    Shard& getShard(std::size_t h) const
+    {
+        // старшие биты: младшие использует хеш-таблица шарда
+        return *_shards[(h >> 7) & _mask];
+    }
+protected:
+    std::vector<std::unique_ptr<Shard>> _shards;    ///< Shards.
+    std::size_t _mask;                              ///< Number of shards minus one.
+}; // class ConcurrentStrPool
+
+
+//------------------------------------------------------------------------------
+}} // namespaces
+
+
+#endif // XILIB_XI_STRUTILS_HASHED_STR_POOL_H_
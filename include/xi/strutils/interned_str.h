@@ -0,0 +1,209 @@
+////////////////////////////////////////////////////////////////////////////////
+/// \file
+/// \brief     Interned strings and a pool producing them.
+/// \author    Sergey Shershakov
+/// \version   0.1.0
+/// \date      18.10.2026
+/// \copyright (c) xidv.ru 2014–2017.
+///            This source is for internal use only — Restricted Distribution.
+///            All rights reserved.
+///
+/// An interned string is a brief handle to a single permanent instance of a string
+/// value stored in a pool along with its precomputed hash. Handles from the same
+/// pool are compared by pointers. The pool looks strings up by std::string_view in
+/// the same way as ConcurrentStrPool, so that interning a known string allocates
+/// no memory.
+///
+////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef XILIB_XI_STRUTILS_INTERNED_STR_H_
+#define XILIB_XI_STRUTILS_INTERNED_STR_H_
+
+
+#include "xi/xilib_dll.h"
+#include "xi/strutils/hashed_str_pool.h"
+
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace xi {namespace strutils {; //
+
+
+class XILIB_API InternStrPool;
+
+
+/** \brief Service info stored in a pool along with every interned string. */
+struct InternedStrMeta {
+    std::size_t hash;               ///< Precomputed hash of the string.
+    const InternStrPool* pool;      ///< Owner pool.
+}; // struct InternedStrMeta
+
+
+//==============================================================================
+// class InternedStr
+//==============================================================================
+
+/** \brief Handle of a string interned in an InternStrPool.
+ *
+ *  The handle is a single pointer, so copying it is trivial. Two handles of the same
+ *  pool are equal iff they point to the same entry; handles of different pools are
+ *  compared by hashes and then by contents. Ordering is always by contents, so that
+ *  interned strings are ordered in the same way as plain ones.
+ *  A default constructed handle is null and is less than any non-null one.
+ */
+class XILIB_API InternedStr {
+public:
+    //-----<Types>-----
+
+    /** \brief Pool entry: the string itself and its service info. */
+    typedef std::pair<const std::string, InternedStrMeta> Entry;
+public:
+    /** \brief Default constructor: null handle. */
+    InternedStr() : _e(nullptr) {}
+
+    /** \brief Constructs a handle for a pool entry \a e. */
+    explicit InternedStr(const Entry* e) : _e(e) {}
+public:
+    /** \brief Returns the string; empty string for a null handle. */
+    const std::string& str() const { return _e ? _e->first : emptyStr(); }
+
+    /** \brief Returns a pointer to the pooled string or nullptr for a null handle. */
+    const std::string* strP() const { return _e ? &_e->first : nullptr; }
+
+    /** \brief Returns the precomputed hash of the string. */
+    std::size_t hash() const { return _e ? _e->second.hash : 0; }
+
+    /** \brief Returns the owner pool or nullptr for a null handle. */
+    const InternStrPool* getPool() const { return _e ? _e->second.pool : nullptr; }
+
+    /** \brief Returns true for a null handle. */
+    bool isNull() const { return _e == nullptr; }
+
+    /** \brief Returns the pool entry. */
+    const Entry* getEntry() const { return _e; }
+public:
+    //-----<Operators>-----
+
+    bool operator==(const InternedStr& rhv) const
+    {
+        if (_e == rhv._e)
+            return true;
+        if (!_e || !rhv._e || _e->second.pool == rhv._e->second.pool)
+            return false;               // в одном пуле строка единственна
+
+        return _e->second.hash == rhv._e->second.hash && _e->first == rhv._e->first;
+    }
+
+    bool operator!=(const InternedStr& rhv) const { return !operator==(rhv); }
+
+    bool operator<(const InternedStr& rhv) const
+    {
+        if (_e == rhv._e || !rhv._e)
+            return false;
+        if (!_e)
+            return true;
+
+        return _e->first < rhv._e->first;
+    }
+
+protected:
+    /** \brief Returns a static empty string. */
+    static const std::string& emptyStr();
+protected:
+    const Entry* _e;                ///< Pool entry.
+}; // class InternedStr
+
+
+//==============================================================================
+// class InternStrPool
+//==============================================================================
+
+/** \brief Pool of unique strings producing InternedStr handles.
+ *
+ *  Entries are never moved, so handles stay valid until the pool is cleared or
+ *  destroyed. As in ConcurrentStrPool, a string goes to a shard determined by its
+ *  hash and every shard is guarded by its own mutex, so a pool can be shared by
+ *  several concurrent loaders. Lookups go by std::string_view: memory is allocated
+ *  only for an entry of a new string.
+ *  A process-wide pool is available through global().
+ */
+class XILIB_API InternStrPool {
+public:
+    //-----<Types>-----
+
+    /** \brief Index of a shard: views of pooled strings to their entries. */
+    typedef std::unordered_map<HashedStrPool::HashedView, const InternedStr::Entry*,
+        HashedStrPool::HashedViewHash> StrsIndex;
+public:
+    /** \brief Constructs a pool with \a shardsNum shards (rounded up to a power
+     *  of two).
+     */
+    explicit InternStrPool(std::size_t shardsNum = ConcurrentStrPool::DEF_SHARDS_NUM);
+protected:
+    InternStrPool(const InternStrPool&);                    // Prevent copy-construction
+    InternStrPool& operator=(const InternStrPool&);         // Prevent assignment
+public:
+
+    /** \brief Interns a string \a str and returns a handle to its pooled instance. */
+    InternedStr intern(std::string_view str);
+
+    /** \brief Operator acts in the same way as intern() method. */
+    InternedStr operator[](std::string_view str) { return intern(str); }
+
+    /** \brief Returns a handle to the pooled instance of \a str or a null handle
+     *  if there is no such a string in the pool.
+     */
+    InternedStr find(std::string_view str) const;
+
+    /** \brief Returns a number of strings in the pool. */
+    std::size_t getSize() const;
+
+    /** \brief Returns the number of shards. */
+    std::size_t getShardsNum() const { return _shards.size(); }
+
+    /** \brief Returns a number of heap bytes taken by the pool: buckets, entries
+     *  and buffers of long strings.
+     */
+    std::size_t getBytes() const;
+
+    /** \brief Clears the pool.
+     *
+     *  This will invalidate all externally keeped handles.
+     */
+    void clear();
+
+    /** \brief Returns a process-wide pool. */
+    static InternStrPool& global();
+protected:
+    /** \brief Shard of the pool. */
+    struct Shard {
+        StrsIndex index;
+        std::deque<InternedStr::Entry> entries;     ///< Deque does not move elements.
+        mutable std::mutex mtx;
+    };
+
+    /** \brief Returns a shard for a hash \a h. */
+    Shard& getShard(std::size_t h) const
+    {
+        // как в ConcurrentStrPool: младшие биты использует хеш-таблица шарда
+        return *_shards[(h >> 7) & _mask];
+    }
+protected:
+    std::vector<std::unique_ptr<Shard>> _shards;    ///< Shards.
+    std::size_t _mask;                              ///< Number of shards minus one.
+}; // class InternStrPool
+
+
+//------------------------------------------------------------------------------
+}} // namespaces
+
+
+#endif // XILIB_XI_STRUTILS_INTERNED_STR_H_
@@ -22,8 +22,10 @@
 
 #include "xi/xilib_dll.h"
 
+#include <functional>
 #include <set>
 #include <string>
+#include <string_view>
 
 namespace xi {namespace strutils {; //
 
@@ -31,7 +33,7 @@ namespace xi {namespace strutils {; //
 // экспорт конкретизированных шаблонов в DLL
 // это должно быть ДО использования в нижележащих классах
 #ifdef XILIB_DLL
-XILIB_EXPIMP_TEMPLATE template class XILIB_API std::set<std::string>;
+XILIB_EXPIMP_TEMPLATE template class XILIB_API std::set<std::string, std::less<>>;
 #endif // XILIB_DLL
 
 
@@ -44,11 +46,15 @@ XILIB_EXPIMP_TEMPLATE template class XILIB_API std::set<std::string>;
  *  are preserving their elements from being reconstructed when new elments are added to containers:
  *    - http://stackoverflow.com/questions/5182122/pointers-to-elements-of-stl-containers
  *    - http://stackoverflow.com/questions/20938441/implementing-a-string-pool-that-is-guaranteed-not-to-move
+ *
+ *  The set uses a transparent comparator, so looking up an already pooled string
+ *  does not construct a temporary <CODE>std::string</CODE>. For large pools
+ *  HashedStrPool and ConcurrentStrPool (hashed_str_pool.h) are preferrable.
  */
 class XILIB_API SetStrPool {
 public:
     //-----<Types>-----
-    typedef std::set<std::string> StrsSet;
+    typedef std::set<std::string, std::less<>> StrsSet;
     
     /** \brief Iterator type for StrsSet */
     typedef StrsSet::iterator StrsSetIter;
@@ -57,7 +63,7 @@ public:
     /** \brief Inserts a given string \a str into a set and returns a const 
      *  pointer to its internal (permanent) copy.
      */
-    const std::string* insert(const std::string& str);
+    const std::string* insert(std::string_view str);
 
     /** \brief Clears the pool. 
      *
@@ -67,7 +73,12 @@ public:
     void clear();
 
     /** \brief Operator acts in the same way as insert() method */
-    const std::string* operator[](const std::string& str);
+    const std::string* operator[](std::string_view str) { return insert(str); }
+
+    /** \brief Returns a pointer to the pooled copy of \a str or nullptr if there is
+     *  no such a string in the pool.
+     */
+    const std::string* find(std::string_view str) const;
 
     /** \brief Returns an underlying pool set */
     StrsSet& getPool() { return _pool;  }
@@ -0,0 +1,370 @@
+////////////////////////////////////////////////////////////////////////////////
+// Module Name:  compact_attr.h/cpp
+// Authors:      Sergey Shershakov
+// Version:      0.1.0
+// Date:         18.10.2026
+// Copyright (c) xidv.ru 2014–2017.
+//
+// This source is for internal use only — Restricted Distribution.
+// All rights reserved.
+////////////////////////////////////////////////////////////////////////////////
+
+#include "xi/attributes/compact_attr.h"
+
+#include <functional>
+#include <stdexcept>
+#include <type_traits>
+
+namespace xi { namespace attributes {; //
+
+static_assert(sizeof(CompactAttribute) == 16, "CompactAttribute must take 16 bytes");
+static_assert(std::is_trivially_copyable<CompactAttribute>::value,
+    "CompactAttribute must be trivially copyable");
+
+namespace {
+
+// перемешивание для числовых значений (splitmix64)
+inline std::uint32_t mixNum(std::uint64_t v, unsigned t)
+{
+    v += 0x9E3779B97F4A7C15ull * (t + 1);
+    v = (v ^ (v >> 30)) * 0xBF58476D1CE4E5B9ull;
+    v = (v ^ (v >> 27)) * 0x94D049BB133111EBull;
+    return (std::uint32_t)(v ^ (v >> 31));
+}
+
+// хеш строки согласован с std::hash<std::string>, т.е. и с InternedStr::hash()
+inline std::uint32_t hashStr(std::string_view s)
+{
+    return (std::uint32_t)std::hash<std::string_view>()(s);
+}
+
+} // anonymous namespace
+
+
+//==============================================================================
+// class CompactAttribute
+//==============================================================================
+
+CompactAttribute::CompactAttribute(double val)
+{
+    clear();
+    if (val == 0.0)
+        val = 0.0;                      // -0.0 == 0.0, хеши должны совпадать
+    std::memcpy(_buf, &val, sizeof(val));
+    _tag = tDouble;
+
+    std::uint64_t bits;
+    std::memcpy(&bits, &val, sizeof(bits));
+    _hash = mixNum(bits, tDouble);
+}
+
+//------------------------------------------------------------------------------
+
+CompactAttribute::CompactAttribute(const InternedStr& s)
+{
+    clear();
+    if (s.isNull())
+        return;
+
+    const InternedStr::Entry* e = s.getEntry();
+    std::memcpy(_buf, &e, sizeof(e));
+    _tag = tInternedStr;
+    _hash = (std::uint32_t)s.hash();
+}
+
+//------------------------------------------------------------------------------
+
+CompactAttribute::CompactAttribute(const StringSharedPtr& s)
+{
+    clear();
+    if (s)
+        setStr(*s);
+}
+
+//------------------------------------------------------------------------------
+
+CompactAttribute::CompactAttribute(const VarAttribute1& a)
+{
+    clear();
+
+    typedef VarAttribute1 VA;
+    const VA::BaseVariant& v = a.getRef();
+    switch (a.getType())
+    {
+    case VA::tBlank:
+        break;
+    case VA::tChar:
+        setNum(tChar, boost::get<char>(v));
+        break;
+    case VA::tUChar:
+        setNum(tUChar, boost::get<unsigned char>(v));
+        break;
+    case VA::tInt:
+        setNum(tInt, boost::get<int>(v));
+        break;
+    case VA::tUInt:
+        setNum(tUInt, boost::get<unsigned int>(v));
+        break;
+    case VA::tInt64:
+        setNum(tInt64, boost::get<xi::types::TInt64>(v));
+        break;
+    case VA::tUInt64:
+        setNum(tUInt64, (xi::types::TInt64)boost::get<xi::types::TQword>(v));
+        break;
+    case VA::tDouble:
+        *this = CompactAttribute(boost::get<double>(v));
+        break;
+    case VA::tVoidP:
+        setPtr(tVoidP, boost::get<void*>(v));
+        break;
+    case VA::tVoidCP:
+        setPtr(tVoidCP, boost::get<const void*>(v));
+        break;
+    case VA::tCharP:
+    case VA::tCharCP:
+    {
+        const char* s = (a.getType() == VA::tCharP) ? boost::get<char*>(v) : boost::get<const char*>(v);
+        if (s)
+            setStr(s);
+        break;
+    }
+    case VA::tCStrSharedArr:
+    {
+        const CStrSharedArr& s = boost::get<CStrSharedArr>(v);
+        if (s)
+            setStr(s.get());
+        break;
+    }
+    case VA::tStringSharedPtr:
+        *this = CompactAttribute(boost::get<StringSharedPtr>(v));
+        break;
+    case VA::tInternedStr:
+        *this = CompactAttribute(boost::get<InternedStr>(v));
+        break;
+    case VA::tDestrObjSharedPtr:
+    {
+        const DestrByteArray* ba = dynamic_cast<const DestrByteArray*>(a.asDestrObj());
+        if (!ba)
+            throw std::invalid_argument("Can't convert an owned object to a compact attribute.");
+
+        *this = bytes(ba->getArr(), ba->getSize());
+        break;
+    }
+    }
+}
+
+//------------------------------------------------------------------------------
+
+// static
+CompactAttribute CompactAttribute::bytes(const void* data, std::size_t size)
+{
+    CompactAttribute a;
+    a.setStr(std::string_view((const char*)data, size));
+
+    return a;
+}
+
+//------------------------------------------------------------------------------
+
+// static
+xi::strutils::InternStrPool& CompactAttribute::strPool()
+{
+    return xi::strutils::InternStrPool::global();
+}
+
+//------------------------------------------------------------------------------
+
+int CompactAttribute::compare(const CompactAttribute& rhv) const
+{
+    // все строковые представления — один тип
+    AType lt = getType();
+    AType rt = rhv.getType();
+    AType lc = lt >= tSmallStr ? tSmallStr : lt;
+    AType rc = rt >= tSmallStr ? tSmallStr : rt;
+    if (lc != rc)
+        return lc < rc ? -1 : 1;
+
+    switch (lc)
+    {
+    case tBlank:
+        return 0;
+    case tUInt64:
+    {
+        xi::types::TQword l = (xi::types::TQword)loadNum();
+        xi::types::TQword r = (xi::types::TQword)rhv.loadNum();
+        return l < r ? -1 : (r < l ? 1 : 0);
+    }
+    case tDouble:
+    {
+        double l = asDouble();
+        double r = rhv.asDouble();
+        return l < r ? -1 : (r < l ? 1 : 0);
+    }
+    case tVoidP:
+    case tVoidCP:
+    {
+        std::uintptr_t l = (std::uintptr_t)loadPtr();
+        std::uintptr_t r = (std::uintptr_t)rhv.loadPtr();
+        return l < r ? -1 : (r < l ? 1 : 0);
+    }
+    case tSmallStr:
+    {
+        // пулированные строки с одинаковыми указателями — одна и та же строка
+        if (lt == rt && lt != tSmallStr && std::memcmp(_buf, rhv._buf, sizeof(void*)) == 0)
+            return 0;
+
+        int res = asStrView().compare(rhv.asStrView());
+        return res < 0 ? -1 : (res > 0 ? 1 : 0);
+    }
+    default:                            // знаковые целые
+    {
+        xi::types::TInt64 l = loadNum();
+        xi::types::TInt64 r = rhv.loadNum();
+        return l < r ? -1 : (r < l ? 1 : 0);
+    }
+    }
+}
+
+//------------------------------------------------------------------------------
+
+double CompactAttribute::asDouble() const
+{
+    if (getType() == tDouble)
+    {
+        double d;
+        std::memcpy(&d, _buf, sizeof(d));
+        return d;
+    }
+
+    return (double)asInt64();
+}
+
+//------------------------------------------------------------------------------
+
+std::string_view CompactAttribute::asStrView() const
+{
+    switch (getType())
+    {
+    case tSmallStr:
+        return std::string_view(_buf, _tag >> 4);
+    case tPooledStr:
+    {
+        const unsigned char* l = (const unsigned char*)_buf + sizeof(void*);
+        std::uint32_t len = l[0] | (l[1] << 8) | (l[2] << 16);
+        return std::string_view((const char*)loadPtr(), len);
+    }
+    case tInternedStr:
+        return static_cast<const InternedStr::Entry*>(loadPtr())->first;
+    default:
+        return std::string_view();
+    }
+}
+
+//------------------------------------------------------------------------------
+
+std::string CompactAttribute::toString() const
+{
+    switch (getType())
+    {
+    case tBlank:
+        return "<Empty>";
+    case tChar:
+        return std::string(1, (char)loadNum());
+    case tUInt64:
+        return std::to_string((xi::types::TQword)loadNum());
+    case tDouble:
+        return std::to_string(asDouble());
+    case tVoidP:
+    case tVoidCP:
+        return std::to_string(reinterpret_cast<std::uintptr_t>(loadPtr()));
+    case tSmallStr:
+    case tPooledStr:
+    case tInternedStr:
+        return std::string(asStrView());
+    default:
+        return std::to_string(loadNum());
+    }
+}
+
+//------------------------------------------------------------------------------
+
+VarAttribute1 CompactAttribute::toVar() const
+{
+    switch (getType())
+    {
+    case tBlank:
+        return VarAttribute1();
+    case tChar:
+        return VarAttribute1((char)loadNum());
+    case tUChar:
+        return VarAttribute1((unsigned char)loadNum());
+    case tInt:
+        return VarAttribute1((int)loadNum());
+    case tUInt:
+        return VarAttribute1((unsigned int)loadNum());
+    case tInt64:
+        return VarAttribute1(loadNum());
+    case tUInt64:
+        return VarAttribute1((xi::types::TQword)loadNum());
+    case tDouble:
+        return VarAttribute1(asDouble());
+    case tVoidP:
+        return VarAttribute1(const_cast<void*>(loadPtr()));
+    case tVoidCP:
+        return VarAttribute1(loadPtr());
+    case tInternedStr:
+        return VarAttribute1(InternedStr(static_cast<const InternedStr::Entry*>(loadPtr())));
+    default:                            // tSmallStr, tPooledStr
+        return VarAttribute1(std::string(asStrView()));
+    }
+}
+
+//------------------------------------------------------------------------------
+
+void CompactAttribute::setNum(AType t, xi::types::TInt64 val)
+{
+    clear();
+    std::memcpy(_buf, &val, sizeof(val));
+    _tag = (std::uint8_t)t;
+    _hash = mixNum((std::uint64_t)val, t);
+}
+
+//------------------------------------------------------------------------------
+
+void CompactAttribute::setPtr(AType t, const void* p)
+{
+    clear();
+    std::memcpy(_buf, &p, sizeof(p));
+    _tag = (std::uint8_t)t;
+    _hash = mixNum((std::uint64_t)(std::uintptr_t)p, t);
+}
+
+//------------------------------------------------------------------------------
+
+void CompactAttribute::setStr(std::string_view s)
+{
+    clear();
+    _hash = hashStr(s);
+
+    if (s.size() <= SSO_CAP)
+    {
+        std::memcpy(_buf, s.data(), s.size());
+        _tag = (std::uint8_t)(tSmallStr | (s.size() << 4));
+        return;
+    }
+
+    if (s.size() > MAX_POOLED_LEN)
+        throw std::length_error("String is too long for a compact attribute.");
+
+    const char* p = strPool().intern(s).str().data();   // элементы пула не перемещаются
+    std::uint32_t len = (std::uint32_t)s.size();
+    std::memcpy(_buf, &p, sizeof(p));
+    _buf[sizeof(p)] = (char)(len & 0xFF);               // 3 байта длины
+    _buf[sizeof(p) + 1] = (char)((len >> 8) & 0xFF);
+    _buf[sizeof(p) + 2] = (char)((len >> 16) & 0xFF);
+    _tag = tPooledStr;
+}
+
+
+}
+} // namespaces
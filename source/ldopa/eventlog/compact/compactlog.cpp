@@ -0,0 +1,766 @@
+////////////////////////////////////////////////////////////////////////////////
+// Module Name:  compactlog.h/cpp
+// Authors:      Sergey Shershakov
+// Version:      0.1.0
+// Date:         18.10.2026
+// Copyright (c) xidv.ru 2014–2017.
+//
+// This source is for internal use only — Restricted Distribution.
+// All rights reserved.
+////////////////////////////////////////////////////////////////////////////////
+
+
+// ldopa
+#include "xi/ldopa/eventlog/compact/compactlog.h"
+#include "xi/ldopa/utils.h"
+
+// std
+#include <algorithm>    // std::upper_bound
+#include <memory>       // std::unique_ptr
+
+
+namespace xi { namespace ldopa { namespace eventlog {;   //
+
+
+//==============================================================================
+// class CompactAttrsEnumerator
+//==============================================================================
+
+/** \brief Enumerator owning a (small) vector of attributes. */
+class CompactAttrsEnumerator : public BaseAttributesEnumerator {
+public:
+    typedef CompactLog_traits::NmAttributesVector NmAttributesVector;
+public:
+    CompactAttrsEnumerator(NmAttributesVector&& attrs)
+        : _attrs(std::move(attrs)), _cur(0) {}
+public:
+    virtual bool hasNext() const override
+    {
+        return _cur < _attrs.size();
+    }
+
+    virtual NamedAttribute getNext() override
+    {
+        if (_cur >= _attrs.size())
+            throw std::range_error("Enumeration has no more elements.");
+        return _attrs[_cur++];
+    }
+
+    virtual void reset() override
+    {
+        _cur = 0;
+    }
+protected:
+    NmAttributesVector _attrs;      ///< Owned attributes.
+    size_t _cur;                    ///< Current position.
+}; // class CompactAttrsEnumerator
+
+
+
+//==============================================================================
+// class CompactEvent
+//==============================================================================
+
+
+bool CompactEvent::getAttr(const char* id, Attribute& a)
+{
+    return _owner->_owner->getEventAttrInternal(_actCode, _timest, id, a);
+}
+
+//------------------------------------------------------------------------------
+
+int CompactEvent::getAttrsNum()
+{
+    return _owner->_owner->_data->_withTimests ? 2 : 1;
+}
+
+//------------------------------------------------------------------------------
+
+IAttributesEnumerator* CompactEvent::getAttrs()
+{
+    return _owner->_owner->makeEventAttrsEnum(_actCode, _timest);
+}
+
+//------------------------------------------------------------------------------
+
+IEventTrace* CompactEvent::getTrace()
+{
+    return _owner;
+}
+
+
+
+//==============================================================================
+// class CompactTrace
+//==============================================================================
+
+
+CompactTrace::CompactTrace(CompactLog* owner, UInt traceNum)
+    : _owner(owner)
+    , _traceNum(traceNum)
+    , _pins(0)
+{
+}
+
+//------------------------------------------------------------------------------
+
+int CompactTrace::getAttrsNum()
+{
+    return (int)(_owner->_data->_trAttrOffs[_traceNum + 1] - _owner->_data->_trAttrOffs[_traceNum]);
+}
+
+//------------------------------------------------------------------------------
+
+bool CompactTrace::getAttr(const char* id, Attribute& a)
+{
+    return _owner->getTraceAttrInternal(_traceNum, id, a);
+}
+
+//------------------------------------------------------------------------------
+
+IAttributesEnumerator* CompactTrace::getAttrs()
+{
+    return _owner->makeTraceAttrsEnum(_traceNum);
+}
+
+//------------------------------------------------------------------------------
+
+IEvent* CompactTrace::getEvent(UInt eventNum)
+{
+    if (eventNum >= (UInt)getSize())
+        return nullptr;
+
+    if (_events.empty())
+        decodeEvents();
+
+    return &_events[eventNum];
+}
+
+//------------------------------------------------------------------------------
+
+int CompactTrace::getSize()
+{
+    return (int)(_owner->_data->_evOffs[_traceNum + 1] - _owner->_data->_evOffs[_traceNum]);
+}
+
+//------------------------------------------------------------------------------
+
+IEventLog* CompactTrace::getLog()
+{
+    return _owner;
+}
+
+//------------------------------------------------------------------------------
+
+void CompactTrace::decodeEvents()
+{
+    CompactLog::CodesVector codes;
+    CompactLog::TimestampsVector timests;
+    _owner->decodeTrace(_traceNum, codes);
+    _owner->decodeTimestamps(_traceNum, timests);
+
+    // вектор выделяется ровно один раз, так что указатели на события стабильны
+    _events.reserve(codes.size());
+    for (size_t i = 0; i < codes.size(); ++i)
+        _events.push_back(CompactEvent(this, codes[i], timests.empty() ? 0 : timests[i]));
+
+    _owner->registerDecoded(this);
+}
+
+
+
+//==============================================================================
+// class CompactLog
+//==============================================================================
+
+
+CompactLog::CompactLog()
+    : _data(this)
+    , _loaded(false)
+    , _withTimests(false)
+    , _decodedLimit(DEF_DECODED_TRACES_LIMIT)
+    , _curTrace(NO_TRACE)
+{
+}
+
+//------------------------------------------------------------------------------
+
+CompactLog::CompactLog(IEventLog* src, bool withTimestamps,
+    xi::strutils::InternStrPool* strPool)
+    : CompactLog()
+{
+    load(src, withTimestamps, strPool);
+}
+
+//------------------------------------------------------------------------------
+
+CompactLog::CompactLog(const CompactLog& data, ShareData)
+    : CompactLog()
+{
+    // данные лога-владельца только читаются, поэтому виды можно читать из разных потоков
+    _data = data._data;
+}
+
+//------------------------------------------------------------------------------
+
+CompactLog::~CompactLog()
+{
+    freeTraces();
+}
+
+//------------------------------------------------------------------------------
+
+void CompactLog::load(IEventLog* src, bool withTimestamps,
+    xi::strutils::InternStrPool* strPool)
+{
+    if (!src)
+        throw LdopaException("Can't load a compact log: no source log is set.");
+    if (isView())
+        throw LdopaException("Can't load a compact log: the log is a view of another one.");
+
+    clear();
+    src->open();
+
+    _actAttrID = src->getEvActAttrId();
+    if (_actAttrID.empty())
+        throw LdopaException("Can't load a compact log: ID for Activity attribute not set.");
+    _timestAttrID = src->getEvTimestAttrId();
+    if (withTimestamps && _timestAttrID.empty())
+        throw LdopaException("Can't load a compact log: ID for Timestamp attribute not set.");
+    _caseAttrID = src->getEvCaseAttrId();
+    _infoStr = src->getInfoStr();
+    _withTimests = withTimestamps;
+
+    // атрибуты лога копируем как есть, их немного
+    std::unique_ptr<IAttributesEnumerator> logAttrs(src->getLogAttrs());
+    if (logAttrs)
+        while (logAttrs->hasNext())
+            _logAttrs.push_back(logAttrs->getNext());
+
+    int tracesNum = src->getTracesNum();
+    _actOffs.reserve(tracesNum + 1);
+    _evOffs.reserve(tracesNum + 1);
+    _trAttrOffs.reserve(tracesNum + 1);
+    _actOffs.push_back(0);
+    _evOffs.push_back(0);
+    _trAttrOffs.push_back(0);
+    if (_withTimests)
+    {
+        _tsOffs.reserve(tracesNum + 1);
+        _tsOffs.push_back(0);
+    }
+
+    Attribute a;
+    for (int i = 0; i < tracesNum; ++i)
+    {
+        IEventTrace* tr = src->getTrace(i);
+        if (!tr)
+            throw LdopaException("Error getting trace.");
+
+        // атрибуты трассы: имена — через словарь
+        std::unique_ptr<IAttributesEnumerator> trAttrs(tr->getAttrs());
+        if (trAttrs)
+            while (trAttrs->hasNext())
+            {
+                NamedAttribute na = trAttrs->getNext();
+                _trAttrs.push_back(CodedAttribute(getOrAddTraceAttrCode(na.first), na.second));
+            }
+        _trAttrOffs.push_back((UInt)_trAttrs.size());
+
+        Timestamp prevTs = 0;
+        int traceSize = tr->getSize();
+        for (int j = 0; j < traceSize; ++j)
+        {
+            IEvent* ev = tr->getEvent(j);
+            if (!ev)
+                throw LdopaException("Error getting event.");
+
+            if (!ev->getAttr(_actAttrID.c_str(), a))
+                throw LdopaException("Another event doesn't have the Activity attribute.");
+            encodeVarint(_actData, getOrAddActivityCode(a.toString(), strPool));
+
+            if (_withTimests)
+            {
+                if (!ev->getAttr(_timestAttrID.c_str(), a))
+                    throw LdopaException("Another event doesn't have the Timestamp attribute.");
+                Timestamp ts = a.asInt64();
+                encodeVarint(_tsData, zigzag(ts - prevTs));
+                prevTs = ts;
+            }
+        }
+
+        _actOffs.push_back(_actData.size());
+        _evOffs.push_back(_evOffs.back() + traceSize);
+        if (_withTimests)
+            _tsOffs.push_back(_tsData.size());
+    }
+
+    _actData.shrink_to_fit();
+    _tsData.shrink_to_fit();
+    _trAttrs.shrink_to_fit();
+    _loaded = true;
+}
+
+//------------------------------------------------------------------------------
+
+void CompactLog::clear()
+{
+    if (isView())
+        throw LdopaException("Can't clear a compact log: the log is a view of another one.");
+
+    freeTraces();
+
+    _loaded = false;
+    _withTimests = false;
+    ByteVec().swap(_actData);
+    OffsetVec().swap(_actOffs);
+    std::vector<UInt>().swap(_evOffs);
+    ByteVec().swap(_tsData);
+    OffsetVec().swap(_tsOffs);
+    _actAttrs.clear();
+    _actCodes.clear();
+    _logAttrs.clear();
+    _trAttrNames.clear();
+    _trAttrCodes.clear();
+    std::vector<CodedAttribute>().swap(_trAttrs);
+    std::vector<UInt>().swap(_trAttrOffs);
+}
+
+//------------------------------------------------------------------------------
+
+void CompactLog::open()
+{
+    // данные живут в памяти, открывать нечего
+}
+
+//------------------------------------------------------------------------------
+
+void CompactLog::close()
+{
+    // данные остаются, освобождаем лишь объекты трасс
+    freeTraces();
+}
+
+//------------------------------------------------------------------------------
+
+bool CompactLog::isOpen()
+{
+    return _data->_loaded;
+}
+
+//------------------------------------------------------------------------------
+
+int CompactLog::getEventsNum()
+{
+    return _data->_loaded ? (int)_data->_evOffs.back() : 0;
+}
+
+//------------------------------------------------------------------------------
+
+int CompactLog::getTracesNum()
+{
+    return _data->_loaded ? (int)_data->_evOffs.size() - 1 : 0;
+}
+
+//------------------------------------------------------------------------------
+
+int CompactLog::getActivitiesNum()
+{
+    return (int)_data->_actAttrs.size();
+}
+
+//------------------------------------------------------------------------------
+
+int CompactLog::getLogAttrsNum()
+{
+    return (int)_data->_logAttrs.size();
+}
+
+//------------------------------------------------------------------------------
+
+bool CompactLog::getLogAttr(const char* id, Attribute& a)
+{
+    for (const NamedAttribute& el : _data->_logAttrs)
+    {
+        if (el.first == id)
+        {
+            a = el.second;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+//------------------------------------------------------------------------------
+
+IAttributesEnumerator* CompactLog::getLogAttrs()
+{
+    return new CompactAttrsEnumerator(NmAttributesVector(_data->_logAttrs));
+}
+
+//------------------------------------------------------------------------------
+
+bool CompactLog::getEventAttr(int traceNum, int eventNum, const char* id, Attribute& a)
+{
+    if (!checkTraceNum(traceNum) || eventNum < 0 || eventNum >= getTraceSize(traceNum))
+        return false;
+
+    seekTrace((UInt)traceNum);
+    return getEventAttrInternal(_curCodes[eventNum], 
+        _data->_withTimests ? _curTimests[eventNum] : 0, id, a);
+}
+
+//------------------------------------------------------------------------------
+
+bool CompactLog::getEventAttr(int eventId, const char* id, Attribute& a)
+{
+    UInt traceNum, eventNum;
+    if (!locateEvent(eventId, traceNum, eventNum))
+        return false;
+
+    return getEventAttr((int)traceNum, (int)eventNum, id, a);
+}
+
+//------------------------------------------------------------------------------
+
+IAttributesEnumerator* CompactLog::getEventAttrs(int traceNum, int eventNum)
+{
+    if (!checkTraceNum(traceNum) || eventNum < 0 || eventNum >= getTraceSize(traceNum))
+        return nullptr;
+
+    seekTrace((UInt)traceNum);
+    return makeEventAttrsEnum(_curCodes[eventNum], _data->_withTimests ? _curTimests[eventNum] : 0);
+}
+
+//------------------------------------------------------------------------------
+
+IAttributesEnumerator* CompactLog::getEventAttrs(int eventId)
+{
+    UInt traceNum, eventNum;
+    if (!locateEvent(eventId, traceNum, eventNum))
+        return nullptr;
+
+    return getEventAttrs((int)traceNum, (int)eventNum);
+}
+
+//------------------------------------------------------------------------------
+
+bool CompactLog::getTraceAttr(int traceNum, const char* id, Attribute& a)
+{
+    if (!checkTraceNum(traceNum))
+        return false;
+
+    return getTraceAttrInternal((UInt)traceNum, id, a);
+}
+
+//------------------------------------------------------------------------------
+
+IAttributesEnumerator* CompactLog::getTraceAttrs(int traceNum)
+{
+    if (!checkTraceNum(traceNum))
+        return nullptr;
+
+    return makeTraceAttrsEnum((UInt)traceNum);
+}
+
+//------------------------------------------------------------------------------
+
+int CompactLog::getTraceSize(int traceNum)
+{
+    if (!checkTraceNum(traceNum))
+        return 0;
+
+    return (int)(_data->_evOffs[traceNum + 1] - _data->_evOffs[traceNum]);
+}
+
+//------------------------------------------------------------------------------
+
+std::string CompactLog::getEvActAttrId() const
+{
+    return _data->_actAttrID;
+}
+
+//------------------------------------------------------------------------------
+
+std::string CompactLog::getEvTimestAttrId() const
+{
+    return _data->_timestAttrID;
+}
+
+//------------------------------------------------------------------------------
+
+std::string CompactLog::getEvCaseAttrId() const
+{
+    return _data->_caseAttrID;
+}
+
+//------------------------------------------------------------------------------
+
+std::string CompactLog::getInfoStr() const
+{
+    return "Compact log of: " + _data->_infoStr;
+}
+
+//------------------------------------------------------------------------------
+
+IEventTrace* CompactLog::getTrace(int traceNum)
+{
+    if (!checkTraceNum(traceNum))
+        return nullptr;
+
+    if (_traces.empty())
+        _traces.resize(getTracesNum(), nullptr);
+
+    CompactTrace*& tr = _traces[traceNum];
+    if (!tr)
+        tr = new CompactTrace(this, (UInt)traceNum);
+
+    return tr;
+}
+
+//------------------------------------------------------------------------------
+
+void CompactLog::decodeTrace(UInt traceNum, CodesVector& codes) const
+{
+    codes.clear();
+    if (!checkTraceNum((int)traceNum))
+        return;
+
+    UInt size = _data->_evOffs[traceNum + 1] - _data->_evOffs[traceNum];
+    codes.resize(size);
+
+    const Byte* p = _data->_actData.data() + _data->_actOffs[traceNum];
+    std::uint64_t code;
+    for (UInt i = 0; i < size; ++i)
+    {
+        p = decodeVarint(p, code);
+        codes[i] = (UInt)code;
+    }
+}
+
+//------------------------------------------------------------------------------
+
+void CompactLog::decodeTimestamps(UInt traceNum, TimestampsVector& timests) const
+{
+    timests.clear();
+    if (!_data->_withTimests || !checkTraceNum((int)traceNum))
+        return;
+
+    UInt size = _data->_evOffs[traceNum + 1] - _data->_evOffs[traceNum];
+    timests.resize(size);
+
+    const Byte* p = _data->_tsData.data() + _data->_tsOffs[traceNum];
+    std::uint64_t d;
+    Timestamp ts = 0;
+    for (UInt i = 0; i < size; ++i)
+    {
+        p = decodeVarint(p, d);
+        ts += unzigzag(d);
+        timests[i] = ts;
+    }
+}
+
+//------------------------------------------------------------------------------
+
+int CompactLog::getActivityCode(const std::string& act) const
+{
+    auto it = _data->_actCodes.find(act);
+    return it == _data->_actCodes.end() ? -1 : (int)it->second;
+}
+
+//------------------------------------------------------------------------------
+
+void CompactLog::setDecodedTracesLimit(UInt limit)
+{
+    _decodedLimit = limit;
+    evictDecoded();
+}
+
+//------------------------------------------------------------------------------
+
+void CompactLog::pinTrace(UInt traceNum)
+{
+    CompactTrace* tr = static_cast<CompactTrace*>(getTrace((int)traceNum));
+    if (!tr)
+        throw LdopaException("Can't pin a trace: bad trace number.");
+
+    ++tr->_pins;
+}
+
+//------------------------------------------------------------------------------
+
+void CompactLog::unpinTrace(UInt traceNum)
+{
+    CompactTrace* tr = (size_t)traceNum < _traces.size() ? _traces[traceNum] : nullptr;
+    if (!tr || tr->_pins == 0)
+        throw LdopaException("Can't unpin a trace: the trace is not pinned.");
+
+    --tr->_pins;
+    evictDecoded();
+}
+
+//------------------------------------------------------------------------------
+
+CompactLog::UInt CompactLog::getOrAddActivityCode(const std::string& act,
+    xi::strutils::InternStrPool* strPool)
+{
+    auto res = _actCodes.insert({ act, (UInt)_actAttrs.size() });
+    if (res.second)                 // новая активность: один общий атрибут на все события
+        _actAttrs.push_back(strPool ? Attribute(strPool->intern(act)) : Attribute(act));
+
+    return res.first->second;
+}
+
+//------------------------------------------------------------------------------
+
+CompactLog::UInt CompactLog::getOrAddTraceAttrCode(const std::string& name)
+{
+    auto res = _trAttrCodes.insert({ name, (UInt)_trAttrNames.size() });
+    if (res.second)
+        _trAttrNames.push_back(name);
+
+    return res.first->second;
+}
+
+//------------------------------------------------------------------------------
+
+bool CompactLog::getTraceAttrInternal(UInt traceNum, const char* id, Attribute& a) const
+{
+    auto it = _data->_trAttrCodes.find(id);
+    if (it == _data->_trAttrCodes.end())
+        return false;
+
+    for (UInt i = _data->_trAttrOffs[traceNum]; i < _data->_trAttrOffs[traceNum + 1]; ++i)
+    {
+        if (_data->_trAttrs[i].first == it->second)
+        {
+            a = _data->_trAttrs[i].second;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+//------------------------------------------------------------------------------
+
+IAttributesEnumerator* CompactLog::makeTraceAttrsEnum(UInt traceNum) const
+{
+    const CompactLog& d = *_data;
+    NmAttributesVector attrs;
+    attrs.reserve(d._trAttrOffs[traceNum + 1] - d._trAttrOffs[traceNum]);
+    for (UInt i = d._trAttrOffs[traceNum]; i < d._trAttrOffs[traceNum + 1]; ++i)
+        attrs.push_back(NamedAttribute(d._trAttrNames[d._trAttrs[i].first], d._trAttrs[i].second));
+
+    return new CompactAttrsEnumerator(std::move(attrs));
+}
+
+//------------------------------------------------------------------------------
+
+void CompactLog::seekTrace(UInt traceNum)
+{
+    if (_curTrace == traceNum)
+        return;
+
+    decodeTrace(traceNum, _curCodes);
+    decodeTimestamps(traceNum, _curTimests);
+    _curTrace = traceNum;
+}
+
+//------------------------------------------------------------------------------
+
+bool CompactLog::locateEvent(int eventId, UInt& traceNum, UInt& eventNum) const
+{
+    if (!_data->_loaded || eventId < 0 || (UInt)eventId >= _data->_evOffs.back())
+        return false;
+
+    // первая трасса, начинающаяся позже события, — следующая за искомой
+    auto it = std::upper_bound(_data->_evOffs.begin(), _data->_evOffs.end(), (UInt)eventId);
+    traceNum = (UInt)(it - _data->_evOffs.begin()) - 1;
+    eventNum = (UInt)eventId - _data->_evOffs[traceNum];
+
+    return true;
+}
+
+//------------------------------------------------------------------------------
+
+void CompactLog::registerDecoded(CompactTrace* tr)
+{
+    if (tr->_events.empty())
+        return;
+
+    _decoded.push_back(tr);
+    evictDecoded();
+}
+
+//------------------------------------------------------------------------------
+
+void CompactLog::evictDecoded()
+{
+    if (_decodedLimit == 0)
+        return;
+
+    // закрепленные трассы пропускаем: на их события могут ссылаться; последнюю
+    // раскодированную трассу не трогаем — ее события как раз запрошены
+    auto it = _decoded.begin();
+    while (_decoded.size() > _decodedLimit && it + 1 < _decoded.end())
+    {
+        if ((*it)->_pins != 0)
+        {
+            ++it;
+            continue;
+        }
+
+        (*it)->freeEvents();
+        it = _decoded.erase(it);
+    }
+}
+
+//------------------------------------------------------------------------------
+
+bool CompactLog::getEventAttrInternal(UInt actCode, Timestamp timest, const char* id,
+    Attribute& a) const
+{
+    if (_data->_actAttrID == id)
+    {
+        a = _data->_actAttrs[actCode];
+        return true;
+    }
+
+    if (_data->_withTimests && _data->_timestAttrID == id)
+    {
+        a = timest;
+        return true;
+    }
+
+    return false;
+}
+
+//------------------------------------------------------------------------------
+
+IAttributesEnumerator* CompactLog::makeEventAttrsEnum(UInt actCode, Timestamp timest) const
+{
+    NmAttributesVector attrs;
+    attrs.push_back(NamedAttribute(_data->_actAttrID, _data->_actAttrs[actCode]));
+    if (_data->_withTimests)
+        attrs.push_back(NamedAttribute(_data->_timestAttrID, Attribute(timest)));
+
+    return new CompactAttrsEnumerator(std::move(attrs));
+}
+
+//------------------------------------------------------------------------------
+
+void CompactLog::freeTraces()
+{
+    for (CompactTrace* tr : _traces)
+        delete tr;
+    VectorOfTraces().swap(_traces);
+    _decoded.clear();
+    _curTrace = NO_TRACE;
+    CodesVector().swap(_curCodes);
+    TimestampsVector().swap(_curTimests);
+}
+
+
+}}} // namespace xi { namespace ldopa { namespace eventlog {
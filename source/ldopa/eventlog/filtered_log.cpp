@@ -0,0 +1,587 @@
+////////////////////////////////////////////////////////////////////////////////
+// Module Name:  filtered_log.h/cpp
+// Authors:      Sergey Shershakov
+// Version:      0.1.0
+// Date:         18.10.2026
+// Copyright (c) xidv.ru 2014–2017.
+//
+// This source is for internal use only — Restricted Distribution.
+// All rights reserved.
+////////////////////////////////////////////////////////////////////////////////
+
+
+// ldopa
+#include "xi/ldopa/eventlog/filtered_log.h"
+#include "xi/ldopa/utils.h"
+
+// std
+#include <algorithm>    // std::sample
+#include <cmath>        // std::round
+#include <iterator>     // std::back_inserter
+#include <random>       // std::mt19937
+
+
+namespace xi { namespace ldopa { namespace eventlog {;   //
+
+//==============================================================================
+// class FilteredTrace
+//==============================================================================
+
+
+FilteredTrace::FilteredTrace(FilteredLog* owner, IEventTrace* src, UInt srcTraceNum)
+    : _owner(owner)
+    , _src(src)
+    , _srcTraceNum(srcTraceNum)
+    , _identity(true)
+{
+    if (_owner->hasActivityMask())
+        applyMask();
+}
+
+//------------------------------------------------------------------------------
+
+int FilteredTrace::getAttrsNum()
+{
+    return _src->getAttrsNum();
+}
+
+//------------------------------------------------------------------------------
+
+bool FilteredTrace::getAttr(const char* id, Attribute& a)
+{
+    return _src->getAttr(id, a);
+}
+
+//------------------------------------------------------------------------------
+
+IAttributesEnumerator* FilteredTrace::getAttrs()
+{
+    return _src->getAttrs();
+}
+
+//------------------------------------------------------------------------------
+
+IEvent* FilteredTrace::getEvent(UInt eventNum)
+{
+    if (eventNum >= (UInt)getSize())
+        return nullptr;
+
+    return _src->getEvent(mapEventNum(eventNum));
+}
+
+//------------------------------------------------------------------------------
+
+int FilteredTrace::getSize()
+{
+    return _identity ? _src->getSize() : (int)_evInds.size();
+}
+
+//------------------------------------------------------------------------------
+
+IEventLog* FilteredTrace::getLog()
+{
+    return _owner;
+}
+
+//------------------------------------------------------------------------------
+
+void FilteredTrace::applyMask()
+{
+    const std::string& actID = _owner->obtainActAttrID();
+
+    _evInds.clear();
+    _identity = false;
+
+    Attribute act;
+    int srcSize = _src->getSize();
+    for (int i = 0; i < srcSize; ++i)
+    {
+        IEvent* ev = _src->getEvent(i);
+        if (!ev || !ev->getAttr(actID.c_str(), act))
+            throw LdopaException("Another event doesn't have the Activity attribute.");
+
+        if (_owner->isActivityPassed(act.toString()))
+            _evInds.push_back(i);
+    }
+
+    // если маска ничего не выкинула, массив индексов не нужен
+    if (_evInds.size() == (size_t)srcSize)
+    {
+        _identity = true;
+        IndexVec().swap(_evInds);
+    }
+}
+
+
+
+//==============================================================================
+// class FilteredLog
+//==============================================================================
+
+
+FilteredLog::FilteredLog(IEventLog* src)
+    : _src(src)
+    , _identity(true)
+    , _hasKeepActs(false)
+    , _eventsNum(-1)
+    , _activitiesNum(-1)
+{
+    if (!_src)
+        throw LdopaException("Can't create a filtered log view: no source log is set.");
+}
+
+//------------------------------------------------------------------------------
+
+FilteredLog::~FilteredLog()
+{
+    freeTraces();
+}
+
+//------------------------------------------------------------------------------
+
+FilteredLog& FilteredLog::keepActivities(const ActivitiesSet& acts)
+{
+    if (_hasKeepActs)
+    {
+        // пересекаем с уже заданным множеством
+        ActivitiesSet isect;
+        std::set_intersection(_keepActs.begin(), _keepActs.end(),
+            acts.begin(), acts.end(), std::inserter(isect, isect.begin()));
+        _keepActs.swap(isect);
+    }
+    else
+    {
+        _keepActs = acts;
+        _hasKeepActs = true;
+    }
+
+    invalidateMask();
+    return *this;
+}
+
+//------------------------------------------------------------------------------
+
+FilteredLog& FilteredLog::removeActivities(const ActivitiesSet& acts)
+{
+    _removeActs.insert(acts.begin(), acts.end());
+
+    invalidateMask();
+    return *this;
+}
+
+//------------------------------------------------------------------------------
+
+FilteredLog& FilteredLog::limitTraceLength(int minLen, int maxLen)
+{
+    retainTraces([this, minLen, maxLen](UInt i) {
+        int size = getTraceSize((int)i);
+        return size >= minLen && (maxLen < 0 || size <= maxLen);
+    });
+
+    return *this;
+}
+
+//------------------------------------------------------------------------------
+
+FilteredLog& FilteredLog::filterTraces(const TracePredicate& pred)
+{
+    retainTraces([this, &pred](UInt i) {
+        return pred(getTrace((int)i));
+    });
+
+    return *this;
+}
+
+//------------------------------------------------------------------------------
+
+FilteredLog& FilteredLog::filterByTraceAttr(const char* id, const AttrPredicate& pred)
+{
+    Attribute a;
+    retainTraces([this, id, &pred, &a](UInt i) {
+        return _src->getTraceAttr((int)mapTraceNum(i), id, a) && pred(a);
+    });
+
+    return *this;
+}
+
+//------------------------------------------------------------------------------
+
+FilteredLog& FilteredLog::sample(UInt n, unsigned int seed)
+{
+    UInt tracesNum = (UInt)getTracesNum();
+    if (n >= tracesNum)
+        return *this;
+
+    // выбираем номера трасс представления; std::sample сохраняет их порядок
+    IndexVec all(tracesNum);
+    for (UInt i = 0; i < tracesNum; ++i)
+        all[i] = i;
+
+    IndexVec chosen;
+    chosen.reserve(n);
+    std::sample(all.begin(), all.end(), std::back_inserter(chosen), n, std::mt19937(seed));
+
+    std::vector<bool> keep(tracesNum, false);
+    for (UInt i : chosen)
+        keep[i] = true;
+
+    retainTraces([&keep](UInt i) { return keep[i]; });
+
+    return *this;
+}
+
+//------------------------------------------------------------------------------
+
+FilteredLog& FilteredLog::sampleFraction(double frac, unsigned int seed)
+{
+    if (frac < 0 || frac > 1)
+        throw LdopaException("Sample fraction must be in [0, 1].");
+
+    return sample((UInt)std::round(frac * getTracesNum()), seed);
+}
+
+//------------------------------------------------------------------------------
+
+void FilteredLog::open()
+{
+    _src->open();
+}
+
+//------------------------------------------------------------------------------
+
+void FilteredLog::close()
+{
+    // объекты трасс источника после его закрытия недействительны
+    freeTraces();
+    _src->close();
+}
+
+//------------------------------------------------------------------------------
+
+bool FilteredLog::isOpen()
+{
+    return _src->isOpen();
+}
+
+//------------------------------------------------------------------------------
+
+int FilteredLog::getEventsNum()
+{
+    if (!isOpen())
+        return 0;                   // по соглашению
+
+    if (_identity && !hasActivityMask())
+        return _src->getEventsNum();
+
+    if (_eventsNum == -1)
+    {
+        int tracesNum = getTracesNum();
+        int eventsNum = 0;
+        for (int i = 0; i < tracesNum; ++i)
+            eventsNum += getTraceSize(i);
+        _eventsNum = eventsNum;
+    }
+
+    return _eventsNum;
+}
+
+//------------------------------------------------------------------------------
+
+int FilteredLog::getTracesNum()
+{
+    if (!isOpen())
+        return 0;                   // по соглашению
+
+    return _identity ? _src->getTracesNum() : (int)_traceInds.size();
+}
+
+//------------------------------------------------------------------------------
+
+int FilteredLog::getActivitiesNum()
+{
+    if (!isOpen())
+        return 0;                   // по соглашению
+
+    if (_identity && !hasActivityMask())
+        return _src->getActivitiesNum();
+
+    // иначе один раз проходим по всем событиям представления
+    if (_activitiesNum == -1)
+    {
+        const std::string& actID = obtainActAttrID();
+        ActivitiesSet acts;
+        Attribute act;
+        int tracesNum = getTracesNum();
+        for (int i = 0; i < tracesNum; ++i)
+        {
+            IEventTrace* tr = getTrace(i);
+            int size = tr->getSize();
+            for (int j = 0; j < size; ++j)
+            {
+                if (tr->getEvent(j)->getAttr(actID.c_str(), act))
+                    acts.insert(act.toString());
+            }
+        }
+        _activitiesNum = (int)acts.size();
+    }
+
+    return _activitiesNum;
+}
+
+//------------------------------------------------------------------------------
+
+int FilteredLog::getLogAttrsNum()
+{
+    return _src->getLogAttrsNum();
+}
+
+//------------------------------------------------------------------------------
+
+bool FilteredLog::getLogAttr(const char* id, Attribute& a)
+{
+    return _src->getLogAttr(id, a);
+}
+
+//------------------------------------------------------------------------------
+
+IAttributesEnumerator* FilteredLog::getLogAttrs()
+{
+    return _src->getLogAttrs();
+}
+
+//------------------------------------------------------------------------------
+
+bool FilteredLog::getEventAttr(int traceNum, int eventNum, const char* id, Attribute& a)
+{
+    if (!checkTraceNum(traceNum))
+        return false;
+
+    // без маски событий обходимся без объекта трассы
+    if (!hasActivityMask())
+        return _src->getEventAttr((int)mapTraceNum(traceNum), eventNum, id, a);
+
+    FilteredTrace* tr = (FilteredTrace*)getTrace(traceNum);
+    if (eventNum < 0 || eventNum >= tr->getSize())
+        return false;
+
+    return _src->getEventAttr((int)tr->getSrcTraceNum(), (int)tr->mapEventNum(eventNum), id, a);
+}
+
+//------------------------------------------------------------------------------
+
+bool FilteredLog::getEventAttr(int eventId, const char* id, Attribute& a)
+{
+    return _src->getEventAttr(eventId, id, a);
+}
+
+//------------------------------------------------------------------------------
+
+IAttributesEnumerator* FilteredLog::getEventAttrs(int traceNum, int eventNum)
+{
+    if (!checkTraceNum(traceNum))
+        return nullptr;
+
+    if (!hasActivityMask())
+        return _src->getEventAttrs((int)mapTraceNum(traceNum), eventNum);
+
+    FilteredTrace* tr = (FilteredTrace*)getTrace(traceNum);
+    if (eventNum < 0 || eventNum >= tr->getSize())
+        return nullptr;
+
+    return _src->getEventAttrs((int)tr->getSrcTraceNum(), (int)tr->mapEventNum(eventNum));
+}
+
+//------------------------------------------------------------------------------
+
+IAttributesEnumerator* FilteredLog::getEventAttrs(int eventId)
+{
+    return _src->getEventAttrs(eventId);
+}
+
+//------------------------------------------------------------------------------
+
+bool FilteredLog::getTraceAttr(int traceNum, const char* id, Attribute& a)
+{
+    if (!checkTraceNum(traceNum))
+        return false;
+
+    return _src->getTraceAttr((int)mapTraceNum(traceNum), id, a);
+}
+
+//------------------------------------------------------------------------------
+
+IAttributesEnumerator* FilteredLog::getTraceAttrs(int traceNum)
+{
+    if (!checkTraceNum(traceNum))
+        return nullptr;
+
+    return _src->getTraceAttrs((int)mapTraceNum(traceNum));
+}
+
+//------------------------------------------------------------------------------
+
+int FilteredLog::getTraceSize(int traceNum)
+{
+    if (!checkTraceNum(traceNum))
+        return 0;
+
+    if (!hasActivityMask())
+        return _src->getTraceSize((int)mapTraceNum(traceNum));
+
+    return getTrace(traceNum)->getSize();
+}
+
+//------------------------------------------------------------------------------
+
+std::string FilteredLog::getEvActAttrId() const
+{
+    return _src->getEvActAttrId();
+}
+
+//------------------------------------------------------------------------------
+
+std::string FilteredLog::getEvTimestAttrId() const
+{
+    return _src->getEvTimestAttrId();
+}
+
+//------------------------------------------------------------------------------
+
+std::string FilteredLog::getEvCaseAttrId() const
+{
+    return _src->getEvCaseAttrId();
+}
+
+//------------------------------------------------------------------------------
+
+std::string FilteredLog::getInfoStr() const
+{
+    return "Filtered view of: " + _src->getInfoStr();
+}
+
+//------------------------------------------------------------------------------
+
+IEventTrace* FilteredLog::getTrace(int traceNum)
+{
+    if (!checkTraceNum(traceNum))
+        return nullptr;
+
+    // массив трасс растет лениво
+    if (_traces.size() <= (size_t)traceNum)
+        _traces.resize(getTracesNum(), nullptr);
+
+    FilteredTrace*& tr = _traces[traceNum];
+    if (!tr)
+    {
+        UInt srcNum = mapTraceNum(traceNum);
+        IEventTrace* srcTr = _src->getTrace((int)srcNum);
+        if (!srcTr)
+            return nullptr;
+        tr = new FilteredTrace(this, srcTr, srcNum);
+    }
+
+    return tr;
+}
+
+//------------------------------------------------------------------------------
+
+bool FilteredLog::isActivityPassed(const std::string& act) const
+{
+    if (_hasKeepActs && _keepActs.find(act) == _keepActs.end())
+        return false;
+
+    return _removeActs.find(act) == _removeActs.end();
+}
+
+//------------------------------------------------------------------------------
+
+void FilteredLog::materializeTraceInds()
+{
+    if (!_identity)
+        return;
+
+    UInt tracesNum = (UInt)_src->getTracesNum();
+    _traceInds.resize(tracesNum);
+    for (UInt i = 0; i < tracesNum; ++i)
+        _traceInds[i] = i;
+    _identity = false;
+}
+
+//------------------------------------------------------------------------------
+
+void FilteredLog::retainTraces(const std::function<bool(UInt)>& keep)
+{
+    if (!isOpen())
+        throw LdopaException("Can't filter traces: the source log is not open.");
+
+    materializeTraceInds();
+
+    // уплотняем на месте массив индексов и (параллельно) массив объектов трасс
+    size_t tracesNum = _traceInds.size();
+    if (_traces.size() < tracesNum)
+        _traces.resize(tracesNum, nullptr);
+
+    size_t j = 0;
+    for (size_t i = 0; i < tracesNum; ++i)
+    {
+        if (keep((UInt)i))
+        {
+            _traceInds[j] = _traceInds[i];
+            _traces[j] = _traces[i];
+            ++j;
+        }
+        else
+            delete _traces[i];
+    }
+
+    _traceInds.resize(j);
+    _traceInds.shrink_to_fit();
+    _traces.resize(j);
+    _traces.shrink_to_fit();
+
+    _eventsNum = -1;
+    _activitiesNum = -1;
+}
+
+//------------------------------------------------------------------------------
+
+void FilteredLog::invalidateMask()
+{
+    // трассы с уже посчитанными индексами событий придется пересоздать
+    freeTraces();
+    _eventsNum = -1;
+    _activitiesNum = -1;
+}
+
+//------------------------------------------------------------------------------
+
+void FilteredLog::freeTraces()
+{
+    for (FilteredTrace* tr : _traces)
+        delete tr;
+    VectorOfTraces().swap(_traces);
+}
+
+//------------------------------------------------------------------------------
+
+bool FilteredLog::checkTraceNum(int traceNum)
+{
+    return traceNum >= 0 && traceNum < getTracesNum();
+}
+
+//------------------------------------------------------------------------------
+
+const std::string& FilteredLog::obtainActAttrID()
+{
+    if (_actAttrID.empty())
+    {
+        _actAttrID = _src->getEvActAttrId();
+        if (_actAttrID.empty())
+            throw LdopaException("Can't apply an activity mask: ID for Activity attribute not set.");
+    }
+
+    return _actAttrID;
+}
+
+
+}}} // namespace xi { namespace ldopa { namespace eventlog {
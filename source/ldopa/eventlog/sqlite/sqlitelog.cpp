@@ -28,6 +28,16 @@
 
 namespace xi { namespace ldopa { namespace eventlog {;   //
 
+/** \brief Counts heap bytes of a vector of named attributes \a attrs. */
+static size_t nmAttrsBytes(const SQLiteLog_traits::NmAttributesVector& attrs)
+{
+    size_t bytes = mem::contBytes(attrs);
+    for (const SQLiteLog_traits::NamedAttribute& na : attrs)
+        bytes += mem::contBytes(na.first) + na.second.getPayloadSize();
+
+    return bytes;
+}
+
 //==============================================================================
 // class SQLiteTrace
 //==============================================================================
@@ -163,6 +173,23 @@ IEventLog* SQLiteTrace::getLog()
     return _owner;
 }
 
+//------------------------------------------------------------------------------
+
+MemUsage SQLiteTrace::memoryUsage() const
+{
+    MemUsage mu;
+    mu.add("object", sizeof(SQLiteTrace));
+    mu.add("events", mem::contBytes(_events));
+    for (const IEvent* ev : _events)
+    {
+        if (ev)
+            mu.add("events", static_cast<const SQLiteEvent*>(ev)->memoryUsage());
+    }
+    mu.add("attrs", nmAttrsBytes(_attributes));
+
+    return mu;
+}
+
 
 //------------------------------------------------------------------------------
 
@@ -243,7 +270,8 @@ void SQLiteTrace::fetchUpTo(int eventNum)
 
 void SQLiteTrace::createExtractor()
 {
-    const std::string& qry = _owner->getConfigParamOrDef(PAR_LQRY_GETTRACE_EVENTS); // getQryGetTraceEvents();
+    const SQLiteLog* owner = _owner;                    // только читаем, параметр не добавляется
+    const std::string& qry = owner->getConfigParamOrDef(PAR_LQRY_GETTRACE_EVENTS); // getQryGetTraceEvents();
     if (qry.empty())
         throw LdopaException(
         "Can't extract trace's events because there has not been set a corresponding query.");
@@ -309,6 +337,17 @@ IEventTrace* SQLiteEvent::getTrace()
 
 //------------------------------------------------------------------------------
 
+MemUsage SQLiteEvent::memoryUsage() const
+{
+    MemUsage mu;
+    mu.add("object", sizeof(SQLiteEvent));
+    mu.add("attrs", nmAttrsBytes(_attributes));
+
+    return mu;
+}
+
+//------------------------------------------------------------------------------
+
 void SQLiteEvent::extractAttributes(SQLiteStmt* stmt)
 {
     Attribute attr;    
@@ -320,7 +359,7 @@ void SQLiteEvent::extractAttributes(SQLiteStmt* stmt)
     // перебираем все колоночки текущей записи
     for (int i = 0; i < colsNum; ++i)
     {
-        if (SQLiteLog::extractAttributeHor(stmt, i, attr, &aName))
+        if (SQLiteLog::extractAttributeHor(stmt, i, attr, &aName, _owner->_owner->getStrPool()))
         {
             _attributes.push_back(make_pair(aName, attr));
         }
@@ -369,6 +408,7 @@ const char* SQLiteLog::COMP_LABEL                       = "SQLiteLog";
 SQLiteLog::SQLiteLog()
     //: _dbHandle(NULL)
     : _settings(DEF_SETTINGS)
+    , _strPool(nullptr)
 {
     reset();
 }
@@ -669,6 +709,35 @@ std::string SQLiteLog::getInfoStr() const
 
 //------------------------------------------------------------------------------
 
+MemUsage SQLiteLog::memoryUsage() const
+{
+    MemUsage mu;
+    mu.add("traces", mem::contBytes(_traces));
+    for (const SQLiteTrace* tr : _traces)
+    {
+        if (tr)
+            mu.add("traces", tr->memoryUsage());
+    }
+
+    size_t ids = mem::contBytes(_traceIDs);
+    for (const Attribute& a : _traceIDs)
+        ids += a.getPayloadSize();
+    mu.add("traceIDs", ids);
+    mu.add("logAttrs", nmAttrsBytes(_logAttributes));
+
+    size_t qrs = mem::contBytes(_workQueries);
+    for (const SqlQueriesMap::value_type& q : _workQueries)
+        qrs += mem::contBytes(q.first) + mem::contBytes(q.second);
+    mu.add("queries", qrs);
+
+    if (_strPool)
+        mu.add("strPool", _strPool->getBytes());
+
+    return mu;
+}
+
+//------------------------------------------------------------------------------
+
 SQLiteLog::AttributesMap SQLiteLog::getLogAttrsAsMap()
 {
     AttributesMap aMap;
@@ -943,7 +1012,7 @@ bool SQLiteLog::requestEventAttr(int traceNum, int eventNum,
         // 3-й параметр запроса — идентификатор атрибута — только для вертикального
         stmt->bindText(3, id);
 
-        return fetchAttributeVert(stmt.get(), id, a, 1, 2, 3);
+        return fetchAttributeVert(stmt.get(), id, a, 1, 2, 3, _strPool);
     }
 
     // горизонтальный режим
@@ -972,7 +1041,7 @@ bool SQLiteLog::requestEventAttrByID(int eventId, const char* id, Attribute& a)
         // 2-й параметр запроса — идентификатор атрибута — только для вертикального
         stmt->bindText(2, id);
 
-        return fetchAttributeVert(stmt.get(), id, a, 1, 2, 3);
+        return fetchAttributeVert(stmt.get(), id, a, 1, 2, 3, _strPool);
     }
 
     // горизонтальный режим
@@ -1003,7 +1072,7 @@ bool SQLiteLog::requestTraceAttr(int traceNum, const char* id, Attribute& a)
         // 2-й параметр запроса — идентификатор атрибута — только для вертикального
         stmt->bindText(2, id);
 
-        return fetchAttributeVert(stmt.get(), id, a, 1, 2, 3);
+        return fetchAttributeVert(stmt.get(), id, a, 1, 2, 3, _strPool);
     }
 
     // горизонтальный режим
@@ -1155,7 +1224,7 @@ bool SQLiteLog::fetchAttributeHor(SQLiteStmt* stmt, const char* aId, Attribute&
     {
         const char* cName = stmt->getColumnName(i);
         if (isStrsEq(aId, cName))                   // нашли параметр
-            return extractAttributeHor(stmt, i, a); // здесь ID не просим извлекать, т.к. итак его знаем
+            return extractAttributeHor(stmt, i, a, nullptr, _strPool); // здесь ID не просим извлекать, т.к. итак его знаем
     }
 
     return false;
@@ -1237,7 +1306,7 @@ std::string SQLiteLog::sqlizeString(const char* s, int lenHint /* = -1*/)
 //------------------------------------------------------------------------------
 
 bool SQLiteLog::extractAttributeVert(SQLiteStmt* stmt, std::string& aId, Attribute& a,
-    int idNum, int valNum, int typeNum)
+    int idNum, int valNum, int typeNum, xi::strutils::InternStrPool* strPool)
 {
     using xi::attributes::DestrByteArray;
     using xi::attributes::DestrObjSharedPtr;
@@ -1264,6 +1333,13 @@ bool SQLiteLog::extractAttributeVert(SQLiteStmt* stmt, std::string& aId, Attribu
         }
         case 2:
         {
+            if (strPool)                            // строка из пула: ищется прямо в буфере
+            {                                       // SQLite, память — только под новую
+                int size;
+                const char* cStr = (const char*)stmt->getCStr(valNum, size);
+                a = strPool->intern(std::string_view(cStr, size));
+                return true;
+            }
             std::string* s = new std::string(stmt->getStr(valNum));  // завели указатель
             xi::attributes::StringSharedPtr sp(s);              // умный указатель
             a = sp;                                     // вариант
@@ -1275,9 +1351,13 @@ bool SQLiteLog::extractAttributeVert(SQLiteStmt* stmt, std::string& aId, Attribu
             const void* rawData = stmt->getBlob(valNum, dataSize);
             if (!rawData)                   // может и не быть
                 return false;
+#ifdef XI_COMPACT_ATTRIBUTES
+            a = Attribute::bytes(rawData, dataSize);        // компактный атрибут ничем не владеет
+#else
             DestrByteArray* bArr = new DestrByteArray((const DestrByteArray::Byte*)rawData, dataSize);
             DestrObjSharedPtr bArrPtr(bArr);
             a = bArrPtr;
+#endif
             return true;
         }
     } // switch
@@ -1288,13 +1368,13 @@ bool SQLiteLog::extractAttributeVert(SQLiteStmt* stmt, std::string& aId, Attribu
 //------------------------------------------------------------------------------
 
 bool SQLiteLog::fetchAttributeVert(SQLiteStmt* stmt, const char* reqId, 
-    Attribute& a, int idNum, int valNum, int typeNum)
+    Attribute& a, int idNum, int valNum, int typeNum, xi::strutils::InternStrPool* strPool)
 {
     if (!stmt->fetch())
         return false;           // ну вот нетути такого
 
     std::string realId;
-    if (!extractAttributeVert(stmt, realId, a, idNum, valNum, typeNum))
+    if (!extractAttributeVert(stmt, realId, a, idNum, valNum, typeNum, strPool))
         throw LdopaException("Error when extracting log attribute: bad data.");
 
     // атрибут извлекся, проверим теперь его имя
@@ -1306,7 +1386,8 @@ bool SQLiteLog::fetchAttributeVert(SQLiteStmt* stmt, const char* reqId,
 
 //------------------------------------------------------------------------------
 
-bool SQLiteLog::extractAttributeHor(SQLiteStmt* stmt, int iCol, Attribute& a, std::string* aId)
+bool SQLiteLog::extractAttributeHor(SQLiteStmt* stmt, int iCol, Attribute& a, std::string* aId,
+    xi::strutils::InternStrPool* strPool)
 {
     using xi::attributes::DestrByteArray;
     using xi::attributes::DestrObjSharedPtr;
@@ -1336,6 +1417,13 @@ bool SQLiteLog::extractAttributeHor(SQLiteStmt* stmt, int iCol, Attribute& a, st
         }
         case SQLiteDB::stText:
         {
+            if (strPool)                            // строка из пула: ищется прямо в буфере
+            {                                       // SQLite, память — только под новую
+                int size;
+                const char* cStr = (const char*)stmt->getCStr(iCol, size);
+                a = strPool->intern(std::string_view(cStr, size));
+                return true;
+            }
             std::string* s = new std::string(stmt->getStr(iCol));  // завели указатель
             xi::attributes::StringSharedPtr sp(s);              // умный указатель
             a = sp;                                             // вариант
@@ -1347,9 +1435,13 @@ bool SQLiteLog::extractAttributeHor(SQLiteStmt* stmt, int iCol, Attribute& a, st
             const void* rawData = stmt->getBlob(iCol, dataSize);
             if (!rawData)                   // может и не быть
                 return false;
+#ifdef XI_COMPACT_ATTRIBUTES
+            a = Attribute::bytes(rawData, dataSize);        // компактный атрибут ничем не владеет
+#else
             DestrByteArray* bArr = new DestrByteArray((const DestrByteArray::Byte*)rawData, dataSize);
             DestrObjSharedPtr bArrPtr(bArr);
             a = bArrPtr;
+#endif
             return true;
         }
         case SQLiteDB::stNull:
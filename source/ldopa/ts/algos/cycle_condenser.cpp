@@ -325,10 +325,17 @@ CycleCondensedTsBuilder::TS* CycleCondensedTsBuilder::build(unsigned int k)
     _stIDsPool->setLimit(basis.getParikhVectors().size());
 
     _ts = new TS(_stIDsPool, _srcTs->getMapOfAttrsToIndexes());
+    _stateMap.clear();
 
     // Копируем старый TS, применяя к состояниям функцию _sf.
     copyTS();
 
+    // Частоты и принимающие состояния переносим отдельным проходом:
+    // в одно состояние _ts может склеиться несколько исходных
+    copyFreqs();
+    _ts->setTracesNum(_srcTs->getTracesNum());
+    _stateMap.clear();
+
 
     XI_LDOPA_ELAPSEDTIME_STOP(timer)
 
@@ -361,20 +368,55 @@ void CycleCondensedTsBuilder::copyTS()
             const TS::Attribute& lbl = _srcTs->getTransLbl(*origBeg);
 
             TS::State origTrg = _srcTs->getTargState(*origBeg);
+            bool visited = _stateMap.find(origTrg) != _stateMap.end();
             TS::State curTrg = copyState(origTrg);
 
-            TS::Transition t = _ts->getOrAddTrans(cur, curTrg, lbl);
+            _ts->getOrAddTrans(cur, curTrg, lbl);
 
-            q.push(std::make_pair(curTrg, origTrg));
+            // выходы уже скопированного состояния обработаны (или в очереди)
+            if (!visited)
+                q.push(std::make_pair(curTrg, origTrg));
         }
     }
 }
 
 //------------------------------------------------------------------------------
 
+void CycleCondensedTsBuilder::copyFreqs()
+{
+    // состояния, склеенные в одно, — принимающее, если принимающее хотя бы одно из них;
+    // копии состояний берутся из _stateMap, заполненной в copyTS()
+    TS::StateIter sBeg, sEnd;
+    for (boost::tie(sBeg, sEnd) = _srcTs->getStates(); sBeg != sEnd; ++sBeg)
+    {
+        if (_srcTs->isStateAccepting(*sBeg))
+            _ts->setAcceptingState(copyState(*sBeg), true);
+    }
+
+    // частоты склеенных переходов суммируются
+    TS::TransIter tBeg, tEnd;
+    for (boost::tie(tBeg, tEnd) = _srcTs->getTransitions(); tBeg != tEnd; ++tBeg)
+    {
+        TS::IntRes fr = _srcTs->getTransFreq(*tBeg);
+        if (!fr.second)
+            continue;
+
+        TS::Transition t = _ts->getOrAddTrans(copyState(_srcTs->getSrcState(*tBeg)),
+            copyState(_srcTs->getTargState(*tBeg)), _srcTs->getTransLbl(*tBeg));
+        TS::IntRes curFr = _ts->getTransFreq(t);
+        _ts->setTransFreq(t, curFr.second ? curFr.first + fr.first : fr.first);
+    }
+}
+
+//------------------------------------------------------------------------------
+
 CycleCondensedTsBuilder::TS::State CycleCondensedTsBuilder::copyState(
     TS::State stOrig) 
 {
+    StateMap::const_iterator it = _stateMap.find(stOrig);
+    if (it != _stateMap.end())
+        return it->second;
+
     const TS::ParikhVectorRes& pv_res = _srcTs->getParikhVector(stOrig);
     if (!pv_res.second) {
         throw LdopaException("State in TS does not have parikh vector.");
@@ -382,6 +424,7 @@ CycleCondensedTsBuilder::TS::State CycleCondensedTsBuilder::copyState(
 
     const IStateId* stID = _sf->makeState(pv_res.first);
     TS::State s = _ts->getOrAddState(stID);
+    _stateMap.insert(std::make_pair(stOrig, s));
 
     return s;
 }
@@ -4,10 +4,385 @@
 
 #include "xi/ldopa/ts/algos/dual_ts_simulator.h"
 
+// std
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <thread>
+#include <unordered_map>
+
+// boost
+#include <boost/functional/hash.hpp>
 
 
 namespace xi { namespace ldopa { namespace ts { ;   //
 
+namespace {
+
+/** \brief Access to a pair of regular TSs for PrecSimulation: states of TS1 get dense
+ *  indices in the order of TS1 states.
+ */
+class RegularPairAccess {
+public:
+    typedef DualTsSimulator::TS TS;
+    typedef TS::State State1;
+    typedef TS::State State2;
+
+    RegularPairAccess(const TS& ts1, const TS& ts2)
+        : _ts1(ts1), _ts2(ts2)
+    {
+        _idx.reserve(ts1.getStatesNum());
+        TS::StateIter sCur, sEnd;
+        for (boost::tie(sCur, sEnd) = ts1.getStates(); sCur != sEnd; ++sCur)
+            _idx.insert(std::make_pair(*sCur, _idx.size()));
+    }
+
+    size_t getStatesNum1() const { return _idx.size(); }
+    size_t index1(State1 s1) const { return _idx.find(s1)->second; }
+    State1 getInitState1() const { return _ts1.getInitState(); }
+    State2 getInitState2() const { return _ts2.getInitState(); }
+    bool isAccepting1(State1 s1) const { return _ts1.isStateAccepting(s1); }
+    bool isAccepting2(State2 s2) const { return _ts2.isStateAccepting(s2); }
+
+    /** \brief Calls \a f(matched, ns1, ns2) for every output transition of \a s1 and 
+     *  a transition of \a s2 with the same label, if any.
+     */
+    template <typename F>
+    void forEachOutTrans(State1 s1, State2 s2, F f) const
+    {
+        TS::OtransIter tCur, tEnd;
+        for (boost::tie(tCur, tEnd) = _ts1.getOutTransitions(s1); tCur != tEnd; ++tCur)
+        {
+            TS::TransRes trr = _ts2.getFirstOutTrans(s2, _ts1.getTransLbl(*tCur));
+            f(trr.second, _ts1.getTargState(*tCur), 
+                trr.second ? _ts2.getTargState(trr.first) : State2());
+        }
+    }
+
+protected:
+    const TS& _ts1;
+    const TS& _ts2;
+    std::unordered_map<State1, size_t> _idx;        ///< Dense indices of TS1 states.
+}; // class RegularPairAccess
+
+
+/** \brief Access to a pair of frozen TSs for PrecSimulation: labels are matched by codes. */
+class FrozenPairAccess {
+public:
+    typedef FrozenEvLogTS::Index Index;
+    typedef Index State1;
+    typedef Index State2;
+
+    FrozenPairAccess(const FrozenEvLogTS& ts1, const FrozenEvLogTS& ts2)
+        : _ts1(ts1), _ts2(ts2)
+        , _codes(ts1.getLabelsNum())
+    {
+        // коды меток TS1 → коды меток TS2
+        for (Index c = 0; c < _codes.size(); ++c)
+            _codes[c] = ts2.getLabelCode(ts1.getLabel(c));
+    }
+
+    size_t getStatesNum1() const { return _ts1.getStatesNum(); }
+    size_t index1(State1 s1) const { return s1; }
+    State1 getInitState1() const { return _ts1.getInitState(); }
+    State2 getInitState2() const { return _ts2.getInitState(); }
+    bool isAccepting1(State1 s1) const { return _ts1.isStateAccepting(s1); }
+    bool isAccepting2(State2 s2) const { return _ts2.isStateAccepting(s2); }
+
+    template <typename F>
+    void forEachOutTrans(State1 s1, State2 s2, F f) const
+    {
+        FrozenEvLogTS::OtransIter tCur, tEnd;
+        for (boost::tie(tCur, tEnd) = _ts1.getOutTransitions(s1); tCur != tEnd; ++tCur)
+        {
+            Index code = _codes[_ts1.getTransLblCode(*tCur)];
+            FrozenEvLogTS::TransRes trr = (code == FrozenEvLogTS::NO_INDEX)
+                ? FrozenEvLogTS::TransRes(code, false) : _ts2.getFirstOutTrans(s2, code);
+            f(trr.second, _ts1.getTargState(*tCur), 
+                trr.second ? _ts2.getTargState(trr.first) : FrozenEvLogTS::NO_INDEX);
+        }
+    }
+
+protected:
+    const FrozenEvLogTS& _ts1;
+    const FrozenEvLogTS& _ts2;
+    std::vector<Index> _codes;              ///< Codes of labels of TS2 by codes of TS1.
+}; // class FrozenPairAccess
+
+
+/** \brief Simulation of TS1 on TS2 through an accessor of type TAccess. */
+template <typename TAccess>
+class PrecSimulation {
+public:
+    typedef typename TAccess::State1 State1;
+    typedef typename TAccess::State2 State2;
+    typedef std::pair<State1, State2> Pair;
+    typedef DualTsSimulator::DblInt DblInt;
+    typedef DualTsSimulator::VecOfDblInts VecOfDblInts;
+
+    /** \brief Partial precision of a pair of states for a TS1 state with index idx. */
+    struct Term {
+        size_t idx;
+        double prec;
+        bool set;                           ///< False if the TS1 state has no outputs at all.
+    };
+
+    /** \brief Sparse partial precisions: TS1 state indices with sums. */
+    typedef std::vector<std::pair<size_t, DblInt>> SparsePrecs;
+
+    /** \brief Min number of subtrees for parallel simulation. */
+    static const size_t MIN_TASKS_NUM = 64;
+
+public:
+    explicit PrecSimulation(const TAccess& acc) : _acc(acc) {}
+
+    /** \brief Returns the initial pair of states. */
+    Pair getInitPair() const { return Pair(_acc.getInitState1(), _acc.getInitState2()); }
+
+    /** \brief Computes a partial precision of a pair \a p and appends pairs 
+     *  reached from it to \a kids.
+     */
+    Term expand(const Pair& p, std::vector<Pair>& kids) const
+    {
+        int pen = 0;                        // число выходных переходов, которые не могут быть проиграны
+        int numOfOutEdges = 0;
+        _acc.forEachOutTrans(p.first, p.second, [&](bool matched, State1 ns1, State2 ns2)
+        {
+            if (matched)
+                kids.push_back(Pair(ns1, ns2));
+            else
+                ++pen;
+            ++numOfOutEdges;
+        });
+
+        // принимающее состояние — как бы еще одна выходная транзиция; если 
+        // эквивалетное состояние TS2 не принимающее, то еще одна штрафочка
+        if (_acc.isAccepting1(p.first))
+        {
+            ++numOfOutEdges;
+            if (!_acc.isAccepting2(p.second))
+                ++pen;
+        }
+
+        // здесь по-прежнему игнорируем проблему отсутствующих выходов у не-fit 
+        // TS1 (например, "жирного")
+        Term t;
+        t.idx = _acc.index1(p.first);
+        t.set = (numOfOutEdges != 0);
+        t.prec = t.set ? (double)(numOfOutEdges - pen) / (double)numOfOutEdges : 0.;
+        return t;
+    }
+
+    /** \brief Simulates pairs reachable from \a root calling \a add(idx, prec) for their 
+     *  partial precisions in the order of the recursive algorithm: a pair after its subtree.
+     *
+     *  TS2 is a prefix tree, so there are no cycles of pairs.
+     */
+    template <typename TAdd>
+    void simulateSubtree(const Pair& root, TAdd add) const
+    {
+        struct Frame {
+            Term term;
+            size_t begin;                   ///< Pairs reached from the pair are kids[begin, end).
+            size_t next;
+            size_t end;
+        };
+
+        std::vector<Pair> kids;
+        std::vector<Frame> frames;
+        auto push = [&](const Pair& p)
+        {
+            Frame f;
+            f.begin = f.next = kids.size();
+            f.term = expand(p, kids);
+            f.end = kids.size();
+            frames.push_back(f);
+        };
+
+        push(root);
+        while (!frames.empty())
+        {
+            Frame& f = frames.back();
+            if (f.next < f.end)
+            {
+                Pair p = kids[f.next++];    // до push, который инвалидирует f
+                push(p);
+                continue;
+            }
+
+            if (f.term.set)
+                add(f.term.idx, f.term.prec);
+            kids.resize(f.begin);
+            frames.pop_back();
+        }
+    }
+
+    /** \brief Sequential simulation. */
+    void simulateSeq(VecOfDblInts& precs) const
+    {
+        simulateSubtree(getInitPair(), [&precs](size_t idx, double prec)
+        {
+            precs[idx].first += prec;
+            precs[idx].second += 1;
+        });
+    }
+
+    /** \brief Parallel simulation by \a thrNum threads. */
+    void simulatePar(unsigned int thrNum, VecOfDblInts& precs) const
+    {
+        // верхние уровни раскрываем, пока поддеревьев не станет достаточно; граница
+        // от числа потоков не зависит, поэтому и результат тоже
+        std::vector<Pair> frontier(1, getInitPair());
+        std::vector<Pair> next;
+        std::vector<Term> upper;
+        while (frontier.size() < MIN_TASKS_NUM)
+        {
+            next.clear();
+            for (const Pair& p : frontier)
+                upper.push_back(expand(p, next));
+            frontier.swap(next);
+            if (frontier.empty())
+                break;
+        }
+
+        // поддеревья берутся потоками по очереди, результаты — отдельно для каждого
+        std::vector<SparsePrecs> taskPrecs(frontier.size());
+        std::atomic<size_t> nextTask(0);
+        auto worker = [&]()
+        {
+            VecOfDblInts scratch(precs.size(), DblInt(0., 0.));
+            std::vector<size_t> touched;
+            for (size_t task = nextTask++; task < frontier.size(); task = nextTask++)
+            {
+                simulateSubtree(frontier[task], [&](size_t idx, double prec)
+                {
+                    if (!(scratch[idx].second > 0))
+                        touched.push_back(idx);
+                    scratch[idx].first += prec;
+                    scratch[idx].second += 1;
+                });
+
+                SparsePrecs& sp = taskPrecs[task];
+                sp.reserve(touched.size());
+                for (size_t idx : touched)
+                {
+                    sp.push_back(std::make_pair(idx, scratch[idx]));
+                    scratch[idx] = DblInt(0., 0.);
+                }
+                touched.clear();
+            }
+        };
+
+        const size_t thrs = std::min<size_t>(thrNum, frontier.size());
+        std::vector<std::thread> threads;
+        for (size_t i = 1; i < thrs; ++i)
+            threads.push_back(std::thread(worker));
+        worker();
+        for (std::thread& th : threads)
+            th.join();
+
+        // сведение в фиксированном порядке: поддеревья, затем верхние пары
+        for (const SparsePrecs& sp : taskPrecs)
+            for (const std::pair<size_t, DblInt>& ip : sp)
+            {
+                precs[ip.first].first += ip.second.first;
+                precs[ip.first].second += ip.second.second;
+            }
+        for (const Term& t : upper)
+            if (t.set)
+            {
+                precs[t.idx].first += t.prec;
+                precs[t.idx].second += 1;
+            }
+    }
+
+    /** \brief Simulation expanding every pair once; partial precisions of pairs are
+     *  taken with the numbers of paths leading to them.
+     */
+    void simulateMemo(VecOfDblInts& precs) const
+    {
+        typedef std::pair<size_t, State2> Key;
+
+        // граф пар: обход в глубину с нумерацией пар
+        std::unordered_map<Key, size_t, boost::hash<Key>> ids;
+        std::vector<Pair> pairs;
+        std::vector<Term> terms;
+        std::vector<std::pair<size_t, size_t>> kidRanges;
+        std::vector<size_t> kidIds;
+        std::vector<size_t> indeg;
+
+        std::vector<Pair> kids;
+        std::vector<size_t> stack;
+        auto getId = [&](const Pair& p) -> size_t
+        {
+            auto ins = ids.insert(std::make_pair(Key(_acc.index1(p.first), p.second), pairs.size()));
+            if (ins.second)
+            {
+                pairs.push_back(p);
+                terms.push_back(Term());
+                kidRanges.push_back(std::make_pair(0, 0));
+                indeg.push_back(0);
+                stack.push_back(ins.first->second);
+            }
+            return ins.first->second;
+        };
+
+        getId(getInitPair());
+        while (!stack.empty())
+        {
+            size_t id = stack.back();
+            stack.pop_back();
+
+            kids.clear();
+            terms[id] = expand(pairs[id], kids);
+            size_t begin = kidIds.size();
+            for (const Pair& k : kids)
+            {
+                size_t kid = getId(k);
+                kidIds.push_back(kid);
+                ++indeg[kid];
+            }
+            kidRanges[id] = std::make_pair(begin, kidIds.size());
+        }
+
+        // кратности пар — в топологическом порядке; число путей растет экспоненциально,
+        // поэтому считаем в double
+        std::vector<double> mult(pairs.size(), 0.);
+        mult[0] = 1.;
+        std::deque<size_t> queue(1, 0);
+        size_t done = 0;
+        while (!queue.empty())
+        {
+            size_t id = queue.front();
+            queue.pop_front();
+            ++done;
+
+            const Term& t = terms[id];
+            if (t.set)
+            {
+                precs[t.idx].first += mult[id] * t.prec;
+                precs[t.idx].second += mult[id];
+            }
+
+            for (size_t k = kidRanges[id].first; k < kidRanges[id].second; ++k)
+            {
+                size_t kid = kidIds[k];
+                mult[kid] += mult[id];
+                if (--indeg[kid] == 0)
+                    queue.push_back(kid);
+            }
+        }
+
+        if (done != pairs.size())
+            throw LdopaException("Can't simulate: pairs of states form a cycle.");
+    }
+
+protected:
+    const TAccess& _acc;
+}; // class PrecSimulation
+
+} // anonymous namespace
+
 //==============================================================================
 //  class DualTsSimulator
 //==============================================================================
@@ -16,12 +391,14 @@ namespace xi { namespace ldopa { namespace ts { ;   //
 DualTsSimulator::DualTsSimulator()
     : _ts1(nullptr)
     , _ts2(nullptr)
+    , _threadsNum(1)
+    , _pairsMemo(false)
 {
 }
 
 //------------------------------------------------------------------------------
 
-double DualTsSimulator::calcPrecision(TS* ts1, TS* ts2)
+double DualTsSimulator::calcPrecision(const TS* ts1, const TS* ts2)
 {
     _ts1 = ts1;
     _ts2 = ts2;
@@ -29,100 +406,58 @@ double DualTsSimulator::calcPrecision(TS* ts1, TS* ts2)
     if (!_ts1 || !_ts2)
         throw LdopaException("Can't simulate: either TS1 or TS2 is null.");
 
-    _partStatePrecs.clear();        // очищаем с прошлого раза, если было
-    
-    // рассчитываем частичную точность по состояниям
-    calcStatePrecision(_ts1->getInitState(), _ts2->getInitState());    
+    return simulate(RegularPairAccess(*_ts1, *_ts2));
+}
 
-    return sumPartialPrecisions();
+//------------------------------------------------------------------------------
+
+double DualTsSimulator::calcPrecision(const FrozenEvLogTS& ts1, const FrozenEvLogTS& ts2)
+{
+    if (ts1.getInitState() == FrozenEvLogTS::NO_INDEX || ts2.getInitState() == FrozenEvLogTS::NO_INDEX)
+        throw LdopaException("Can't simulate: either TS1 or TS2 has no initial state.");
+
+    return simulate(FrozenPairAccess(ts1, ts2));
 }
 
 //------------------------------------------------------------------------------
 
-void DualTsSimulator::calcStatePrecision(TS::State s1, TS::State s2)
+template <typename TAccess>
+double DualTsSimulator::simulate(const TAccess& acc)
 {
-    int pen = 0;        // число выходных переходов, которые не могут быть проиграны
-   
-    // перебираем все выходные транзиции состояния s1
-    int numOfOutEdges = 0;                                  // а также посчитаем их число
-    TS::OtransIter tCur, tEnd;    
-    for (boost::tie(tCur, tEnd) = _ts1->getOutTransitions(s1); tCur != tEnd; ++tCur)
-    {
-        // соответствующая выходная транзиция из состояния s2
-        TransRes trr = getMatchingTransOfTs2(*tCur, s2);
-        if (trr.second)                                     // есть такая!
-        {
-            State ns1 = _ts1->getTargState(*tCur);
-            State ns2 = _ts2->getTargState(trr.first);
-
-            // итеративно вызываем метод расчет частичной точности для новых состояний
-            // казалось бы, здесь могли бы попасть в цикл, т.к. _ts1 допускает циклы и
-            // даже петли, но! _ts2 — по определению префиксное дерево, т.е. там циклов
-            // точно не будет, а значит, однажды дойдя до листьев, алгоритм уйдет в 
-            // ветку else этого цикла, откуда произойдет рекурсивный выход
-            calcStatePrecision(ns1, ns2);
-        }
-        else                                                // нет такой! альтернативная ветка
-            ++pen;                                          // с выходом из рекурсии и подсчет пенальти
+    // частичные точности — по плотным индексам состояний TS1
+    _partStatePrecs.assign(acc.getStatesNum1(), DblInt(0., 0.));
 
-        ++numOfOutEdges;                                    // еще одна выходная транзиция
-    }
+    PrecSimulation<TAccess> sim(acc);
+    unsigned int thrNum = _threadsNum;
+    if (thrNum == 0)
+        thrNum = std::max(1u, std::thread::hardware_concurrency());
 
-    // после выхода из цикла перебора выходных транзиций, надо посомтреть на
-    // текущее состояние: если оно принимающее, это эквивалент того, 
-    // что у него как бы еще одна выходная транзиция была бы
-    if (_ts1->isStateAccepting(s1))
-    {
-        ++numOfOutEdges;
-        // а вот если эквивалетное состояние в префиксном дереве не принимающее, 
-        // то еще одна штрафочка
-        if (!_ts2->isStateAccepting(s2))
-            ++pen;
-    }
+    if (_pairsMemo)
+        sim.simulateMemo(_partStatePrecs);
+    else if (thrNum > 1)
+        sim.simulatePar(thrNum, _partStatePrecs);
+    else
+        sim.simulateSeq(_partStatePrecs);
 
-    // перед выходом из рекурсии посчитаем частичный пресижн текущего состояния
-    // здесь по-прежнему игнорируем проблему отсутствующих выходов у не-fit 
-    // TS1 (например, "жирного")
-    if (numOfOutEdges != 0)
-    {
-        // получастичный пресижн для текущего состояния и переподсчет частичного
-        double semiPartStatePrec = (double)(numOfOutEdges - pen) / (double)numOfOutEdges;
-        incStatePrecision(s1, semiPartStatePrec);         // пересчитываем
-    }
+    return sumPartialPrecisions();
 }
 
 //------------------------------------------------------------------------------
 
-void DualTsSimulator::incStatePrecision(State s1, double semiPartStatePrec)
+double DualTsSimulator::sumPartialPrecisions() const
 {
     // #apnote: в java-решении выполняется последовательное деление/умножение 
     // на число частичных пресижнов, что может привести к накоплению ошибки
     // дополнительной. В этой версии накапливаем сумму частичных пресижнов
     // и увеличивает число слагаемых, а подели один раз в конце!
-    
-    // берем парочку по ссылке так, что сразу можно писать в нее
-    DblInt& pprec = getStatePrecision(s1);       // здесь либо сущ, либо нули
-    
-    pprec.first += semiPartStatePrec;           // суммируем частичную точноть
-    ++pprec.second;                             // увеличиваем число слагаемых   
-}
-
-//------------------------------------------------------------------------------
-
-double DualTsSimulator::sumPartialPrecisions()
-{
     double sumPrec = 0;                         // сумма частичных пресижнов
     int num = 0;                                // их число
 
-    // берем все состояния _ts1
-    TS::StateIter tCur, tEnd;
-    for (boost::tie(tCur, tEnd) = _ts1->getStates(); tCur != tEnd; ++tCur)
+    for (const DblInt& stPr : _partStatePrecs)
     {
-        // берем частичный полупресижн для текущего состояния по ссылке, чтобы без копий
-        const DblInt& stPr = getStatePrecision(*tCur);
-        if (stPr.second != 0)                   // если есть хотя бы один полупресижн
+        if (stPr.second > 0)                    // если есть хотя бы один полупресижн
         {                                       // добавляем среднее полупресижнов
-            sumPrec += stPr.first / double(stPr.second);
+            sumPrec += stPr.first / stPr.second;
             ++num;                              // число средних увеличили
         }
     }
@@ -130,19 +465,5 @@ double DualTsSimulator::sumPartialPrecisions()
     return sumPrec / double(num);               // результат — среднее
 }
 
-//------------------------------------------------------------------------------
-
-DualTsSimulator::DblInt& DualTsSimulator::getStatePrecision(State s)
-{
-    StateDblIntMap::iterator it = _partStatePrecs.find(s);
-    if (it != _partStatePrecs.end())
-        return it->second;                  // есть такое
-
-    // иначе вставим и вернем       
-    it = (_partStatePrecs.insert(std::pair<TS::State, DblInt>   
-        (s, std::make_pair(0., 0)))).first;
-    return it->second;
-}
-
 
 }}} // namespace xi { namespace ldopa { namespace ts {
@@ -5,6 +5,7 @@
 #include "xi/ldopa/ts/algos/freq_condenser.h"
 
 #include <math.h>       // round
+#include <algorithm>
 
 #include "boost/tuple/tuple.hpp"
 using boost::tie;
@@ -20,7 +21,11 @@ namespace xi { namespace ldopa { namespace ts { ;   //
 CondensedTsBuilder::CondensedTsBuilder(TS* ts)
     : _srcTs(ts)
     , _ts(nullptr)
+    , _ovl(ts)
     , _threshold(0)
+    , _minPresFreq(0)
+    , _sweepPos(0)
+    , _sweeping(false)
 {
 
 }
@@ -61,6 +66,38 @@ CondensedTsBuilder::TS* CondensedTsBuilder::detach()
 //------------------------------------------------------------------------------
 
 CondensedTsBuilder::TS* CondensedTsBuilder::build(double threshold)
+{
+    // очищаем предыдущую TS, если была
+    cleanTS();
+
+    XI_LDOPA_ELAPSEDTIME_START(timer)
+    buildOverlay(threshold);
+    _ts = _ovl.materialize();                               // копируем только оставшееся
+    XI_LDOPA_ELAPSEDTIME_STOP(timer)
+
+    return _ts;
+}
+
+//------------------------------------------------------------------------------
+
+const EvLogTSOverlay* CondensedTsBuilder::buildOverlay(double threshold)
+{
+    setThreshold(threshold);
+    _sweeping = false;                                      // перебор порогов прерывается
+
+    _ovl.reset();                                           // вместо точной копии — пустой оверлей
+
+    markGauntTransitions();                                 // находим и помечаем все тонкие дуги
+    removeMarkedTransitions();                              // удаляем помеченные дуги
+    removeWidowStates();                                    // удаляем "вдовьи" вершины
+
+    return &_ovl;
+}
+
+
+//------------------------------------------------------------------------------
+
+void CondensedTsBuilder::setThreshold(double threshold)
 {
     if (!_srcTs)
         throw LdopaException("No source (full) TS set.");
@@ -71,22 +108,168 @@ CondensedTsBuilder::TS* CondensedTsBuilder::build(double threshold)
 
     _threshold = threshold;
     _minPresFreq = (int)round(threshold * _srcTs->getTracesNum());      // TODO: проконтроллировать
+}
 
+//------------------------------------------------------------------------------
 
-    // очищаем предыдущую TS, если была
+void CondensedTsBuilder::startSweep()
+{
+    if (!_srcTs)
+        throw LdopaException("No source (full) TS set.");
+
+    _ovl.reset();
+    _threshold = 0;
+    _minPresFreq = 0;
+
+    // переходы с частотами — по возрастанию частот; без частоты не удаляются никогда
+    _sweepTrans.clear();
+    _sweepTrans.reserve(_srcTs->getTransitionsNum());
+    for (TS::LogTS::TransIterPair trs = _srcTs->getTransitions();
+        trs.first != trs.second; ++trs.first)
+    {
+        EvLogTSWithFreqs::IntRes tr_r = _srcTs->getTransFreq(*trs.first);
+        if (tr_r.second)
+            _sweepTrans.push_back(FreqTrans(tr_r.first, *trs.first));
+    }
+    std::stable_sort(_sweepTrans.begin(), _sweepTrans.end(),
+        [](const FreqTrans& a, const FreqTrans& b) { return a.first < b.first; });
+    _sweepPos = 0;
+
+    // порядок состояний, в котором removeWidowStates() их проверяет
+    _stOrder.clear();
+    _stOrder.reserve(_srcTs->getStatesNum());
+    size_t pos = 0;
+    TS::LogTS::StateIter vi, viEnd;
+    for (tie(vi, viEnd) = _srcTs->getStates(); vi != viEnd; ++vi)
+        _stOrder[*vi] = pos++;
+
+    _sweeping = true;
+}
+
+//------------------------------------------------------------------------------
+
+const EvLogTSOverlay* CondensedTsBuilder::sweepOverlay(double threshold)
+{
+    if (!_sweeping)
+        startSweep();
+    else if (threshold < _threshold)
+        throw LdopaException("Sweep thresholds must go in ascending order.");
+
+    setThreshold(threshold);
+
+    // снимаем только переходы, частоты которых стали меньше мин. сохраняемой
+    std::vector<TS::State> cands;
+    for (; _sweepPos < _sweepTrans.size() && _sweepTrans[_sweepPos].first < _minPresFreq;
+        ++_sweepPos)
+    {
+        const TS::Transition& t = _sweepTrans[_sweepPos].second;
+        _ovl.removeTrans(t);
+        cands.push_back(_srcTs->getTargState(t));
+    }
+
+    // "вдовами" могут стать только цели снятых переходов (и далее по цепочке)
+    removeWidowStates(cands);
+
+    return &_ovl;
+}
+
+//------------------------------------------------------------------------------
+
+CondensedTsBuilder::TS* CondensedTsBuilder::sweep(double threshold)
+{
     cleanTS();
 
     XI_LDOPA_ELAPSEDTIME_START(timer)
-    _ts = new TS(*_srcTs);                                  // создаем точную копию пока
-
-    markGauntTransitions();                                 // находим и помечаем все тонкие дуги
-    removeMarkedTransitions();                              // удаляем помеченные дуги
-    removeWidowStates();                                    // удаляем "вдовьи" вершины
+    sweepOverlay(threshold);
+    _ts = _ovl.materialize();
     XI_LDOPA_ELAPSEDTIME_STOP(timer)
 
     return _ts;
 }
 
+//------------------------------------------------------------------------------
+
+CondensedTsBuilder::VecOfSweepPoints CondensedTsBuilder::sweepCounts(
+    const std::vector<double>& thresholds)
+{
+    VecOfSweepPoints res;
+    res.reserve(thresholds.size());
+
+    XI_LDOPA_ELAPSEDTIME_START(timer)
+    startSweep();
+    for (double thr : thresholds)
+    {
+        sweepOverlay(thr);
+
+        SweepPoint pt;
+        pt.threshold = thr;
+        pt.minPresFreq = _minPresFreq;
+        pt.statesNum = _ovl.getStatesNum();
+        pt.transNum = _ovl.getTransitionsNum();
+        res.push_back(pt);
+    }
+    XI_LDOPA_ELAPSEDTIME_STOP(timer)
+
+    return res;
+}
+
+//------------------------------------------------------------------------------
+
+bool CondensedTsBuilder::isTransGaunt(const TS::Transition& t) const
+{
+    EvLogTSWithFreqs::IntRes tr_r = _srcTs->getTransFreq(t);
+    return tr_r.second && tr_r.first < _minPresFreq;
+}
+
+//------------------------------------------------------------------------------
+
+bool CondensedTsBuilder::isStateWidow(TS::State s) const
+{
+    if (s == _srcTs->getInitState())
+        return false;
+
+    // при проходе removeWidowStates() к моменту проверки s удалены тонкие дуги и
+    // дуги удаленных ранее (предшествующих s) состояний
+    const size_t sPos = _stOrder.at(s);
+    for (TS::ItransIterPair its = _srcTs->getInTransitions(s); its.first != its.second; ++its.first)
+    {
+        const TS::Transition& t = *its.first;
+        if (isTransGaunt(t))
+            continue;
+
+        TS::State src = _srcTs->getSrcState(t);
+        if (_ovl.isStateRemoved(src) && _stOrder.at(src) < sPos)
+            continue;
+
+        return false;                                   // живая входная дуга
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------
+
+void CondensedTsBuilder::removeWidowStates(std::vector<TS::State>& cands)
+{
+    while (!cands.empty())
+    {
+        TS::State s = cands.back();
+        cands.pop_back();
+        if (_ovl.isStateRemoved(s) || !isStateWidow(s))
+            continue;
+
+        _ovl.removeState(s);
+
+        // удаление s сказывается только на следующих за ним состояниях
+        const size_t sPos = _stOrder.at(s);
+        for (TS::OtransIterPair ots = _srcTs->getOutTransitions(s); ots.first != ots.second; ++ots.first)
+        {
+            TS::State t = _srcTs->getTargState(*ots.first);
+            if (_stOrder.at(t) > sPos)
+                cands.push_back(t);
+        }
+    }
+}
 
 //------------------------------------------------------------------------------
 
@@ -97,11 +280,11 @@ void CondensedTsBuilder::markGauntTransitions()
 
     // берем все переходы и проверяем их частотность
     
-    for (TS::LogTS::TransIterPair trs = _ts->getTransitions();
+    for (TS::LogTS::TransIterPair trs = _srcTs->getTransitions();
         trs.first != trs.second; ++trs.first)
     {
         const TS::Transition& t = *(trs.first);               // для удобства
-        EvLogTSWithFreqs::IntRes tr_r = _ts->getTransFreq(t);
+        EvLogTSWithFreqs::IntRes tr_r = _srcTs->getTransFreq(t);
 
         // TODO: если частота для заданной дуги не задана, мы ее пока не удаляем, 
         // но в целом не очень понятно, от чего это может быть и как надо на это реагировать
@@ -121,7 +304,7 @@ void CondensedTsBuilder::markGauntTransitions()
 void CondensedTsBuilder::removeMarkedTransitions()
 {
     for (SetOfTransIter it = _trans2excl.begin(); it != _trans2excl.end(); ++it)
-        _ts->removeTrans(*it);
+        _ovl.removeTrans(*it);
 }
 
 //------------------------------------------------------------------------------
@@ -131,17 +314,15 @@ void CondensedTsBuilder::removeWidowStates()
     // см. про стабильность: http://www.boost.org/doc/libs/1_37_0/libs/graph/doc/adjacency_list.html
 
     // отдельно возьмем начальное состояние
-    TS::State init = _ts->getInitState();
+    TS::State init = _srcTs->getInitState();
 
-    // переберем все вершины
-    TS::LogTS::StateIter vi, viEnd, next;
-    tie(vi, viEnd) = _ts->getStates();
-    for (next = vi; vi != viEnd; vi = next)
+    // переберем все вершины; удаление в оверлее итераторы не инвалидирует
+    TS::LogTS::StateIter vi, viEnd;
+    for (tie(vi, viEnd) = _srcTs->getStates(); vi != viEnd; ++vi)
     { 
-        ++next;                                             // сразу переходим к след, чтобы не инвалидировать удалением
-        TS::State& s = *vi;                                 // текущее состояние
-        if (!_ts->hasInTransitions(s) && (s != init))
-            _ts->removeState(s);
+        TS::State s = *vi;                                  // текущее состояние
+        if (!_ovl.isStateRemoved(s) && !_ovl.hasInTransitions(s) && (s != init))
+            _ovl.removeState(s);
     }
     
 }
@@ -248,10 +248,15 @@ void TsFoldBuilder::processTrace(IEventTrace* tr)
 
         // получаем соответствующее состояние и между состояниями навешиваем транзицию
         TS::State curState = _ts->getOrAddState(stID);
-        _ts->getOrAddTransPV(prevState, curState, actAttr, 1);
+        _ts->getOrAddTransPVF(prevState, curState, actAttr, 1, 1);
 
         prevState = curState;
     }
+
+    // если в трассе было хотя бы одно событие, то появилось состояние, помимо
+    // начального, которое надо отметить принимающим
+    if (traceSize > 0)
+        _ts->setAcceptingState(prevState, true);
 }
 
 //------------------------------------------------------------------------------
@@ -278,10 +283,15 @@ void TsFoldBuilder::processTrace(int traceNum)
         TS::State curState = _ts->getOrAddState(stID);
 
         // между состояниями навешиваем транзицию
-        _ts->getOrAddTransPV(prevState, curState, actAttr, 1);
+        _ts->getOrAddTransPVF(prevState, curState, actAttr, 1, 1);
         prevState = curState;
 
     }
+
+    // если в трассе было хотя бы одно событие, то появилось состояние, помимо
+    // начального, которое надо отметить принимающим
+    if (traceSize > 0)
+        _ts->setAcceptingState(prevState, true);
 }
 
 
@@ -0,0 +1,261 @@
+// starting from 06.12.2018 we use a /FI approach to force including stdafx.h:
+// https://chadaustin.me/2009/05/unintrusive-precompiled-headers-pch/
+//#include "stdafx.h"
+
+#include "xi/ldopa/ts/algos/ts_grid_evaluator.h"
+#include "xi/ldopa/ts/algos/freq_condenser.h"
+#include "xi/ldopa/ts/algos/ts_metrics_calc.h"
+#include "xi/ldopa/ts/algos/ts_simple_builder.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <thread>
+
+
+namespace xi { namespace ldopa { namespace ts { ;   //
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+// время (мс) по настенным часам: clock() в нескольких потоках считает их общее время ЦП
+inline double msBetween(Clock::time_point from, Clock::time_point to)
+{
+    return std::chrono::duration<double, std::milli>(to - from).count();
+}
+
+// прерывает построение СП, как только она вместе с пулом ID превысит ограничение памяти
+class MemLimitCallback final : public IProgressCallback {
+public:
+    MemLimitCallback(const TsBuilder& bldr, const AttrListStateIDsPool& pool, size_t limit)
+        : _bldr(bldr), _pool(pool), _limit(limit), _bytes(0) {}
+public:
+    virtual Res progress(Byte) override
+    {
+        const TsBuilder::TS* ts = _bldr.getTS();
+        _bytes = (ts ? ts->memoryUsage().getTotal() : 0) + _pool.memoryUsage().getTotal();
+        return isExceeded() ? ResCancel : ResOK;
+    }
+
+    bool isExceeded() const { return _bytes > _limit; }
+    size_t getBytes() const { return _bytes; }
+protected:
+    const TsBuilder& _bldr;
+    const AttrListStateIDsPool& _pool;
+    size_t _limit;
+    size_t _bytes;                                      // память при последней проверке
+}; // class MemLimitCallback
+
+} // anonymous namespace
+
+//==============================================================================
+// class TsGridEvaluator
+//==============================================================================
+
+TsGridEvaluator::TsGridEvaluator(IEventLog* log)
+    : _log(log)
+    , _threadsNum(1)
+    , _memLimit(0)
+    , _zsa(VarWsTsBuilder::zsaSpecState)
+{
+    // префиксное дерево — полная СП для точности, одна на всех
+    PrefixStateFunc fnc(&_log, &_fullPool);
+    TsBuilder bldr(&_log, &fnc, &_fullPool);
+    bldr.build(false);
+    _fullTs.reset(bldr.detach());
+}
+
+//------------------------------------------------------------------------------
+
+TsGridEvaluator::VecOfCandidates TsGridEvaluator::makeGrid(const std::vector<int>& wss,
+    const std::vector<double>& thresholds, const std::vector<double>& vwscs)
+{
+    VecOfCandidates cands;
+    cands.reserve(wss.size() * thresholds.size() * vwscs.size());
+    for (int ws : wss)
+        for (double thr : thresholds)
+            for (double vwsc : vwscs)
+            {
+                Candidate c = { ws, thr, vwsc };
+                cands.push_back(c);
+            }
+
+    return cands;
+}
+
+//------------------------------------------------------------------------------
+
+TsGridEvaluator::VecOfResults TsGridEvaluator::evaluate(const VecOfCandidates& cands)
+{
+    Clock::time_point start = Clock::now();
+
+    VecOfResults res(cands.size());
+
+    // кандидаты с одинаковыми окном и порогом — одна задача, в порядке появления
+    std::vector<Task> tasks;
+    std::map<std::pair<int, double>, size_t> taskNums;
+    for (size_t i = 0; i < cands.size(); ++i)
+    {
+        const Candidate& c = cands[i];
+        auto ins = taskNums.insert(std::make_pair(std::make_pair(c.ws, c.threshold), tasks.size()));
+        if (ins.second)
+        {
+            Task t;
+            t.ws = c.ws;
+            t.threshold = c.threshold;
+            tasks.push_back(t);
+        }
+        tasks[ins.first->second].cands.push_back(i);
+
+        Result& r = res[i];
+        r.cand = c;
+        r.status = stError;
+        r.statesNum = r.transNum = 0;
+        r.simplicity = r.precision = r.generalization = -1;
+        r.buildTime = r.metricsTime = 0;
+        r.memBytes = 0;
+    }
+
+    unsigned int thrNum = _threadsNum;
+    if (thrNum == 0)
+        thrNum = std::max(1u, std::thread::hardware_concurrency());
+    thrNum = (unsigned int)std::min<size_t>(thrNum, tasks.size());
+
+    if (thrNum <= 1)
+    {
+        for (const Task& t : tasks)
+            runTask(t, &_log, cands, res);
+    }
+    else
+    {
+        // объекты трасс кешируются, поэтому у каждого потока — свой вид снимка: данные
+        // лога общие, раскодированные трассы свои
+        std::vector<std::unique_ptr<eventlog::CompactLog>> logs;
+        for (unsigned int i = 0; i < thrNum; ++i)
+            logs.emplace_back(new eventlog::CompactLog(_log, eventlog::CompactLog::ShareData()));
+
+        // свободный поток берет следующую задачу
+        std::atomic<size_t> next(0);
+        std::vector<std::thread> threads;
+        for (unsigned int i = 0; i < thrNum; ++i)
+            threads.push_back(std::thread([&, i]()
+            {
+                for (size_t t = next++; t < tasks.size(); t = next++)
+                    runTask(tasks[t], logs[i].get(), cands, res);
+            }));
+        for (std::thread& th : threads)
+            th.join();
+    }
+
+    _elapsed = msBetween(start, Clock::now());
+
+    return res;
+}
+
+//------------------------------------------------------------------------------
+
+void TsGridEvaluator::runTask(const Task& task, IEventLog* log, const VecOfCandidates& cands,
+    VecOfResults& res) const
+{
+    size_t done = 0;                                    // кандидаты задачи с результатом
+    try
+    {
+        Clock::time_point start = Clock::now();
+
+        // оставшиеся кандидаты задачи не строятся
+        auto rejectRest = [&](size_t memBytes)
+        {
+            for (; done < task.cands.size(); ++done)
+            {
+                Result& r = res[task.cands[done]];
+                r.status = stMemLimit;
+                r.buildTime = msBetween(start, Clock::now());
+                r.memBytes = memBytes;
+            }
+        };
+
+        // ID состояний всех СП задачи — в одном пуле: перестроение дополняет исходную СП
+        AttrListStateIDsPool pool;
+        PrefixStateFunc fnc(log, &pool, task.ws);
+        TsBuilder bldr(log, &fnc, &pool);
+
+        // СП с окном — самая большая, поэтому память проверяется уже при ее построении
+        MemLimitCallback memCb(bldr, pool, _memLimit);
+        if (_memLimit)
+            bldr.setProgressCB(&memCb);
+        TS* ts = nullptr;
+        try
+        {
+            ts = bldr.build(false);
+        }
+        catch (const LdopaException&)
+        {
+            if (!memCb.isExceeded())
+                throw;
+        }
+        if (!ts)
+        {
+            rejectRest(memCb.getBytes());
+            return;
+        }
+
+        CondensedTsBuilder reducer(ts);
+        TS* cts = reducer.build(task.threshold);
+        const size_t baseBytes = ts->memoryUsage().getTotal() + cts->memoryUsage().getTotal();
+
+        if (_memLimit && baseBytes + pool.memoryUsage().getTotal() > _memLimit)
+        {
+            rejectRest(baseBytes + pool.memoryUsage().getTotal());
+            return;
+        }
+
+        std::vector<double> vwscs;
+        vwscs.reserve(task.cands.size());
+        for (size_t c : task.cands)
+            vwscs.push_back(cands[c].vwsc);
+
+        // СП приходят в порядке vwscs; каждая удаляется после расчета метрик. потоки
+        // здесь не нужны: задачи и так считаются пулом
+        VarWsTsBuilder rebuilder(log, cts, &fnc);
+        rebuilder.setThreadsNum(1);
+        rebuilder.setMaxVariantsNum(1);
+        rebuilder.sweepVwsc(vwscs, _zsa, [&](double, TS* vts)
+        {
+            Result& r = res[task.cands[done]];
+            Clock::time_point built = Clock::now();
+            r.buildTime = msBetween(start, built);
+            r.statesNum = vts->getStatesNum();
+            r.transNum = vts->getTransitionsNum();
+            r.memBytes = baseBytes + vts->memoryUsage().getTotal() + pool.memoryUsage().getTotal();
+
+            if (_memLimit && r.memBytes > _memLimit)
+                r.status = stMemLimit;
+            else
+            {
+                TsMetricsCalc mCalc(log, _fullTs.get());
+                TsMetricsCalc::Metrics m = mCalc.calcAll(vts);
+                r.simplicity = m.simplicity;
+                r.precision = m.precision;
+                r.generalization = m.generalization;
+                r.status = stOk;
+            }
+            ++done;
+
+            start = Clock::now();
+            r.metricsTime = msBetween(built, start);
+
+            return false;
+        });
+    }
+    catch (const std::exception& e)
+    {
+        // остальные кандидаты задачи не построены
+        for (; done < task.cands.size(); ++done)
+            res[task.cands[done]].error = e.what();
+    }
+}
+
+
+}}} // namespace xi { namespace ldopa { namespace ts {
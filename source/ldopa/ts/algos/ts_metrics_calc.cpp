@@ -4,19 +4,288 @@
 
 #include "xi/ldopa/ts/algos/ts_metrics_calc.h"
 #include "xi/ldopa/ts/algos/dual_ts_simulator.h"
+#include "xi/ldopa/utils/elapsed_time.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cmath>    // <math.h> // sqrt
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// boost
+#include <boost/functional/hash.hpp>
 
 
 namespace xi { namespace ldopa { namespace ts { ;   //
 
+namespace {
+
+/** \brief Per-state data of a TS in flat arrays, indexed densely in the order of states. */
+struct StateArrays {
+    typedef EvLogTSWithFreqs TS;
+
+    /** \brief Marks no initial state. */
+    static const size_t NO_INDEX = (size_t)-1;
+
+    /** \brief Gathers data of a \a ts by a single pass over its states and out-transitions;
+     *  in-flow of the initial state (if any) is \a tracesNum.
+     */
+    void gather(const TS& ts, int tracesNum)
+    {
+        const size_t n = ts.getStatesNum();
+        idx.clear();
+        idx.reserve(n);
+        states.clear();
+        states.reserve(n);
+        accepting.assign(n, 0);
+        TS::StateIter sCur, sEnd;
+        for (boost::tie(sCur, sEnd) = ts.getStates(); sCur != sEnd; ++sCur)
+        {
+            accepting[states.size()] = ts.isStateAccepting(*sCur) ? 1 : 0;
+            idx.insert(std::make_pair(*sCur, states.size()));
+            states.push_back(*sCur);
+        }
+
+        inFlows.assign(n, 0);
+        outDegs.assign(n, 0);
+        for (size_t i = 0; i < n; ++i)
+        {
+            TS::OtransIter oCur, oEnd;
+            for (boost::tie(oCur, oEnd) = ts.getOutTransitions(states[i]); oCur != oEnd; ++oCur)
+            {
+                ++outDegs[i];
+                TS::IntRes trFreq = ts.getTransFreq(*oCur);
+                if (trFreq.second)
+                    inFlows[idx.find(ts.getTargState(*oCur))->second] += trFreq.first;
+            }
+        }
+
+        // у пустой СП начального состояния может и не быть
+        auto init = idx.find(ts.getInitState());
+        initIdx = (init != idx.end()) ? init->second : NO_INDEX;
+        if (initIdx != NO_INDEX)
+            inFlows[initIdx] = tracesNum;
+    }
+
+    std::unordered_map<TS::State, size_t> idx;      ///< Dense indices of states.
+    std::vector<TS::State> states;                  ///< States by indices.
+    std::vector<int> inFlows;                       ///< In-flows by transitions frequencies.
+    std::vector<int> outDegs;                       ///< Numbers of out-transitions.
+    std::vector<char> accepting;                    ///< Accepting flags.
+    size_t initIdx = NO_INDEX;                      ///< Index of the initial state.
+}; // struct StateArrays
+
+
+/** \brief Generalization by in-flows of states (zero in-flows are skipped). */
+double calcGeneralizationOf(const std::vector<int>& inFlows)
+{
+    const size_t n = inFlows.size();
+    const int* flows = inFlows.data();
+    double sum = 0;
+    for (size_t i = 0; i < n; ++i)
+        sum += (flows[i] != 0) ? 1 / sqrt((double)flows[i]) : 0.;
+
+    return 1 - sum / (double)n;
+}
+
+// генерализация для любого представления СП (EvLogTSWithFreqs, FrozenEvLogTS)
+template<typename TTs>
+double calcGeneralizationOf(const TTs& ts, int tracesNum)
+{
+    double sum = 0;                             // сумма гармонического среднего
+
+    // переберем все состояния ts
+    typename TTs::StateIter tCur, tEnd;
+    for (boost::tie(tCur, tEnd) = ts.getStates(); tCur != tEnd; ++tCur)
+    {
+        int stInFlow = 0;                       // входной поток
+        typename TTs::State st = *tCur;         // текущее состояния
+
+        // начальное состояние рассматриваем отдельно
+        if (ts.getInitState() == st)
+            stInFlow = tracesNum;               // все трассы
+        else                                    // входной поток реально считаем!
+        {
+            typename TTs::ItransIter iCur, iEnd;
+            for (boost::tie(iCur, iEnd) = ts.getInTransitions(st); iCur != iEnd; ++iCur)
+            {
+                typename TTs::IntRes trFreq = ts.getTransFreq(*iCur);
+                if (trFreq.second)              // что делать в противном случае, не понятно
+                    stInFlow += trFreq.first;
+            }
+        }
+
+        // если входной поток для некоторого состояния нулевой, это странно...
+        if (stInFlow != 0)
+            sum += (1 / sqrt((double)stInFlow));
+    }
+
+    // нормализуем по числу состояний
+    return 1 - sum / (double)(ts.getStatesNum());
+}
+
+
+/** \brief Replay of a log on a TS, which builds a prefix automaton of replayed prefixes
+ *  and counts in-flows of states.
+ *
+ *  A node of the automaton is a prefix of traces, which the TS replays up to its state
+ *  st; the node is accepting if a trace ends in it. Children of nodes are keyed by the
+ *  TS transitions, so only prefixes the TS can replay are kept.
+ */
+class LogReplay {
+public:
+    typedef EvLogTSWithFreqs TS;
+    typedef eventlog::IEventLog IEventLog;
+    typedef std::pair<double, int> DblInt;
+
+    /** \brief Prefix automaton node. */
+    struct Node {
+        TS::State st;                   ///< State of the TS reached by the prefix.
+        int kidsNum;                    ///< Number of longer replayed prefixes.
+        bool accepting;                 ///< A trace ends by the prefix.
+    };
+
+public:
+    /** \brief Constructor; \a arr are arrays gathered for the \a ts. */
+    LogReplay(const TS& ts, const StateArrays& arr) 
+        : _ts(ts)
+        , _arr(arr)
+    {
+        _inFlows.assign(arr.states.size(), 0);
+    }
+
+    /** \brief Replays all traces of a \a log. */
+    void replay(IEventLog* log)
+    {
+        log->open();
+        std::string actAttrID = log->getEvActAttrId();
+        if (actAttrID.empty())
+            throw LdopaException("Can't replay the log: ID for Activity attribute is not set.");
+
+        _nodes.clear();
+        _kids.clear();
+        _tracesNum = log->getTracesNum();
+        if (_arr.initIdx == StateArrays::NO_INDEX)      // СП не проигрывает ни одного префикса
+            return;
+
+        Node root = { _ts.getInitState(), 0, false };
+        _nodes.push_back(root);
+
+        for (int traceNum = 0; traceNum < _tracesNum; ++traceNum)
+        {
+            eventlog::IEventTrace* tr = log->getTrace(traceNum);
+            if (!tr)
+                throw LdopaException("Error getting a trace.");
+            int traceSize = tr->getSize();
+
+            size_t node = 0;                        // префикс трассы — узел автомата
+            TS::State cur = root.st;
+            bool fit = true;
+            for (int i = 0; i < traceSize && fit; ++i)
+            {
+                IEventLog::Attribute actAttr;
+                eventlog::IEvent* ev = tr->getEvent(i);
+                if (!ev)
+                    throw LdopaException("Error getting event.");
+                if (!ev->getAttr(actAttrID.c_str(), actAttr))
+                    throw LdopaException("Error getting event's attribute.");
+
+                TS::TransRes trr = _ts.getFirstOutTrans(cur, actAttr);
+                if (!trr.second)                    // дальше префиксы СП не проигрывает
+                {
+                    fit = false;
+                    break;
+                }
+                cur = _ts.getTargState(trr.first);
+                ++_inFlows[_arr.idx.find(cur)->second];
+
+                auto ins = _kids.insert(std::make_pair(NodeTrans(node, trr.first), _nodes.size()));
+                if (ins.second)                     // новый префикс
+                {
+                    ++_nodes[node].kidsNum;
+                    Node kid = { cur, 0, false };
+                    _nodes.push_back(kid);
+                }
+                node = ins.first->second;
+            }
+
+            if (fit)
+                _nodes[node].accepting = true;
+        }
+    }
+
+    /** \brief Calculates precision as DualTsSimulator does for the TS and a prefix tree. */
+    double calcPrecision() const
+    {
+        std::vector<DblInt> precs(_arr.states.size(), DblInt(0., 0));
+        for (const Node& n : _nodes)
+        {
+            size_t idx = _arr.idx.find(n.st)->second;
+
+            // выходные переходы, которых нет у префикса, — пенальти; также и принятие
+            int numOfOutEdges = _arr.outDegs[idx];
+            int pen = numOfOutEdges - n.kidsNum;
+            if (_arr.accepting[idx])
+            {
+                ++numOfOutEdges;
+                if (!n.accepting)
+                    ++pen;
+            }
+
+            if (numOfOutEdges != 0)
+            {
+                precs[idx].first += (double)(numOfOutEdges - pen) / (double)numOfOutEdges;
+                ++precs[idx].second;
+            }
+        }
+
+        double sumPrec = 0;
+        int num = 0;
+        for (const DblInt& stPr : precs)
+            if (stPr.second != 0)
+            {
+                sumPrec += stPr.first / double(stPr.second);
+                ++num;
+            }
+
+        return sumPrec / double(num);
+    }
+
+    /** \brief Calculates generalization by counted in-flows of states. */
+    double calcGeneralization() const
+    {
+        // как и в calcGeneralizationOf(), в начальное состояние входят все трассы
+        std::vector<int> inFlows = _inFlows;
+        if (_arr.initIdx != StateArrays::NO_INDEX)
+            inFlows[_arr.initIdx] = _tracesNum;
+
+        return calcGeneralizationOf(inFlows);
+    }
+
+    /** \brief Returns the number of nodes of the prefix automaton. */
+    size_t getNodesNum() const { return _nodes.size(); }
+
+protected:
+    typedef std::pair<size_t, TS::Transition> NodeTrans;
+
+    const TS& _ts;
+    const StateArrays& _arr;                        ///< Indices, out-degrees etc. of states.
+    std::vector<Node> _nodes;                       ///< Nodes of the prefix automaton.
+    std::unordered_map<NodeTrans, size_t, boost::hash<NodeTrans>> _kids;    ///< Children of nodes.
+    std::vector<int> _inFlows;                      ///< In-flows of states by indices.
+    int _tracesNum = 0;
+}; // class LogReplay
+
+} // anonymous namespace
+
 //==============================================================================
 //  class TsMetricsCalc
 //==============================================================================
 
 
 TsMetricsCalc::TsMetricsCalc(IEventLog* log, //const AttributesSet* logActivities, 
-    TsMetricsCalc::TS* _fullTs /*= nullptr*/)
+    const TsMetricsCalc::TS* _fullTs /*= nullptr*/)
     : _log(log)
     //, _logActivities(logActivities)
     , _ts(nullptr)
@@ -24,13 +293,16 @@ TsMetricsCalc::TsMetricsCalc(IEventLog* log, //const AttributesSet* logActivitie
     , _calculatedSimplicity(-1)     // has not been calculated yet
     , _calculatedPrecision(-1)      // has not been calculated yet
     , _calculatedGeneralization(-1) // has not been calculated yet
+    , _calculatedFitness(-1)        // has not been calculated yet
+    , _progrCB(nullptr)
+    , _threadsNum(1)
 {
 
 }
 
 //------------------------------------------------------------------------------
 
-void TsMetricsCalc::setAndCheckTs(TS* ts)
+void TsMetricsCalc::setAndCheckTs(const TS* ts)
 {
     if (ts)
         _ts = ts;
@@ -40,7 +312,7 @@ void TsMetricsCalc::setAndCheckTs(TS* ts)
 
 //------------------------------------------------------------------------------
 
-double TsMetricsCalc::calcSimplicity(TS* ts)
+double TsMetricsCalc::calcSimplicity(const TS* ts)
 {
     // TODO: возможно, проверку _log надо вынести в setAndCheckTs
     if (!_log)
@@ -49,8 +321,8 @@ double TsMetricsCalc::calcSimplicity(TS* ts)
 
     // три составляющие simplicity
     double nE = (double)(_log->getActivitiesNum());     // число (классов) активностей    
-    double nS = (double)ts->getStatesNum();             // число состояний в СП
-    double nT = (double)ts->getTransitionsNum();        // число переходов в СП
+    double nS = (double)_ts->getStatesNum();            // число состояний в СП
+    double nT = (double)_ts->getTransitionsNum();       // число переходов в СП
      
     _calculatedSimplicity = (nE + 1) / (nS + nT);
 
@@ -59,7 +331,7 @@ double TsMetricsCalc::calcSimplicity(TS* ts)
 
 //------------------------------------------------------------------------------
 
-double TsMetricsCalc::calcPrecision(TS* ts /*= nullptr*/)
+double TsMetricsCalc::calcPrecision(const TS* ts /*= nullptr*/)
 {
     if (!_fullTs)
         throw LdopaException("Can't calc TS precision: no full TS (prefix tree) is presented.");
@@ -67,62 +339,311 @@ double TsMetricsCalc::calcPrecision(TS* ts /*= nullptr*/)
     setAndCheckTs(ts);
 
     DualTsSimulator sim;
-    _calculatedPrecision = sim.calcPrecision(ts, _fullTs);
+    _calculatedPrecision = sim.calcPrecision(_ts, _fullTs);
 
     return _calculatedPrecision;
 }
 
 //------------------------------------------------------------------------------
 
-double TsMetricsCalc::calcGeneralization(TS* ts /*= nullptr*/)
+double TsMetricsCalc::calcGeneralization(const TS* ts /*= nullptr*/)
 {
     // TODO: возможно, проверку _log надо вынести в setAndCheckTs
     if (!_log)
         throw LdopaException("Can't calc TS precision: no event log is set.");
     setAndCheckTs(ts);
 
-    double sum = 0;                             // сумма гармонического среднего
+    _calculatedGeneralization = calcGeneralizationOf(*_ts, _log->getTracesNum());
 
-    // переберем все состояния _ts
-    TS::StateIter tCur, tEnd;
-    for (boost::tie(tCur, tEnd) = _ts->getStates(); tCur != tEnd; ++tCur)
-    {
-        int stInFlow;                           // выходной поток
-        TS::State& st = *tCur;                  // текущее состояния
-        
-        // начальное состояние рассматриваем отдельно
-        if (_ts->getInitState() == st)
-            stInFlow = _log->getTracesNum();    // все трассы
-        else                                    // входной поток реально
-            stInFlow = getStateInFlow(st);      // считаем!
+    return _calculatedGeneralization;
+}
 
-        // если входной поток для некоторого состояния нулевой, это странно...
-        if (stInFlow != 0)
-            sum += (1 / sqrt((double)stInFlow));
-    }
+//------------------------------------------------------------------------------
 
-    // нормализуем по числу состояний
-    sum = sum / (double)(_ts->getStatesNum());
-    _calculatedGeneralization = 1 - sum;
+double TsMetricsCalc::calcPrecisionByLog(const TS* ts /*= nullptr*/)
+{
+    if (!_log)
+        throw LdopaException("Can't calc TS precision: no event log is set.");
+    setAndCheckTs(ts);
+
+    StateArrays arr;
+    arr.gather(*_ts, _log->getTracesNum());
+    LogReplay lr(*_ts, arr);
+    lr.replay(_log);
+    _calculatedPrecision = lr.calcPrecision();
+
+    return _calculatedPrecision;
+}
+
+//------------------------------------------------------------------------------
+
+double TsMetricsCalc::calcGeneralizationByLog(const TS* ts /*= nullptr*/)
+{
+    if (!_log)
+        throw LdopaException("Can't calc TS generalization: no event log is set.");
+    setAndCheckTs(ts);
+
+    StateArrays arr;
+    arr.gather(*_ts, _log->getTracesNum());
+    LogReplay lr(*_ts, arr);
+    lr.replay(_log);
+    _calculatedGeneralization = lr.calcGeneralization();
 
     return _calculatedGeneralization;
 }
 
 //------------------------------------------------------------------------------
 
-int TsMetricsCalc::getStateInFlow(TS::State st) const
+TsMetricsCalc::Metrics TsMetricsCalc::calcAll(const TS* ts /*= nullptr*/)
 {
-    int sum = 0;
+    if (!_log)
+        throw LdopaException("Can't calc TS metrics: no event log is set.");
+    setAndCheckTs(ts);
 
-    TS::ItransIter tCur, tEnd;
-    for (boost::tie(tCur, tEnd) = _ts->getInTransitions(st); tCur != tEnd; ++tCur)
-    {
-        TS::IntRes trFreq = _ts->getTransFreq(*tCur);
-        if (trFreq.second)                      // что делать в противном случае, не понятно
-            sum += trFreq.first;
-    }    
+    Metrics res;
     
-    return sum;
+    // один проход по СП
+    XI_LDOPA_ELAPSEDTIME_START(gatherTimer)
+    StateArrays arr;
+    arr.gather(*_ts, _log->getTracesNum());
+    XI_LDOPA_ELAPSEDTIME_STOP_TO(gatherTimer, res.gatherTime)
+
+    // простота — по размерам
+    XI_LDOPA_ELAPSEDTIME_START(simplTimer)
+    double nE = (double)(_log->getActivitiesNum());
+    double nS = (double)arr.states.size();
+    double nT = 0;
+    for (size_t i = 0; i < arr.outDegs.size(); ++i)
+        nT += arr.outDegs[i];
+    _calculatedSimplicity = res.simplicity = (nE + 1) / (nS + nT);
+    XI_LDOPA_ELAPSEDTIME_STOP_TO(simplTimer, res.simplicityTime)
+
+    // генерализация — по входным потокам
+    XI_LDOPA_ELAPSEDTIME_START(genTimer)
+    _calculatedGeneralization = res.generalization = calcGeneralizationOf(arr.inFlows);
+    XI_LDOPA_ELAPSEDTIME_STOP_TO(genTimer, res.generalizationTime)
+
+    // точность — по полной СП, если она есть, иначе по логу
+    XI_LDOPA_ELAPSEDTIME_START(precTimer)
+    if (_fullTs)
+    {
+        DualTsSimulator sim;
+        res.precision = sim.calcPrecision(_ts, _fullTs);
+    }
+    else
+    {
+        LogReplay lr(*_ts, arr);
+        lr.replay(_log);
+        res.precision = lr.calcPrecision();
+    }
+    _calculatedPrecision = res.precision;
+    XI_LDOPA_ELAPSEDTIME_STOP_TO(precTimer, res.precisionTime)
+
+    return res;
+}
+
+//------------------------------------------------------------------------------
+
+TsMetricsCalc::Fitness TsMetricsCalc::calcFitness(const TS* ts /*= nullptr*/)
+{
+    setAndCheckTs(ts);
+
+    FrozenEvLogTS fts(*_ts);
+    return calcFitness(fts);
+}
+
+//------------------------------------------------------------------------------
+
+TsMetricsCalc::Fitness TsMetricsCalc::calcFitness(const FrozenEvLogTS& ts)
+{
+    typedef FrozenEvLogTS::LabelCode LabelCode;
+    typedef std::vector<LabelCode> Codes;
+
+    /** \brief Result of replaying a variant. */
+    struct VariantRes {
+        int prefixEventsNum;
+        int unmatchedEventsNum;
+        bool fits;
+    };
+
+    if (!_log)
+        throw LdopaException("Can't calc TS fitness: no event log is set.");
+    if (ts.getInitState() == FrozenEvLogTS::NO_INDEX)
+        throw LdopaException("Can't calc TS fitness: TS has no initial state.");
+
+    _log->open();
+    std::string actAttrID = _log->getEvActAttrId();
+    if (actAttrID.empty())
+        throw LdopaException("Can't replay the log: ID for Activity attribute is not set.");
+
+    // уведомляет о прогрессе, если он изменился; false — если надо прервать
+    int lastProgress = -1;
+    auto notify = [&](int curPr) -> bool
+    {
+        if (!_progrCB || curPr == lastProgress)
+            return true;
+        lastProgress = curPr;
+        return _progrCB->progress((IProgressCallback::Byte)curPr) != IProgressCallback::ResCancel;
+    };
+    const char* const CANCEL_MSG = "Interrupted at the request of the caller.";
+
+    Fitness res = {};
+    if (!notify(0))
+        throw LdopaException(CANCEL_MSG);
+
+    //----[варианты трасс — последовательности кодов меток]----
+    // активность, которой нет среди меток СП, получает NO_INDEX и не совпадет ни с чем
+    std::unordered_map<Codes, size_t, boost::hash<Codes>> varNums;
+    std::vector<const Codes*> variants;
+    std::vector<int> varFreqs;
+
+    res.tracesNum = _log->getTracesNum();
+    Codes codes;
+    for (int traceNum = 0; traceNum < res.tracesNum; ++traceNum)
+    {
+        eventlog::IEventTrace* tr = _log->getTrace(traceNum);
+        if (!tr)
+            throw LdopaException("Error getting a trace.");
+        int traceSize = tr->getSize();
+
+        codes.clear();
+        for (int i = 0; i < traceSize; ++i)
+        {
+            IEventLog::Attribute actAttr;
+            eventlog::IEvent* ev = tr->getEvent(i);
+            if (!ev)
+                throw LdopaException("Error getting event.");
+            if (!ev->getAttr(actAttrID.c_str(), actAttr))
+                throw LdopaException("Error getting event's attribute.");
+            codes.push_back(ts.getLabelCode(actAttr));
+        }
+        res.eventsNum += traceSize;
+
+        auto ins = varNums.insert(std::make_pair(codes, variants.size()));
+        if (ins.second)
+        {
+            variants.push_back(&ins.first->first);
+            varFreqs.push_back(0);
+        }
+        ++varFreqs[ins.first->second];
+
+        if (!notify((int)((double)traceNum / (double)res.tracesNum * 50.)))
+            throw LdopaException(CANCEL_MSG);
+    }
+    res.variantsNum = (int)variants.size();
+
+    //----[проигрывание вариантов]----
+    const size_t varsNum = variants.size();
+    std::vector<VariantRes> varRes(varsNum);
+    auto replay = [&](size_t v)
+    {
+        VariantRes& vr = varRes[v];
+        vr.prefixEventsNum = 0;
+        vr.unmatchedEventsNum = 0;
+
+        FrozenEvLogTS::State cur = ts.getInitState();
+        for (LabelCode code : *variants[v])
+        {
+            FrozenEvLogTS::TransRes trr(FrozenEvLogTS::NO_INDEX, false);
+            if (code != FrozenEvLogTS::NO_INDEX)
+                trr = ts.getFirstOutTrans(cur, code);
+            if (!trr.second)                    // событие пропускаем, состояние то же
+            {
+                ++vr.unmatchedEventsNum;
+                continue;
+            }
+            cur = ts.getTargState(trr.first);
+            if (vr.unmatchedEventsNum == 0)
+                ++vr.prefixEventsNum;
+        }
+        // пустая трасса подходит, только если начальное состояние принимающее
+        vr.fits = vr.unmatchedEventsNum == 0 && ts.isStateAccepting(cur);
+    };
+
+    unsigned int thrNum = _threadsNum;
+    if (thrNum == 0)
+        thrNum = std::max(1u, std::thread::hardware_concurrency());
+
+    // варианты берутся порциями; о прогрессе уведомляет только вызывающий поток
+    const size_t CHUNK_SIZE = 256;
+    std::atomic<size_t> next(0);
+    std::atomic<bool> cancelled(false);
+    auto work = [&](bool notifying)
+    {
+        for (size_t from = next.fetch_add(CHUNK_SIZE); from < varsNum && !cancelled;
+            from = next.fetch_add(CHUNK_SIZE))
+        {
+            size_t to = std::min(from + CHUNK_SIZE, varsNum);
+            for (size_t v = from; v < to; ++v)
+                replay(v);
+            if (notifying && !notify(50 + (int)((double)to / (double)varsNum * 50.)))
+                cancelled = true;
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (unsigned int i = 1; i < thrNum && i * CHUNK_SIZE < varsNum; ++i)
+        threads.push_back(std::thread(work, false));
+    work(true);
+    for (std::thread& th : threads)
+        th.join();
+    if (cancelled)
+        throw LdopaException(CANCEL_MSG);
+
+    // сводим по частотам вариантов
+    for (size_t v = 0; v < varsNum; ++v)
+    {
+        const VariantRes& vr = varRes[v];
+        res.prefixEventsNum += (EventsCount)vr.prefixEventsNum * varFreqs[v];
+        res.unmatchedEventsNum += (EventsCount)vr.unmatchedEventsNum * varFreqs[v];
+        if (vr.fits)
+            res.fittingTracesNum += varFreqs[v];
+    }
+    res.fitness = (res.eventsNum != 0)
+        ? 1 - (double)res.unmatchedEventsNum / (double)res.eventsNum : 1.;
+    _calculatedFitness = res.fitness;
+
+    notify(100);
+
+    return res;
+}
+
+//------------------------------------------------------------------------------
+
+double TsMetricsCalc::calcSimplicity(const FrozenEvLogTS& ts)
+{
+    if (!_log)
+        throw LdopaException("Can't calc TS simplicity: no event log is set.");
+
+    double nE = (double)(_log->getActivitiesNum());     // число (классов) активностей    
+    double nS = (double)ts.getStatesNum();              // число состояний в СП
+    double nT = (double)ts.getTransitionsNum();         // число переходов в СП
+
+    _calculatedSimplicity = (nE + 1) / (nS + nT);
+
+    return _calculatedSimplicity;
+}
+
+//------------------------------------------------------------------------------
+
+double TsMetricsCalc::calcPrecision(const FrozenEvLogTS& ts, const FrozenEvLogTS& fullTs)
+{
+    DualTsSimulator sim;
+    _calculatedPrecision = sim.calcPrecision(ts, fullTs);
+
+    return _calculatedPrecision;
+}
+
+//------------------------------------------------------------------------------
+
+double TsMetricsCalc::calcGeneralization(const FrozenEvLogTS& ts)
+{
+    if (!_log)
+        throw LdopaException("Can't calc TS generalization: no event log is set.");
+
+    _calculatedGeneralization = calcGeneralizationOf(ts, _log->getTracesNum());
+
+    return _calculatedGeneralization;
 }
 
 }}} // namespace xi { namespace ldopa { namespace ts {
@@ -209,7 +209,8 @@ void PrefixStateFunc::reset()
 
 
 TsBuilder::TsBuilder(IEventLog* log, ITsStateFunc* sf, IStateIDsPool* stIDsPool)
-    : _log(log)
+    : _settings(DEF_SETTINGS)
+    , _log(log)
     , _sf(sf)
     , _ts(nullptr)
     , _stIDsPool(stIDsPool)
@@ -248,7 +249,7 @@ TsBuilder::TS* TsBuilder::build(bool trackActivities)
 
     XI_LDOPA_ELAPSEDTIME_START(timer)
     _ts = new TS(_stIDsPool);
-
+    _ts->setTransIndexing(isIndexTransLbls());  // индекс переходов по меткам
 
     _tracesNum = _log->getTracesNum();
     _ts->setTracesNum(_tracesNum);              // сохраняем инф. о числе трасс в TS!
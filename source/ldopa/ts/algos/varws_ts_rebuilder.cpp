@@ -5,6 +5,11 @@
 #include "xi/ldopa/ts/algos/varws_ts_rebuilder.h"
 
 #include <cmath>
+#include <algorithm>
+#include <thread>
+#include <exception>
+#include <memory>
+#include <unordered_map>
 
 namespace xi { namespace ldopa { namespace ts { ;   //
 
@@ -19,6 +24,11 @@ VarWsTsBuilder::VarWsTsBuilder(IEventLog* log, TS* ts, ITsStateFuncVarWs* sf)
     , _srcTs(ts)
     , _ts(nullptr)
     , _tracesNum(0)
+    , _roundsNum(0)
+    , _replaysNum(0)
+    , _threadsNum(1)
+    , _maxVariantsNum(1)
+    , _restateMtx(nullptr)
     , _0wsStateSet(false)
 {
 }
@@ -72,6 +82,47 @@ void VarWsTsBuilder::reset()
     // множество временных транзиций
     _tempTrans.clear();
 
+    // поначалу не проиграна ни одна трасса
+    _pending.resize(_tracesNum);
+    for (int i = 0; i < _tracesNum; ++i)
+        _pending[i] = i;
+    _blocked.clear();
+    _blockedOrder.clear();
+    _restatedStates.clear();
+    _roundsNum = 0;
+    _replaysNum = 0;
+
+    // для параллельного проигрывания активности трасс читаются из лога один раз
+    _traceActs.reset();
+    if (_threadsNum != 1)
+        cacheTraceActs();
+}
+
+//------------------------------------------------------------------------------
+
+void VarWsTsBuilder::cacheTraceActs()
+{
+    std::shared_ptr<std::vector<VecOfActs>> traceActs(new std::vector<VecOfActs>(_tracesNum));
+    for (int traceNum = 0; traceNum < _tracesNum; ++traceNum)
+    {
+        IEventTrace* tr = _log->getTrace(traceNum);
+        if (!tr)
+            throw LdopaException("Error getting a trace.");
+        int traceSize = tr->getSize();
+
+        VecOfActs& acts = (*traceActs)[traceNum];
+        acts.resize(traceSize);
+        for (int i = 0; i < traceSize; ++i)
+        {
+            IEvent* ev = tr->getEvent(i);
+            if (!ev)
+                throw LdopaException("Error getting event.");
+            if (!ev->getAttr(_actAttrID.c_str(), acts[i]))
+                throw LdopaException("Error getting event's attribute.");
+        }
+    }
+
+    _traceActs = traceActs;
 }
 
 //------------------------------------------------------------------------------
@@ -107,25 +158,320 @@ VarWsTsBuilder::TS* VarWsTsBuilder::build(double vwsc, ZeroSizeWndAction zsa)
 
 void VarWsTsBuilder::replayLoop()
 {
-    // по крайней мере один раз все трассы надо проиграть
-    bool uncompleteTraces;
-    do {
-        uncompleteTraces = false;
+    // в каждом раунде проигрываем только недоигранные трассы (по возрастанию номеров)
+    unsigned int thrNum = _threadsNum;
+    if (thrNum == 0)
+        thrNum = std::max(1u, std::thread::hardware_concurrency());
+
+    IntVector stillPending;
+    std::vector<ReplayRes> res;
+    while (!_pending.empty())
+    {
+        stillPending.clear();
+        if (_traceActs)                                 // по закешированным активностям
+        {
+            replayPendingRO(thrNum, res);
 
-        // перебираем все трассы        
-        for (int i = 0; i < _tracesNum; ++i)
+            std::unique_lock<std::mutex> lk = lockRestate();
+            applyReplayRes(res, stillPending);
+            finishRound(stillPending);
+        }
+        else
         {
-            if (!replayTrace(i))
-                uncompleteTraces = true;
+            for (int traceNum : _pending)
+            {
+                if (!replayTrace(traceNum))
+                    stillPending.push_back(traceNum);
+            }
+            finishRound(stillPending);
         }
+    }
+}
 
-        // если хотя бы одну трассу не удалось проиграть, надо восстановить состояния всей системы
-        if (uncompleteTraces)
+//------------------------------------------------------------------------------
+
+void VarWsTsBuilder::finishRound(IntVector& stillPending)
+{
+    _replaysNum += (int)_pending.size();
+    _pending.swap(stillPending);
+    ++_roundsNum;
+
+    // если хотя бы одну трассу не удалось проиграть, восстанавливаем временные переходы
+    if (!_pending.empty())
+        restateBlocked();
+
+    if (_roundCb)
+        _roundCb(_roundsNum, (int)_pending.size());
+}
+
+//------------------------------------------------------------------------------
+
+std::unique_lock<std::mutex> VarWsTsBuilder::lockRestate()
+{
+    if (!_restateMtx)
+        return std::unique_lock<std::mutex>();
+
+    return std::unique_lock<std::mutex>(*_restateMtx);
+}
+
+//------------------------------------------------------------------------------
+
+void VarWsTsBuilder::replayPendingRO(unsigned int thrNum, std::vector<ReplayRes>& res) const
+{
+    // к началу раунда временных переходов нет, так что трассы проигрываются по 
+    // одним регулярным переходам, и СП во время проигрывания не меняется
+    const size_t pendNum = _pending.size();
+    res.resize(pendNum);
+    if (thrNum <= 1 || pendNum < 2)
+    {
+        for (size_t k = 0; k < pendNum; ++k)
+            res[k] = replayTraceRO(_pending[k]);
+        return;
+    }
+
+    const size_t chunk = (pendNum + thrNum - 1) / thrNum;
+    std::vector<std::thread> threads;
+    for (size_t from = 0; from < pendNum; from += chunk)
+    {
+        const size_t to = std::min(pendNum, from + chunk);
+        threads.push_back(std::thread([this, &res, from, to]()
+        {
+            for (size_t k = from; k < to; ++k)
+                res[k] = replayTraceRO(_pending[k]);
+        }));
+    }
+    for (std::thread& th : threads)
+        th.join();
+}
+
+//------------------------------------------------------------------------------
+
+void VarWsTsBuilder::applyReplayRes(const std::vector<ReplayRes>& res, IntVector& stillPending)
+{
+    // временные переходы создаем и учитываем по порядку трасс, как при последовательном проигрывании
+    for (size_t k = 0; k < res.size(); ++k)
+    {
+        const int traceNum = _pending[k];
+        const VecOfActs& acts = (*_traceActs)[traceNum];
+        const int eventNum = res[k].first;
+        if (eventNum == (int)acts.size())
+        {
+            setLastEventNum(traceNum, eventNum);            // трасса полностью проиграна
+            continue;
+        }
+
+        const TS::State curState = res[k].second;
+        setLastEvNumState(traceNum, eventNum, curState);
+        stillPending.push_back(traceNum);
+
+        // переход, если есть, может быть только временным, созданным на этом раунде
+        TS::TransRes trRes = _ts->getFirstOutTrans(curState, acts[eventNum]);
+        if (trRes.second)
+        {
+            incTransFreq(trRes.first);
+            blockTrace(trRes.first, traceNum);
+        }
+        else
         {
-            for (int i = 0; i < _tracesNum; ++i)
-                restateTrace(i);
+            TS::State sa = _ts->addAnonState();
+            TS::Transition ta = _ts->getOrAddTransF(curState, sa, acts[eventNum], 1);
+            markTransAsTemp(ta, true);
+            blockTrace(ta, traceNum);
         }
-    } while (uncompleteTraces);
+    }
+}
+
+//------------------------------------------------------------------------------
+
+VarWsTsBuilder::ReplayRes VarWsTsBuilder::replayTraceRO(int traceNum) const
+{
+    const VecOfActs& acts = (*_traceActs)[traceNum];
+    const int traceSize = (int)acts.size();
+
+    int lastEventNum = getLastEventNum(traceNum);
+    if (lastEventNum == traceSize)
+        return ReplayRes(traceSize, TS::State());
+
+    const TS* ts = _ts;                                 // только читаем
+    TS::State curState = (lastEventNum == 0) ? ts->getInitState() : getLastEventState(traceNum);
+    for (int i = lastEventNum; i < traceSize; ++i)
+    {
+        TS::TransRes trRes = ts->getFirstOutTrans(curState, acts[i]);
+        if (!trRes.second)
+            return ReplayRes(i, curState);
+
+        curState = ts->getTargState(trRes.first);
+    }
+
+    return ReplayRes(traceSize, curState);
+}
+
+//------------------------------------------------------------------------------
+
+VarWsTsBuilder::VecOfVwscPoints VarWsTsBuilder::sweepVwsc(const std::vector<double>& vwscs,
+    ZeroSizeWndAction zsa, const VwscCallback& cb)
+{
+    if (_log == nullptr)
+        throw LdopaException("Can't build a TS: no event log is set.");
+
+    if (_srcTs == nullptr)
+        throw LdopaException("No source (condensed) TS is set.");
+
+    cleanTS();
+    _zsa = zsa;
+
+    VecOfVwscPoints points;
+    points.reserve(vwscs.size());
+
+    XI_LDOPA_ELAPSEDTIME_START(timer)
+
+    // исходная СП копируется один раз; на ней проигрывается общий для всех vwsc первый
+    // раунд, т.к. до первого восстановления коэффициент ни на что не влияет
+    std::unique_ptr<TS> ts0(new TS(*_srcTs));
+    reset();
+    if (!_traceActs)
+        cacheTraceActs();
+    _ts = ts0.get();
+
+    unsigned int thrNum = _threadsNum;
+    if (thrNum == 0)
+        thrNum = std::max(1u, std::thread::hardware_concurrency());
+
+    std::vector<ReplayRes> res0;
+    replayPendingRO(thrNum, res0);
+    _ts = nullptr;
+
+    // варианты строятся пачками не более чем по _maxVariantsNum одновременно; 0 — по
+    // числу аппаратных потоков, а не все сразу: у каждого варианта свой поток и своя СП
+    const size_t batchSize = (_maxVariantsNum != 0) ? _maxVariantsNum
+        : std::max(1u, std::thread::hardware_concurrency());
+    std::mutex restateMtx;
+    for (size_t from = 0; from < vwscs.size(); from += batchSize)
+    {
+        const size_t to = std::min(vwscs.size(), from + batchSize);
+        std::vector<std::unique_ptr<VarWsTsBuilder>> vars;
+        for (size_t i = from; i < to; ++i)
+        {
+            vars.push_back(std::unique_ptr<VarWsTsBuilder>(new VarWsTsBuilder(_log, _srcTs, _sf)));
+            vars.back()->initVariant(*this, vwscs[i], 
+                (to - from > 1) ? 1 : thrNum, (to - from > 1) ? &restateMtx : nullptr);
+        }
+
+        if (vars.size() == 1)
+            vars[0]->replayVariant(*ts0, res0);
+        else
+        {
+            std::vector<std::exception_ptr> errs(vars.size());
+            std::vector<std::thread> threads;
+            for (size_t i = 0; i < vars.size(); ++i)
+                threads.push_back(std::thread([&, i]()
+                {
+                    try {
+                        vars[i]->replayVariant(*ts0, res0);
+                    }
+                    catch (...) {
+                        errs[i] = std::current_exception();
+                    }
+                }));
+            for (std::thread& th : threads)
+                th.join();
+            for (std::exception_ptr& e : errs)
+                if (e)
+                    std::rethrow_exception(e);
+        }
+
+        // результаты — по порядку коэффициентов
+        for (std::unique_ptr<VarWsTsBuilder>& var : vars)
+        {
+            VwscPoint pt;
+            pt.vwsc = var->_vwsc;
+            pt.statesNum = var->_ts->getStatesNum();
+            pt.transNum = var->_ts->getTransitionsNum();
+            pt.roundsNum = var->_roundsNum;
+            points.push_back(pt);
+
+            if (cb && cb(pt.vwsc, var->_ts))
+                var->detach();                          // СП забрал вызывающий
+        }
+    }
+    XI_LDOPA_ELAPSEDTIME_STOP(timer)
+
+    return points;
+}
+
+//------------------------------------------------------------------------------
+
+void VarWsTsBuilder::initVariant(const VarWsTsBuilder& base, double vwsc, 
+    unsigned int thrNum, std::mutex* restateMtx)
+{
+    _actAttrID = base._actAttrID;
+    _vwsc = vwsc;
+    _zsa = base._zsa;
+    _tracesNum = base._tracesNum;
+    _tracesCompl = base._tracesCompl;
+    _pending = base._pending;
+    _traceActs = base._traceActs;                       // активности общие
+    _threadsNum = thrNum;
+    _restateMtx = restateMtx;
+}
+
+//------------------------------------------------------------------------------
+
+void VarWsTsBuilder::replayVariant(const TS& ts0, const std::vector<ReplayRes>& res0)
+{
+    _ts = new TS(ts0);
+
+    // копия графа сохраняет порядок вершин, по нему переносим состояния первого раунда
+    std::unordered_map<TS::State, TS::State> stMap(ts0.getStatesNum());
+    TS::StateIterPair sts0 = ts0.getStates();
+    TS::StateIterPair sts = _ts->getStates();
+    for (; sts0.first != sts0.second; ++sts0.first, ++sts.first)
+        stMap[*sts0.first] = *sts.first;
+
+    std::vector<ReplayRes> res(res0);
+    for (ReplayRes& r : res)
+    {
+        auto it = stMap.find(r.second);
+        if (it != stMap.end())
+            r.second = it->second;
+    }
+
+    IntVector stillPending;
+    {
+        std::unique_lock<std::mutex> lk = lockRestate();
+        applyReplayRes(res, stillPending);
+        finishRound(stillPending);
+    }
+    replayLoop();                                       // остальные раунды — уже свои
+}
+
+//------------------------------------------------------------------------------
+
+void VarWsTsBuilder::blockTrace(TS::Transition t, int traceNum)
+{
+    IntVector& traces = _blocked[t];
+    if (traces.empty())
+        _blockedOrder.push_back(t);                     // новый временный переход
+    traces.push_back(traceNum);
+}
+
+//------------------------------------------------------------------------------
+
+void VarWsTsBuilder::restateBlocked()
+{
+    // временный переход создан первой (с наименьшим номером) из трасс, которые на нем 
+    // остановились, и именно по ней восстанавливается; для остальных трасс
+    // restateTrace() ничего бы не сделал; переходы — в порядке их создания, как и
+    // при восстановлении всех трасс по порядку
+    for (const TS::Transition& t : _blockedOrder)
+        restateTrace(_blocked[t].front());
+
+    // временные состояния — листья, на них ничего не ссылается, так что удаляются пачкой
+    _ts->removeStates(_restatedStates);
+    _restatedStates.clear();
+
+    _blocked.clear();
+    _blockedOrder.clear();
 }
 
 
@@ -175,6 +521,7 @@ bool VarWsTsBuilder::replayTrace(int traceNum)
             {
                 incTransFreq(t);                                        // увеличим частоту временной
                 setLastEvNumState(traceNum, i, curState);               // сохраняем предыдущее состояние!!!
+                blockTrace(t, traceNum);
 
                 return false;
             }
@@ -189,6 +536,7 @@ bool VarWsTsBuilder::replayTrace(int traceNum)
                 actAttr, 1);        // сразу частоту увеличим
             markTransAsTemp(ta, true);                                  // помечаем переход временным
             setLastEvNumState(traceNum, i, curState);                   // сохраняем предыдущее состояние!!!
+            blockTrace(ta, traceNum);
 
             return false;                                               // и пока с этой трассой все...
         }   // if ... else        
@@ -281,9 +629,9 @@ void VarWsTsBuilder::restateTrace(int traceNum)
         newState = _ts->getOrAddState(stID);
     }
 
-    // теперь удаляем пред. состояние и переход
+    // теперь удаляем пред. состояние и переход: состояние — в конце раунда, см. restateBlocked()
     markTransAsTemp(tempTrans, false);                      // убираем переход из множества временных
-    _ts->removeState(tempState);                            // убирая состояние из графа, автоматом уйдут связанные ребра
+    _restatedStates.push_back(tempState);                   // убирая состояние из графа, автоматом уйдут связанные ребра
 
     // наконец, наводим новый регулярный переход между последним норм. состоянием и новым состоянием
     _ts->getOrAddTransF(regState, newState, actAttr, freq);  // пусть уже и частота сохранится
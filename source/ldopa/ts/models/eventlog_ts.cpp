@@ -64,5 +64,77 @@ BaseEventLogTS& BaseEventLogTS::operator=(const BaseEventLogTS& that)
     return *this;
 }
 
+//------------------------------------------------------------------------------
+
+MemUsage BaseEventLogTS::memoryUsage() const
+{
+    MemUsage mu;
+    mu.add("lts.object", sizeof(LogTS));
+    mu.add("lts", _ts->memoryUsage());
+
+    return mu;
+}
+
+//------------------------------------------------------------------------------
+
+BaseEventLogTS::IntRes BaseEventLogTS::getTransFreq(Transition t) const
+{
+    const TransData& td = getTransData(t);
+    if (!td.freqSet)
+        return std::make_pair(int(), false);   
+
+    return std::make_pair(td.freq, true);
+}
+
+//------------------------------------------------------------------------------
+
+void BaseEventLogTS::setTransFreq(Transition t, int freq)
+{
+    TransData& td = getTransData(t);
+    td.freq = freq;
+    td.freqSet = true;
+}
+
+
+//------------------------------------------------------------------------------
+
+BaseEventLogTS::StateFlagsRes BaseEventLogTS::getStateFlags(State s) const
+{
+    const StateData& sd = getStateData(s);
+    if (!sd.flagsSet)
+        return std::make_pair(StateFlags(), false);
+
+    return std::make_pair(StateFlags(sd.flags), true);
+}
+
+//------------------------------------------------------------------------------
+
+void BaseEventLogTS::setStateFlags(State s, StateFlags sf)
+{
+    StateData& sd = getStateData(s);
+    sd.flags = (unsigned char)sf.to_ulong();
+    sd.flagsSet = true;
+}
+
+//------------------------------------------------------------------------------
+
+bool BaseEventLogTS::isStateAccepting(State s) const
+{
+    StateFlagsRes sfr = getStateFlags(s);
+    if (!sfr.second)                        // если вообще никакие флаги не установлены
+        return false;
+
+    return sfr.first.getAccepting() == StateFlags::triTrue;
+}
+
+//------------------------------------------------------------------------------
+
+void BaseEventLogTS::setAcceptingState(State s, bool accepting)
+{
+    StateFlagsRes sfr = getStateFlags(s);
+    sfr.first.setAccepting(accepting);
+    setStateFlags(s, sfr.first);
+}
+
 
 }}} // namespace xi { namespace ldopa { namespace ts {
@@ -150,6 +150,27 @@ size_t AttrListStateIDsPool::getSize() const
     return _poolSet->size();
 }
 
+//------------------------------------------------------------------------------
+
+MemUsage AttrListStateIDsPool::memoryUsage() const
+{
+    size_t attrs = 0;
+    size_t payloads = 0;
+    for (const AttrListStateId& stId : *_poolSet)
+    {
+        attrs += mem::contBytes(stId.getAttrs());
+        for (const AttrListStateId::VectorOfAttrs::value_type& a : stId.getAttrs())
+            payloads += a.getPayloadSize();
+    }
+
+    MemUsage mu;
+    mu.add("ids", sizeof(StateIDsSet) + mem::contBytes(*_poolSet));
+    mu.add("ids.attrs", attrs);
+    mu.add("ids.payloads", payloads);
+
+    return mu;
+}
+
 const AttrListStateId* AttrListStateIDsPool::operator[](const AttrListStateId& stId)
 {
     std::pair<StateIDsSetIter, bool> res = _poolSet->insert(stId);
@@ -324,6 +345,21 @@ size_t FixedIntListStateIdsPool::getSize() const
     return _poolSet->size();
 }
 
+//------------------------------------------------------------------------------
+
+MemUsage FixedIntListStateIdsPool::memoryUsage() const
+{
+    size_t ints = 0;
+    for (const FixedIntListStateId& stId : *_poolSet)
+        ints += mem::contBytes(stId.getAttrs());
+
+    MemUsage mu;
+    mu.add("ids", sizeof(StateIDsSet) + mem::contBytes(*_poolSet));
+    mu.add("ids.ints", ints);
+
+    return mu;
+}
+
 const FixedIntListStateId* FixedIntListStateIdsPool::operator[](const FixedIntListStateId& stId)
 {
     std::pair<StateIDsSetIter, bool> res = _poolSet->insert(stId);
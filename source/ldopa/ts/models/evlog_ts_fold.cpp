@@ -1,4 +1,5 @@
 #include "xi/ldopa/ts/models/evlog_ts_fold.h"
+#include "xi/ldopa/ts/models/frozen_ts.h"
 #include <numeric> // std::gcd
 
 
@@ -134,6 +135,37 @@ EvLogTSWithParVecs::ParikhVectorPtr EvLogTSWithParVecs::getParikhVectorPtr(State
 
 //------------------------------------------------------------------------------
 
+FrozenEvLogTS EvLogTSWithParVecs::freeze() const
+{
+    return FrozenEvLogTS(*this);
+}
+
+//------------------------------------------------------------------------------
+
+MemUsage EvLogTSWithParVecs::memoryUsage() const
+{
+    MemUsage mu = BaseEventLogTS::memoryUsage();
+
+    size_t pvs = mem::contBytes(_stateParVec);
+    for (const auto& sp : _stateParVec)
+        pvs += mem::contBytes(sp.second.GetAttrsCnt());
+    mu.add("parikhVectors", pvs);
+
+    size_t diffs = mem::contBytes(_diffs.getParikhVectors());
+    for (const ParikhVector& pv : _diffs.getParikhVectors())
+        diffs += mem::contBytes(pv.GetAttrsCnt());
+    mu.add("parikhDiffs", diffs);
+
+    size_t attrs = mem::contBytes(_attrInds);
+    for (const auto& ai : _attrInds)
+        attrs += ai.first.getPayloadSize();
+    mu.add("attrIndex", attrs);
+
+    return mu;
+}
+
+//------------------------------------------------------------------------------
+
 void EvLogTSWithParVecs::setParikhVector(State s, const ParikhVector* pv)
 {
     StateParikhVectorMap::iterator pvIt = _stateParVec.find(s);
@@ -189,4 +221,17 @@ EvLogTSWithParVecs::Transition EvLogTSWithParVecs::getOrAddTransPV(State s, Stat
 
 //------------------------------------------------------------------------------
 
+EvLogTSWithParVecs::Transition EvLogTSWithParVecs::getOrAddTransPVF(State s, State t, 
+    const Attribute& lbl, Value lblCnt, int addFreq) 
+{
+    Transition tr = getOrAddTransPV(s, t, lbl, lblCnt);
+
+    IntRes fr = getTransFreq(tr);
+    setTransFreq(tr, fr.second ? fr.first + addFreq : addFreq);
+
+    return tr;
+}
+
+//------------------------------------------------------------------------------
+
 }}} // namespace xi { namespace ldopa { namespace ts {
@@ -0,0 +1,1009 @@
+// starting from 06.12.2018 we use a /FI approach to force including stdafx.h:
+// https://chadaustin.me/2009/05/unintrusive-precompiled-headers-pch/
+//#include "stdafx.h"
+
+#include "xi/ldopa/ts/models/frozen_ts.h"
+#include "xi/ldopa/ts/models/overlay_ts.h"
+#include "xi/ldopa/ts/models/evlog_ts_fold.h"
+#include "xi/ldopa/ts/models/eventlog_ts_stateids.h"
+
+// std
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <map>
+#include <unordered_map>
+
+// mapping files into memory
+#ifdef _WIN32
+#include <iterator>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+namespace xi { namespace ldopa { namespace ts { ;   //
+
+//==============================================================================
+// Helpers
+//==============================================================================
+
+namespace {
+
+typedef FrozenEvLogTS::Index Index;
+typedef FrozenEvLogTS::Value Value;
+typedef FrozenEvLogTS::Attribute Attribute;
+typedef FrozenEvLogTS::IntRes IntRes;
+typedef EvLogTSWithFreqs::State SrcState;
+typedef EvLogTSWithFreqs::Transition SrcTrans;
+
+
+/** \brief Columns owned by a snapshot built in memory. */
+struct OwnedColumns {
+    std::vector<Index> outOffs;
+    std::vector<Index> srcs;
+    std::vector<Index> targs;
+    std::vector<Index> lblCodes;
+    std::vector<int> freqs;
+    std::vector<Index> inOffs;
+    std::vector<Index> inTrans;
+    std::vector<unsigned char> stFlags;
+    std::vector<Value> parVecs;
+};
+
+template<typename T>
+void bindColumn(FrozenEvLogTS::Column<T>& col, const std::vector<T>& v)
+{
+    col.data = v.data();
+    col.size = v.size();
+}
+
+template<typename T>
+void bindColumn(FrozenEvLogTS::Column<T>& col, const char* base, size_t bytes)
+{
+    col.data = reinterpret_cast<const T*>(base);
+    col.size = bytes / sizeof(T);
+}
+
+//------------------------------------------------------------------------------
+
+// начальное состояние исходной СП, если оно есть
+EvLogTSWithFreqs::StateRes getSrcInitState(const BaseEventLogTS& ts)
+{
+    if (!ts.getInitStateID())
+        return EvLogTSWithFreqs::StateRes(SrcState(), false);
+
+    return const_cast<BaseEventLogTS&>(ts).getState(ts.getInitStateID());
+}
+
+EvLogTSWithFreqs::StateRes getSrcInitState(const EvLogTSOverlay& ts)
+{
+    EvLogTSWithFreqs::StateRes init = getSrcInitState(*ts.getSrcTS());
+    if (init.second && ts.isStateRemoved(init.first))
+        init.second = false;
+
+    return init;
+}
+
+// частоты и флаги (если не заданы — NO_FREQ и не принимающее)
+template<typename TSrcTs>
+IntRes getSrcTransFreq(const TSrcTs& ts, SrcTrans t) { return ts.getTransFreq(t); }
+
+template<typename TSrcTs>
+bool isSrcStateAccepting(const TSrcTs& ts, SrcState s) { return ts.isStateAccepting(s); }
+
+// векторы Париха — только у EvLogTSWithParVecs
+template<typename TSrcTs>
+void getSrcParikhAttrs(const TSrcTs&, std::vector<Attribute>&) {}
+
+void getSrcParikhAttrs(const EvLogTSWithParVecs& ts, std::vector<Attribute>& attrs)
+{
+    attrs.resize(ts.getMapOfAttrsToIndexes().size());
+    for (const auto& ai : ts.getMapOfAttrsToIndexes())
+        attrs[ai.second] = ai.first;
+}
+
+template<typename TSrcTs>
+bool getSrcParikhVector(const TSrcTs&, SrcState, Value*, size_t) { return false; }
+
+bool getSrcParikhVector(const EvLogTSWithParVecs& ts, SrcState s, Value* out, size_t dim)
+{
+    EvLogTSWithParVecs::ParikhVectorRes pvr = ts.getParikhVector(s);
+    if (!pvr.second)
+        return false;
+
+    const std::vector<Value>& v = pvr.first.GetAttrsCnt();
+    std::copy(v.begin(), v.begin() + std::min(v.size(), dim), out);
+    return true;
+}
+
+//------------------------------------------------------------------------------
+// Binary format
+//------------------------------------------------------------------------------
+
+/** \brief Sections of a file. */
+enum Section {
+    secLabels,                  ///< Encoded labels.
+    secOutOffs,
+    secSrcs,
+    secTargs,
+    secLblCodes,
+    secFreqs,
+    secInOffs,
+    secInTrans,
+    secStFlags,
+    secParVecs,
+    secPvAttrs,                 ///< Encoded attributes of Parikh vector elements.
+    secStIdOffs,                ///< Offsets of state IDs in secStIdData, n + 1.
+    secStIdData,                ///< Codes of attributes (or integers) of state IDs.
+    secStIdAttrs,               ///< Encoded dictionary of attributes of state IDs.
+    sec__LAST
+};
+
+/** \brief Kinds of state IDs. */
+enum StIdKind {
+    sikNone,                    ///< State IDs are not saved.
+    sikAttrList,                ///< AttrListStateId.
+    sikFixedIntList,            ///< FixedIntListStateId.
+};
+
+const char FILE_MAGIC[8] = { 'L', 'D', 'O', 'P', 'A', 'F', 'T', 'S' };
+const std::uint32_t BYTE_ORDER_MARK = 0x01020304;
+const std::uint64_t SECTION_ALIGN = 8;
+
+/** \brief Header of a file; sections follow it aligned by SECTION_ALIGN. */
+struct FileHeader {
+    char magic[8];
+    std::uint32_t byteOrder;
+    std::uint32_t version;
+    std::uint32_t headerSize;
+    std::uint32_t flags;                ///< Bit 0: the snapshot has the initial state.
+    std::uint32_t statesNum;
+    std::uint32_t transNum;
+    std::uint32_t labelsNum;
+    std::uint32_t tracesNum;
+    std::int32_t maxWS;
+    std::uint32_t pvDim;
+    std::uint32_t pvAttrsNum;
+    std::uint32_t stIdKind;
+    std::uint32_t stIdAttrsNum;
+    std::uint32_t reserved;
+    std::uint64_t secOffs[sec__LAST];
+    std::uint64_t secSizes[sec__LAST];
+};
+
+// теги закодированных атрибутов
+enum AttrTag {
+    atBlank,
+    atInt,                      ///< Followed by the original type and 8 bytes.
+    atDouble,
+    atStr,                      ///< Followed by a 4-byte length and characters.
+};
+
+std::uint64_t alignUp(std::uint64_t bytes)
+{
+    return (bytes + SECTION_ALIGN - 1) / SECTION_ALIGN * SECTION_ALIGN;
+}
+
+bool isStrAttr(const Attribute& a)
+{
+#ifdef XI_COMPACT_ATTRIBUTES
+    return a.isStr();
+#else
+    switch (a.getType())
+    {
+    case Attribute::tCharP:
+    case Attribute::tCharCP:
+    case Attribute::tCStrSharedArr:
+    case Attribute::tStringSharedPtr:
+    case Attribute::tInternedStr:
+        return true;
+    default:
+        return false;
+    }
+#endif
+}
+
+void encodeAttr(const Attribute& a, std::string& out)
+{
+    int t = (int)a.getType();
+    if (t == Attribute::tBlank)
+    {
+        out.push_back((char)atBlank);
+        return;
+    }
+
+    if (t >= Attribute::tChar && t <= Attribute::tUInt64)
+    {
+        xi::types::TInt64 v = a.asInt64();
+        out.push_back((char)atInt);
+        out.push_back((char)t);
+        out.append((const char*)&v, sizeof(v));
+        return;
+    }
+
+    if (t == Attribute::tDouble)
+    {
+        double v = a.asDouble();
+        out.push_back((char)atDouble);
+        out.append((const char*)&v, sizeof(v));
+        return;
+    }
+
+    if (isStrAttr(a))
+    {
+        std::string s = a.toString();
+        std::uint32_t len = (std::uint32_t)s.size();
+        out.push_back((char)atStr);
+        out.append((const char*)&len, sizeof(len));
+        out.append(s);
+        return;
+    }
+
+    throw LdopaException::f("Can't save an attribute of type %d: only numbers and strings are supported.", t);
+}
+
+void checkAvail(const char* p, const char* end, size_t n)
+{
+    if ((size_t)(end - p) < n)
+        throw LdopaException("Malformed TS file: an attribute is truncated.");
+}
+
+Attribute decodeAttr(const char*& p, const char* end)
+{
+    checkAvail(p, end, 1);
+    AttrTag tag = (AttrTag)*p++;
+    switch (tag)
+    {
+    case atBlank:
+        return Attribute();
+
+    case atInt:
+    {
+        checkAvail(p, end, 1 + sizeof(xi::types::TInt64));
+        int t = (unsigned char)*p++;
+        xi::types::TInt64 v;
+        std::memcpy(&v, p, sizeof(v));
+        p += sizeof(v);
+        switch (t)
+        {
+        case Attribute::tChar:   return Attribute((char)v);
+        case Attribute::tUChar:  return Attribute((unsigned char)v);
+        case Attribute::tInt:    return Attribute((int)v);
+        case Attribute::tUInt:   return Attribute((unsigned int)v);
+        case Attribute::tInt64:  return Attribute(v);
+        case Attribute::tUInt64: return Attribute((xi::types::TQword)v);
+        default:
+            throw LdopaException("Malformed TS file: bad type of an integer attribute.");
+        }
+    }
+
+    case atDouble:
+    {
+        checkAvail(p, end, sizeof(double));
+        double v;
+        std::memcpy(&v, p, sizeof(v));
+        p += sizeof(v);
+        return Attribute(v);
+    }
+
+    case atStr:
+    {
+        checkAvail(p, end, sizeof(std::uint32_t));
+        std::uint32_t len;
+        std::memcpy(&len, p, sizeof(len));
+        p += sizeof(len);
+        checkAvail(p, end, len);
+        std::string s(p, len);
+        p += len;
+        return Attribute(s);
+    }
+
+    default:
+        throw LdopaException("Malformed TS file: bad attribute tag.");
+    }
+}
+
+std::string encodeAttrs(const std::vector<Attribute>& attrs)
+{
+    std::string out;
+    for (const Attribute& a : attrs)
+        encodeAttr(a, out);
+    return out;
+}
+
+std::vector<Attribute> decodeAttrs(const char* p, size_t bytes, size_t num)
+{
+    const char* end = p + bytes;
+    std::vector<Attribute> attrs;
+    attrs.reserve(num);
+    for (size_t i = 0; i < num; ++i)
+        attrs.push_back(decodeAttr(p, end));
+    return attrs;
+}
+
+//------------------------------------------------------------------------------
+
+/** \brief Read-only image of a file mapped into memory. */
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& fileName)
+        : _data(nullptr)
+        , _size(0)
+    {
+#ifdef _WIN32
+        std::ifstream f(fileName, std::ios::binary);
+        if (!f)
+            throw LdopaException::f("Can't open TS file %s.", fileName.c_str());
+        _buf.assign(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+        _data = _buf.data();
+        _size = _buf.size();
+#else
+        int fd = ::open(fileName.c_str(), O_RDONLY);
+        if (fd < 0)
+            throw LdopaException::f("Can't open TS file %s.", fileName.c_str());
+
+        struct stat st;
+        if (::fstat(fd, &st) != 0)
+        {
+            ::close(fd);
+            throw LdopaException::f("Can't get the size of TS file %s.", fileName.c_str());
+        }
+
+        _size = (size_t)st.st_size;
+        if (_size)
+        {
+            void* p = ::mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p == MAP_FAILED)
+            {
+                ::close(fd);
+                throw LdopaException::f("Can't map TS file %s.", fileName.c_str());
+            }
+            _data = (const char*)p;
+        }
+        ::close(fd);                                    // отображение остается действительным
+#endif
+    }
+
+    ~MappedFile()
+    {
+#ifndef _WIN32
+        if (_data)
+            ::munmap(const_cast<char*>(_data), _size);
+#endif
+    }
+
+    const char* getData() const { return _data; }
+    size_t getSize() const { return _size; }
+protected:
+    MappedFile(const MappedFile&);
+    MappedFile& operator=(const MappedFile&);
+protected:
+    const char* _data;
+    size_t _size;
+#ifdef _WIN32
+    std::vector<char> _buf;
+#endif
+};
+
+//------------------------------------------------------------------------------
+
+template<typename T>
+void writeColumn(std::ostream& os, const FrozenEvLogTS::Column<T>& col)
+{
+    if (col.size)
+        os.write((const char*)col.data, col.size * sizeof(T));
+}
+
+void writePadding(std::ostream& os, std::uint64_t bytes)
+{
+    static const char zeros[SECTION_ALIGN] = { 0 };
+    if (alignUp(bytes) != bytes)
+        os.write(zeros, alignUp(bytes) - bytes);
+}
+
+} // anonymous namespace
+
+
+//==============================================================================
+// class FrozenEvLogTS
+//==============================================================================
+
+const FrozenEvLogTS::Index FrozenEvLogTS::NO_INDEX;
+const int FrozenEvLogTS::NO_FREQ;
+const std::uint32_t FrozenEvLogTS::FILE_VERSION;
+
+//------------------------------------------------------------------------------
+
+FrozenEvLogTS::FrozenEvLogTS()
+    : _pvDim(0)
+    , _hasInitState(false)
+    , _tracesNum(0)
+    , _maxWS(0)
+{
+    std::shared_ptr<OwnedColumns> cols = std::make_shared<OwnedColumns>();
+    cols->outOffs.assign(1, 0);
+    cols->inOffs.assign(1, 0);
+    bindColumn(_outOffs, cols->outOffs);
+    bindColumn(_inOffs, cols->inOffs);
+    _storage = cols;
+}
+
+//------------------------------------------------------------------------------
+
+FrozenEvLogTS::FrozenEvLogTS(const EvLogTSWithFreqs& ts)
+    : _pvDim(0)
+    , _hasInitState(false)
+    , _tracesNum(ts.getTracesNum())
+    , _maxWS(ts.getMaxWS())
+{
+    init(ts);
+}
+
+//------------------------------------------------------------------------------
+
+FrozenEvLogTS::FrozenEvLogTS(const EvLogTSOverlay& ts)
+    : _pvDim(0)
+    , _hasInitState(false)
+    , _tracesNum(ts.getTracesNum())
+    , _maxWS(ts.getMaxWS())
+{
+    init(ts);
+}
+
+//------------------------------------------------------------------------------
+
+FrozenEvLogTS::FrozenEvLogTS(const EvLogTSWithParVecs& ts)
+    : _pvDim(0)
+    , _hasInitState(false)
+    , _tracesNum(ts.getTracesNum())
+    , _maxWS(0)
+{
+    init(ts);
+}
+
+//------------------------------------------------------------------------------
+
+template<typename TSrcTs>
+void FrozenEvLogTS::init(const TSrcTs& ts)
+{
+    std::shared_ptr<OwnedColumns> cols = std::make_shared<OwnedColumns>();
+
+    // коды меток — в порядке самих меток
+    std::map<Attribute, LabelCode> lblCodes;
+    typename TSrcTs::TransIterPair trs = ts.getTransitions();
+    for (; trs.first != trs.second; ++trs.first)
+        lblCodes.emplace(ts.getTransLbl(*trs.first), 0);
+
+    _labels.reserve(lblCodes.size());
+    for (auto& lc : lblCodes)
+    {
+        lc.second = (LabelCode)_labels.size();
+        _labels.push_back(lc.first);
+    }
+    sortLabels();
+
+    // нумерация состояний обходом в ширину от начального, затем — недостижимые
+    size_t statesNum = ts.getStatesNum();
+    std::unordered_map<SrcState, State> stIdx(statesNum);
+    _origStates.reserve(statesNum);
+
+    std::vector<std::vector<std::pair<LabelCode, SrcTrans>>> outs;    // выходные по состояниям
+    outs.reserve(statesNum);
+    std::deque<SrcState> queue;
+
+    auto visit = [&](SrcState s) {
+        if (stIdx.emplace(s, (State)_origStates.size()).second)
+        {
+            _origStates.push_back(s);
+            queue.push_back(s);
+        }
+    };
+
+    auto bfs = [&]() {
+        while (!queue.empty())
+        {
+            SrcState s = queue.front();
+            queue.pop_front();
+
+            std::vector<std::pair<LabelCode, SrcTrans>> sOuts;
+            typename TSrcTs::OtransIterPair ots = ts.getOutTransitions(s);
+            for (; ots.first != ots.second; ++ots.first)
+                sOuts.push_back(std::make_pair(lblCodes[ts.getTransLbl(*ots.first)], *ots.first));
+            std::stable_sort(sOuts.begin(), sOuts.end(),
+                [](const std::pair<LabelCode, SrcTrans>& a, const std::pair<LabelCode, SrcTrans>& b)
+                    { return a.first < b.first; });
+
+            for (const auto& o : sOuts)
+                visit(ts.getTargState(o.second));
+            outs.push_back(std::move(sOuts));           // состояния извлекаются в порядке номеров
+        }
+    };
+
+    EvLogTSWithFreqs::StateRes init = getSrcInitState(ts);
+    if (init.second)
+    {
+        _hasInitState = true;
+        visit(init.first);
+        bfs();
+    }
+
+    typename TSrcTs::StateIterPair sts = ts.getStates();
+    for (; sts.first != sts.second; ++sts.first)
+    {
+        visit(*sts.first);
+        bfs();
+    }
+
+    // состояния
+    size_t n = _origStates.size();
+    getSrcParikhAttrs(ts, _pvAttrs);
+    _pvDim = (Uint)_pvAttrs.size();
+    _stateIds.resize(n);
+    cols->stFlags.resize(n);
+    cols->parVecs.resize(n * _pvDim);
+    for (State i = 0; i < n; ++i)
+    {
+        SrcState s = _origStates[i];
+        bool anon = ts.isStateAnon(s);
+        _stateIds[i] = anon ? nullptr : ts.getStateID(s);
+
+        unsigned char fl = 0;
+        if (anon)
+            fl |= SF_ANON;
+        if (isSrcStateAccepting(ts, s))
+            fl |= SF_ACCEPTING;
+        if (_pvDim && getSrcParikhVector(ts, s, cols->parVecs.data() + (size_t)i * _pvDim, _pvDim))
+            fl |= SF_PARVEC;
+        cols->stFlags[i] = fl;
+    }
+
+    // выходные переходы
+    size_t m = ts.getTransitionsNum();
+    cols->outOffs.resize(n + 1);
+    cols->srcs.reserve(m);
+    cols->targs.reserve(m);
+    cols->lblCodes.reserve(m);
+    cols->freqs.reserve(m);
+    for (State i = 0; i < n; ++i)
+    {
+        cols->outOffs[i] = (Index)cols->targs.size();
+        for (const auto& o : outs[i])
+        {
+            cols->srcs.push_back(i);
+            cols->targs.push_back(stIdx[ts.getTargState(o.second)]);
+            cols->lblCodes.push_back(o.first);
+            IntRes f = getSrcTransFreq(ts, o.second);
+            cols->freqs.push_back(f.second ? f.first : NO_FREQ);
+        }
+    }
+    cols->outOffs[n] = (Index)cols->targs.size();
+
+    // входные переходы: подсчет и раскладка
+    cols->inOffs.assign(n + 1, 0);
+    for (State t : cols->targs)
+        ++cols->inOffs[t + 1];
+    for (size_t i = 0; i < n; ++i)
+        cols->inOffs[i + 1] += cols->inOffs[i];
+
+    cols->inTrans.resize(cols->targs.size());
+    std::vector<Index> fill(cols->inOffs.begin(), cols->inOffs.end() - 1);
+    for (Transition t = 0; t < cols->targs.size(); ++t)
+        cols->inTrans[fill[cols->targs[t]]++] = t;
+
+    bindColumn(_outOffs, cols->outOffs);
+    bindColumn(_srcs, cols->srcs);
+    bindColumn(_targs, cols->targs);
+    bindColumn(_lblCodes, cols->lblCodes);
+    bindColumn(_freqs, cols->freqs);
+    bindColumn(_inOffs, cols->inOffs);
+    bindColumn(_inTrans, cols->inTrans);
+    bindColumn(_stFlags, cols->stFlags);
+    bindColumn(_parVecs, cols->parVecs);
+    _storage = cols;
+}
+
+//------------------------------------------------------------------------------
+
+void FrozenEvLogTS::sortLabels()
+{
+    // у загруженного снимка строки восстанавливаются как std::string,
+    // поэтому порядок кодов может не совпасть с порядком меток; со строками
+    // из пула они сравниваются по содержимому
+    _lblSorted.resize(_labels.size());
+    for (LabelCode c = 0; c < _lblSorted.size(); ++c)
+        _lblSorted[c] = c;
+
+    std::stable_sort(_lblSorted.begin(), _lblSorted.end(),
+        [this](LabelCode a, LabelCode b) { return _labels[a] < _labels[b]; });
+}
+
+//------------------------------------------------------------------------------
+
+FrozenEvLogTS::LabelCode FrozenEvLogTS::getLabelCode(const Attribute& lbl) const
+{
+    std::vector<LabelCode>::const_iterator it =
+        std::lower_bound(_lblSorted.begin(), _lblSorted.end(), lbl,
+            [this](LabelCode c, const Attribute& l) { return _labels[c] < l; });
+    if (it == _lblSorted.end() || !(_labels[*it] == lbl))
+        return NO_INDEX;
+
+    return *it;
+}
+
+//------------------------------------------------------------------------------
+
+FrozenEvLogTS::TransRes FrozenEvLogTS::getFirstOutTrans(State s, LabelCode code) const
+{
+    const LabelCode* beg = _lblCodes.begin() + _outOffs[s];
+    const LabelCode* end = _lblCodes.begin() + _outOffs[s + 1];
+
+    // выходные переходы упорядочены по кодам меток
+    const LabelCode* it = std::lower_bound(beg, end, code);
+    if (it == end || *it != code)
+        return TransRes(NO_INDEX, false);
+
+    return TransRes((Transition)(it - _lblCodes.begin()), true);
+}
+
+//------------------------------------------------------------------------------
+
+FrozenEvLogTS::TransRes FrozenEvLogTS::getTrans(State s, State t, const Attribute& lbl) const
+{
+    LabelCode code = getLabelCode(lbl);
+    if (code == NO_INDEX)
+        return TransRes(NO_INDEX, false);
+
+    for (TransRes tr = getFirstOutTrans(s, code);
+        tr.first < _outOffs[s + 1] && _lblCodes[tr.first] == code; ++tr.first)
+    {
+        if (_targs[tr.first] == t)
+            return tr;
+    }
+
+    return TransRes(NO_INDEX, false);
+}
+
+//------------------------------------------------------------------------------
+
+MemUsage FrozenEvLogTS::memoryUsage() const
+{
+    MemUsage mu;
+    mu.add("columns", sizeof(Index) * (_outOffs.size + _inOffs.size + _inTrans.size)
+        + sizeof(State) * (_srcs.size + _targs.size)
+        + sizeof(LabelCode) * _lblCodes.size + sizeof(int) * _freqs.size
+        + _stFlags.size + sizeof(Value) * _parVecs.size);
+    mu.add("stateIds", mem::contBytes(_stateIds));
+    mu.add("origStates", mem::contBytes(_origStates));
+
+    size_t lbls = mem::contBytes(_labels) + mem::contBytes(_lblSorted) + mem::contBytes(_pvAttrs);
+    for (const Attribute& a : _labels)
+        lbls += a.getPayloadSize();
+    for (const Attribute& a : _pvAttrs)
+        lbls += a.getPayloadSize();
+    mu.add("labels", lbls);
+
+    return mu;
+}
+
+//------------------------------------------------------------------------------
+
+void FrozenEvLogTS::save(std::ostream& os) const
+{
+    size_t n = getStatesNum();
+
+    // 1-й проход по ID состояний: вид, объем данных и словарь атрибутов
+    StIdKind stIdKind = sikNone;
+    std::uint64_t stIdDataNum = 0;
+    std::map<Attribute, std::uint32_t> stIdAttrCodes;
+    for (const IStateId* id : _stateIds)
+    {
+        if (!id)
+            continue;
+
+        StIdKind kind;
+        if (const AttrListStateId* aid = dynamic_cast<const AttrListStateId*>(id))
+        {
+            kind = sikAttrList;
+            stIdDataNum += aid->getAttrs().size();
+            for (const Attribute& a : aid->getAttrs())
+                stIdAttrCodes.emplace(a, 0);
+        }
+        else if (const FixedIntListStateId* iid = dynamic_cast<const FixedIntListStateId*>(id))
+        {
+            kind = sikFixedIntList;
+            stIdDataNum += iid->getAttrs().size();
+        }
+        else
+            throw LdopaException("Can't save a TS: unsupported type of state IDs.");
+
+        if (stIdKind != sikNone && stIdKind != kind)
+            throw LdopaException("Can't save a TS: state IDs of different types.");
+        stIdKind = kind;
+    }
+
+    std::vector<Attribute> stIdAttrs;
+    stIdAttrs.reserve(stIdAttrCodes.size());
+    for (auto& ac : stIdAttrCodes)
+    {
+        ac.second = (std::uint32_t)stIdAttrs.size();
+        stIdAttrs.push_back(ac.first);
+    }
+
+    std::string lblsBlob = encodeAttrs(_labels);
+    std::string pvAttrsBlob = encodeAttrs(_pvAttrs);
+    std::string stIdAttrsBlob = encodeAttrs(stIdAttrs);
+
+    // заголовок
+    FileHeader hdr;
+    std::memset(&hdr, 0, sizeof(hdr));
+    std::memcpy(hdr.magic, FILE_MAGIC, sizeof(hdr.magic));
+    hdr.byteOrder = BYTE_ORDER_MARK;
+    hdr.version = FILE_VERSION;
+    hdr.headerSize = sizeof(FileHeader);
+    hdr.flags = _hasInitState ? 1 : 0;
+    hdr.statesNum = (std::uint32_t)n;
+    hdr.transNum = (std::uint32_t)getTransitionsNum();
+    hdr.labelsNum = (std::uint32_t)_labels.size();
+    hdr.tracesNum = _tracesNum;
+    hdr.maxWS = _maxWS;
+    hdr.pvDim = _pvDim;
+    hdr.pvAttrsNum = (std::uint32_t)_pvAttrs.size();
+    hdr.stIdKind = stIdKind;
+    hdr.stIdAttrsNum = (std::uint32_t)stIdAttrs.size();
+
+    hdr.secSizes[secLabels] = lblsBlob.size();
+    hdr.secSizes[secOutOffs] = _outOffs.size * sizeof(Index);
+    hdr.secSizes[secSrcs] = _srcs.size * sizeof(Index);
+    hdr.secSizes[secTargs] = _targs.size * sizeof(Index);
+    hdr.secSizes[secLblCodes] = _lblCodes.size * sizeof(Index);
+    hdr.secSizes[secFreqs] = _freqs.size * sizeof(int);
+    hdr.secSizes[secInOffs] = _inOffs.size * sizeof(Index);
+    hdr.secSizes[secInTrans] = _inTrans.size * sizeof(Index);
+    hdr.secSizes[secStFlags] = _stFlags.size;
+    hdr.secSizes[secParVecs] = _parVecs.size * sizeof(Value);
+    hdr.secSizes[secPvAttrs] = pvAttrsBlob.size();
+    hdr.secSizes[secStIdOffs] = stIdKind == sikNone ? 0 : (n + 1) * sizeof(Index);
+    hdr.secSizes[secStIdData] = stIdDataNum * sizeof(std::int32_t);
+    hdr.secSizes[secStIdAttrs] = stIdAttrsBlob.size();
+
+    std::uint64_t off = alignUp(sizeof(FileHeader));
+    for (int i = 0; i < sec__LAST; ++i)
+    {
+        hdr.secOffs[i] = off;
+        off += alignUp(hdr.secSizes[i]);
+    }
+
+    os.write((const char*)&hdr, sizeof(hdr));
+    writePadding(os, sizeof(hdr));
+
+    // секции — по порядку, без образа всего файла в памяти
+    os.write(lblsBlob.data(), lblsBlob.size());
+    writePadding(os, lblsBlob.size());
+
+    writeColumn(os, _outOffs);      writePadding(os, hdr.secSizes[secOutOffs]);
+    writeColumn(os, _srcs);         writePadding(os, hdr.secSizes[secSrcs]);
+    writeColumn(os, _targs);        writePadding(os, hdr.secSizes[secTargs]);
+    writeColumn(os, _lblCodes);     writePadding(os, hdr.secSizes[secLblCodes]);
+    writeColumn(os, _freqs);        writePadding(os, hdr.secSizes[secFreqs]);
+    writeColumn(os, _inOffs);       writePadding(os, hdr.secSizes[secInOffs]);
+    writeColumn(os, _inTrans);      writePadding(os, hdr.secSizes[secInTrans]);
+    writeColumn(os, _stFlags);      writePadding(os, hdr.secSizes[secStFlags]);
+    writeColumn(os, _parVecs);      writePadding(os, hdr.secSizes[secParVecs]);
+
+    os.write(pvAttrsBlob.data(), pvAttrsBlob.size());
+    writePadding(os, pvAttrsBlob.size());
+
+    // 2-й проход по ID состояний: смещения и данные
+    if (stIdKind != sikNone)
+    {
+        Index stIdOff = 0;
+        for (State i = 0; i < n; ++i)
+        {
+            os.write((const char*)&stIdOff, sizeof(stIdOff));
+            const IStateId* id = _stateIds[i];
+            if (!id)
+                continue;
+            stIdOff += (Index)(stIdKind == sikAttrList
+                ? static_cast<const AttrListStateId*>(id)->getAttrs().size()
+                : static_cast<const FixedIntListStateId*>(id)->getAttrs().size());
+        }
+        os.write((const char*)&stIdOff, sizeof(stIdOff));
+        writePadding(os, hdr.secSizes[secStIdOffs]);
+
+        for (const IStateId* id : _stateIds)
+        {
+            if (!id)
+                continue;
+
+            if (stIdKind == sikAttrList)
+            {
+                for (const Attribute& a : static_cast<const AttrListStateId*>(id)->getAttrs())
+                {
+                    std::int32_t code = (std::int32_t)stIdAttrCodes[a];
+                    os.write((const char*)&code, sizeof(code));
+                }
+            }
+            else
+            {
+                for (Value v : static_cast<const FixedIntListStateId*>(id)->getAttrs())
+                {
+                    std::int32_t iv = (std::int32_t)v;
+                    os.write((const char*)&iv, sizeof(iv));
+                }
+            }
+        }
+        writePadding(os, hdr.secSizes[secStIdData]);
+    }
+
+    os.write(stIdAttrsBlob.data(), stIdAttrsBlob.size());
+    writePadding(os, stIdAttrsBlob.size());
+
+    if (!os)
+        throw LdopaException("Error writing a TS.");
+}
+
+//------------------------------------------------------------------------------
+
+void FrozenEvLogTS::save(const std::string& fileName) const
+{
+    std::ofstream f(fileName, std::ios::binary | std::ios::trunc);
+    if (!f)
+        throw LdopaException::f("Can't create TS file %s.", fileName.c_str());
+
+    save(f);
+}
+
+//------------------------------------------------------------------------------
+
+FrozenEvLogTS FrozenEvLogTS::load(const std::string& fileName, IStateIDsPool* pool)
+{
+    std::shared_ptr<MappedFile> mf = std::make_shared<MappedFile>(fileName);
+    const char* base = mf->getData();
+    size_t size = mf->getSize();
+
+    // заголовок
+    if (size < sizeof(FileHeader))
+        throw LdopaException("Malformed TS file: no header.");
+
+    FileHeader hdr;
+    std::memcpy(&hdr, base, sizeof(hdr));
+    if (std::memcmp(hdr.magic, FILE_MAGIC, sizeof(hdr.magic)) != 0)
+        throw LdopaException("Not a TS file.");
+    if (hdr.byteOrder != BYTE_ORDER_MARK)
+        throw LdopaException("TS file has been made on a platform with another byte order.");
+    if (hdr.version != FILE_VERSION || hdr.headerSize != sizeof(FileHeader))
+        throw LdopaException::f("Unsupported version %u of TS file.", hdr.version);
+
+    // размеры секций
+    std::uint64_t n = hdr.statesNum, m = hdr.transNum;
+    const std::uint64_t expected[sec__LAST] = {
+        hdr.secSizes[secLabels],
+        (n + 1) * sizeof(Index),
+        m * sizeof(Index),
+        m * sizeof(Index),
+        m * sizeof(Index),
+        m * sizeof(int),
+        (n + 1) * sizeof(Index),
+        m * sizeof(Index),
+        n,
+        n * hdr.pvDim * sizeof(Value),
+        hdr.secSizes[secPvAttrs],
+        hdr.stIdKind == sikNone ? 0 : (n + 1) * sizeof(Index),
+        hdr.secSizes[secStIdData],
+        hdr.secSizes[secStIdAttrs],
+    };
+    for (int i = 0; i < sec__LAST; ++i)
+    {
+        if (hdr.secSizes[i] != expected[i] || hdr.secOffs[i] % SECTION_ALIGN != 0
+            || hdr.secOffs[i] > size || hdr.secSizes[i] > size - hdr.secOffs[i])
+            throw LdopaException::f("Malformed TS file: bad section %d.", i);
+    }
+
+    FrozenEvLogTS fts;
+    fts._storage = mf;
+    fts._hasInitState = (hdr.flags & 1) != 0;
+    fts._tracesNum = hdr.tracesNum;
+    fts._maxWS = hdr.maxWS;
+    fts._pvDim = hdr.pvDim;
+
+    // колонки — прямо в отображенном файле
+    bindColumn(fts._outOffs, base + hdr.secOffs[secOutOffs], hdr.secSizes[secOutOffs]);
+    bindColumn(fts._srcs, base + hdr.secOffs[secSrcs], hdr.secSizes[secSrcs]);
+    bindColumn(fts._targs, base + hdr.secOffs[secTargs], hdr.secSizes[secTargs]);
+    bindColumn(fts._lblCodes, base + hdr.secOffs[secLblCodes], hdr.secSizes[secLblCodes]);
+    bindColumn(fts._freqs, base + hdr.secOffs[secFreqs], hdr.secSizes[secFreqs]);
+    bindColumn(fts._inOffs, base + hdr.secOffs[secInOffs], hdr.secSizes[secInOffs]);
+    bindColumn(fts._inTrans, base + hdr.secOffs[secInTrans], hdr.secSizes[secInTrans]);
+    bindColumn(fts._stFlags, base + hdr.secOffs[secStFlags], hdr.secSizes[secStFlags]);
+    bindColumn(fts._parVecs, base + hdr.secOffs[secParVecs], hdr.secSizes[secParVecs]);
+
+    // смещения не убывают, иначе диапазоны переходов состояний выйдут за колонки
+    for (State i = 0; i < n; ++i)
+    {
+        if (fts._outOffs[i] > fts._outOffs[i + 1] || fts._inOffs[i] > fts._inOffs[i + 1])
+            throw LdopaException("Malformed TS file: inconsistent transitions.");
+    }
+    if (fts._outOffs[n] != m || fts._inOffs[n] != m)
+        throw LdopaException("Malformed TS file: inconsistent transitions.");
+
+    // декодируются только метки и атрибуты
+    fts._labels = decodeAttrs(base + hdr.secOffs[secLabels], hdr.secSizes[secLabels], hdr.labelsNum);
+    fts.sortLabels();
+    fts._pvAttrs = decodeAttrs(base + hdr.secOffs[secPvAttrs], hdr.secSizes[secPvAttrs], hdr.pvAttrsNum);
+
+    for (Transition t = 0; t < m; ++t)
+    {
+        if (fts._srcs[t] >= n || fts._targs[t] >= n || fts._inTrans[t] >= m
+            || fts._lblCodes[t] >= hdr.labelsNum)
+            throw LdopaException("Malformed TS file: bad transition.");
+    }
+
+    // ID состояний — по запросу
+    if (!pool || hdr.stIdKind == sikNone)
+        return fts;
+
+    Column<Index> stIdOffs;
+    Column<std::int32_t> stIdData;
+    bindColumn(stIdOffs, base + hdr.secOffs[secStIdOffs], hdr.secSizes[secStIdOffs]);
+    bindColumn(stIdData, base + hdr.secOffs[secStIdData], hdr.secSizes[secStIdData]);
+    for (State i = 0; i < n; ++i)
+    {
+        if (stIdOffs[i] > stIdOffs[i + 1])
+            throw LdopaException("Malformed TS file: inconsistent state IDs.");
+    }
+    if (stIdOffs[n] != stIdData.size)
+        throw LdopaException("Malformed TS file: inconsistent state IDs.");
+
+    fts._stateIds.assign(n, nullptr);
+    if (hdr.stIdKind == sikAttrList)
+    {
+        AttrListStateIDsPool* aPool = dynamic_cast<AttrListStateIDsPool*>(pool);
+        if (!aPool)
+            throw LdopaException("Can't load state IDs: AttrListStateIDsPool is expected.");
+
+        std::vector<Attribute> attrs = decodeAttrs(base + hdr.secOffs[secStIdAttrs],
+            hdr.secSizes[secStIdAttrs], hdr.stIdAttrsNum);
+        for (State i = 0; i < n; ++i)
+        {
+            if (fts.isStateAnon(i))
+                continue;
+
+            AttrListStateId id;
+            for (Index j = stIdOffs[i]; j < stIdOffs[i + 1]; ++j)
+            {
+                if ((std::uint32_t)stIdData[j] >= attrs.size())
+                    throw LdopaException("Malformed TS file: bad attribute of a state ID.");
+                id.append(attrs[stIdData[j]]);
+            }
+            fts._stateIds[i] = (*aPool)[id];
+        }
+    }
+    else if (hdr.stIdKind == sikFixedIntList)
+    {
+        FixedIntListStateIdsPool* iPool = dynamic_cast<FixedIntListStateIdsPool*>(pool);
+        if (!iPool)
+            throw LdopaException("Can't load state IDs: FixedIntListStateIdsPool is expected.");
+
+        for (State i = 0; i < n; ++i)
+        {
+            if (fts.isStateAnon(i))
+                continue;
+
+            FixedIntListStateId id;
+            id.getAttrs().assign(stIdData.begin() + stIdOffs[i], stIdData.begin() + stIdOffs[i + 1]);
+            fts._stateIds[i] = (*iPool)[id];
+        }
+    }
+    else
+        throw LdopaException::f("Malformed TS file: unknown kind %u of state IDs.", hdr.stIdKind);
+
+    return fts;
+}
+
+
+}}} // namespace xi { namespace ldopa { namespace ts {
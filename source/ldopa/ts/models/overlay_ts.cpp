@@ -0,0 +1,208 @@
+// starting from 06.12.2018 we use a /FI approach to force including stdafx.h:
+// https://chadaustin.me/2009/05/unintrusive-precompiled-headers-pch/
+//#include "stdafx.h"
+
+#include "xi/ldopa/ts/models/overlay_ts.h"
+
+
+namespace xi { namespace ldopa { namespace ts { ;   //
+
+//==============================================================================
+// class EvLogTSOverlay
+//==============================================================================
+
+EvLogTSOverlay::EvLogTSOverlay(const TS* src)
+    : _src(src)
+{
+}
+
+//------------------------------------------------------------------------------
+
+void EvLogTSOverlay::removeState(State s)
+{
+    if (!_remStates.insert(s).second)
+        return;                                         // уже удалено
+
+    // как и в исходной СП, вместе с состоянием уходят все его переходы
+    TS::OtransIterPair ots = _src->getOutTransitions(s);
+    for (; ots.first != ots.second; ++ots.first)
+        _remTrans.insert(*ots.first);
+
+    TS::ItransIterPair its = _src->getInTransitions(s);
+    for (; its.first != its.second; ++its.first)
+        _remTrans.insert(*its.first);
+}
+
+//------------------------------------------------------------------------------
+
+void EvLogTSOverlay::removeTrans(const Transition& t)
+{
+    _remTrans.insert(t);
+}
+
+//------------------------------------------------------------------------------
+
+void EvLogTSOverlay::setAcceptingState(State s, bool accepting)
+{
+    StateFlagsRes sfr = getStateFlags(s);
+    sfr.first.setAccepting(accepting);
+    setStateFlags(s, sfr.first);
+}
+
+//------------------------------------------------------------------------------
+
+void EvLogTSOverlay::reset()
+{
+    _remStates.clear();
+    _remTrans.clear();
+    _freqs.clear();
+    _flags.clear();
+}
+
+//------------------------------------------------------------------------------
+
+MemUsage EvLogTSOverlay::memoryUsage() const
+{
+    MemUsage mu;
+    mu.add("removedStates", mem::contBytes(_remStates));
+    mu.add("removedTrans", mem::contBytes(_remTrans));
+    mu.add("freqs", mem::contBytes(_freqs));
+    mu.add("flags", mem::contBytes(_flags));
+
+    return mu;
+}
+
+//------------------------------------------------------------------------------
+
+EvLogTSOverlay::TS* EvLogTSOverlay::materialize() const
+{
+    TS* ts = new TS(_src->getStateIDsPool());
+    ts->setTransIndexing(_src->isTransIndexing());
+    ts->setTracesNum(_src->getTracesNum());
+    ts->setMaxWS(_src->getMaxWS());
+
+    // состояния: в порядке исходной СП
+    std::unordered_map<State, State> stMap(getStatesNum());
+    for (StateIterPair sts = getStates(); sts.first != sts.second; ++sts.first)
+    {
+        State s = *sts.first;
+        State ns = isStateAnon(s) ? ts->addAnonState() : ts->getOrAddState(getStateID(s));
+        stMap[s] = ns;
+
+        StateFlagsRes sfr = getStateFlags(s);
+        if (sfr.second)
+            ts->setStateFlags(ns, sfr.first);
+    }
+
+    // переходы
+    for (TransIterPair trs = getTransitions(); trs.first != trs.second; ++trs.first)
+    {
+        const Transition& t = *trs.first;
+        Transition nt = ts->getOrAddTrans(stMap[getSrcState(t)], stMap[getTargState(t)],
+            getTransLbl(t));
+
+        IntRes fr = getTransFreq(t);
+        if (fr.second)
+            ts->setTransFreq(nt, fr.first);
+    }
+
+    return ts;
+}
+
+//------------------------------------------------------------------------------
+
+EvLogTSOverlay::StateIterPair EvLogTSOverlay::getStates() const
+{
+    TS::StateIterPair sts = _src->getStates();
+    LiveStateFilter f(this);
+    return StateIterPair(StateIter(f, sts.first, sts.second), StateIter(f, sts.second, sts.second));
+}
+
+//------------------------------------------------------------------------------
+
+EvLogTSOverlay::TransIterPair EvLogTSOverlay::getTransitions() const
+{
+    TS::TransIterPair trs = _src->getTransitions();
+    LiveTransFilter f(this);
+    return TransIterPair(TransIter(f, trs.first, trs.second), TransIter(f, trs.second, trs.second));
+}
+
+//------------------------------------------------------------------------------
+
+EvLogTSOverlay::OtransIterPair EvLogTSOverlay::getOutTransitions(State s) const
+{
+    TS::OtransIterPair ots = _src->getOutTransitions(s);
+    LiveTransFilter f(this);
+    return OtransIterPair(OtransIter(f, ots.first, ots.second), OtransIter(f, ots.second, ots.second));
+}
+
+//------------------------------------------------------------------------------
+
+EvLogTSOverlay::ItransIterPair EvLogTSOverlay::getInTransitions(State s) const
+{
+    TS::ItransIterPair its = _src->getInTransitions(s);
+    LiveTransFilter f(this);
+    return ItransIterPair(ItransIter(f, its.first, its.second), ItransIter(f, its.second, its.second));
+}
+
+//------------------------------------------------------------------------------
+
+EvLogTSOverlay::TransRes EvLogTSOverlay::getFirstOutTrans(State s, const Attribute& lbl) const
+{
+    LiveTransFilter live(this);
+
+    // при наличии индекса меток — без перебора всех выходных переходов
+    if (_src->isTransIndexing())
+    {
+        const TS::LogTS::TransIndex::StateIndex* sIdx =
+            _src->getLts().getTransIndex()->getStateIndex(s);
+        if (!sIdx)
+            return TransRes(Transition(), false);
+
+        return sIdx->find(lbl, live);
+    }
+
+    for (OtransIterPair ots = getOutTransitions(s); ots.first != ots.second; ++ots.first)
+    {
+        if (getTransLbl(*ots.first) == lbl)
+            return TransRes(*ots.first, true);
+    }
+
+    return TransRes(Transition(), false);
+}
+
+//------------------------------------------------------------------------------
+
+EvLogTSOverlay::IntRes EvLogTSOverlay::getTransFreq(Transition t) const
+{
+    auto it = _freqs.find(t);
+    if (it != _freqs.end())
+        return IntRes(it->second, true);
+
+    return _src->getTransFreq(t);
+}
+
+//------------------------------------------------------------------------------
+
+EvLogTSOverlay::StateFlagsRes EvLogTSOverlay::getStateFlags(State s) const
+{
+    auto it = _flags.find(s);
+    if (it != _flags.end())
+        return StateFlagsRes(it->second, true);
+
+    return _src->getStateFlags(s);
+}
+
+//------------------------------------------------------------------------------
+
+bool EvLogTSOverlay::isStateAccepting(State s) const
+{
+    StateFlagsRes sfr = getStateFlags(s);
+    if (!sfr.second)
+        return false;
+
+    return sfr.first.getAccepting() == StateFlags::triTrue;
+}
+
+
+}}} // namespace xi { namespace ldopa { namespace ts {
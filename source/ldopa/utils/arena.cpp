@@ -0,0 +1,79 @@
+// starting from 06.12.2018 we use a /FI approach to force including stdafx.h:
+// https://chadaustin.me/2009/05/unintrusive-precompiled-headers-pch/
+//#include "stdafx.h"
+
+#include "xi/ldopa/utils/arena.h"
+
+// std
+#include <algorithm>
+
+
+namespace xi { namespace ldopa { ;   //
+
+//==============================================================================
+// class MonotonicArena
+//==============================================================================
+
+const size_t MonotonicArena::DEF_CHUNK_SIZE;
+const size_t MonotonicArena::MAX_CHUNK_SIZE;
+
+MonotonicArena::MonotonicArena(size_t chunkSize)
+    : _cur(nullptr)
+    , _end(nullptr)
+    , _chunkSize(chunkSize ? chunkSize : DEF_CHUNK_SIZE)
+    , _reserved(0)
+    , _used(0)
+{
+}
+
+//------------------------------------------------------------------------------
+
+MonotonicArena::~MonotonicArena()
+{
+    release();
+}
+
+//------------------------------------------------------------------------------
+
+void MonotonicArena::release()
+{
+    for (char* c : _chunks)
+        ::operator delete(c);
+
+    _chunks.clear();
+    _cur = _end = nullptr;
+    _reserved = _used = 0;
+}
+
+//------------------------------------------------------------------------------
+
+void* MonotonicArena::allocateSlow(size_t bytes, size_t align)
+{
+    // крупные запросы получают отдельный кусок, текущий при этом не теряется
+    size_t need = bytes + align;
+    if (need > _chunkSize)
+    {
+        char* c = static_cast<char*>(::operator new(need));
+        _chunks.push_back(c);
+        _reserved += need;
+        _used += bytes;
+
+        return alignUp(c, align);
+    }
+
+    char* c = static_cast<char*>(::operator new(_chunkSize));
+    _chunks.push_back(c);
+    _reserved += _chunkSize;
+    _cur = c;
+    _end = c + _chunkSize;
+    _chunkSize = std::min(_chunkSize * 2, std::max(_chunkSize, MAX_CHUNK_SIZE));
+
+    char* p = alignUp(_cur, align);
+    _cur = p + bytes;
+    _used += bytes;
+
+    return p;
+}
+
+
+}} // namespace xi { namespace ldopa {
@@ -0,0 +1,70 @@
+// starting from 06.12.2018 we use a /FI approach to force including stdafx.h:
+// https://chadaustin.me/2009/05/unintrusive-precompiled-headers-pch/
+//#include "stdafx.h"
+
+#include "xi/ldopa/utils/mem_usage.h"
+
+
+namespace xi { namespace ldopa { ;   //
+
+//==============================================================================
+// class MemUsage
+//==============================================================================
+
+void MemUsage::add(const std::string& name, size_t bytes)
+{
+    for (Component& c : _comps)
+    {
+        if (c.first == name)
+        {
+            c.second += bytes;
+            return;
+        }
+    }
+
+    _comps.push_back(Component(name, bytes));
+}
+
+//------------------------------------------------------------------------------
+
+void MemUsage::add(const std::string& prefix, const MemUsage& other)
+{
+    for (const Component& c : other._comps)
+        add(prefix.empty() ? c.first : prefix + '.' + c.first, c.second);
+}
+
+//------------------------------------------------------------------------------
+
+size_t MemUsage::getBytes(const std::string& name) const
+{
+    for (const Component& c : _comps)
+    {
+        if (c.first == name)
+            return c.second;
+    }
+
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+
+size_t MemUsage::getTotal() const
+{
+    size_t total = 0;
+    for (const Component& c : _comps)
+        total += c.second;
+
+    return total;
+}
+
+//------------------------------------------------------------------------------
+
+void MemUsage::print(std::ostream& os) const
+{
+    for (const Component& c : _comps)
+        os << c.first << ": " << c.second << '\n';
+    os << "total: " << getTotal() << '\n';
+}
+
+
+}} // namespace xi { namespace ldopa {
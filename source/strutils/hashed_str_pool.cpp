@@ -0,0 +1,195 @@
+////////////////////////////////////////////////////////////////////////////////
+// Module Name:  hashed_str_pool.h/cpp
+// Authors:      Sergey Shershakov
+// Version:      0.1.0
+// Date:         18.10.2026
+// Copyright (c) xidv.ru 2014–2017.
+//
+// This source is for internal use only — Restricted Distribution.
+// All rights reserved.
+////////////////////////////////////////////////////////////////////////////////
+
+#include "xi/strutils/hashed_str_pool.h"
+
+#include <cstring>
+
+namespace xi { namespace strutils {; //
+
+//==============================================================================
+// class StrArena
+//==============================================================================
+
+StrArena::StrArena(std::size_t chunkSize)
+    : _cur(nullptr)
+    , _left(0)
+    , _chunkSize(chunkSize ? chunkSize : DEF_CHUNK_SIZE)
+    , _allocated(0)
+    , _used(0)
+{
+}
+
+//------------------------------------------------------------------------------
+
+std::string_view StrArena::store(std::string_view str)
+{
+    std::size_t need = str.size() + 1;          // + завершающий ноль
+    if (need > _left)
+    {
+        // длинная строка получает собственный кусок, текущий при этом не бросаем
+        if (need > _chunkSize / 4)
+        {
+            _chunks.emplace_back(new char[need]);
+            _allocated += need;
+            char* dst = _chunks.back().get();
+            std::memcpy(dst, str.data(), str.size());
+            dst[str.size()] = '\0';
+            _used += need;
+
+            return std::string_view(dst, str.size());
+        }
+
+        _chunks.emplace_back(new char[_chunkSize]);
+        _allocated += _chunkSize;
+        _cur = _chunks.back().get();
+        _left = _chunkSize;
+    }
+
+    char* dst = _cur;
+    std::memcpy(dst, str.data(), str.size());
+    dst[str.size()] = '\0';
+    _cur += need;
+    _left -= need;
+    _used += need;
+
+    return std::string_view(dst, str.size());
+}
+
+//------------------------------------------------------------------------------
+
+void StrArena::clear()
+{
+    _chunks.clear();
+    _cur = nullptr;
+    _left = 0;
+    _allocated = 0;
+    _used = 0;
+}
+
+
+//==============================================================================
+// class HashedStrPool
+//==============================================================================
+
+HashedStrPool::HashedStrPool(std::size_t chunkSize)
+    : _arena(chunkSize)
+{
+}
+
+//------------------------------------------------------------------------------
+
+std::string_view HashedStrPool::insert(std::string_view str, std::size_t h)
+{
+    // при попадании строка не копируется, хеш не пересчитывается
+    StrsSet::const_iterator it = _set.find(HashedView{ str, h });
+    if (it != _set.end())
+        return it->str;
+
+    std::string_view stored = _arena.store(str);
+    _set.insert(HashedView{ stored, h });
+
+    return stored;
+}
+
+//------------------------------------------------------------------------------
+
+std::string_view HashedStrPool::find(std::string_view str, std::size_t h) const
+{
+    StrsSet::const_iterator it = _set.find(HashedView{ str, h });
+
+    return it == _set.end() ? std::string_view() : it->str;
+}
+
+//------------------------------------------------------------------------------
+
+bool HashedStrPool::contains(std::string_view str) const
+{
+    StrsSet::const_iterator it = _set.find(HashedView{ str, hashOf(str) });
+
+    return it != _set.end() && it->str.data() == str.data();
+}
+
+//------------------------------------------------------------------------------
+
+void HashedStrPool::clear()
+{
+    _set.clear();
+    _arena.clear();
+}
+
+
+//==============================================================================
+// class ConcurrentStrPool
+//==============================================================================
+
+ConcurrentStrPool::ConcurrentStrPool(std::size_t shardsNum, std::size_t chunkSize)
+{
+    std::size_t n = 1;
+    while (n < shardsNum)
+        n <<= 1;
+
+    _shards.reserve(n);
+    for (std::size_t i = 0; i < n; ++i)
+        _shards.emplace_back(new Shard(chunkSize));
+    _mask = n - 1;
+}
+
+//------------------------------------------------------------------------------
+
+std::string_view ConcurrentStrPool::insert(std::string_view str)
+{
+    std::size_t h = HashedStrPool::hashOf(str);
+    Shard& sh = getShard(h);
+
+    std::lock_guard<std::mutex> lock(sh.mtx);
+    return sh.pool.insert(str, h);
+}
+
+//------------------------------------------------------------------------------
+
+std::string_view ConcurrentStrPool::find(std::string_view str) const
+{
+    std::size_t h = HashedStrPool::hashOf(str);
+    Shard& sh = getShard(h);
+
+    std::lock_guard<std::mutex> lock(sh.mtx);
+    return sh.pool.find(str, h);
+}
+
+//------------------------------------------------------------------------------
+
+std::size_t ConcurrentStrPool::getSize() const
+{
+    std::size_t res = 0;
+    for (const std::unique_ptr<Shard>& sh : _shards)
+    {
+        std::lock_guard<std::mutex> lock(sh->mtx);
+        res += sh->pool.getSize();
+    }
+
+    return res;
+}
+
+//------------------------------------------------------------------------------
+
+void ConcurrentStrPool::clear()
+{
+    for (std::unique_ptr<Shard>& sh : _shards)
+    {
+        std::lock_guard<std::mutex> lock(sh->mtx);
+        sh->pool.clear();
+    }
+}
+
+
+}
+} // namespaces
@@ -0,0 +1,141 @@
+////////////////////////////////////////////////////////////////////////////////
+// Module Name:  interned_str.h/cpp
+// Authors:      Sergey Shershakov
+// Version:      0.1.0
+// Date:         18.10.2026
+// Copyright (c) xidv.ru 2014–2017.
+//
+// This source is for internal use only — Restricted Distribution.
+// All rights reserved.
+////////////////////////////////////////////////////////////////////////////////
+
+#include "xi/strutils/interned_str.h"
+
+namespace xi { namespace strutils {; //
+
+//==============================================================================
+// class InternedStr
+//==============================================================================
+
+const std::string& InternedStr::emptyStr()
+{
+    static const std::string empty;
+    return empty;
+}
+
+
+//==============================================================================
+// class InternStrPool
+//==============================================================================
+
+InternStrPool::InternStrPool(std::size_t shardsNum)
+{
+    std::size_t n = 1;
+    while (n < shardsNum)
+        n <<= 1;
+
+    _shards.reserve(n);
+    for (std::size_t i = 0; i < n; ++i)
+        _shards.emplace_back(new Shard());
+    _mask = n - 1;
+}
+
+//------------------------------------------------------------------------------
+
+InternedStr InternStrPool::intern(std::string_view str)
+{
+    // хеш совпадает с std::hash<std::string>, т.е. с InternedStr::hash()
+    std::size_t h = HashedStrPool::hashOf(str);
+    Shard& sh = getShard(h);
+
+    std::lock_guard<std::mutex> lock(sh.mtx);
+
+    // при попадании ничего не выделяется: ключ — представление искомой строки
+    StrsIndex::const_iterator it = sh.index.find(HashedStrPool::HashedView{ str, h });
+    if (it != sh.index.end())
+        return InternedStr(it->second);
+
+    sh.entries.emplace_back(std::string(str), InternedStrMeta{ h, this });
+    const InternedStr::Entry* e = &sh.entries.back();
+    sh.index.emplace(HashedStrPool::HashedView{ e->first, h }, e);
+
+    return InternedStr(e);
+}
+
+//------------------------------------------------------------------------------
+
+InternedStr InternStrPool::find(std::string_view str) const
+{
+    std::size_t h = HashedStrPool::hashOf(str);
+    Shard& sh = getShard(h);
+
+    std::lock_guard<std::mutex> lock(sh.mtx);
+
+    StrsIndex::const_iterator it = sh.index.find(HashedStrPool::HashedView{ str, h });
+    return it == sh.index.end() ? InternedStr() : InternedStr(it->second);
+}
+
+//------------------------------------------------------------------------------
+
+std::size_t InternStrPool::getSize() const
+{
+    std::size_t res = 0;
+    for (const std::unique_ptr<Shard>& sh : _shards)
+    {
+        std::lock_guard<std::mutex> lock(sh->mtx);
+        res += sh->entries.size();
+    }
+
+    return res;
+}
+
+//------------------------------------------------------------------------------
+
+std::size_t InternStrPool::getBytes() const
+{
+    std::size_t bytes = _shards.capacity() * sizeof(void*);
+    for (const std::unique_ptr<Shard>& sh : _shards)
+    {
+        std::lock_guard<std::mutex> lock(sh->mtx);
+
+        // единственная корзина встроена в таблицу; узел хеш-таблицы: элемент,
+        // ссылка на следующий и кешированный хеш
+        const StrsIndex& ind = sh->index;
+        bytes += sizeof(Shard)
+            + (ind.bucket_count() > 1 ? ind.bucket_count() * sizeof(void*) : 0)
+            + ind.size() * (sizeof(StrsIndex::value_type) + 2 * sizeof(void*))
+            + sh->entries.size() * sizeof(InternedStr::Entry);
+        for (const InternedStr::Entry& e : sh->entries)
+        {
+            if (e.first.capacity() > 15)
+                bytes += e.first.capacity() + 1;
+        }
+    }
+
+    return bytes;
+}
+
+//------------------------------------------------------------------------------
+
+void InternStrPool::clear()
+{
+    for (std::unique_ptr<Shard>& sh : _shards)
+    {
+        std::lock_guard<std::mutex> lock(sh->mtx);
+        sh->index.clear();
+        sh->entries.clear();
+    }
+}
+
+//------------------------------------------------------------------------------
+
+// static
+InternStrPool& InternStrPool::global()
+{
+    static InternStrPool pool;
+    return pool;
+}
+
+
+}
+} // namespaces
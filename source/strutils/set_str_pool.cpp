@@ -20,11 +20,13 @@ namespace xi { namespace strutils {; //
 
 //
 //const SetStrPool::String* SetStrPool::insert(const std::string& str)
-const std::string* SetStrPool::insert(const std::string& str)
+const std::string* SetStrPool::insert(std::string_view str)
 {
-    std::pair<StrsSetIter, bool> res = _pool.insert(str);
+    StrsSetIter it = _pool.find(str);   //  :   
+    if (it == _pool.end())
+        it = _pool.emplace(str).first;
     
-    return &(*(res.first));     // address of an str object that is got through dereference of iter
+    return &(*it);              // address of an str object that is got through dereference of iter
 }
 
 
@@ -38,12 +40,11 @@ void SetStrPool::clear()
 
 //------------------------------------------------------------------------------
 
-const std::string* SetStrPool::operator[](const std::string& str)
+const std::string* SetStrPool::find(std::string_view str) const
 {
-    std::pair<StrsSetIter, bool> res = _pool.insert(str);
-
-    return &(*(res.first));     // address of an str object that is got through dereference of iter
+    StrsSet::const_iterator it = _pool.find(str);
 
+    return it == _pool.end() ? nullptr : &(*it);
 }
 
 
@@ -0,0 +1,139 @@
+////////////////////////////////////////////////////////////////////////////////
+/// \file
+/// \brief     Tests for compact attributes.
+/// \author    Sergey Shershakov
+/// \version   0.1.0
+/// \date      18.10.2026
+/// \copyright (c) xidv.ru 2014–2017.
+///            This source is for internal use only — Restricted Distribution.
+///            All rights reserved.
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#include <gtest/gtest.h>
+
+#include "xi/attributes/compact_attr.h"
+
+// std
+#include <set>
+#include <string>
+#include <unordered_set>
+
+namespace {
+
+using namespace xi::attributes;
+typedef CompactAttribute CA;
+
+//===================================================================================
+
+TEST(CompactAttribute1, types1)
+{
+    EXPECT_EQ(16u, sizeof(CA));
+
+    CA a;
+    EXPECT_TRUE(a.isEmpty());
+    EXPECT_EQ("<Empty>", a.toString());
+
+    EXPECT_EQ(CA::tInt, CA(42).getType());
+    EXPECT_EQ(42, CA(42).asInt());
+    EXPECT_EQ(CA::tInt64, CA((xi::types::TInt64)-5).getType());
+    EXPECT_EQ(-5, CA((xi::types::TInt64)-5).asInt64());
+    EXPECT_EQ(CA::tDouble, CA(1.5).getType());
+    EXPECT_DOUBLE_EQ(1.5, CA(1.5).asDouble());
+    EXPECT_DOUBLE_EQ(3.0, CA(3).asDouble());
+    EXPECT_EQ("x", CA('x').toString());
+
+    // короткая строка — внутри, длинная — в пуле
+    CA s1("activity");
+    EXPECT_EQ(CA::tSmallStr, s1.getType());
+    EXPECT_EQ("activity", s1.asStrView());
+
+    std::string longStr = "a rather long activity name";
+    CA s2(longStr);
+    CA s3 = CA(std::string_view(longStr));
+    EXPECT_EQ(CA::tPooledStr, s2.getType());
+    EXPECT_EQ(longStr, s2.toString());
+    EXPECT_EQ(s2.asStrView().data(), s3.asStrView().data());       // один экземпляр в пуле
+
+    // байты с нулями
+    const char raw[] = { 'a', 0, 'b', 0, 'c', 'd', 'e', 'f', 'g', 'h', 'i', 'j', 'k' };
+    CA b = CA::bytes(raw, sizeof(raw));
+    EXPECT_EQ(sizeof(raw), b.asStrView().size());
+    EXPECT_EQ(0, std::memcmp(raw, b.asStrView().data(), sizeof(raw)));
+}
+
+//-----------------------------------------------------------------------------
+
+TEST(CompactAttribute1, compare1)
+{
+    xi::strutils::InternStrPool pool;
+
+    CA a1("abc");
+    CA a2(std::string("abc"));
+    CA a3(pool.intern("abc"));
+    CA b("abd");
+    EXPECT_EQ(CA::tInternedStr, a3.getType());
+
+    // все виды строк сравниваются по содержимому
+    EXPECT_TRUE(a1 == a2);
+    EXPECT_TRUE(a1 == a3);
+    EXPECT_EQ(a1.hash(), a3.hash());
+    EXPECT_TRUE(a1 != b);
+    EXPECT_TRUE(a3 < b);
+    EXPECT_FALSE(b < a1);
+
+    std::string l1 = "a long string number one";
+    std::string l2 = "a long string number two";
+    EXPECT_TRUE(CA(l1) < CA(l2));
+    EXPECT_TRUE(CA(l1) == CA(pool.intern(l1)));
+
+    // значения разных типов не равны
+    EXPECT_FALSE(CA(1) == CA((xi::types::TInt64)1));
+    EXPECT_FALSE(CA(1) == CA("1"));
+    EXPECT_TRUE(CA(-0.0) == CA(0.0));
+    EXPECT_EQ(CA(-0.0).hash(), CA(0.0).hash());
+    EXPECT_TRUE(CA(-1) < CA(2));
+
+    std::set<CA> s = { a1, a2, a3, b, CA(1), CA(2), CA(1) };
+    EXPECT_EQ(4u, s.size());
+
+    std::unordered_set<CA, VarAttributeHash<CA>> hs = { a1, a2, a3, b, CA(1), CA(2), CA(1) };
+    EXPECT_EQ(4u, hs.size());
+}
+
+//-----------------------------------------------------------------------------
+
+TEST(CompactAttribute1, convert1)
+{
+    xi::strutils::InternStrPool pool;
+
+    VarAttribute1 vs(std::string("abc"));
+    CA cs(vs);
+    EXPECT_EQ(CA::tSmallStr, cs.getType());
+    EXPECT_TRUE(cs.toVar() == vs);
+
+    VarAttribute1 vi(pool.intern("interned"));
+    CA ci(vi);
+    EXPECT_EQ(CA::tInternedStr, ci.getType());
+    EXPECT_EQ(VarAttribute1::tInternedStr, ci.toVar().getType());
+    EXPECT_TRUE(ci.toVar() == vi);
+
+    VarAttribute1 vn((xi::types::TInt64)123456789012);
+    EXPECT_TRUE(CA(vn).toVar() == vn);
+    VarAttribute1 vd(2.5);
+    EXPECT_TRUE(CA(vd).toVar() == vd);
+    EXPECT_TRUE(CA(VarAttribute1()).isEmpty());
+
+    // байтовый массив превращается в пулированную байтовую строку
+    const DestrByteArray::Byte raw[] = { 1, 2, 3 };
+    VarAttribute1 vb(DestrObjSharedPtr(new DestrByteArray(raw, 3)));
+    CA cb(vb);
+    EXPECT_EQ(3u, cb.asStrView().size());
+
+    // прочие объекты не конвертируются
+    class Obj : public IDestructableObject {};
+    VarAttribute1 vo(DestrObjSharedPtr(new Obj()));
+    EXPECT_THROW(CA cx(vo), std::invalid_argument);
+}
+
+} // namespace
@@ -0,0 +1,299 @@
+////////////////////////////////////////////////////////////////////////////////
+/// \file
+/// \brief     Tests for the compact in-memory event log.
+/// \author    Sergey Shershakov
+/// \version   0.1.0
+/// \date      18.10.2026
+/// \copyright (c) xidv.ru 2014–2017.
+///            This source is for internal use only — Restricted Distribution.
+///            All rights reserved.
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#include <gtest/gtest.h>
+
+// ldopa
+#include "xi/ldopa/eventlog/compact/compactlog.h"
+#include "xi/ldopa/eventlog/sqlite/sqlitelog.h"
+
+#include "constants.h"
+
+// std
+#include <memory>
+#include <vector>
+
+namespace {
+
+using namespace xi::ldopa;
+using namespace xi::ldopa::eventlog;
+
+// Tests CompactLog class. Part 1
+class CompactLog_1_Test : public ::testing::Test {
+public:
+    static const char*  LOG_FILE_RTS_04;                // log04.sq3: abc, abd, bcd, bdce
+protected:
+    virtual void SetUp()
+    {
+        _log = new SQLiteLog(LOG_FILE_RTS_04);
+        _log->setAutoLoadConfig(true);
+        _log->setAutoLoadConfigQry("SELECT * FROM DefConfig");
+        _log->open();
+    }
+
+    virtual void TearDown()
+    {
+        delete _log;
+    }
+
+protected:
+    SQLiteLog* _log;
+}; // class CompactLog_1_Test
+
+// ---<do not change followings>
+const char* CompactLog_1_Test::LOG_FILE_RTS_04 = CSVLOG1_TEST_LOGS_BASE_DIR "logs/log04.sq3";
+
+//===================================================================================
+
+// кодирование и декодирование varint-ов
+TEST(CompactLogVarint, encodeDecode1)
+{
+    typedef CompactLog CL;
+    const std::uint64_t vals[] = { 0, 1, 127, 128, 300, 16383, 16384, 0xFFFFFFFFull, ~0ull };
+
+    CL::ByteVec buf;
+    for (std::uint64_t v : vals)
+        CL::encodeVarint(buf, v);
+    EXPECT_EQ(0, buf[0]);                       // 0 — один байт
+
+    const CL::Byte* p = buf.data();
+    for (std::uint64_t v : vals)
+    {
+        std::uint64_t d;
+        p = CL::decodeVarint(p, d);
+        EXPECT_EQ(v, d);
+    }
+    EXPECT_EQ(buf.data() + buf.size(), p);
+
+    for (std::int64_t v : { 0LL, 1LL, -1LL, 100LL, -100LL, 1497979876LL, -1497979876LL })
+        EXPECT_EQ(v, CL::unzigzag(CL::zigzag(v)));
+    EXPECT_EQ(1u, CL::zigzag(-1));
+    EXPECT_EQ(2u, CL::zigzag(1));
+}
+
+//-----------------------------------------------------------------------------
+
+// загрузка лога и сравнение с исходным
+TEST_F(CompactLog_1_Test, load1)
+{
+    CompactLog cl(_log, true);
+    EXPECT_TRUE(cl.isOpen());
+    EXPECT_TRUE(cl.hasTimestamps());
+    EXPECT_EQ(_log->getTracesNum(), cl.getTracesNum());
+    EXPECT_EQ(_log->getEventsNum(), cl.getEventsNum());
+    EXPECT_EQ(_log->getActivitiesNum(), cl.getActivitiesNum());
+    EXPECT_EQ(_log->getEvActAttrId(), cl.getEvActAttrId());
+
+    // 13 событий: по байту на код активности + дельты времен
+    EXPECT_GT(cl.getEncodedSize(), 13u);
+
+    IEventLog::Attribute a1, a2;
+    for (int i = 0; i < _log->getTracesNum(); ++i)
+    {
+        IEventTrace* tr1 = _log->getTrace(i);
+        IEventTrace* tr2 = cl.getTrace(i);
+        ASSERT_EQ(tr1->getSize(), tr2->getSize());
+        EXPECT_EQ(&cl, tr2->getLog());
+        for (int j = 0; j < tr1->getSize(); ++j)
+        {
+            EXPECT_TRUE(tr1->getEvent(j)->getAttr("activity", a1));
+            EXPECT_TRUE(tr2->getEvent(j)->getAttr("activity", a2));
+            EXPECT_EQ(a1.toString(), a2.toString());
+
+            EXPECT_TRUE(tr1->getEvent(j)->getAttr("timest", a1));
+            EXPECT_TRUE(tr2->getEvent(j)->getAttr("timest", a2));
+            EXPECT_EQ(a1.asInt64(), a2.asInt64());
+
+            // процедурный интерфейс
+            EXPECT_TRUE(cl.getEventAttr(i, j, "timest", a2));
+            EXPECT_EQ(a1.asInt64(), a2.asInt64());
+        }
+        EXPECT_EQ(nullptr, tr2->getEvent(tr2->getSize()));
+    }
+    EXPECT_EQ(nullptr, cl.getTrace(4));
+}
+
+//-----------------------------------------------------------------------------
+
+// коды активностей и прямой доступ к данным
+TEST_F(CompactLog_1_Test, codes1)
+{
+    CompactLog cl(_log);
+    EXPECT_FALSE(cl.hasTimestamps());
+    EXPECT_EQ(13u, cl.getEncodedSize());        // по байту на событие
+
+    CompactLog::CodesVector codes;
+    cl.decodeTrace(3, codes);                   // bdce
+    ASSERT_EQ(4u, codes.size());
+    EXPECT_EQ("b", cl.getActivity(codes[0]).toString());
+    EXPECT_EQ("e", cl.getActivity(codes[3]).toString());
+    EXPECT_EQ((int)codes[1], cl.getActivityCode("d"));
+    EXPECT_EQ(-1, cl.getActivityCode("z"));
+
+    // общий объект атрибута для всех событий одной активности
+    IEventLog::Attribute a1, a2;
+    EXPECT_TRUE(cl.getEventAttr(0, 1, "activity", a1));
+    EXPECT_TRUE(cl.getEventAttr(1, 1, "activity", a2));
+    EXPECT_EQ(a1.asStrP(), a2.asStrP());
+
+    // события по глобальному номеру
+    EXPECT_TRUE(cl.getEventAttr(12, "activity", a1));
+    EXPECT_EQ("e", a1.toString());
+    EXPECT_FALSE(cl.getEventAttr(13, "activity", a1));
+    EXPECT_FALSE(cl.getEventAttr(12, "timest", a1));
+
+    std::unique_ptr<IAttributesEnumerator> en(cl.getEventAttrs(3));
+    ASSERT_TRUE(en->hasNext());
+    EXPECT_EQ("activity", en->getNext().first);
+    EXPECT_FALSE(en->hasNext());
+}
+
+//-----------------------------------------------------------------------------
+
+// ограничение числа раскодированных трасс
+TEST_F(CompactLog_1_Test, decodedLimit1)
+{
+    CompactLog cl(_log);
+    const unsigned int defLimit = CompactLog::DEF_DECODED_TRACES_LIMIT;
+    EXPECT_EQ(defLimit, cl.getDecodedTracesLimit());
+    EXPECT_LT(0u, defLimit);
+
+    // без ограничения (явно заданного) события всех трасс живут до закрытия лога
+    cl.setDecodedTracesLimit(0);
+    IEventLog::Attribute a;
+    std::vector<IEvent*> firsts;
+    for (int i = 0; i < cl.getTracesNum(); ++i)
+        firsts.push_back(cl.getTrace(i)->getEvent(0));
+    for (int i = 0; i < cl.getTracesNum(); ++i)
+    {
+        EXPECT_TRUE(firsts[i]->getAttr("activity", a));
+        EXPECT_EQ(i < 2 ? "a" : "b", a.toString());
+    }
+
+    cl.setDecodedTracesLimit(1);
+    for (int k = 0; k < 2; ++k)
+        for (int i = 0; i < cl.getTracesNum(); ++i)
+        {
+            IEventTrace* tr = cl.getTrace(i);
+            EXPECT_TRUE(tr->getEvent(0)->getAttr("activity", a));
+            EXPECT_EQ(i < 2 ? "a" : "b", a.toString());
+        }
+}
+
+//-----------------------------------------------------------------------------
+
+// закрепленные трассы не вытесняются
+TEST_F(CompactLog_1_Test, pinTrace1)
+{
+    CompactLog cl(_log);
+    cl.setDecodedTracesLimit(1);
+
+    IEventLog::Attribute a;
+    {
+        CompactLog::TracePin pin(cl, 3);
+        IEvent* last = cl.getTrace(3)->getEvent(3);             // bdce
+        for (int i = 0; i < 3; ++i)
+            EXPECT_NE(nullptr, cl.getTrace(i)->getEvent(0));
+        EXPECT_TRUE(last->getAttr("activity", a));
+        EXPECT_EQ("e", a.toString());
+    }
+
+    EXPECT_THROW(cl.unpinTrace(3), LdopaException);
+    EXPECT_THROW(cl.pinTrace(4), LdopaException);
+}
+
+//-----------------------------------------------------------------------------
+
+// атрибуты трасс и процедурный интерфейс
+TEST_F(CompactLog_1_Test, traceAttrs1)
+{
+    CompactLog cl(_log);
+
+    IEventLog::Attribute a1, a2;
+    for (int i = 0; i < _log->getTracesNum(); ++i)
+    {
+        IEventTrace* tr1 = _log->getTrace(i);
+        IEventTrace* tr2 = cl.getTrace(i);
+        ASSERT_EQ(tr1->getAttrsNum(), tr2->getAttrsNum());
+
+        std::unique_ptr<IAttributesEnumerator> en(tr1->getAttrs());
+        while (en->hasNext())
+        {
+            IEventLog::NamedAttribute na = en->getNext();
+            EXPECT_TRUE(tr2->getAttr(na.first.c_str(), a2));
+            EXPECT_EQ(na.second.toString(), a2.toString());
+            EXPECT_TRUE(cl.getTraceAttr(i, na.first.c_str(), a2));
+            EXPECT_EQ(na.second.toString(), a2.toString());
+        }
+        EXPECT_FALSE(tr2->getAttr("no such attribute", a2));
+    }
+    EXPECT_TRUE(cl.getTraceAttr(3, "case", a1));
+    EXPECT_EQ("case 4", a1.toString());
+
+    // процедурный интерфейс не раздает событий трасс
+    for (int j = 0; j < cl.getTraceSize(3); ++j)
+    {
+        EXPECT_TRUE(cl.getEventAttr(3, j, "activity", a1));
+        EXPECT_TRUE(_log->getEventAttr(3, j, "activity", a2));
+        EXPECT_EQ(a2.toString(), a1.toString());
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+// вид лога: общие данные, свои трассы
+TEST_F(CompactLog_1_Test, view1)
+{
+    CompactLog cl(_log, true);
+    CompactLog v1(cl, CompactLog::ShareData());
+    CompactLog v2(v1, CompactLog::ShareData());        // вид вида — вид исходного лога
+    EXPECT_FALSE(cl.isView());
+    EXPECT_TRUE(v1.isView());
+    EXPECT_TRUE(v2.isView());
+
+    EXPECT_EQ(cl.getTracesNum(), v1.getTracesNum());
+    EXPECT_EQ(cl.getEventsNum(), v2.getEventsNum());
+    EXPECT_EQ(cl.getEncodedSize(), v1.getEncodedSize());
+    EXPECT_TRUE(v1.hasTimestamps());
+    EXPECT_EQ(cl.getActivityCode("d"), v2.getActivityCode("d"));
+
+    IEventLog::Attribute a1, a2;
+    for (int i = 0; i < cl.getTracesNum(); ++i)
+    {
+        IEventTrace* tr1 = cl.getTrace(i);
+        IEventTrace* tr2 = v1.getTrace(i);
+        EXPECT_NE(tr1, tr2);
+        EXPECT_EQ(&v1, tr2->getLog());
+        ASSERT_EQ(tr1->getSize(), tr2->getSize());
+        for (int j = 0; j < tr1->getSize(); ++j)
+        {
+            EXPECT_TRUE(tr1->getEvent(j)->getAttr("activity", a1));
+            EXPECT_TRUE(tr2->getEvent(j)->getAttr("activity", a2));
+            EXPECT_EQ(a1.asStrP(), a2.asStrP());         // общий объект атрибута
+            EXPECT_TRUE(v2.getEventAttr(i, j, "timest", a2));
+            EXPECT_TRUE(tr1->getEvent(j)->getAttr("timest", a1));
+            EXPECT_EQ(a1.asInt64(), a2.asInt64());
+        }
+    }
+    EXPECT_TRUE(v1.getTraceAttr(3, "case", a1));
+    EXPECT_EQ("case 4", a1.toString());
+
+    // закрытие вида освобождает лишь его трассы
+    v1.close();
+    EXPECT_TRUE(cl.getTrace(0)->getEvent(0)->getAttr("activity", a1));
+    EXPECT_TRUE(v1.isOpen());
+
+    EXPECT_THROW(v1.clear(), LdopaException);
+    EXPECT_THROW(v1.load(_log), LdopaException);
+}
+
+} // namespace
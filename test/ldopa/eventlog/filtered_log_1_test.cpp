@@ -0,0 +1,158 @@
+////////////////////////////////////////////////////////////////////////////////
+/// \file
+/// \brief     Tests for filtered log views.
+/// \author    Sergey Shershakov
+/// \version   0.1.0
+/// \date      18.10.2026
+/// \copyright (c) xidv.ru 2014–2017.
+///            This source is for internal use only — Restricted Distribution.
+///            All rights reserved.
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#include <gtest/gtest.h>
+
+// ldopa
+#include "xi/ldopa/eventlog/filtered_log.h"
+#include "xi/ldopa/eventlog/sqlite/sqlitelog.h"
+
+#include "constants.h"
+
+namespace {
+
+using namespace xi::ldopa;
+using namespace xi::ldopa::eventlog;
+
+// Tests FilteredLog class. Part 1
+class FilteredLog_1_Test : public ::testing::Test {
+public:
+    static const char*  LOG_FILE_RTS_04;                // log04.sq3: abc, abd, bcd, bdce
+protected:
+    virtual void SetUp()
+    {
+        _log = new SQLiteLog(LOG_FILE_RTS_04);
+        _log->setAutoLoadConfig(true);
+        _log->setAutoLoadConfigQry("SELECT * FROM DefConfig");
+        _log->open();
+    }
+
+    virtual void TearDown()
+    {
+        delete _log;
+    }
+
+    /** \brief Concatenates activities of a trace \a traceNum of the log \a log. */
+    static std::string traceStr(IEventLog* log, int traceNum)
+    {
+        std::string res;
+        IEventTrace* tr = log->getTrace(traceNum);
+        IEventLog::Attribute a;
+        for (int i = 0; i < tr->getSize(); ++i)
+        {
+            EXPECT_TRUE(tr->getEvent(i)->getAttr("activity", a));
+            res += a.toString();
+        }
+        return res;
+    }
+
+protected:
+    SQLiteLog* _log;
+}; // class FilteredLog_1_Test
+
+// ---<do not change followings>
+const char* FilteredLog_1_Test::LOG_FILE_RTS_04 = CSVLOG1_TEST_LOGS_BASE_DIR "logs/log04.sq3";
+
+//===================================================================================
+
+// представление без фильтров совпадает с исходным логом
+TEST_F(FilteredLog_1_Test, identity1)
+{
+    FilteredLog view(_log);
+    EXPECT_TRUE(view.isOpen());
+    EXPECT_EQ(_log->getTracesNum(), view.getTracesNum());
+    EXPECT_EQ(_log->getEventsNum(), view.getEventsNum());
+    EXPECT_EQ(_log->getActivitiesNum(), view.getActivitiesNum());
+
+    EXPECT_EQ("abc", traceStr(&view, 0));
+    EXPECT_EQ("bdce", traceStr(&view, 3));
+    EXPECT_EQ(nullptr, view.getTrace(4));
+}
+
+//-----------------------------------------------------------------------------
+
+// маска активностей
+TEST_F(FilteredLog_1_Test, activityMask1)
+{
+    FilteredLog view(_log);
+    view.removeActivities({ "e" });
+    EXPECT_EQ(4, view.getTracesNum());
+    EXPECT_EQ(12, view.getEventsNum());
+    EXPECT_EQ(4, view.getActivitiesNum());
+    EXPECT_EQ(3, view.getTraceSize(3));
+    EXPECT_EQ("bdc", traceStr(&view, 3));
+
+    view.keepActivities({ "a", "b", "c" }).keepActivities({ "b", "c", "d" });
+    EXPECT_EQ("bc", traceStr(&view, 0));
+    EXPECT_EQ("b", traceStr(&view, 1));
+    EXPECT_EQ(2, view.getActivitiesNum());
+
+    // процедурный интерфейс следует за маской
+    IEventLog::Attribute a;
+    EXPECT_TRUE(view.getEventAttr(0, 1, "activity", a));
+    EXPECT_EQ("c", a.toString());
+    EXPECT_FALSE(view.getEventAttr(1, 1, "activity", a));
+}
+
+//-----------------------------------------------------------------------------
+
+// фильтры трасс и их цепочки
+TEST_F(FilteredLog_1_Test, traceFilters1)
+{
+    FilteredLog view(_log);
+    view.limitTraceLength(4);
+    ASSERT_EQ(1, view.getTracesNum());
+    EXPECT_EQ(3u, view.mapTraceNum(0));
+
+    IEventLog::Attribute a;
+    EXPECT_TRUE(view.getTraceAttr(0, "case", a));
+    EXPECT_EQ("case 4", a.toString());
+
+    FilteredLog view2(_log);
+    view2.removeActivities({ "a", "e" })
+        .filterByTraceAttr("case", [](const IEventLog::Attribute& caseAttr) { return caseAttr.toString() != "case 3"; })
+        .limitTraceLength(3, 3);
+    ASSERT_EQ(1, view2.getTracesNum());
+    EXPECT_EQ("bdc", traceStr(&view2, 0));
+    EXPECT_EQ(3, view2.getEventsNum());
+
+    // представление над представлением
+    FilteredLog view3(&view2);
+    view3.filterTraces([](IEventTrace* tr) { return tr->getSize() > 3; });
+    EXPECT_EQ(0, view3.getTracesNum());
+    EXPECT_EQ(0, view3.getEventsNum());
+}
+
+//-----------------------------------------------------------------------------
+
+// выборка трасс
+TEST_F(FilteredLog_1_Test, sample1)
+{
+    FilteredLog view(_log);
+    view.sample(2, 42);
+    ASSERT_EQ(2, view.getTracesNum());
+    EXPECT_LT(view.mapTraceNum(0), view.mapTraceNum(1));        // порядок сохранен
+
+    FilteredLog view2(_log);
+    view2.sample(2, 42);
+    EXPECT_EQ(view.mapTraceNum(0), view2.mapTraceNum(0));       // воспроизводимо
+    EXPECT_EQ(view.mapTraceNum(1), view2.mapTraceNum(1));
+
+    FilteredLog view3(_log);
+    view3.sampleFraction(1.0);
+    EXPECT_EQ(4, view3.getTracesNum());
+    view3.sampleFraction(0.0);
+    EXPECT_EQ(0, view3.getTracesNum());
+    EXPECT_THROW(view3.sampleFraction(1.5), LdopaException);
+}
+
+} // namespace
@@ -0,0 +1,192 @@
+////////////////////////////////////////////////////////////////////////////////
+/// \file
+/// \brief     Tests for interned strings and attributes based on them.
+/// \author    Sergey Shershakov
+/// \version   0.1.0
+/// \date      18.10.2026
+/// \copyright (c) xidv.ru 2014–2017.
+///            This source is for internal use only — Restricted Distribution.
+///            All rights reserved.
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#include <gtest/gtest.h>
+
+#include "xi/strutils/interned_str.h"
+#include "xi/attributes/boost_attr.h"
+
+// ldopa
+#include "xi/ldopa/eventlog/sqlite/sqlitelog.h"
+#include "xi/ldopa/eventlog/compact/compactlog.h"
+#include "xi/ldopa/ts/models/eventlog_ts_stateids.h"
+
+#include "constants.h"
+
+// std
+#include <cstdio>
+#include <string_view>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+namespace {
+
+using xi::strutils::InternStrPool;
+using xi::strutils::InternedStr;
+
+//===================================================================================
+
+TEST(InternStrPool1, intern1)
+{
+    InternStrPool pool;
+    InternedStr a1 = pool.intern("a");
+    InternedStr a2 = pool["a"];
+    InternedStr b = pool.intern("b");
+
+    EXPECT_EQ(2u, pool.getSize());
+    EXPECT_EQ(a1.getEntry(), a2.getEntry());    // единственный экземпляр
+    EXPECT_TRUE(a1 == a2);
+    EXPECT_TRUE(a1 != b);
+    EXPECT_TRUE(a1 < b);
+    EXPECT_FALSE(b < a1);
+    EXPECT_EQ("a", a1.str());
+    EXPECT_EQ(std::hash<std::string>()("a"), a1.hash());
+    EXPECT_EQ(&pool, a1.getPool());
+
+    EXPECT_TRUE(pool.find("c").isNull());
+    EXPECT_EQ(b.getEntry(), pool.find("b").getEntry());
+
+    // null-дескриптор
+    InternedStr n;
+    EXPECT_TRUE(n.isNull());
+    EXPECT_EQ("", n.str());
+    EXPECT_TRUE(n < a1);
+    EXPECT_FALSE(a1 < n);
+    EXPECT_FALSE(n == a1);
+
+    // разные пулы — сравнение по содержимому
+    InternStrPool pool2;
+    InternedStr a3 = pool2.intern("a");
+    EXPECT_TRUE(a1 == a3);
+    EXPECT_FALSE(a1 == pool2.intern("b"));
+}
+
+//-----------------------------------------------------------------------------
+
+// пул шардирован и ищет строки по string_view
+TEST(InternStrPool1, concurrent1)
+{
+    InternStrPool pool(5);
+    EXPECT_EQ(8u, pool.getShardsNum());
+
+    const int THREADS = 4;
+    const int STRS = 2000;
+    std::vector<std::vector<InternedStr>> res(THREADS);
+    std::vector<std::thread> thrs;
+    for (int t = 0; t < THREADS; ++t)
+        thrs.emplace_back([&pool, &res, t]() {
+            char buf[32];
+            for (int i = 0; i < STRS; ++i)
+            {
+                int len = std::snprintf(buf, sizeof(buf), "s%d", (i * 7 + t) % STRS);
+                res[t].push_back(pool.intern(std::string_view(buf, len)));
+            }
+        });
+    for (std::thread& th : thrs)
+        th.join();
+
+    EXPECT_EQ((std::size_t)STRS, pool.getSize());
+
+    // одинаковые строки из разных потоков — один экземпляр
+    for (int t = 0; t < THREADS; ++t)
+        for (int i = 0; i < STRS; ++i)
+        {
+            std::string s = "s" + std::to_string((i * 7 + t) % STRS);
+            ASSERT_EQ(s, res[t][i].str());
+            ASSERT_EQ(pool.find(s).getEntry(), res[t][i].getEntry());
+            ASSERT_EQ(std::hash<std::string>()(s), res[t][i].hash());
+        }
+
+    pool.clear();
+    EXPECT_EQ(0u, pool.getSize());
+}
+
+//-----------------------------------------------------------------------------
+
+TEST(InternStrPool1, attributes1)
+{
+    typedef xi::attributes::VarAttribute1 Attribute;
+    InternStrPool pool;
+
+    Attribute a1 = pool.intern("abc");
+    Attribute a2 = pool.intern("abc");
+    Attribute b = pool.intern("abd");
+    EXPECT_EQ(Attribute::tInternedStr, a1.getType());
+    EXPECT_TRUE(a1 == a2);
+    EXPECT_TRUE(a1 != b);
+    EXPECT_TRUE(a1 < b);
+    EXPECT_EQ("abc", a1.toString());
+    EXPECT_EQ("abc", a1.asStr());
+    EXPECT_EQ(a1.hash(), a2.hash());
+    EXPECT_EQ(Attribute(std::string("abc")).hash(), a1.hash());   // согласован с обычными строками
+
+    // интернированные и обычные строки сравниваются по содержимому
+    Attribute sa(std::string("abc")), sb(std::string("abb"));
+    EXPECT_TRUE(a1 == sa);
+    EXPECT_TRUE(sa == a1);
+    EXPECT_TRUE(a1 != sb);
+    EXPECT_TRUE(sb < a1);
+    EXPECT_TRUE(a1 < Attribute(std::string("abd")));
+    EXPECT_FALSE(a1 < sa);
+    EXPECT_FALSE(sa < a1);
+    EXPECT_TRUE(Attribute(1) < a1);                                 // прочие типы — по порядку типов
+    EXPECT_TRUE(Attribute(1) < sa);
+
+    std::unordered_set<Attribute, xi::attributes::VarAttributeHash<Attribute>> hs;
+    hs.insert(a1);
+    hs.insert(a2);
+    hs.insert(b);
+    EXPECT_EQ(2u, hs.size());
+
+    // идентификаторы состояний
+    using xi::ldopa::ts::AttrListStateIDsPool;
+    using xi::ldopa::ts::AttrListStateId;
+    AttrListStateIDsPool stPool;
+    const AttrListStateId* s1 = stPool[AttrListStateId({ a1, b })];
+    EXPECT_EQ(s1, stPool[AttrListStateId({ a2, b })]);
+    EXPECT_NE(s1, stPool[AttrListStateId({ b, a1 })]);
+}
+
+//-----------------------------------------------------------------------------
+
+// лог отдает интернированные строки
+TEST(InternStrPool1, sqliteLog1)
+{
+    using namespace xi::ldopa::eventlog;
+
+    InternStrPool pool;
+    SQLiteLog log(CSVLOG1_TEST_LOGS_BASE_DIR "logs/log04.sq3");
+    log.setAutoLoadConfig(true);
+    log.setAutoLoadConfigQry("SELECT * FROM DefConfig");
+    log.setStrPool(&pool);
+    log.open();
+
+    IEventLog::Attribute a1, a2;
+    EXPECT_TRUE(log.getTrace(0)->getEvent(0)->getAttr("activity", a1));     // a
+    EXPECT_TRUE(log.getTrace(1)->getEvent(0)->getAttr("activity", a2));     // a
+    EXPECT_EQ(IEventLog::Attribute::tInternedStr, a1.getType());
+    EXPECT_EQ(a1.asStrP(), a2.asStrP());
+
+    EXPECT_TRUE(log.getEventAttr(3, 3, "activity", a1));                    // e
+    EXPECT_EQ(IEventLog::Attribute::tInternedStr, a1.getType());
+    EXPECT_EQ("e", a1.toString());
+    EXPECT_TRUE(pool.find("c").isNull());                                   // события не загружались
+
+    // компактный лог кодирует активности, интернируя их в тот же пул
+    CompactLog clog(&log, false, &pool);
+    EXPECT_EQ(5, clog.getActivitiesNum());
+    EXPECT_FALSE(pool.find("c").isNull());
+    EXPECT_EQ(IEventLog::Attribute::tInternedStr, clog.getActivity(0).getType());
+}
+
+} // namespace
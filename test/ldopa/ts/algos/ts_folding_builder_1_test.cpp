@@ -9,8 +9,10 @@
 
 #include "xi/ldopa/eventlog/sqlite/sqlitelog.h"
 #include "xi/ldopa/ts/algos/cycle_condenser.h"
+#include "xi/ldopa/ts/algos/ts_simple_builder.h"
+#include "xi/ldopa/ts/algos/ts_metrics_calc.h"
+#include "xi/ldopa/ts/models/frozen_ts.h"
 // #include "xi/ldopa/ts/algos/varws_ts_rebuilder.h"
-// #include "xi/ldopa/ts/algos/ts_metrics_calc.h"
 
 // #include "xi/ldopa/ts/algos/grviz/evlog_ts_red_dotwriter.h" // DOT writter
 // #include "xi/ldopa/ts/algos/ts_sas_converter.h"
@@ -335,6 +337,57 @@ TEST_F(TsFoldBuilder_1_Test, buildAndReduceSimpleLog1)
     // после редукции 40 % (мин. сохраненная частота 2) остается 4 вершины и 3 дуг
     EXPECT_EQ(2, rts->getStatesNum());
     EXPECT_EQ(3, rts->getTransitionsNum());
+
+    // частоты и принимающие состояния — за тот же проход, что и векторы Париха
+    EXPECT_EQ(2, ts->getTracesNum());
+    TS::OtransIterPair ots = ts->getOutTransitions(ts->getInitState());
+    for (; ots.first != ots.second; ++ots.first)
+    {
+        TS::IntRes fr = ts->getTransFreq(*ots.first);
+        EXPECT_TRUE(fr.second);
+        EXPECT_EQ(1, fr.first);
+    }
+    EXPECT_FALSE(ts->isStateAccepting(ts->getInitState()));
+
+    // в редуцированной частоты склеенных дуг суммируются: 8 событий
+    EXPECT_EQ(2, rts->getTracesNum());
+    int freqSum = 0;
+    for (TS::TransIterPair trs = rts->getTransitions(); trs.first != trs.second; ++trs.first)
+    {
+        TS::IntRes fr = rts->getTransFreq(*trs.first);
+        EXPECT_TRUE(fr.second);
+        freqSum += fr.first;
+    }
+    EXPECT_EQ(8, freqSum);
+
+    int accNum = 0;
+    for (TS::StateIterPair sts = rts->getStates(); sts.first != sts.second; ++sts.first)
+        if (rts->isStateAccepting(*sts.first))
+            ++accNum;
+    EXPECT_LT(0, accNum);
+
+    // метрики — по снимкам, без повторного построения СП по логу
+    typedef EvLogTSWithFreqs FTS;
+    AttrListStateIDsPool fPool;
+    PrefixStateFunc fFnc(&log, &fPool);
+    TsBuilder fBldr(&log, &fFnc, &fPool);
+    FTS* fts = fBldr.build(false);
+
+    FrozenEvLogTS frTs(*ts);
+    FrozenEvLogTS frRts(*rts);
+    TsMetricsCalc mCalc(&log, fts);
+    EXPECT_DOUBLE_EQ(mCalc.calcGeneralization(fts), mCalc.calcGeneralization(frTs));
+    EXPECT_DOUBLE_EQ(mCalc.calcPrecision(fts), mCalc.calcPrecision(frTs, frTs));
+    EXPECT_DOUBLE_EQ(1.0, mCalc.calcPrecision(frTs, frTs));
+
+    double simpl = mCalc.calcSimplicity(frRts);
+    double prec = mCalc.calcPrecision(frRts, frTs);
+    double gen = mCalc.calcGeneralization(frRts);
+    EXPECT_LT(0, simpl);
+    EXPECT_LT(0, prec);
+    EXPECT_GE(1, prec);
+    EXPECT_LT(0, gen);
+    EXPECT_GE(1, gen);
 }
 
 //------------------------------------------------------------------------------
@@ -0,0 +1,141 @@
+///////////////////////////////////////////////////////////////////////////////
+/// \file
+/// \brief Testing batch evaluation of TSs for a grid of parameters
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#include <gtest/gtest.h>
+
+// ldopa
+#include "xi/ldopa/ts/algos/ts_grid_evaluator.h"
+#include "xi/ldopa/ts/algos/ts_simple_builder.h"
+#include "xi/ldopa/ts/algos/freq_condenser.h"
+#include "xi/ldopa/ts/algos/varws_ts_rebuilder.h"
+#include "xi/ldopa/ts/algos/ts_metrics_calc.h"
+#include "xi/ldopa/eventlog/sqlite/sqlitelog.h"
+
+#include "constants.h"
+
+// std
+#include <algorithm>
+
+namespace {
+
+using namespace xi::ldopa;
+using namespace xi::ldopa::ts;
+
+const char* LOG_FILE_RTS_05 = CSVLOG1_TEST_LOGS_BASE_DIR "logs/log05.sq3";
+
+//==============================================================================
+// class TsGridEvaluator
+//==============================================================================
+
+// результаты по сетке совпадают с построением СП по шагам
+TEST(TsGridEvaluator1, evaluate1)
+{
+    typedef EvLogTSWithFreqs TS;
+    typedef TsGridEvaluator Ev;
+
+    eventlog::SQLiteLog log(LOG_FILE_RTS_05);
+    log.setAutoLoadConfig(true);
+    log.setAutoLoadConfigQry("SELECT * FROM DefConfig");
+    log.open();
+
+    Ev ev(&log);
+    EXPECT_EQ(16, ev.getFullTs()->getStatesNum());
+    EXPECT_EQ(8u, ev.getFullTs()->getTracesNum());
+    EXPECT_LT(0u, ev.getLog().getEncodedSize());
+
+    // порог 2 — неверный
+    Ev::VecOfCandidates cands = Ev::makeGrid({ PrefixStateFunc::UNLIM_WND_SIZE, 2 },
+        { 0.33, 0.5, 2 }, { 0.5, 1 });
+    ASSERT_EQ(12u, cands.size());
+    EXPECT_EQ(2, cands[11].ws);
+    EXPECT_EQ(2, cands[11].threshold);
+    EXPECT_EQ(1, cands[11].vwsc);
+
+    Ev::VecOfResults res = ev.evaluate(cands);
+    ASSERT_EQ(cands.size(), res.size());
+
+    // по шагам — с тем же логом и префиксным деревом
+    AttrListStateIDsPool fullPool;
+    PrefixStateFunc fullFnc(&log, &fullPool);
+    TsBuilder fullBldr(&log, &fullFnc, &fullPool);
+    TS* fullTs = fullBldr.build(false);
+    TsMetricsCalc mCalc(&log, fullTs);
+
+    for (size_t i = 0; i < cands.size(); ++i)
+    {
+        const Ev::Result& r = res[i];
+        EXPECT_EQ(cands[i].ws, r.cand.ws);
+        if (cands[i].threshold > 1)
+        {
+            EXPECT_EQ(Ev::stError, r.status);
+            EXPECT_FALSE(r.error.empty());
+            continue;
+        }
+        ASSERT_EQ(Ev::stOk, r.status);
+
+        AttrListStateIDsPool pool;
+        PrefixStateFunc fnc(&log, &pool, cands[i].ws);
+        TsBuilder bldr(&log, &fnc, &pool);
+        TS* ts = bldr.build(false);
+        CondensedTsBuilder reducer(ts);
+        VarWsTsBuilder rebuilder(&log, reducer.build(cands[i].threshold), &fnc);
+        TS* rts = rebuilder.build(cands[i].vwsc, VarWsTsBuilder::zsaSpecState);
+
+        EXPECT_EQ(rts->getStatesNum(), r.statesNum);
+        EXPECT_EQ(rts->getTransitionsNum(), r.transNum);
+        EXPECT_DOUBLE_EQ(mCalc.calcSimplicity(rts), r.simplicity);
+        EXPECT_DOUBLE_EQ(mCalc.calcPrecision(rts), r.precision);
+        EXPECT_DOUBLE_EQ(mCalc.calcGeneralization(rts), r.generalization);
+        EXPECT_LT(0u, r.memBytes);
+        EXPECT_LE(0, r.buildTime);
+    }
+
+    // после редукции 33 % и восстановления с VWSC = 1 — 12 вершин и 13 дуг
+    EXPECT_EQ(12u, res[1].statesNum);
+    EXPECT_EQ(13u, res[1].transNum);
+
+    // в нескольких потоках — то же самое
+    ev.setThreadsNum(4);
+    Ev::VecOfResults parRes = ev.evaluate(cands);
+    ASSERT_EQ(res.size(), parRes.size());
+    for (size_t i = 0; i < res.size(); ++i)
+    {
+        EXPECT_EQ(res[i].status, parRes[i].status);
+        EXPECT_EQ(res[i].statesNum, parRes[i].statesNum);
+        EXPECT_EQ(res[i].transNum, parRes[i].transNum);
+        EXPECT_EQ(res[i].precision, parRes[i].precision);
+        EXPECT_EQ(res[i].generalization, parRes[i].generalization);
+        EXPECT_EQ(res[i].memBytes, parRes[i].memBytes);
+    }
+
+    // ограничение, которому удовлетворяют все кандидаты, ничего не меняет
+    size_t maxBytes = 0;
+    for (const Ev::Result& r : res)
+        maxBytes = std::max(maxBytes, r.memBytes);
+    ev.setMemLimit(maxBytes);
+    Ev::VecOfResults okRes = ev.evaluate(cands);
+    for (size_t i = 0; i < res.size(); ++i)
+    {
+        EXPECT_EQ(res[i].status, okRes[i].status);
+        EXPECT_EQ(res[i].memBytes, okRes[i].memBytes);
+    }
+
+    // ни один кандидат не укладывается в 1 КБ: построение прерывается еще до
+    // редукции, так что и неверный порог не успевает проявиться
+    ev.setMemLimit(1024);
+    Ev::VecOfResults limRes = ev.evaluate(cands);
+    for (size_t i = 0; i < limRes.size(); ++i)
+    {
+        EXPECT_EQ(Ev::stMemLimit, limRes[i].status);
+        EXPECT_LT(1024u, limRes[i].memBytes);
+        EXPECT_EQ(0u, limRes[i].statesNum);
+        if (res[i].status == Ev::stOk)
+            EXPECT_LT(limRes[i].memBytes, res[i].memBytes);
+    }
+}
+
+
+} // anonymous namespace
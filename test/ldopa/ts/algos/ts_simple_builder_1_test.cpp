@@ -8,6 +8,7 @@
 
 #include "xi/ldopa/ts/algos/ts_simple_builder.h"
 #include "xi/ldopa/eventlog/sqlite/sqlitelog.h"
+#include "xi/ldopa/eventlog/filtered_log.h"
 #include "xi/ldopa/ts/algos/freq_condenser.h"
 #include "xi/ldopa/ts/algos/varws_ts_rebuilder.h"
 #include "xi/ldopa/ts/algos/ts_metrics_calc.h"
@@ -19,6 +20,9 @@
 // #include "eventlog/csvlog_test_settings.h"
 #include "constants.h"
 
+// std
+#include <memory>
+
 //==============================================================================
 // Testbed class.
 //==============================================================================
@@ -39,6 +43,42 @@ public:
     static const char*  LOG_FILE_RTS_04_1;              // log04-1.sq3 - 04 w/o <b d c e> trace
     static const char*  LOG_FILE_RTS_05;                // log05.sq3 from reduce transition systems topic
     static const char*  LOG_FILE_RUBIN_1;               // Rubin's log w/o the case 622.
+protected:
+    /** \brief Log with its full and reduced TSs; the builders own the TSs. */
+    struct ReducedLog {
+        explicit ReducedLog(const char* fileName)
+            : log(fileName)
+            , fnc(&log, &pool)
+            , bldr(&log, &fnc, &pool)
+            , rts(nullptr)
+        {
+            log.setAutoLoadConfig(true);
+            log.setAutoLoadConfigQry("SELECT * FROM DefConfig");
+            log.open();
+        }
+
+        xi::ldopa::eventlog::SQLiteLog log;
+        xi::ldopa::ts::AttrListStateIDsPool pool;
+        xi::ldopa::ts::PrefixStateFunc fnc;
+        xi::ldopa::ts::TsBuilder bldr;
+        std::unique_ptr<xi::ldopa::ts::CondensedTsBuilder> reducer;
+        xi::ldopa::ts::EvLogTSWithFreqs* rts;       ///< Reduced TS.
+    }; // struct ReducedLog
+
+    /** \brief Builds full and reduced (33 %) TSs of LOG_FILE_RTS_05 into \a rl, as in
+     *  reduceRebuiltSimpleLog1; call it in ASSERT_NO_FATAL_FAILURE().
+     */
+    static void buildReducedLog05(std::unique_ptr<ReducedLog>& rl)
+    {
+        rl.reset(new ReducedLog(LOG_FILE_RTS_05));
+
+        xi::ldopa::ts::EvLogTSWithFreqs* ts = rl->bldr.build(true);
+        ASSERT_EQ(16, ts->getStatesNum());
+
+        rl->reducer.reset(new xi::ldopa::ts::CondensedTsBuilder(ts));
+        rl->rts = rl->reducer->build(0.33);
+        ASSERT_EQ(6, rl->rts->getStatesNum());
+    }
 protected:
     virtual void SetUp()
     {
@@ -350,6 +390,143 @@ TEST_F(TsSimpleBuilder_1_Test, reduceRebuiltSimpleLog1)
     // генерализация пусть уже
     double ts1_genr = mCalc.calcGeneralization(ts);  
     double ts3_genr = mCalc.calcGeneralization(fts); 
+
+    // то же по логу, без префиксного дерева
+    EXPECT_NEAR(ts1_prec, mCalc.calcPrecisionByLog(ts), 1e-12);
+    EXPECT_NEAR(ts3_prec, mCalc.calcPrecisionByLog(fts), 1e-12);
+    EXPECT_NEAR(ts1_genr, mCalc.calcGeneralizationByLog(ts), 1e-12);
+
+    // все сразу за один проход
+    TsMetricsCalc::Metrics m3 = mCalc.calcAll(fts);
+    EXPECT_DOUBLE_EQ(mCalc.calcSimplicity(fts), m3.simplicity);
+    EXPECT_DOUBLE_EQ(ts3_prec, m3.precision);
+    EXPECT_DOUBLE_EQ(ts3_genr, m3.generalization);
+    EXPECT_LE(0, m3.gatherTime);
+}
+
+//------------------------------------------------------------------------------
+
+// восстановление: в каждом раунде проигрываются только недоигранные трассы
+TEST_F(TsSimpleBuilder_1_Test, rebuildPendingTraces1)
+{
+    instantiateNeedfulAttributeMembers();
+
+    using namespace xi::ldopa;
+    using namespace xi::ldopa::ts;
+
+    typedef EvLogTSWithFreqs TS;
+
+    std::unique_ptr<ReducedLog> rl;
+    ASSERT_NO_FATAL_FAILURE(buildReducedLog05(rl));
+    eventlog::SQLiteLog& log = rl->log;
+    PrefixStateFunc& fnc = rl->fnc;
+    TS* rts = rl->rts;
+
+    VarWsTsBuilder rebuilder(&log, rts, &fnc);
+    int cbRounds = 0, cbPending = -1;
+    rebuilder.setRoundCallback([&](int round, int pending) { cbRounds = round; cbPending = pending; });
+    TS* fts = rebuilder.build(1, VarWsTsBuilder::zsaSpecState);
+    EXPECT_EQ(12, fts->getStatesNum());
+    EXPECT_EQ(13, fts->getTransitionsNum());
+
+    EXPECT_EQ(rebuilder.getRoundsNum(), cbRounds);
+    EXPECT_EQ(0, cbPending);
+    EXPECT_EQ(0, rebuilder.getPendingTracesNum());
+    EXPECT_LT(1, rebuilder.getRoundsNum());
+    EXPECT_LE((int)log.getTracesNum(), rebuilder.getReplaysNum());
+    EXPECT_GT(rebuilder.getRoundsNum() * (int)log.getTracesNum(), rebuilder.getReplaysNum());
+}
+
+//------------------------------------------------------------------------------
+
+// восстановление: параллельное проигрывание дает ту же СП за те же раунды
+TEST_F(TsSimpleBuilder_1_Test, rebuildParallel1)
+{
+    instantiateNeedfulAttributeMembers();
+
+    using namespace xi::ldopa;
+    using namespace xi::ldopa::ts;
+
+    typedef EvLogTSWithFreqs TS;
+
+    std::unique_ptr<ReducedLog> rl;
+    ASSERT_NO_FATAL_FAILURE(buildReducedLog05(rl));
+    eventlog::SQLiteLog& log = rl->log;
+    PrefixStateFunc& fnc = rl->fnc;
+    TS* rts = rl->rts;
+
+    VarWsTsBuilder rebuilder(&log, rts, &fnc);
+    TS* fts = rebuilder.build(1, VarWsTsBuilder::zsaSpecState);
+
+    VarWsTsBuilder parRebuilder(&log, rts, &fnc);
+    parRebuilder.setThreadsNum(4);
+    TS* pts = parRebuilder.build(1, VarWsTsBuilder::zsaSpecState);
+    EXPECT_EQ(fts->getStatesNum(), pts->getStatesNum());
+    EXPECT_EQ(fts->getTransitionsNum(), pts->getTransitionsNum());
+    EXPECT_EQ(rebuilder.getRoundsNum(), parRebuilder.getRoundsNum());
+    EXPECT_EQ(rebuilder.getReplaysNum(), parRebuilder.getReplaysNum());
+    for (TS::StateIterPair sts = fts->getStates(); sts.first != sts.second; ++sts.first)
+    {
+        if (fts->isStateAnon(*sts.first))
+            continue;
+        TS::StateRes ps = pts->getState(fts->getStateID(*sts.first));
+        ASSERT_TRUE(ps.second);
+        EXPECT_EQ(fts->isStateAccepting(*sts.first), pts->isStateAccepting(ps.first));
+        for (TS::OtransIterPair ots = fts->getOutTransitions(*sts.first); ots.first != ots.second; ++ots.first)
+        {
+            TS::TransRes pt = pts->getFirstOutTrans(ps.first, fts->getTransLbl(*ots.first));
+            ASSERT_TRUE(pt.second);
+            EXPECT_EQ(fts->getTransFreq(*ots.first).first, pts->getTransFreq(pt.first).first);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+
+// перебор vwsc с общим первым раундом дает те же СП, что и отдельные построения
+TEST_F(TsSimpleBuilder_1_Test, rebuildVwscSweep1)
+{
+    instantiateNeedfulAttributeMembers();
+
+    using namespace xi::ldopa;
+    using namespace xi::ldopa::ts;
+
+    typedef EvLogTSWithFreqs TS;
+
+    std::unique_ptr<ReducedLog> rl;
+    ASSERT_NO_FATAL_FAILURE(buildReducedLog05(rl));
+    eventlog::SQLiteLog& log = rl->log;
+    PrefixStateFunc& fnc = rl->fnc;
+    TS* rts = rl->rts;
+
+    const std::vector<double> vwscs = { 0.5, 1, 2 };
+    for (unsigned int maxVars : { 1u, 3u, 0u })
+    {
+        VarWsTsBuilder sweeper(&log, rts, &fnc);
+        sweeper.setMaxVariantsNum(maxVars);
+        TS* kept = nullptr;
+        VarWsTsBuilder::VecOfVwscPoints vpts = sweeper.sweepVwsc(vwscs, VarWsTsBuilder::zsaSpecState,
+            [&](double vwsc, TS* vts) {
+                if (vwsc != 1)
+                    return false;
+                kept = vts;                             // забираем СП для vwsc = 1
+                return true;
+            });
+        ASSERT_EQ(vwscs.size(), vpts.size());
+        for (size_t i = 0; i < vwscs.size(); ++i)
+        {
+            VarWsTsBuilder single(&log, rts, &fnc);
+            TS* sts = single.build(vwscs[i], VarWsTsBuilder::zsaSpecState);
+            EXPECT_EQ(vwscs[i], vpts[i].vwsc);
+            EXPECT_EQ(sts->getStatesNum(), vpts[i].statesNum);
+            EXPECT_EQ(sts->getTransitionsNum(), vpts[i].transNum);
+            EXPECT_EQ(single.getRoundsNum(), vpts[i].roundsNum);
+        }
+        ASSERT_TRUE(kept != nullptr);
+        EXPECT_EQ(12, kept->getStatesNum());
+        EXPECT_EQ(13, kept->getTransitionsNum());
+        delete kept;
+    }
 }
 
 //------------------------------------------------------------------------------
@@ -417,6 +594,82 @@ TEST_F(TsSimpleBuilder_1_Test, calcPrecision1)
     double ts_genr = mCalc.calcGeneralization(ts);
     double ts1_genr = mCalc.calcGeneralization(ts1);
 
+    // то же по логу, без префиксного дерева
+    EXPECT_NEAR(ts_prec, mCalc.calcPrecisionByLog(ts), 1e-12);
+    EXPECT_NEAR(ts1_prec, mCalc.calcPrecisionByLog(ts1), 1e-12);
+    EXPECT_NEAR(ts_genr, mCalc.calcGeneralizationByLog(ts), 1e-12);
+
+    // все сразу за один проход: с префиксным деревом и без него
+    TsMetricsCalc::Metrics m1 = mCalc.calcAll(ts1);
+    EXPECT_DOUBLE_EQ(ts1_simpl, m1.simplicity);
+    EXPECT_DOUBLE_EQ(ts1_prec, m1.precision);
+    EXPECT_DOUBLE_EQ(ts1_genr, m1.generalization);
+
+    TsMetricsCalc lCalc(&log);
+    TsMetricsCalc::Metrics lm1 = lCalc.calcAll(ts1);
+    EXPECT_NEAR(ts1_prec, lm1.precision, 1e-12);
+    EXPECT_DOUBLE_EQ(ts1_genr, lm1.generalization);
+
+    // пригодность: свой лог проигрывается полностью
+    TsMetricsCalc::Fitness fit = mCalc.calcFitness(ts1);
+    EXPECT_EQ(4, fit.tracesNum);
+    EXPECT_EQ(4, fit.variantsNum);
+    EXPECT_EQ(4, fit.fittingTracesNum);
+    EXPECT_EQ(12, fit.prefixEventsNum);
+    EXPECT_EQ(0, fit.unmatchedEventsNum);
+    EXPECT_EQ(1., fit.fitness);
+
+    // в 4-м логе в трассе <b d c e> события e в СП нет
+    SQLiteLog log4(LOG_FILE_RTS_04);
+    log4.setAutoLoadConfig(true);
+    log4.setAutoLoadConfigQry("SELECT * FROM DefConfig");
+    log4.open();
+    TsMetricsCalc tCalc(&log4);
+    for (unsigned int thrNum : { 1u, 4u })
+    {
+        tCalc.setThreadsNum(thrNum);
+        for (const TS* fts : { (const TS*)ts, (const TS*)ts1 })
+        {
+            fit = tCalc.calcFitness(fts);
+            EXPECT_EQ(4, fit.tracesNum);
+            EXPECT_EQ(3, fit.fittingTracesNum);
+            EXPECT_EQ(13, fit.eventsNum);
+            EXPECT_EQ(12, fit.prefixEventsNum);
+            EXPECT_EQ(1, fit.unmatchedEventsNum);
+            EXPECT_DOUBLE_EQ(12. / 13., fit.fitness);
+        }
+    }
+
+    // без активностей a, b, c, d трассы пусты: подходят, только если начальное
+    // состояние принимающее
+    eventlog::FilteredLog elog(&log);
+    elog.removeActivities({ "a", "b", "c", "d" });
+    TsMetricsCalc eCalc(&elog);
+    ASSERT_FALSE(ts1->isStateAccepting(ts1->getInitState()));
+    fit = eCalc.calcFitness(ts1);
+    EXPECT_EQ(4, fit.tracesNum);
+    EXPECT_EQ(1, fit.variantsNum);
+    EXPECT_EQ(0, fit.eventsNum);
+    EXPECT_EQ(0, fit.fittingTracesNum);
+    EXPECT_DOUBLE_EQ(1., fit.fitness);
+
+    // прерывание по запросу
+    struct CancelCB final : public IProgressCallback {
+        virtual Res progress(Byte progress) override { return progress > 0 ? ResCancel : ResOK; }
+    } cancelCB;
+    tCalc.setProgressCB(&cancelCB);
+    EXPECT_THROW(tCalc.calcFitness(ts), LdopaException);
+
+    // СП без начального состояния: по логу не проигрывается ни один префикс
+    TS nts(&pool);
+    nts.getOrAddState(pool[{ "a" }]);
+    nts.removeState(nts.getInitState());
+    ASSERT_FALSE(nts.getState(nts.getInitStateID()).second);
+    EXPECT_DOUBLE_EQ(1., lCalc.calcGeneralization(&nts));
+    EXPECT_DOUBLE_EQ(1., lCalc.calcGeneralizationByLog(&nts));
+    EXPECT_DOUBLE_EQ(1., lCalc.calcAll(&nts).generalization);
+    lCalc.calcPrecisionByLog(&nts);
+
     delete ts;                                          // мы ее отдетачили!
 }
 
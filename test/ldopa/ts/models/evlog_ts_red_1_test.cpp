@@ -9,6 +9,12 @@
 // ldopa
 #include "xi/ldopa/ts/models/evlog_ts_red.h"
 #include "xi/ldopa/ts/models/eventlog_ts_stateids.h"
+#include "xi/ldopa/ts/algos/dual_ts_simulator.h"
+
+// std
+#include <cmath>
+#include <thread>
+#include <vector>
 
 //==============================================================================
 // class EvLogTSWithFreqs
@@ -160,3 +166,260 @@ TEST(EventLogTsFreq1, acceptingState1)
     ts1.setAcceptingState(st_a, false);
     EXPECT_FALSE(ts1.isStateAccepting(st_a));
 }
+
+//-----------------------------------------------------------------------------
+
+// частоты и флаги хранятся в бандлах и копируются вместе с графом
+TEST(EventLogTsFreq1, embeddedData1)
+{
+    using namespace xi::ldopa::ts;
+
+    typedef EvLogTSWithFreqs TS;
+
+    AttrListStateIDsPool pool;
+    TS ts1(&pool);
+
+    TS::State st_init = ts1.getInitState();
+    TS::State st_a = ts1.getOrAddState(pool[{ "a" }]);
+    TS::State st_b = ts1.getOrAddState(pool[{ "b" }]);
+    TS::Transition t1 = ts1.getOrAddTransF(st_init, st_a, "a", 3);
+    TS::Transition t2 = ts1.getOrAddTrans(st_a, st_b, "b");     // без частоты
+    ts1.setAcceptingState(st_b, true);
+
+    EXPECT_EQ(3, ts1.getTransData(t1).freq);
+    EXPECT_FALSE(ts1.getTransFreq(t2).second);
+    EXPECT_FALSE(ts1.getStateFlags(st_a).second);
+    EXPECT_TRUE(ts1.getStateFlags(st_b).second);
+
+    // копия
+    TS ts2(ts1);
+    TS::State st_b2 = ts2.getState(pool[{ "b" }]).first;
+    TS::TransRes t12 = ts2.getTrans(ts2.getInitState(), ts2.getState(pool[{ "a" }]).first, "a");
+    ASSERT_TRUE(t12.second);
+    EXPECT_EQ(TS::IntRes(3, true), ts2.getTransFreq(t12.first));
+    EXPECT_TRUE(ts2.isStateAccepting(st_b2));
+
+    // изменения копии не затрагивают исходную СП
+    ts2.setTransFreq(t12.first, 10);
+    ts2.setAcceptingState(st_b2, false);
+    EXPECT_EQ(3, ts1.getTransFreq(t1).first);
+    EXPECT_TRUE(ts1.isStateAccepting(st_b));
+
+    // присваивание
+    TS ts3(&pool);
+    ts3 = ts2;
+    TS::TransRes t13 = ts3.getTrans(ts3.getInitState(), ts3.getState(pool[{ "a" }]).first, "a");
+    ASSERT_TRUE(t13.second);
+    EXPECT_EQ(10, ts3.getTransFreq(t13.first).first);
+    EXPECT_FALSE(ts3.isStateAccepting(ts3.getState(pool[{ "b" }]).first));
+
+    // удаленный и вновь добавленный переход не наследует частоту
+    ts1.removeTrans(t2);
+    TS::Transition t2n = ts1.getOrAddTrans(st_a, st_b, "b");
+    EXPECT_FALSE(ts1.getTransFreq(t2n).second);
+}
+
+//------------------------------------------------------------------------------
+
+// константная СП читается несколькими потоками одновременно
+TEST(EventLogTsFreq1, constConcurrentReads1)
+{
+    using namespace xi::ldopa::ts;
+
+    typedef EvLogTSWithFreqs TS;
+
+    // префиксное дерево трасс ab, ac, abc и СП с циклом по b
+    AttrListStateIDsPool pool;
+    TS tree(&pool);
+    TS::State t0 = tree.getInitState();
+    TS::State t_a = tree.getOrAddState(pool[{ "a" }]);
+    TS::State t_ab = tree.getOrAddState(pool[{ "a", "b" }]);
+    TS::State t_ac = tree.getOrAddState(pool[{ "a", "c" }]);
+    TS::State t_abc = tree.getOrAddState(pool[{ "a", "b", "c" }]);
+    tree.getOrAddTransF(t0, t_a, "a", 3);
+    tree.getOrAddTransF(t_a, t_ab, "b", 2);
+    tree.getOrAddTransF(t_a, t_ac, "c", 1);
+    tree.getOrAddTransF(t_ab, t_abc, "c", 1);
+    tree.setAcceptingState(t_ab, true);
+    tree.setAcceptingState(t_ac, true);
+    tree.setAcceptingState(t_abc, true);
+
+    TS ts(&pool);
+    TS::State s_a = ts.getOrAddState(pool[{ "a" }]);
+    TS::State s_c = ts.getOrAddState(pool[{ "c" }]);
+    ts.getOrAddTransF(ts.getInitState(), s_a, "a", 3);
+    ts.getOrAddTransF(s_a, s_a, "b", 2);
+    ts.getOrAddTransF(s_a, s_c, "c", 2);
+    ts.setAcceptingState(s_a, true);
+    ts.setAcceptingState(s_c, true);
+
+    const TS& cts = ts;
+    const TS& ctree = tree;
+    DualTsSimulator sim;
+    const double prec = sim.calcPrecision(&cts, &ctree);
+    const size_t accNum = 2;
+
+    // каждый поток со своим симулятором; СП никто не меняет
+    std::vector<double> precs(4, -1);
+    std::vector<size_t> accs(4, 0);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < precs.size(); ++i)
+        threads.push_back(std::thread([&, i]()
+        {
+            for (int k = 0; k < 100; ++k)
+            {
+                DualTsSimulator thSim;
+                precs[i] = thSim.calcPrecision(&cts, &ctree);
+
+                size_t acc = 0;
+                TS::StateIter sCur, sEnd;
+                for (boost::tie(sCur, sEnd) = cts.getStates(); sCur != sEnd; ++sCur)
+                    if (cts.isStateAccepting(*sCur) && cts.getFirstOutTrans(*sCur, "c").second)
+                        ++acc;
+                accs[i] = acc + (cts.getState(cts.getStateID(s_c)).first == s_c ? 1 : 0);
+            }
+        }));
+    for (std::thread& th : threads)
+        th.join();
+
+    for (size_t i = 0; i < precs.size(); ++i)
+    {
+        EXPECT_DOUBLE_EQ(prec, precs[i]);
+        EXPECT_EQ(accNum, accs[i]);
+    }
+}
+
+//------------------------------------------------------------------------------
+
+// длинная трасса: симуляция без рекурсии; параллельная и с кратностями пар — те же результаты
+TEST(EventLogTsFreq1, dualSimLongTrace1)
+{
+    using namespace xi::ldopa::ts;
+
+    typedef EvLogTSWithFreqs TS;
+
+    // префиксное дерево — цепочка a^n (с отростками b) и СП с петлей по a
+    const int n = 100000;
+    AttrListStateIDsPool pool;
+    TS tree(&pool);
+    TS::State cur = tree.getInitState();
+    for (int i = 0; i < n; ++i)
+    {
+        TS::State next = tree.addAnonState();
+        tree.getOrAddTransF(cur, next, "a", 1);
+        if (i % 1000 == 0)
+            tree.getOrAddTransF(cur, tree.addAnonState(), "b", 1);
+        cur = next;
+    }
+    tree.setAcceptingState(cur, true);
+
+    TS ts(&pool);
+    TS::State s_a = ts.getOrAddState(pool[{ "a" }]);
+    ts.getOrAddTransF(ts.getInitState(), s_a, "a", 1);
+    ts.getOrAddTransF(s_a, s_a, "a", 1);
+    ts.getOrAddTransF(s_a, s_a, "c", 1);
+    ts.setAcceptingState(s_a, true);
+
+    DualTsSimulator sim;
+    const double prec = sim.calcPrecision(&ts, &tree);
+    EXPECT_LT(0., prec);
+    EXPECT_GT(1., prec);
+    ASSERT_EQ(2, sim.getPartStatePrecs().size());
+    EXPECT_EQ(n, sim.getPartStatePrecs()[1].second);          // s_a пройдено n раз
+
+    sim.setThreadsNum(4);
+    EXPECT_NEAR(prec, sim.calcPrecision(&ts, &tree), 1e-9);
+    sim.setThreadsNum(3);
+    const double prec3 = sim.calcPrecision(&ts, &tree);
+    sim.setThreadsNum(4);
+    EXPECT_EQ(prec3, sim.calcPrecision(&ts, &tree));          // не зависит от числа потоков
+
+    sim.setThreadsNum(1);
+    sim.setPairsMemo(true);
+    EXPECT_NEAR(prec, sim.calcPrecision(&ts, &tree), 1e-9);
+
+    FrozenEvLogTS fts = ts.freeze();
+    FrozenEvLogTS ftree = tree.freeze();
+    sim.setPairsMemo(false);
+    EXPECT_DOUBLE_EQ(prec, sim.calcPrecision(fts, ftree));
+}
+
+//------------------------------------------------------------------------------
+
+// если TS2 не дерево, пары состояний раскрываются один раз с кратностями
+TEST(EventLogTsFreq1, dualSimPairsMemo1)
+{
+    using namespace xi::ldopa::ts;
+
+    typedef EvLogTSWithFreqs TS;
+
+    // TS2: ромбы init -x|y-> m1 -x|y-> m2 ...: 2^k путей
+    const int k = 16;
+    AttrListStateIDsPool pool;
+    TS dag(&pool);
+    TS::State cur = dag.getInitState();
+    for (int i = 0; i < k; ++i)
+    {
+        TS::State next = dag.addAnonState();
+        dag.getOrAddTransF(cur, next, "x", 1);
+        dag.getOrAddTransF(cur, next, "y", 1);
+        cur = next;
+    }
+    dag.setAcceptingState(cur, true);
+
+    TS ts(&pool);
+    TS::State s = ts.getInitState();
+    ts.getOrAddTransF(s, s, "x", 1);
+    ts.getOrAddTransF(s, s, "y", 1);
+    ts.getOrAddTransF(s, s, "z", 1);
+
+    DualTsSimulator sim;
+    const double prec = sim.calcPrecision(&ts, &dag);
+    EXPECT_EQ((1 << (k + 1)) - 1, sim.getPartStatePrecs()[0].second);
+
+    sim.setPairsMemo(true);
+    EXPECT_NEAR(prec, sim.calcPrecision(&ts, &dag), 1e-12);
+    EXPECT_EQ((1 << (k + 1)) - 1, sim.getPartStatePrecs()[0].second);
+}
+
+//------------------------------------------------------------------------------
+
+// кратности пар при мемоизации не переполняются, даже если путей больше 2^64
+TEST(EventLogTsFreq1, dualSimPairsMemoManyPaths1)
+{
+    using namespace xi::ldopa::ts;
+
+    typedef EvLogTSWithFreqs TS;
+
+    // те же ромбы, что и в dualSimPairsMemo1, но их 80: 2^80 путей
+    const int k = 80;
+    AttrListStateIDsPool pool;
+    TS dag(&pool);
+    TS::State cur = dag.getInitState();
+    for (int i = 0; i < k; ++i)
+    {
+        TS::State next = dag.addAnonState();
+        dag.getOrAddTransF(cur, next, "x", 1);
+        dag.getOrAddTransF(cur, next, "y", 1);
+        cur = next;
+    }
+    dag.setAcceptingState(cur, true);
+
+    TS ts(&pool);
+    TS::State s = ts.getInitState();
+    ts.getOrAddTransF(s, s, "x", 1);
+    ts.getOrAddTransF(s, s, "y", 1);
+    ts.getOrAddTransF(s, s, "z", 1);
+
+    DualTsSimulator sim;
+    sim.setPairsMemo(true);
+    const double prec = sim.calcPrecision(&ts, &dag);
+
+    // пара (s, m_i) встречается 2^i раз; у всех, кроме последней, точность 2/3, 
+    // у последней — 0
+    const double paths = std::ldexp(1., k + 1) - 1;
+    const double expPrec = 2. / 3. * (std::ldexp(1., k) - 1) / paths;
+    EXPECT_DOUBLE_EQ(paths, sim.getPartStatePrecs()[0].second);
+    EXPECT_NEAR(expPrec, prec, 1e-12);
+    EXPECT_GT(prec, 0.);
+}
@@ -0,0 +1,357 @@
+///////////////////////////////////////////////////////////////////////////////
+/// \file
+/// \brief Testing frozen (CSR) TS snapshots
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#include <gtest/gtest.h>
+
+// ldopa
+#include "xi/ldopa/ts/models/frozen_ts.h"
+#include "xi/ldopa/ts/models/eventlog_ts_stateids.h"
+#include "xi/ldopa/ts/algos/ts_simple_builder.h"
+#include "xi/ldopa/ts/algos/ts_metrics_calc.h"
+#include "xi/ldopa/ts/algos/ts_folding_builder.h"
+#include "xi/ldopa/eventlog/sqlite/sqlitelog.h"
+
+#include "constants.h"
+
+// std
+#include <cstdio>
+
+namespace {
+
+using namespace xi::ldopa;
+using namespace xi::ldopa::ts;
+
+//==============================================================================
+// class FrozenEvLogTS
+//==============================================================================
+
+// структура снимка
+TEST(FrozenEvLogTS1, structure1)
+{
+    typedef EvLogTSWithFreqs TS;
+    typedef FrozenEvLogTS FTS;
+
+    // строковые метки упорядочиваются по содержимому
+    TS::Attribute la(std::string("a")), lb(std::string("b")), lc(std::string("c"));
+
+    AttrListStateIDsPool pool;
+    TS ts(&pool);
+
+    // init -b-> b -c-> c;  init -a-> a -c-> c; c -a-> c
+    TS::State st_init = ts.getInitState();
+    TS::State st_b = ts.getOrAddState(pool[{ "b" }]);
+    TS::State st_a = ts.getOrAddState(pool[{ "a" }]);
+    TS::State st_c = ts.getOrAddState(pool[{ "c" }]);
+    ts.getOrAddTransF(st_init, st_b, lb, 2);
+    ts.getOrAddTransF(st_init, st_a, la, 3);
+    ts.getOrAddTransF(st_b, st_c, lc, 2);
+    ts.getOrAddTransF(st_a, st_c, lc, 3);
+    ts.getOrAddTrans(st_c, st_c, la);                      // без частоты
+    ts.setAcceptingState(st_c, true);
+    ts.setMaxWS(1);
+
+    FTS fts = ts.freeze();
+    EXPECT_EQ(4u, fts.getStatesNum());
+    EXPECT_EQ(5u, fts.getTransitionsNum());
+    EXPECT_EQ(3u, fts.getLabelsNum());
+    EXPECT_EQ(1, fts.getMaxWS());
+
+    // BFS: выходные переходы упорядочены по меткам, поэтому a раньше b
+    FTS::State f_init = fts.getInitState();
+    EXPECT_EQ(0u, f_init);
+    EXPECT_EQ(st_init, fts.getOrigState(0));
+    EXPECT_EQ(st_a, fts.getOrigState(1));
+    EXPECT_EQ(st_b, fts.getOrigState(2));
+    EXPECT_EQ(st_c, fts.getOrigState(3));
+    EXPECT_EQ(pool[{ "c" }], fts.getStateID(3));
+
+    EXPECT_EQ(2u, fts.getOutTransNum(f_init));
+    FTS::TransRes ta = fts.getFirstOutTrans(f_init, la);
+    ASSERT_TRUE(ta.second);
+    EXPECT_EQ(1u, fts.getTargState(ta.first));
+    EXPECT_EQ(3, fts.getTransFreq(ta.first).first);
+    EXPECT_FALSE(fts.getFirstOutTrans(f_init, lc).second);
+    EXPECT_FALSE(fts.getFirstOutTrans(f_init, std::string("z")).second);
+
+    // петля и входные переходы
+    FTS::TransRes tl = fts.getTrans(3, 3, la);
+    ASSERT_TRUE(tl.second);
+    EXPECT_FALSE(fts.getTransFreq(tl.first).second);
+    EXPECT_EQ(3u, fts.getInTransNum(3));
+    EXPECT_EQ(0u, fts.getInTransNum(f_init));
+    EXPECT_TRUE(fts.isStateAccepting(3));
+    EXPECT_FALSE(fts.isStateAccepting(1));
+
+    FTS::ItransIter iCur, iEnd;
+    for (boost::tie(iCur, iEnd) = fts.getInTransitions(3); iCur != iEnd; ++iCur)
+        EXPECT_EQ(3u, fts.getTargState(*iCur));
+
+    // пустой снимок
+    FTS empty;
+    EXPECT_EQ(0u, empty.getStatesNum());
+    EXPECT_EQ(FTS::NO_INDEX, empty.getInitState());
+}
+
+//-----------------------------------------------------------------------------
+
+// метрики на снимке совпадают с метриками на исходной СП
+TEST(FrozenEvLogTS1, metrics1)
+{
+    using eventlog::SQLiteLog;
+    typedef EvLogTSWithFreqs TS;
+
+    SQLiteLog log(CSVLOG1_TEST_LOGS_BASE_DIR "logs/log04-1.sq3");
+    log.setAutoLoadConfig(true);
+    log.setAutoLoadConfigQry("SELECT * FROM DefConfig");
+    log.open();
+
+    AttrListStateIDsPool pool;
+    PrefixStateFunc fnc(&log, &pool);
+    TsBuilder bldr(&log, &fnc, &pool);
+
+    bldr.build(false);
+    TS* ts = bldr.detach();                             // префиксное дерево
+    fnc.setWS(1);
+    TS* ts1 = bldr.build(true);
+
+    FrozenEvLogTS fts = ts->freeze();
+    FrozenEvLogTS fts1 = ts1->freeze();
+    EXPECT_EQ(ts1->getStatesNum(), fts1.getStatesNum());
+    EXPECT_EQ(ts1->getTransitionsNum(), fts1.getTransitionsNum());
+
+    TsMetricsCalc mCalc(&log, ts);
+    EXPECT_DOUBLE_EQ(mCalc.calcSimplicity(ts1), mCalc.calcSimplicity(fts1));
+    EXPECT_DOUBLE_EQ(mCalc.calcPrecision(ts1), mCalc.calcPrecision(fts1, fts));
+    EXPECT_DOUBLE_EQ(mCalc.calcPrecision(ts), mCalc.calcPrecision(fts, fts));
+    EXPECT_DOUBLE_EQ(mCalc.calcGeneralization(ts1), mCalc.calcGeneralization(fts1));
+    EXPECT_DOUBLE_EQ(mCalc.calcGeneralization(ts), mCalc.calcGeneralization(fts));
+
+    delete ts;
+}
+
+//-----------------------------------------------------------------------------
+
+// сохранение и загрузка снимка
+TEST(FrozenEvLogTS1, saveLoad1)
+{
+    using eventlog::SQLiteLog;
+    typedef EvLogTSWithFreqs TS;
+    typedef FrozenEvLogTS FTS;
+    const char* fileName = TS_TEST_MODELS_BASE_DIR "ts/FrozenEvLogTS1-saveLoad1.fts";
+
+    SQLiteLog log(CSVLOG1_TEST_LOGS_BASE_DIR "logs/log04-1.sq3");
+    log.setAutoLoadConfig(true);
+    log.setAutoLoadConfigQry("SELECT * FROM DefConfig");
+    log.open();
+
+    AttrListStateIDsPool pool;
+    PrefixStateFunc fnc(&log, &pool);
+    TsBuilder bldr(&log, &fnc, &pool);
+
+    bldr.build(false);
+    TS* ts = bldr.detach();                             // префиксное дерево
+    fnc.setWS(1);
+    TS* ts1 = bldr.build(true);
+
+    FTS fts = ts->freeze();
+    FTS fts1 = ts1->freeze();
+    fts1.save(fileName);
+
+    // без пула ID состояний не восстанавливаются
+    FTS lts1 = FTS::load(fileName);
+    ASSERT_EQ(fts1.getStatesNum(), lts1.getStatesNum());
+    ASSERT_EQ(fts1.getTransitionsNum(), lts1.getTransitionsNum());
+    EXPECT_EQ(fts1.getLabelsNum(), lts1.getLabelsNum());
+    EXPECT_EQ(fts1.getInitState(), lts1.getInitState());
+    EXPECT_EQ(fts1.getTracesNum(), lts1.getTracesNum());
+    EXPECT_EQ(fts1.getMaxWS(), lts1.getMaxWS());
+    EXPECT_EQ(nullptr, lts1.getStateID(0));
+
+    for (FTS::Transition t = 0; t < fts1.getTransitionsNum(); ++t)
+    {
+        EXPECT_EQ(fts1.getSrcState(t), lts1.getSrcState(t));
+        EXPECT_EQ(fts1.getTargState(t), lts1.getTargState(t));
+        EXPECT_EQ(fts1.getTransFreq(t), lts1.getTransFreq(t));
+        EXPECT_EQ(fts1.getTransLbl(t).toString(), lts1.getTransLbl(t).toString());
+        EXPECT_EQ(t, lts1.getFirstOutTrans(lts1.getSrcState(t), fts1.getTransLbl(t)).first);
+    }
+    for (FTS::State s = 0; s < fts1.getStatesNum(); ++s)
+    {
+        EXPECT_EQ(fts1.isStateAccepting(s), lts1.isStateAccepting(s));
+        EXPECT_EQ(fts1.getInTransNum(s), lts1.getInTransNum(s));
+    }
+
+    // ID состояний восстанавливаются в новом пуле
+    AttrListStateIDsPool pool2;
+    FTS lts1a = FTS::load(fileName, &pool2);
+    for (FTS::State s = 0; s < fts1.getStatesNum(); ++s)
+        EXPECT_EQ(fts1.getStateID(s)->toString(), lts1a.getStateID(s)->toString());
+
+    // пул другого типа
+    FixedIntListStateIdsPool ipool;
+    EXPECT_THROW(FTS::load(fileName, &ipool), LdopaException);
+
+    // метрики на загруженном снимке
+    TsMetricsCalc mCalc(&log, ts);
+    EXPECT_DOUBLE_EQ(mCalc.calcSimplicity(fts1), mCalc.calcSimplicity(lts1));
+    EXPECT_DOUBLE_EQ(mCalc.calcPrecision(fts1, fts), mCalc.calcPrecision(lts1, fts));
+    EXPECT_DOUBLE_EQ(mCalc.calcGeneralization(fts1), mCalc.calcGeneralization(lts1));
+
+    // у загруженного снимка нет исходной СП
+    EXPECT_THROW(lts1.getOrigState(0), LdopaException);
+
+    // копии разделяют отображенный файл
+    FTS lts1c = lts1;
+    lts1 = FTS();
+    EXPECT_EQ(fts1.getTransitionsNum(), lts1c.getTransitionsNum());
+
+    // убывающие смещения переходов: за заголовком (64 байта) идут смещения секций,
+    // вторая из них — смещения выходных переходов; outOffs[1] делаем больше числа переходов
+    {
+        const char* badName = TS_TEST_MODELS_BASE_DIR "ts/FrozenEvLogTS1-saveLoad1-bad.fts";
+        fts1.save(badName);
+        std::FILE* f = std::fopen(badName, "r+b");
+        ASSERT_NE(nullptr, f);
+        std::uint64_t outOffsPos = 0;
+        ASSERT_EQ(0, std::fseek(f, 64 + sizeof(std::uint64_t), SEEK_SET));
+        ASSERT_EQ(1u, std::fread(&outOffsPos, sizeof(outOffsPos), 1, f));
+        FTS::Index bad = (FTS::Index)fts1.getTransitionsNum() + 5;
+        ASSERT_EQ(0, std::fseek(f, (long)(outOffsPos + sizeof(FTS::Index)), SEEK_SET));
+        ASSERT_EQ(1u, std::fwrite(&bad, sizeof(bad), 1, f));
+        std::fclose(f);
+        EXPECT_THROW(FTS::load(badName), LdopaException);
+        std::remove(badName);
+    }
+
+    // испорченный файл
+    {
+        std::FILE* f = std::fopen(fileName, "r+b");
+        ASSERT_NE(nullptr, f);
+        std::fputc('X', f);
+        std::fclose(f);
+    }
+    EXPECT_THROW(FTS::load(fileName), LdopaException);
+    EXPECT_THROW(FTS::load(TS_TEST_MODELS_BASE_DIR "ts/FrozenEvLogTS1-noFile.fts"), LdopaException);
+
+    lts1c = FTS();
+    lts1a = FTS();
+    std::remove(fileName);
+    delete ts;
+}
+
+//-----------------------------------------------------------------------------
+
+// снимок СП с векторами Париха
+TEST(FrozenEvLogTS1, saveLoadParVecs1)
+{
+    using eventlog::SQLiteLog;
+    typedef EvLogTSWithParVecs TS;
+    typedef FrozenEvLogTS FTS;
+    const char* fileName = TS_TEST_MODELS_BASE_DIR "ts/FrozenEvLogTS1-saveLoadParVecs1.fts";
+
+    SQLiteLog log(CSVLOG1_TEST_LOGS_BASE_DIR "logs/log04.sq3");
+    log.setAutoLoadConfig(true);
+    log.setAutoLoadConfigQry("SELECT * FROM DefConfig");
+    log.open();
+
+    AttrListStateIDsPool pool;
+    PrefixStateFunc fnc(&log, &pool);
+    TsFoldBuilder bldr(&log, &fnc, &pool);
+    TS* ts = bldr.build();
+
+    FTS fts = ts->freeze();
+    EXPECT_EQ(ts->getStatesNum(), fts.getStatesNum());
+    EXPECT_EQ(ts->getTransitionsNum(), fts.getTransitionsNum());
+    ASSERT_EQ(ts->getAttributeNum(), fts.getParikhDim());
+
+    // векторы совпадают с исходными, дополненными нулями
+    for (FTS::State s = 0; s < fts.getStatesNum(); ++s)
+    {
+        TS::ParikhVectorRes pvr = ts->getParikhVector(fts.getOrigState(s));
+        const FTS::Value* pv = fts.getParikhVector(s);
+        ASSERT_EQ(pvr.second, pv != nullptr);
+        if (!pv)
+            continue;
+
+        const std::vector<FTS::Value>& cnt = pvr.first.GetAttrsCnt();
+        for (FTS::Uint i = 0; i < fts.getParikhDim(); ++i)
+            EXPECT_EQ(i < cnt.size() ? cnt[i] : 0, pv[i]);
+    }
+
+    fts.save(fileName);
+    AttrListStateIDsPool pool2;
+    FTS lts = FTS::load(fileName, &pool2);
+    ASSERT_EQ(fts.getStatesNum(), lts.getStatesNum());
+    ASSERT_EQ(fts.getParikhDim(), lts.getParikhDim());
+    for (FTS::Uint i = 0; i < fts.getParikhDim(); ++i)
+        EXPECT_EQ(fts.getParikhAttr(i).toString(), lts.getParikhAttr(i).toString());
+
+    for (FTS::State s = 0; s < fts.getStatesNum(); ++s)
+    {
+        const FTS::Value* pv = fts.getParikhVector(s);
+        const FTS::Value* lpv = lts.getParikhVector(s);
+        ASSERT_EQ(pv != nullptr, lpv != nullptr);
+        if (pv)
+        {
+            EXPECT_TRUE(std::equal(pv, pv + fts.getParikhDim(), lpv));
+        }
+        EXPECT_EQ(fts.getStateID(s)->toString(), lts.getStateID(s)->toString());
+    }
+
+    lts = FTS();
+    std::remove(fileName);
+}
+
+//-----------------------------------------------------------------------------
+
+// загруженный снимок СП, построенной по логу с интернированными строками
+TEST(FrozenEvLogTS1, saveLoadInterned1)
+{
+    using eventlog::SQLiteLog;
+    typedef EvLogTSWithFreqs TS;
+    typedef FrozenEvLogTS FTS;
+    const char* fileName = TS_TEST_MODELS_BASE_DIR "ts/FrozenEvLogTS1-saveLoadInterned1.fts";
+
+    xi::strutils::InternStrPool strPool;
+    SQLiteLog log(CSVLOG1_TEST_LOGS_BASE_DIR "logs/log04-1.sq3");
+    log.setAutoLoadConfig(true);
+    log.setAutoLoadConfigQry("SELECT * FROM DefConfig");
+    log.setStrPool(&strPool);
+    log.open();
+
+    AttrListStateIDsPool pool;
+    PrefixStateFunc fnc(&log, &pool);
+    TsBuilder bldr(&log, &fnc, &pool);
+    fnc.setWS(1);
+    TS* ts = bldr.build(true);
+
+    FTS fts = ts->freeze();
+    fts.save(fileName);
+    AttrListStateIDsPool pool2;
+    FTS lts = FTS::load(fileName, &pool2);
+
+    // метки загружены как std::string, но находятся и по интернированным строкам
+    for (FTS::LabelCode c = 0; c < fts.getLabelsNum(); ++c)
+    {
+        const FTS::Attribute& lbl = fts.getLabel(c);
+        ASSERT_EQ(FTS::Attribute::tInternedStr, lbl.getType());
+        EXPECT_EQ(FTS::Attribute::tStringSharedPtr, lts.getLabel(c).getType());
+        EXPECT_EQ(c, lts.getLabelCode(lbl));
+    }
+
+    // лог воспроизводится на загруженном снимке так же, как на исходной СП
+    TsMetricsCalc mCalc(&log, ts);
+    TsMetricsCalc::Fitness f = mCalc.calcFitness(ts);
+    TsMetricsCalc::Fitness lf = mCalc.calcFitness(lts);
+    EXPECT_EQ(0, lf.unmatchedEventsNum);
+    EXPECT_EQ(f.fittingTracesNum, lf.fittingTracesNum);
+    EXPECT_EQ(f.eventsNum, lf.eventsNum);
+
+    lts = FTS();
+    std::remove(fileName);
+}
+
+} // namespace
@@ -805,6 +805,265 @@ TEST_F(LabeledTS_1_Test, CopyOperTS1)
     ASSERT_TRUE(ts2_t12r.second);
 }
 
+//------------------------------------------------------------------------------
+
+// индекс выходных переходов по меткам
+TEST_F(LabeledTS_1_Test, TransIndex1)
+{
+    typedef LabeledTS<int, int> Lts1;
+    typedef Lts1::TransIndex::StateIndex StIdx;
+
+    Lts1 ts;
+    ts.setTransIndexing(true);
+    ASSERT_TRUE(ts.isTransIndexing());
+
+    // состояние 0 с 20 выходными переходами (в т.ч. одинаково помеченными)
+    Lts1::State s0 = ts.getOrAddState(0);
+    for (int i = 1; i <= 20; ++i)
+        ts.getOrAddTrans(s0, ts.getOrAddState(i), i % 10);
+
+    const StIdx* si = ts.getTransIndex()->getStateIndex(s0);
+    ASSERT_TRUE(si != nullptr);
+    EXPECT_EQ(20u, si->getSize());
+    EXPECT_TRUE(si->isHashed());
+
+    // результаты поиска совпадают с перебором
+    Lts1 ts2(ts);
+    ts2.setTransIndexing(false);
+    for (int i = 1; i <= 20; ++i)
+    {
+        Lts1::TransRes tr = ts.getTrans(s0, ts.getState(i).first, i % 10);
+        ASSERT_TRUE(tr.second);
+        EXPECT_EQ(ts.getState(i).first, ts.getTargState(tr.first));
+        EXPECT_FALSE(ts.getTrans(s0, ts.getState(i).first, i % 10 + 1).second);
+
+        Lts1::State s0c = ts2.getState(0).first;
+        EXPECT_TRUE(ts2.getTrans(s0c, ts2.getState(i).first, i % 10).second);
+    }
+    EXPECT_TRUE(ts.getFirstOutTrans(s0, 5).second);
+    EXPECT_FALSE(ts.getFirstOutTrans(s0, 42).second);
+    EXPECT_FALSE(ts.getFirstOutTrans(ts.getState(1).first, 1).second);
+
+    // удаление переходов и состояний поддерживает индекс
+    ts.removeTrans(ts.getTrans(s0, ts.getState(5).first, 5).first);
+    EXPECT_FALSE(ts.getTrans(s0, ts.getState(5).first, 5).second);
+    EXPECT_TRUE(ts.getFirstOutTrans(s0, 5).second);                // 15 ещё есть
+    for (int i = 6; i <= 20; ++i)
+        ts.removeState(ts.getState(i).first);
+    si = ts.getTransIndex()->getStateIndex(s0);
+    EXPECT_EQ(4u, si->getSize());
+    EXPECT_FALSE(si->isHashed());
+    EXPECT_FALSE(ts.getFirstOutTrans(s0, 5).second);
+    EXPECT_TRUE(ts.getTrans(s0, ts.getState(4).first, 4).second);
+
+    ts.clearOutTransitions(s0);
+    EXPECT_EQ(0u, ts.getTransIndex()->getStatesNum());
+}
+
+//------------------------------------------------------------------------------
+
+// хранение в векторах: плотные индексы, удаленные состояния и уплотнение
+TEST_F(LabeledTS_1_Test, VecStorage1)
+{
+    typedef LabeledTS<int, int, boost::no_property, boost::no_property, VecTsStorage> Lts1;
+
+    Lts1 ts;
+    for (int i = 0; i < 5; ++i)
+        EXPECT_EQ((size_t)i, ts.getStateIndex(ts.getOrAddState(i * 10)));
+
+    // цепочка 0 -> 10 -> 20 -> 30 -> 40
+    for (int i = 0; i < 4; ++i)
+    {
+        Lts1::Transition t = ts.getOrAddTrans(ts.getState(i * 10).first, ts.getState(i * 10 + 10).first, i);
+        EXPECT_EQ((size_t)i, ts.getTransIndex(t));
+    }
+    EXPECT_EQ(4u, ts.getTransIndexBound());
+
+    // удаляем состояние: индексы прочих не меняются
+    Lts1::State s40 = ts.getState(40).first;
+    ts.removeState(ts.getState(20).first);
+    EXPECT_EQ(4u, ts.getStatesNum());
+    EXPECT_EQ(2u, ts.getTransitionsNum());
+    EXPECT_EQ(1u, ts.getRemovedStatesNum());
+    EXPECT_TRUE(ts.isStateRemoved(2));
+    EXPECT_FALSE(ts.getState(20).second);
+    EXPECT_EQ(s40, ts.getState(40).first);
+    EXPECT_EQ(30, ts.getStateID(ts.getState(30).first));
+
+    int statesNum = 0;
+    Lts1::StateIter sCur, sEnd;
+    for (boost::tie(sCur, sEnd) = ts.getStates(); sCur != sEnd; ++sCur, ++statesNum)
+        EXPECT_NE(2u, *sCur);                   // удаленное пропускается
+    EXPECT_EQ(4, statesNum);
+
+    // копия сохраняет индексы
+    Lts1 ts2(ts);
+    EXPECT_EQ(4u, ts2.getStatesNum());
+    EXPECT_TRUE(ts2.isStateRemoved(2));
+    EXPECT_TRUE(ts2.getTrans(ts2.getState(30).first, ts2.getState(40).first, 3).second);
+
+    // уплотнение
+    ts.setTransIndexing(true);
+    std::vector<size_t> newIdx = ts.compact();
+    ASSERT_EQ(5u, newIdx.size());
+    EXPECT_EQ(Lts1::NO_INDEX, newIdx[2]);
+    EXPECT_EQ(3u, newIdx[4]);
+    EXPECT_EQ(4u, ts.getStateIndexBound());
+    EXPECT_EQ(0u, ts.getRemovedStatesNum());
+    EXPECT_EQ(2u, ts.getTransIndexBound());
+    EXPECT_EQ(3u, ts.getState(40).first);
+
+    Lts1::TransRes tr = ts.getTrans(ts.getState(30).first, ts.getState(40).first, 3);
+    ASSERT_TRUE(tr.second);
+    EXPECT_EQ(1u, ts.getTransIndex(tr.first));
+    EXPECT_TRUE(ts.getFirstOutTrans(ts.getState(0).first, 0).second);
+}
+
+//------------------------------------------------------------------------------
+
+// пакетное удаление переходов и состояний
+TEST_F(LabeledTS_1_Test, BulkRemove1)
+{
+    typedef LabeledTS<int, int> Lts1;
+
+    // полный граф на 5 состояниях с петлями и параллельными дугами
+    Lts1 ts;
+    ts.setTransIndexing(true);
+    for (int i = 0; i < 5; ++i)
+        ts.getOrAddState(i);
+    for (int i = 0; i < 5; ++i)
+        for (int j = 0; j < 5; ++j)
+        {
+            ts.getOrAddTrans(ts.getState(i).first, ts.getState(j).first, 10 * i + j);
+            ts.getOrAddTrans(ts.getState(i).first, ts.getState(j).first, 100 + 10 * i + j);
+        }
+    EXPECT_EQ(50u, ts.getTransitionsNum());
+
+    // удаляем все дуги с меткой меньше 100, одну из них дважды
+    std::vector<Lts1::Transition> trans;
+    Lts1::TransIter tCur, tEnd;
+    for (boost::tie(tCur, tEnd) = ts.getTransitions(); tCur != tEnd; ++tCur)
+        if (ts.extractTransLbl(*tCur) < 100)
+            trans.push_back(*tCur);
+    trans.push_back(trans.front());
+    EXPECT_EQ(25u, ts.removeTransitions(trans));
+    EXPECT_EQ(25u, ts.getTransitionsNum());
+    EXPECT_EQ(0u, ts.removeTransitions(std::vector<Lts1::Transition>()));
+
+    for (int i = 0; i < 5; ++i)
+    {
+        Lts1::State s = ts.getState(i).first;
+        EXPECT_EQ(5u, ts.getOutTransNum(s));
+        EXPECT_EQ(5u, ts.getInTransNum(s));
+        EXPECT_FALSE(ts.getTrans(s, s, 11 * i).second);
+        EXPECT_TRUE(ts.getTrans(s, s, 100 + 11 * i).second);
+        EXPECT_FALSE(ts.getFirstOutTrans(s, 10 * i).second);       // и из индекса
+        EXPECT_TRUE(ts.getFirstOutTrans(s, 100 + 10 * i).second);
+    }
+
+    // удаляем состояния 1 и 3 вместе с их дугами
+    std::vector<Lts1::State> states = { ts.getState(1).first, ts.getState(3).first, ts.getState(1).first };
+    EXPECT_EQ(2u, ts.removeStates(states));
+    EXPECT_EQ(3u, ts.getStatesNum());
+    EXPECT_EQ(9u, ts.getTransitionsNum());
+    EXPECT_FALSE(ts.getState(1).second);
+    EXPECT_FALSE(ts.getState(3).second);
+    EXPECT_EQ(3u, ts.getOutTransNum(ts.getState(4).first));
+    EXPECT_TRUE(ts.getFirstOutTrans(ts.getState(4).first, 140).second);
+    EXPECT_FALSE(ts.getFirstOutTrans(ts.getState(4).first, 141).second);
+}
+
+//------------------------------------------------------------------------------
+
+TEST_F(LabeledTS_1_Test, BulkRemove2)
+{
+    typedef LabeledTS<int, int, boost::no_property, boost::no_property, VecTsStorage> Lts1;
+
+    // цепочка 0 -> 1 -> ... -> 5 и обратные дуги
+    Lts1 ts;
+    for (int i = 0; i < 6; ++i)
+        ts.getOrAddState(i);
+    for (int i = 0; i < 5; ++i)
+    {
+        ts.getOrAddTrans(ts.getState(i).first, ts.getState(i + 1).first, i);
+        ts.getOrAddTrans(ts.getState(i + 1).first, ts.getState(i).first, -i);
+    }
+
+    std::vector<Lts1::State> states = { ts.getState(2).first, ts.getState(4).first };
+    EXPECT_EQ(2u, ts.removeStates(states));
+    EXPECT_EQ(4u, ts.getStatesNum());
+    EXPECT_EQ(2u, ts.getTransitionsNum());
+    EXPECT_EQ(2u, ts.getRemovedStatesNum());
+
+    // индексы оставшихся дуг прежние, уплотнение перенумеровывает
+    Lts1::TransRes tr = ts.getTrans(ts.getState(1).first, ts.getState(0).first, 0);
+    ASSERT_TRUE(tr.second);
+    EXPECT_EQ(1u, ts.getTransIndex(tr.first));
+
+    ts.compact();
+    EXPECT_EQ(4u, ts.getStateIndexBound());
+    EXPECT_EQ(2u, ts.getTransIndexBound());
+    EXPECT_TRUE(ts.getTrans(ts.getState(0).first, ts.getState(1).first, 0).second);
+}
+
+//------------------------------------------------------------------------------
+
+// хранение на арене: граф и мапы занимают память у арены TS
+TEST_F(LabeledTS_1_Test, ArenaStorage1)
+{
+    typedef LabeledTS<std::string, int, boost::no_property, boost::no_property, ArenaTsStorage> Lts1;
+
+    Lts1* ts = new Lts1();
+    ASSERT_NE(nullptr, ts->getArena());
+    size_t used0 = ts->getArena()->getUsedBytes();
+
+    // цепочка s0 -> s1 -> ... -> s9 и анонимное состояние
+    for (int i = 0; i < 10; ++i)
+        ts->getOrAddState("s" + std::to_string(i));
+    for (int i = 0; i < 9; ++i)
+        ts->getOrAddTrans(ts->getState("s" + std::to_string(i)).first,
+            ts->getState("s" + std::to_string(i + 1)).first, i);
+    Lts1::State anon = ts->addAnonState();
+    ts->getOrAddTrans(ts->getState("s9").first, anon, 9);
+    EXPECT_EQ(11u, ts->getStatesNum());
+    EXPECT_EQ(10u, ts->getTransitionsNum());
+    EXPECT_LT(used0, ts->getArena()->getUsedBytes());
+    EXPECT_LT(0u, ts->memoryUsage().getBytes("arena.unused"));
+
+    // удаление
+    ts->removeState(ts->getState("s5").first);
+    EXPECT_EQ(10u, ts->getStatesNum());
+    EXPECT_EQ(8u, ts->getTransitionsNum());
+    EXPECT_FALSE(ts->getState("s5").second);
+    EXPECT_TRUE(ts->isStateAnon(anon));
+
+    // копия не зависит от арены источника
+    Lts1 ts2(*ts);
+    EXPECT_NE(ts->getArena(), ts2.getArena());
+    delete ts;
+
+    EXPECT_EQ(10u, ts2.getStatesNum());
+    EXPECT_EQ(8u, ts2.getTransitionsNum());
+    EXPECT_TRUE(ts2.getTrans(ts2.getState("s8").first, ts2.getState("s9").first, 8).second);
+    EXPECT_FALSE(ts2.getState("s5").second);
+    ts2.getOrAddTrans(ts2.getState("s4").first, ts2.getState("s6").first, 4);
+    EXPECT_EQ(9u, ts2.getTransitionsNum());
+
+    // присваивание
+    Lts1 ts3;
+    ts3 = ts2;
+    EXPECT_EQ(10u, ts3.getStatesNum());
+    EXPECT_TRUE(ts3.getTrans(ts3.getState("s4").first, ts3.getState("s6").first, 4).second);
+
+    // записи вершин тоже берутся у арены
+    size_t used3 = ts3.getArena()->getUsedBytes();
+    ts3.addAnonState();
+    EXPECT_LE(used3 + sizeof(Lts1::Graph::stored_vertex), ts3.getArena()->getUsedBytes());
+
+    // хранение на арене не используется по умолчанию
+    EXPECT_EQ(nullptr, (LabeledTS<int, int>().getArena()));
+}
+
 //==============================================================================
 // тестирование некоторых побочных моментов
 //==============================================================================
@@ -0,0 +1,227 @@
+///////////////////////////////////////////////////////////////////////////////
+/// \file
+/// \brief Testing overlays over event log TSs
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#include <gtest/gtest.h>
+
+// ldopa
+#include "xi/ldopa/ts/models/overlay_ts.h"
+#include "xi/ldopa/ts/models/frozen_ts.h"
+#include "xi/ldopa/ts/models/eventlog_ts_stateids.h"
+#include "xi/ldopa/ts/algos/ts_simple_builder.h"
+#include "xi/ldopa/ts/algos/freq_condenser.h"
+#include "xi/ldopa/ts/algos/varws_ts_rebuilder.h"
+#include "xi/ldopa/eventlog/sqlite/sqlitelog.h"
+
+#include "constants.h"
+
+// std
+#include <memory>
+
+namespace {
+
+using namespace xi::ldopa;
+using namespace xi::ldopa::ts;
+
+//==============================================================================
+// class EvLogTSOverlay
+//==============================================================================
+
+// удаления в оверлее не затрагивают исходную СП
+TEST(EvLogTSOverlay1, removals1)
+{
+    typedef EvLogTSWithFreqs TS;
+
+    AttrListStateIDsPool pool;
+    TS ts(&pool);
+
+    // init -a-> a -b-> ab;  a -c-> ac
+    TS::State st_init = ts.getInitState();
+    TS::State st_a = ts.getOrAddState(pool[{ "a" }]);
+    TS::State st_ab = ts.getOrAddState(pool[{ "a", "b" }]);
+    TS::State st_ac = ts.getOrAddState(pool[{ "a", "c" }]);
+    TS::Transition t_a = ts.getOrAddTransF(st_init, st_a, "a", 3);
+    TS::Transition t_b = ts.getOrAddTransF(st_a, st_ab, "b", 2);
+    ts.getOrAddTransF(st_a, st_ac, "c", 1);
+    ts.setAcceptingState(st_ab, true);
+
+    EvLogTSOverlay ovl(&ts);
+    EXPECT_EQ(4, ovl.getStatesNum());
+    EXPECT_EQ(3, ovl.getTransitionsNum());
+    EXPECT_EQ(t_b, ovl.getFirstOutTrans(st_a, "b").first);
+
+    // удаление состояния убирает и его переходы
+    ovl.removeState(st_ab);
+    EXPECT_EQ(3, ovl.getStatesNum());
+    EXPECT_EQ(2, ovl.getTransitionsNum());
+    EXPECT_TRUE(ovl.isTransRemoved(t_b));
+    EXPECT_FALSE(ovl.getFirstOutTrans(st_a, "b").second);
+    EXPECT_EQ(1, std::distance(ovl.getOutTransitions(st_a).first, ovl.getOutTransitions(st_a).second));
+
+    // изменение атрибутов
+    ovl.setTransFreq(t_a, 10);
+    ovl.setAcceptingState(st_ac, true);
+    EXPECT_EQ(10, ovl.getTransFreq(t_a).first);
+    EXPECT_EQ(3, ts.getTransFreq(t_a).first);
+    EXPECT_TRUE(ovl.isStateAccepting(st_ac));
+    EXPECT_FALSE(ts.isStateAccepting(st_ac));
+
+    // исходная СП не изменилась
+    EXPECT_EQ(4, ts.getStatesNum());
+    EXPECT_EQ(3, ts.getTransitionsNum());
+
+    // материализация
+    TS* mts = ovl.materialize();
+    EXPECT_EQ(3, mts->getStatesNum());
+    EXPECT_EQ(2, mts->getTransitionsNum());
+    EXPECT_FALSE(mts->getState(pool[{ "a", "b" }]).second);
+    TS::State m_ac = mts->getState(pool[{ "a", "c" }]).first;
+    EXPECT_TRUE(mts->isStateAccepting(m_ac));
+    TS::TransRes m_a = mts->getFirstOutTrans(mts->getInitState(), "a");
+    ASSERT_TRUE(m_a.second);
+    EXPECT_EQ(10, mts->getTransFreq(m_a.first).first);
+    delete mts;
+
+    // снимок оверлея
+    FrozenEvLogTS fts(ovl);
+    EXPECT_EQ(3u, fts.getStatesNum());
+    EXPECT_EQ(2u, fts.getTransitionsNum());
+
+    ovl.reset();
+    EXPECT_EQ(4, ovl.getStatesNum());
+    EXPECT_EQ(3, ovl.getTransitionsNum());
+}
+
+//-----------------------------------------------------------------------------
+
+// перебор порогов сгущения без копирования префиксного дерева
+TEST(EvLogTSOverlay1, condenser1)
+{
+    using eventlog::SQLiteLog;
+    typedef EvLogTSWithFreqs TS;
+
+    SQLiteLog log(CSVLOG1_TEST_LOGS_BASE_DIR "logs/log05.sq3");
+    log.setAutoLoadConfig(true);
+    log.setAutoLoadConfigQry("SELECT * FROM DefConfig");
+    log.open();
+
+    AttrListStateIDsPool pool;
+    PrefixStateFunc fnc(&log, &pool);
+    TsBuilder bldr(&log, &fnc, &pool);
+    TS* ts = bldr.build(true);
+
+    CondensedTsBuilder reducer(ts);
+    const double thresholds[] = { 0, 0.2, 0.33, 0.4, 0.6, 1 };
+    for (double thr : thresholds)
+    {
+        const EvLogTSOverlay* ovl = reducer.buildOverlay(thr);
+        EXPECT_EQ(16, ts->getStatesNum());              // исходная СП не меняется
+
+        TS* rts = reducer.build(thr);
+        EXPECT_EQ(rts->getStatesNum(), ovl->getStatesNum());
+        EXPECT_EQ(rts->getTransitionsNum(), ovl->getTransitionsNum());
+        EXPECT_EQ(6, rts->getMaxWS());
+    }
+
+    // 33 %: 6 вершин и 5 дуг, восстановление из материализованного оверлея
+    const EvLogTSOverlay* ovl = reducer.buildOverlay(0.33);
+    EXPECT_EQ(6, ovl->getStatesNum());
+    EXPECT_EQ(5, ovl->getTransitionsNum());
+
+    std::unique_ptr<TS> mts(ovl->materialize());
+    VarWsTsBuilder rebuilder(&log, mts.get(), &fnc);
+    TS* fts = rebuilder.build(1, VarWsTsBuilder::zsaSpecState);
+    EXPECT_EQ(12, fts->getStatesNum());
+    EXPECT_EQ(13, fts->getTransitionsNum());
+}
+
+//-----------------------------------------------------------------------------
+
+// перебор возрастающих порогов дает то же, что и сгущение с нуля
+TEST(EvLogTSOverlay1, condenserSweep1)
+{
+    using eventlog::SQLiteLog;
+    typedef EvLogTSWithFreqs TS;
+
+    SQLiteLog log(CSVLOG1_TEST_LOGS_BASE_DIR "logs/log05.sq3");
+    log.setAutoLoadConfig(true);
+    log.setAutoLoadConfigQry("SELECT * FROM DefConfig");
+    log.open();
+
+    AttrListStateIDsPool pool;
+    PrefixStateFunc fnc(&log, &pool);
+    TsBuilder bldr(&log, &fnc, &pool);
+    TS* ts = bldr.build(true);
+
+    const std::vector<double> thresholds = { 0, 0.1, 0.2, 0.33, 0.4, 0.6, 1 };
+    CondensedTsBuilder ref(ts);
+    CondensedTsBuilder reducer(ts);
+    CondensedTsBuilder::VecOfSweepPoints pts = reducer.sweepCounts(thresholds);
+    ASSERT_EQ(thresholds.size(), pts.size());
+    for (size_t i = 0; i < thresholds.size(); ++i)
+    {
+        const EvLogTSOverlay* rovl = ref.buildOverlay(thresholds[i]);
+        EXPECT_EQ(ref.getMinPresFreq(), pts[i].minPresFreq);
+        EXPECT_EQ(rovl->getStatesNum(), pts[i].statesNum);
+        EXPECT_EQ(rovl->getTransitionsNum(), pts[i].transNum);
+    }
+    EXPECT_EQ(6, pts[3].statesNum);                     // 33 %: 6 вершин и 5 дуг
+    EXPECT_EQ(5, pts[3].transNum);
+
+    // пошагово, с материализацией
+    reducer.startSweep();
+    reducer.sweepOverlay(0.1);
+    TS* rts = reducer.sweep(0.33);
+    EXPECT_EQ(6, rts->getStatesNum());
+    EXPECT_EQ(5, rts->getTransitionsNum());
+    EXPECT_EQ(16, ts->getStatesNum());                  // исходная СП не меняется
+
+    // порог меньше предыдущего — только после нового начала
+    EXPECT_THROW(reducer.sweepOverlay(0.2), LdopaException);
+    reducer.startSweep();
+    EXPECT_EQ(ref.buildOverlay(0.2)->getStatesNum(), reducer.sweepOverlay(0.2)->getStatesNum());
+}
+
+//-----------------------------------------------------------------------------
+
+// "вдовы" с обратными дугами и петлями удаляются так же, как при сгущении с нуля
+TEST(EvLogTSOverlay1, condenserSweep2)
+{
+    typedef EvLogTSWithFreqs TS;
+
+    AttrListStateIDsPool pool;
+    TS ts(&pool);
+    ts.setTracesNum(10);
+
+    // init -a(9)-> a -b(4)-> b -c(6)-> c -d(2)-> d;  c -e(7)-> a;  b -f(1)-> b;  d -g(8)-> b
+    TS::State st_init = ts.getInitState();
+    TS::State st_a = ts.getOrAddState(pool[{ "a" }]);
+    TS::State st_b = ts.getOrAddState(pool[{ "b" }]);
+    TS::State st_c = ts.getOrAddState(pool[{ "c" }]);
+    TS::State st_d = ts.getOrAddState(pool[{ "d" }]);
+    ts.getOrAddTransF(st_init, st_a, "a", 9);
+    ts.getOrAddTransF(st_a, st_b, "b", 4);
+    ts.getOrAddTransF(st_b, st_c, "c", 6);
+    ts.getOrAddTransF(st_c, st_d, "d", 2);
+    ts.getOrAddTransF(st_c, st_a, "e", 7);
+    ts.getOrAddTransF(st_b, st_b, "f", 1);
+    ts.getOrAddTransF(st_d, st_b, "g", 8);
+
+    CondensedTsBuilder ref(&ts);
+    CondensedTsBuilder reducer(&ts);
+    for (int i = 0; i <= 10; ++i)
+    {
+        const double thr = i / 10.0;
+        const EvLogTSOverlay* rovl = ref.buildOverlay(thr);
+        const EvLogTSOverlay* sovl = reducer.sweepOverlay(thr);
+
+        EXPECT_EQ(rovl->getStatesNum(), sovl->getStatesNum());
+        EXPECT_EQ(rovl->getTransitionsNum(), sovl->getTransitionsNum());
+        for (TS::StateIterPair sts = ts.getStates(); sts.first != sts.second; ++sts.first)
+            EXPECT_EQ(rovl->isStateRemoved(*sts.first), sovl->isStateRemoved(*sts.first));
+    }
+}
+
+} // namespace
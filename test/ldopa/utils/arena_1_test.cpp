@@ -0,0 +1,117 @@
+///////////////////////////////////////////////////////////////////////////////
+/// \file
+/// \brief Testing the monotonic arena and the arena allocator
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#include <gtest/gtest.h>
+
+// ldopa
+#include "xi/ldopa/utils/arena.h"
+
+// std
+#include <cstdint>
+#include <list>
+#include <map>
+
+namespace {
+
+using namespace xi::ldopa;
+
+//==============================================================================
+// class MonotonicArena
+//==============================================================================
+
+TEST(MonotonicArena1, simple1)
+{
+    MonotonicArena arena(256);
+    EXPECT_EQ(0u, arena.getReservedBytes());
+    EXPECT_EQ(0u, arena.getChunksNum());
+
+    void* p1 = arena.allocate(10, 1);
+    void* p2 = arena.allocate(8, 8);
+    EXPECT_EQ(0u, (uintptr_t)p2 % 8);
+    EXPECT_LT((char*)p1, (char*)p2);
+    EXPECT_EQ(18u, arena.getUsedBytes());
+    EXPECT_EQ(256u, arena.getReservedBytes());
+    EXPECT_EQ(1u, arena.getChunksNum());
+
+    // следующий кусок вдвое больше
+    arena.allocate(250, 1);
+    EXPECT_EQ(2u, arena.getChunksNum());
+    EXPECT_EQ(256u + 512u, arena.getReservedBytes());
+
+    // крупный запрос получает отдельный кусок, текущий продолжает использоваться
+    arena.allocate(10000, 8);
+    EXPECT_EQ(3u, arena.getChunksNum());
+    arena.allocate(10, 1);
+    EXPECT_EQ(3u, arena.getChunksNum());
+
+    arena.release();
+    EXPECT_EQ(0u, arena.getReservedBytes());
+    EXPECT_EQ(0u, arena.getUsedBytes());
+    EXPECT_EQ(0u, arena.getChunksNum());
+}
+
+//------------------------------------------------------------------------------
+
+TEST(MonotonicArena1, create1)
+{
+    struct Pt { 
+        Pt(int x_, double y_) : x(x_), y(y_) {} 
+        int x; 
+        double y; 
+    };
+
+    MonotonicArena arena;
+    Pt* p = arena.create<Pt>(1, 2.5);
+    EXPECT_EQ(1, p->x);
+    EXPECT_DOUBLE_EQ(2.5, p->y);
+    EXPECT_EQ(0u, (uintptr_t)p % alignof(Pt));
+    EXPECT_EQ(sizeof(Pt), arena.getUsedBytes());
+}
+
+//==============================================================================
+// class ArenaAllocator
+//==============================================================================
+
+TEST(ArenaAllocator1, containers1)
+{
+    typedef std::map<int, int, std::less<int>, ArenaAllocator<std::pair<const int, int> > > Map;
+    typedef std::list<int, ArenaAllocator<int> > List;
+
+    MonotonicArena arena;
+    Map* m = new Map(Map::allocator_type(&arena));
+    for (int i = 0; i < 100; ++i)
+        (*m)[i] = i * i;
+    EXPECT_EQ(&arena, m->get_allocator().getArena());
+    EXPECT_LE(100 * sizeof(std::pair<const int, int>), arena.getUsedBytes());
+
+    // копия размещается в куче
+    Map m2(*m);
+    EXPECT_EQ(nullptr, m2.get_allocator().getArena());
+    m->erase(10);
+    delete m;
+    arena.release();
+
+    EXPECT_EQ(100u, m2.size());
+    EXPECT_EQ(81, m2[9]);
+
+    // без арены работает как обычный аллокатор
+    List l;
+    l.push_back(1);
+    l.push_back(2);
+    l.pop_front();
+    EXPECT_EQ(2, l.front());
+    EXPECT_EQ(nullptr, l.get_allocator().getArena());
+
+    // созданный по умолчанию контейнер привязывается к арене присваиванием пустого
+    MonotonicArena arena2;
+    List l2;
+    l2 = List(List::allocator_type(&arena2));
+    EXPECT_EQ(&arena2, l2.get_allocator().getArena());
+    l2.push_back(3);
+    EXPECT_LT(0u, arena2.getUsedBytes());
+}
+
+} // namespace
@@ -0,0 +1,221 @@
+///////////////////////////////////////////////////////////////////////////////
+/// \file
+/// \brief Testing memory accounting of TSs, pools, logs and synthesizers
+///
+///////////////////////////////////////////////////////////////////////////////
+
+#include <gtest/gtest.h>
+
+// ldopa
+#include "xi/ldopa/utils/mem_usage.h"
+#include "xi/ldopa/ts/models/evlog_ts_red.h"
+#include "xi/ldopa/ts/models/evlog_ts_fold.h"
+#include "xi/ldopa/ts/models/frozen_ts.h"
+#include "xi/ldopa/ts/models/overlay_ts.h"
+#include "xi/ldopa/ts/models/eventlog_ts_stateids.h"
+#include "xi/ldopa/ts/algos/ts_simple_builder.h"
+#include "xi/ldopa/eventlog/sqlite/sqlitelog.h"
+#include "xi/ldopa/pn/models/evlog_ptnets.h"
+#include "xi/ldopa/pn/algos/regions/pn_synthesis.h"
+
+// std
+#include <sstream>
+
+#include "constants.h"
+
+namespace {
+
+using namespace xi::ldopa;
+using namespace xi::ldopa::ts;
+
+//==============================================================================
+// class MemUsage
+//==============================================================================
+
+TEST(MemUsage1, simple1)
+{
+    MemUsage mu;
+    EXPECT_EQ(0u, mu.getTotal());
+
+    mu.add("a", 10);
+    mu.add("b", 5);
+    mu.add("a", 1);                                     // накапливается
+    EXPECT_EQ(11u, mu.getBytes("a"));
+    EXPECT_EQ(0u, mu.getBytes("c"));
+    EXPECT_EQ(16u, mu.getTotal());
+    EXPECT_EQ(2u, mu.getComponents().size());
+
+    // объединение с префиксом
+    MemUsage rep;
+    rep.add("x", mu);
+    rep.add("x", mu);
+    rep.add("", mu);
+    EXPECT_EQ(22u, rep.getBytes("x.a"));
+    EXPECT_EQ(10u, rep.getBytes("x.b"));
+    EXPECT_EQ(11u, rep.getBytes("a"));
+    EXPECT_EQ(48u, rep.getTotal());
+    EXPECT_EQ("x.a", rep.getComponents()[0].first);     // порядок первого добавления
+
+    std::ostringstream os;
+    rep.print(os);
+    EXPECT_NE(std::string::npos, os.str().find("total: 48"));
+}
+
+//------------------------------------------------------------------------------
+
+TEST(MemUsage1, containers1)
+{
+    std::vector<int> v;
+    v.reserve(10);
+    EXPECT_EQ(10 * sizeof(int), mem::contBytes(v));
+
+    std::string s1("short");
+    std::string s2(100, 'x');
+    EXPECT_EQ(0u, mem::contBytes(s1));
+    EXPECT_EQ(s2.capacity() + 1, mem::contBytes(s2));
+    EXPECT_EQ(mem::STRING_SSO_CAP, std::string().capacity());      // раскладка определена верно
+
+    std::set<int> st = { 1, 2, 3 };
+    EXPECT_EQ((3 + mem::HEAD_NODES) * (sizeof(int) + mem::TREE_NODE_OVERHEAD), mem::contBytes(st));
+}
+
+//==============================================================================
+// TSs and pools
+//==============================================================================
+
+TEST(MemUsage1, ts1)
+{
+    typedef EvLogTSWithFreqs TS;
+
+    AttrListStateIDsPool pool;
+    TS ts(&pool);
+
+    MemUsage mu0 = ts.memoryUsage();
+    EXPECT_LT(0u, mu0.getBytes("lts.graph.vertices"));
+    EXPECT_EQ(mem::HEAD_NODES == 0, mu0.getBytes("lts.graph.edges") == 0);
+
+    TS::State st_init = ts.getInitState();
+    TS::State st_a = ts.getOrAddState(pool[{ "a" }]);
+    TS::State st_ab = ts.getOrAddState(pool[{ "a", "b" }]);
+    ts.getOrAddTransF(st_init, st_a, "a", 3);
+    ts.getOrAddTransF(st_a, st_ab, "b", 2);
+
+    MemUsage mu1 = ts.memoryUsage();
+    EXPECT_LT(mu0.getBytes("lts.graph.vertices"), mu1.getBytes("lts.graph.vertices"));
+    EXPECT_LT(0u, mu1.getBytes("lts.graph.edges"));
+    EXPECT_LT(0u, mu1.getBytes("lts.graph.adjacency"));
+    EXPECT_LT(mu0.getBytes("lts.stateIdMap"), mu1.getBytes("lts.stateIdMap"));
+    // арена (xi_ARENA_TS) резервирует память блоками: растет только занятая часть
+    EXPECT_LT(mu0.getTotal() - mu0.getBytes("lts.arena.unused"),
+        mu1.getTotal() - mu1.getBytes("lts.arena.unused"));
+
+    // пул: 3 идентификатора и их атрибуты
+    MemUsage pmu = pool.memoryUsage();
+    EXPECT_LT(0u, pmu.getBytes("ids"));
+    EXPECT_EQ(3 * sizeof(AttrListStateId::VectorOfAttrs::value_type), pmu.getBytes("ids.attrs"));
+
+    // снимок и оверлей
+    FrozenEvLogTS fts(ts);
+    EXPECT_LT(0u, fts.memoryUsage().getBytes("columns"));
+
+    EvLogTSOverlay ovl(&ts);
+    size_t remBytes0 = ovl.memoryUsage().getBytes("removedStates");
+    ovl.removeState(st_ab);
+    EXPECT_LT(remBytes0, ovl.memoryUsage().getBytes("removedStates"));
+
+    // сводный отчет
+    MemUsage rep;
+    rep.add("ts", ts.memoryUsage());
+    rep.add("pool", pmu);
+    EXPECT_EQ(mu1.getTotal() + pmu.getTotal(), rep.getTotal());
+}
+
+//------------------------------------------------------------------------------
+
+TEST(MemUsage1, parVecs1)
+{
+    FixedIntListStateIdsPool pool(2);
+    EvLogTSWithParVecs ts(&pool);
+
+    ParikhVector pv(2);
+    pv.AddAttrCnt(0, 1);
+    EvLogTSWithParVecs::State st_a = ts.getOrAddState(pool[{ 1, 0 }]);
+    ts.setParikhVector(st_a, &pv);
+
+    MemUsage mu = ts.memoryUsage();
+    EXPECT_LT(0u, mu.getBytes("lts.graph.vertices"));
+    EXPECT_LE(2 * sizeof(ParikhVector::Value), mu.getBytes("parikhVectors"));
+    EXPECT_EQ(2 * 2 * sizeof(ParikhVector::Value), pool.memoryUsage().getBytes("ids.ints"));
+}
+
+//==============================================================================
+// Logs and synthesizers
+//==============================================================================
+
+TEST(MemUsage1, sqliteLog1)
+{
+    using eventlog::SQLiteLog;
+
+    SQLiteLog log(CSVLOG1_TEST_LOGS_BASE_DIR "logs/log05.sq3");
+    log.setAutoLoadConfig(true);
+    log.setAutoLoadConfigQry("SELECT * FROM DefConfig");
+    log.open();
+
+    MemUsage mu0 = log.memoryUsage();
+    EXPECT_EQ(0u, mu0.getBytes("traces.events.attrs"));
+    EXPECT_LT(0u, mu0.getBytes("queries"));
+
+    // извлекаем события всех трасс
+    for (int i = 0; i < log.getTracesNum(); ++i)
+    {
+        eventlog::IEventTrace* tr = log.getTrace(i);
+        for (int j = 0; j < tr->getSize(); ++j)
+            tr->getEvent(j);
+    }
+
+    MemUsage mu1 = log.memoryUsage();
+    EXPECT_LT(0u, mu1.getBytes("traces.object"));
+    EXPECT_LT(0u, mu1.getBytes("traces.events.object"));
+    EXPECT_LT(0u, mu1.getBytes("traces.events.attrs"));
+    EXPECT_LT(mu0.getTotal(), mu1.getTotal());
+    EXPECT_EQ(0u, mu1.getBytes("strPool"));              // интернирование выключено
+}
+
+//------------------------------------------------------------------------------
+
+TEST(MemUsage1, synthesizer1)
+{
+    using namespace xi::ldopa::pn;
+    typedef EvLogTSWithFreqs TS;
+    typedef EventLogPetriNet<> PN;
+
+    AttrListStateIDsPool pool;
+    TS ts(&pool);
+    TS::State st_init = ts.getInitState();
+    TS::State s2 = ts.getOrAddState(pool[{ "s2" }]);
+    TS::State s3 = ts.getOrAddState(pool[{ "s3" }]);
+    TS::State s4 = ts.getOrAddState(pool[{ "s4" }]);
+    TS::State s5 = ts.getOrAddState(pool[{ "s5" }]);
+    TS::State s6 = ts.getOrAddState(pool[{ "s6" }]);
+    ts.setAcceptingState(s6, true);
+    ts.getOrAddTrans(st_init, s2, "a");
+    ts.getOrAddTrans(st_init, s3, "b");
+    ts.getOrAddTrans(s2, s4, "c");
+    ts.getOrAddTrans(s3, s5, "c");
+    ts.getOrAddTrans(s4, s6, "b");
+    ts.getOrAddTrans(s5, s6, "a");
+
+    PnRegSynthesizer<TS, PN> synth(&ts);
+    EXPECT_EQ(0u, synth.memoryUsage().getTotal());
+
+    synth.synthesize();
+    MemUsage mu = synth.memoryUsage();
+    EXPECT_LT(0u, mu.getBytes("pn.object"));
+    EXPECT_LT(0u, mu.getBytes("pn.graph.vertices"));
+    EXPECT_LT(0u, mu.getBytes("pn.graph.edges"));
+    EXPECT_LT(0u, mu.getBytes("lbl2Trans"));
+    EXPECT_LT(0u, mu.getBytes("minPreRegions"));
+    EXPECT_LT(0u, mu.getBytes("mapper"));
+}
+
+} // namespace
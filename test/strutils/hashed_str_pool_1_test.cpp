@@ -0,0 +1,140 @@
+////////////////////////////////////////////////////////////////////////////////
+/// \file
+/// \brief     Tests for string pools.
+/// \author    Sergey Shershakov
+/// \version   0.1.0
+/// \date      18.10.2026
+/// \copyright (c) xidv.ru 2014–2017.
+///            This source is for internal use only — Restricted Distribution.
+///            All rights reserved.
+///
+////////////////////////////////////////////////////////////////////////////////
+
+#include <gtest/gtest.h>
+
+#include "xi/strutils/set_str_pool.h"
+#include "xi/strutils/hashed_str_pool.h"
+
+// std
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using namespace xi::strutils;
+
+//===================================================================================
+
+TEST(SetStrPool1, insert1)
+{
+    SetStrPool pool;
+    std::string a = "abc";
+    const std::string* p1 = pool.insert(a);
+    const std::string* p2 = pool[std::string_view(a)];
+    EXPECT_EQ(p1, p2);
+    EXPECT_EQ(1u, pool.getPool().size());
+
+    EXPECT_EQ(p1, pool.find("abc"));
+    EXPECT_EQ(nullptr, pool.find("abd"));
+}
+
+//-----------------------------------------------------------------------------
+
+TEST(StrArena1, store1)
+{
+    StrArena ar(16);
+    std::string_view s1 = ar.store("abc");
+    std::string_view s2 = ar.store("defgh");
+    EXPECT_EQ("abc", s1);
+    EXPECT_EQ('\0', s1.data()[3]);
+    EXPECT_EQ(s1.data() + 4, s2.data());            // подряд в одном куске
+    EXPECT_EQ(16u, ar.getAllocatedSize());
+    EXPECT_EQ(10u, ar.getUsedSize());
+
+    // длинная строка — отдельным куском, текущий кусок продолжает заполняться
+    std::string_view s3 = ar.store("0123456789");
+    std::string_view s4 = ar.store("x");
+    EXPECT_EQ("0123456789", s3);
+    EXPECT_EQ(s2.data() + 6, s4.data());
+    EXPECT_EQ(27u, ar.getAllocatedSize());
+
+    // не влезает в остаток — новый кусок
+    std::string_view s5 = ar.store("yz");
+    EXPECT_EQ(s4.data() + 2, s5.data());
+    EXPECT_EQ(27u, ar.getAllocatedSize());
+    std::string_view s6 = ar.store("u");
+    EXPECT_EQ("u", s6);
+    EXPECT_EQ(43u, ar.getAllocatedSize());
+
+    ar.clear();
+    EXPECT_EQ(0u, ar.getAllocatedSize());
+}
+
+//-----------------------------------------------------------------------------
+
+TEST(HashedStrPool1, insert1)
+{
+    HashedStrPool pool(64);
+    std::string_view a1 = pool.insert("abc");
+    std::string_view a2 = pool[std::string("abc")];
+    std::string_view b = pool.insert("abd");
+
+    EXPECT_EQ(a1.data(), a2.data());
+    EXPECT_NE(a1.data(), b.data());
+    EXPECT_EQ(2u, pool.getSize());
+    EXPECT_EQ("abd", b);
+
+    EXPECT_EQ(a1.data(), pool.find("abc").data());
+    EXPECT_EQ(nullptr, pool.find("abe").data());
+    EXPECT_TRUE(pool.contains(a1));
+    EXPECT_FALSE(pool.contains("abc"));             // не из пула
+
+    // много строк: при росте таблицы строки не перемещаются
+    std::vector<std::string_view> views;
+    for (int i = 0; i < 1000; ++i)
+        views.push_back(pool.insert(std::to_string(i)));
+    for (int i = 0; i < 1000; ++i)
+        EXPECT_EQ(views[i].data(), pool.insert(std::to_string(i)).data());
+    EXPECT_EQ(1002u, pool.getSize());
+    EXPECT_EQ(a1.data(), pool.find("abc").data());
+
+    pool.clear();
+    EXPECT_EQ(0u, pool.getSize());
+}
+
+//-----------------------------------------------------------------------------
+
+TEST(ConcurrentStrPool1, insert1)
+{
+    ConcurrentStrPool pool(5);
+    EXPECT_EQ(8u, pool.getShardsNum());
+
+    const int THREADS = 4;
+    const int STRS = 2000;
+    std::vector<std::vector<std::string_view>> res(THREADS);
+    std::vector<std::thread> thrs;
+    for (int t = 0; t < THREADS; ++t)
+        thrs.emplace_back([&pool, &res, t]() {
+            for (int i = 0; i < STRS; ++i)
+                res[t].push_back(pool.insert("s" + std::to_string((i * 7 + t) % STRS)));
+        });
+    for (std::thread& th : thrs)
+        th.join();
+
+    EXPECT_EQ((std::size_t)STRS, pool.getSize());
+
+    // одинаковые строки из разных потоков — один экземпляр
+    for (int t = 0; t < THREADS; ++t)
+        for (int i = 0; i < STRS; ++i)
+        {
+            std::string s = "s" + std::to_string((i * 7 + t) % STRS);
+            ASSERT_EQ(s, res[t][i]);
+            ASSERT_EQ(pool.find(s).data(), res[t][i].data());
+        }
+
+    pool.clear();
+    EXPECT_EQ(0u, pool.getSize());
+}
+
+} // namespace